@@ -3,17 +3,8 @@
 #include "catpc_utils.hpp"
 
 #include <vector>
-#include <functional>
-#include <bitset>
 #include "pqos.h"
 
-#include <boost/math/statistics/linear_regression.hpp>
-
-#define MAX_NUM_WAYS 11
-
-std::vector<double> way_occupancy_ratios;
-std::vector<std::vector<std::reference_wrapper<double>>> CLOS_occupency_ratios;
-
 std::vector<llc_ca> get_allocation_config() 
 {
 	int ret;
@@ -50,32 +41,16 @@ std::vector<llc_ca> get_allocation_config()
 		}
 	}
 
-	// Init occupancy ratios
-	for (unsigned i = 0; i < si.l3_cap->u.l3ca->num_ways; ++i) {
-		way_occupancy_ratios.push_back(0);
-	}
-
-	for (unsigned i = 0; i < llc_ca_list.back().clos_count; ++i) {
-		CLOS_occupency_ratios.push_back(std::vector<std::reference_wrapper<double>>());
-		std::bitset<MAX_NUM_WAYS> bitmask{ llc_ca_list.back().clos_list[i].mask };
-		for (int j = 0; j < MAX_NUM_WAYS; ++j) {
-			if (bitmask[j] == 1) {
-				CLOS_occupency_ratios.back().push_back(way_occupancy_ratios[j]);
-			}
-		}
-	}
-
 	return llc_ca_list;
 }
 
 int perform_allocation(catpc_application* application_ptr)
 {
-	int ret = 0, sz = 0;
-	pid_t pids[256];
-	
-	sz = get_pids_by_cmdline(pids, application_ptr->cmdline.c_str());
-	for (int i = 0; i < sz; ++i) {
-		ret = pqos_alloc_assoc_set_pid(pids[i], application_ptr->CLOS_id);
+	int ret = 0;
+	std::vector<pid_t> pids = get_pids_by_cmdline(application_ptr->cmdline);
+
+	for (pid_t pid : pids) {
+		ret = pqos_alloc_assoc_set_pid(pid, application_ptr->CLOS_id);
 		if (ret != PQOS_RETVAL_OK) {
 			return -1 * ret;
 		}
@@ -83,102 +58,55 @@ int perform_allocation(catpc_application* application_ptr)
 	return 0;
 }
 
-uint64_t get_required_llc(const std::map<uint64_t, double>& mrc, const std::vector<llc_ca>& llcs)
-{	
-	std::vector<double> x{};
-	std::vector<double> y{};
-
-	unsigned llc_size = llcs.size() * llcs[0].num_ways * llcs[0].way_size;	// size of last level cache
-
-	for (const auto& [k, v] : mrc) {
-		x.push_back(k);
-		y.push_back(v);
-	}
-
-	while (x.size() > 1) {
-		auto [c, slope] = boost::math::statistics::simple_ordinary_least_squares(x, y);
-		if (slope * llc_size > -0.05) {
-			return x[0];
-		}
-
-		x.erase(x.begin());
-		y.erase(y.begin());
-	}
+uint64_t get_required_llc(const catpc_mrc& mrc, const std::vector<llc_ca>& llcs)
+{
+	const uint64_t llc_size = (uint64_t)llcs.size() * llcs[0].num_ways * llcs[0].way_size;	// size of last level cache
 
-	return x[0];
+	return mrc.required_llc(llc_size);
 }
 
-int perform_smart_allocation(catpc_application* application_ptr, std::vector<llc_ca>& llcs)
+int set_clos_masks(std::vector<llc_ca>& llcs, const std::vector<CLOS>& masks)
 {
-	int num_llcs = llcs.size();
-	unsigned selected_CLOS_id = 0;
-	unsigned way_size = llcs[0].way_size;
-	double target_occupancy_ratio = -1, curr_occupancy_ratio = 0;
-	
-	// Search for the optimal CLOS
-	for (unsigned i = 0; i < llcs[0].clos_count - 1; ++i) {
-		double CLOS_occupancy = std::accumulate(CLOS_occupency_ratios[i].begin(), CLOS_occupency_ratios[i].end(), 0.0);
-		curr_occupancy_ratio = (double)( application_ptr->required_llc + (CLOS_occupancy * num_llcs * way_size) ) / (CLOS_occupency_ratios[i].size() * num_llcs * way_size);
-		
-		if (
-			(target_occupancy_ratio < 0) || 
-			((curr_occupancy_ratio < target_occupancy_ratio) && (target_occupancy_ratio >= 1)) ||
-			((curr_occupancy_ratio < 1) && (target_occupancy_ratio < 1) && (curr_occupancy_ratio > target_occupancy_ratio))
-		){
-			selected_CLOS_id = i;
-			target_occupancy_ratio = curr_occupancy_ratio;
-		}
-	}
-	application_ptr->CLOS_id = selected_CLOS_id;
-
-	// Update CLOS occupancy
-	for (unsigned i = 0; i < CLOS_occupency_ratios[selected_CLOS_id].size(); ++i) {
-		CLOS_occupency_ratios[selected_CLOS_id][i] += (double) application_ptr->required_llc / (num_llcs * way_size * CLOS_occupency_ratios[selected_CLOS_id].size());
-	}
+	for (llc_ca& llc : llcs) {
+		struct pqos_l3ca tab[PQOS_MAX_L3CA_COS];
+		unsigned num = 0;
+		int ret;
 
-	// Perform allocation
-	int ret = 0, sz = 0;
-	pid_t pids[256];
-	sz = get_pids_by_cmdline(pids, application_ptr->cmdline.c_str());
-	for (int i = 0; i < sz; ++i) {
-		ret = pqos_alloc_assoc_set_pid(pids[i], selected_CLOS_id);
+		ret = pqos_l3ca_get(llc.id, PQOS_MAX_L3CA_COS, &num, tab);
 		if (ret != PQOS_RETVAL_OK) {
 			return -1 * ret;
 		}
-	}
 
-	pqos_l3ca tab[PQOS_MAX_L3CA_COS];
-	unsigned num;
-	tab[0].class_id = 0;
-	for (unsigned i = 0; i < llcs.size(); ++i) {
-		ret = pqos_l3ca_get(i, PQOS_MAX_L3CA_COS, &num, tab);	// num = clos_count
+		for (const CLOS& clos : masks) {
+			if (clos.llc_id >= 0 && clos.llc_id != llc.id) {
+				continue;
+			}
+			for (unsigned i = 0; i < num; ++i) {
+				if (tab[i].class_id == clos.id) {
+					tab[i].u.ways_mask = clos.mask;
+				}
+			}
+			for (CLOS& c : llc.clos_list) {
+				if (c.id == clos.id) {
+					c.mask = clos.mask;
+				}
+			}
+		}
 
-		llcs[i].clos_list[num - 1].mask = (0x7ff ^ llcs[i].clos_list[selected_CLOS_id].mask) | 0x400;
-		tab[num - 1].u.ways_mask = llcs[i].clos_list[num - 1].mask;
-		
-		ret = pqos_l3ca_set(i, num, tab);
+		ret = pqos_l3ca_set(llc.id, num, tab);
 		if (ret != PQOS_RETVAL_OK) {
 			return -1 * ret;
 		}
 	}
-	
+
 	return 0;
 }
 
-int remove_application(std::unordered_map<std::string, catpc_application*>& applications, const std::vector<llc_ca>& llcs, const std::string& cmdline)
+int remove_application(std::unordered_map<std::string, catpc_application*>& applications, const std::string& cmdline)
 {
 	if (applications.find(cmdline) == applications.end()) {
 		return -1;
 	}
-	
-	catpc_application* app_ptr = applications[cmdline];
-	int num_llcs = llcs.size();
-	unsigned way_size = llcs[0].way_size;
-
-	// Update CLOS occupancy
-	for (unsigned i = 0; i < CLOS_occupency_ratios[app_ptr->CLOS_id].size(); ++i) {
-		CLOS_occupency_ratios[app_ptr->CLOS_id][i] -= (double) app_ptr->required_llc / (num_llcs * way_size * CLOS_occupency_ratios[app_ptr->CLOS_id].size());
-	}
 
 	// Remove from app list
 	applications.erase(cmdline);
@@ -5,10 +5,12 @@
 #include <unordered_map>
 
 #include "catpc_monitor.hpp"
+#include "catpc_mrc.hpp"
 
 struct CLOS {
 	unsigned int id;
 	uint64_t mask;
+	int llc_id = -1;	/**< cache the mask is programmed on, -1 for all */
 };
 
 struct llc_ca {
@@ -43,28 +45,27 @@ int perform_allocation(catpc_application* application_ptr);
  * @param [in] llcs vector of llc info
  * @return the required llc 
  */
-uint64_t get_required_llc(const std::map<uint64_t, double>& mrc, const std::vector<llc_ca>& llcs);
+uint64_t get_required_llc(const catpc_mrc& mrc, const std::vector<llc_ca>& llcs);
 
 /**
- * @brief 
+ * @brief Program CLOS masks on last level caches
  * 
- * @param [in] application application to which smart cache allocation is to be performed.
- * @param [in] llcs reference to the list of last level caches.
+ * @param [in,out] llcs list of last level caches, masks are updated
+ * @param [in] masks CLOS masks to program, each on its llc_id or on all caches
  * 
  * @retval 0 OK
- * @retval -1 error
+ * @retval <0 error
  */
-int perform_smart_allocation(catpc_application* application_ptr, std::vector<llc_ca>& llcs);
+int set_clos_masks(std::vector<llc_ca>& llcs, const std::vector<CLOS>& masks);
 
 /**
  * @brief Remove an application from the list of monitored applications.
  * 
  * @param [in,out] applications application map list
- * @param [in] llcs constant reference to the list of last level caches
  * @param [in] cmdline command line of the application to remove
  * 
  * @retval 0 OK
  * @retval -1 error
  */
-int remove_application(std::unordered_map<std::string, catpc_application*>& applications, const std::vector<llc_ca>& llcs, const std::string& cmdline);
+int remove_application(std::unordered_map<std::string, catpc_application*>& applications, const std::string& cmdline);
 #endif
\ No newline at end of file
@@ -0,0 +1,19 @@
+#include "catpc_backend.hpp"
+#include "catpc_sim.hpp"
+
+std::unique_ptr<catpc_backend> catpc_make_backend(const std::string& name, std::string& error)
+{
+	if (name == "pqos")
+		return std::make_unique<catpc_pqos_backend>();
+
+	if (name.compare(0, 4, "sim:") == 0) {
+		catpc_sim_scenario scenario;
+
+		if (catpc_load_scenario(name.substr(4), scenario, error) < 0)
+			return nullptr;
+		return std::make_unique<catpc_sim_backend>(scenario);
+	}
+
+	error = "unknown backend: " + name;
+	return nullptr;
+}
@@ -0,0 +1,116 @@
+#ifndef __CATPC_BACKEND_HPP__
+#define __CATPC_BACKEND_HPP__
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "catpc_allocator.hpp"
+#include "catpc_monitor.hpp"
+
+/**
+ * @brief Monitoring and allocation backend of a slave
+ *
+ * Gives access to the cache of the host, either through RDT or through
+ * a simulated cache.
+ */
+class catpc_backend {
+public:
+	virtual ~catpc_backend() = default;
+
+	/** backend name */
+	virtual const char* name() const = 0;
+
+	/**
+	 * @brief Initializes monitoring
+	 *
+	 * @retval 0 OK
+	 * @retval <0 error
+	 */
+	virtual int init() = 0;
+
+	/**
+	 * @brief Gets the cache allocation config
+	 *
+	 * @return list of last level caches, empty on error
+	 */
+	virtual std::vector<llc_ca> get_allocation_config() = 0;
+
+	/**
+	 * @brief Starts monitoring of an application
+	 *
+	 * @param [in] cmdline application command line
+	 *
+	 * @retval 0 OK
+	 * @retval <0 error
+	 */
+	virtual int start_monitoring(const std::string& cmdline) = 0;
+
+	/**
+	 * @brief Reads monitoring values of applications
+	 *
+	 * @param [in,out] applications application map list
+	 *
+	 * @retval 0 OK
+	 * @retval <0 error
+	 */
+	virtual int poll_monitoring_data(std::unordered_map<std::string, catpc_application*>& applications) = 0;
+
+	/**
+	 * @brief Programs CLOS masks, see set_clos_masks()
+	 */
+	virtual int set_clos_masks(std::vector<llc_ca>& llcs, const std::vector<CLOS>& masks) = 0;
+
+	/**
+	 * @brief Associates application with its CLOS, see perform_allocation()
+	 */
+	virtual int perform_allocation(catpc_application* application_ptr) = 0;
+
+	/**
+	 * @brief Stops monitoring of all applications
+	 *
+	 * @param [in] applications application map list
+	 */
+	virtual void stop_monitoring(std::unordered_map<std::string, catpc_application*>& applications) = 0;
+};
+
+/**
+ * @brief Backend of the host RDT, through libpqos
+ */
+class catpc_pqos_backend : public catpc_backend {
+public:
+	const char* name() const override { return "pqos"; }
+	int init() override { return init_monitoring(); }
+	std::vector<llc_ca> get_allocation_config() override { return ::get_allocation_config(); }
+	int start_monitoring(const std::string& cmdline) override { return ::start_monitoring(cmdline); }
+	int poll_monitoring_data(std::unordered_map<std::string, catpc_application*>& applications) override
+	{
+		return ::poll_monitoring_data(applications);
+	}
+	int set_clos_masks(std::vector<llc_ca>& llcs, const std::vector<CLOS>& masks) override
+	{
+		return ::set_clos_masks(llcs, masks);
+	}
+	int perform_allocation(catpc_application* application_ptr) override
+	{
+		return ::perform_allocation(application_ptr);
+	}
+	void stop_monitoring(std::unordered_map<std::string, catpc_application*>& applications) override
+	{
+		::stop_monitoring(applications);
+	}
+};
+
+/**
+ * @brief Creates backend by name
+ *
+ * @param [in] name "pqos", or "sim:SCENARIO" for the cache simulator
+ *             running the applications of a scenario file
+ * @param [out] error reason of a failure
+ *
+ * @return backend, NULL for unknown name or invalid scenario
+ */
+std::unique_ptr<catpc_backend> catpc_make_backend(const std::string& name, std::string& error);
+
+#endif
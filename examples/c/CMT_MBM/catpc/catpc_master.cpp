@@ -0,0 +1,487 @@
+#include "catpc_master.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+
+catpc_slave::~catpc_slave()
+{
+	for (auto& entry : applications)
+		delete entry.second;
+}
+
+catpc_master::catpc_master(FILE* log, std::chrono::milliseconds p, round_handler h)
+	: log_file{log}, period{p}, handler{std::move(h)}
+{
+}
+
+catpc_master::~catpc_master()
+{
+	for (auto& entry : slave_map)
+		close(entry.first);
+	slave_map.clear();
+
+	if (listen_sock >= 0)
+		close(listen_sock);
+	if (timer_fd >= 0)
+		close(timer_fd);
+	if (event_fd >= 0)
+		close(event_fd);
+	if (epoll_fd >= 0)
+		close(epoll_fd);
+}
+
+int catpc_master::listen(uint16_t port, in_addr_t addr)
+{
+	struct sockaddr_in address;
+	const int reuse = 1;
+
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = addr;
+	address.sin_port = htons(port);
+
+	listen_sock = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_TCP);
+	if (listen_sock < 0) {
+		log_fprint(log_file, "ERROR: socket failed: %s (%d)\n", strerror(errno), errno);
+		return -1;
+	}
+	if (setsockopt(listen_sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(int)) < 0)
+		log_fprint(log_file, "ERROR: setsockopt (SO_REUSEADDR) failed: %s (%d)\n", strerror(errno), errno);
+
+	if (bind(listen_sock, (struct sockaddr*)&address, sizeof(address)) < 0) {
+		log_fprint(log_file, "ERROR: bind failed: %s (%d)\n", strerror(errno), errno);
+		return -1;
+	}
+
+	// whole rack may connect at once
+	if (::listen(listen_sock, SOMAXCONN) < 0) {
+		log_fprint(log_file, "ERROR: listen failed: %s (%d)\n", strerror(errno), errno);
+		return -1;
+	}
+
+	return 0;
+}
+
+uint16_t catpc_master::port() const
+{
+	struct sockaddr_in address;
+	socklen_t len = sizeof(address);
+
+	if (listen_sock < 0 || getsockname(listen_sock, (struct sockaddr*)&address, &len) < 0)
+		return 0;
+	return ntohs(address.sin_port);
+}
+
+void catpc_master::stop()
+{
+	const uint64_t one = 1;
+
+	stopping = true;
+	if (event_fd >= 0 && write(event_fd, &one, sizeof(one)) < 0) {
+		// loop notices the flag at the latest on next timer tick
+	}
+}
+
+void catpc_master::notify_all(catpc_event ev, const std::string& cmdline)
+{
+	const uint64_t one = 1;
+
+	{
+		std::lock_guard<std::mutex> lk{pending_mtx};
+		pending.emplace_back(ev, cmdline);
+	}
+	if (event_fd >= 0 && write(event_fd, &one, sizeof(one)) < 0)
+		log_fprint(log_file, "ERROR: eventfd write failed: %s (%d)\n", strerror(errno), errno);
+}
+
+void catpc_master::notify(catpc_slave& slave, catpc_event ev, const std::string& cmdline)
+{
+	slave.events.emplace(ev, cmdline);
+	send_events(slave);
+	flush(slave);
+}
+
+int catpc_master::run()
+{
+	struct epoll_event ev;
+	struct itimerspec spec;
+	std::vector<struct epoll_event> events(256);
+
+	epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	if (event_fd < 0)
+		event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (epoll_fd < 0 || timer_fd < 0 || event_fd < 0 || listen_sock < 0) {
+		log_fprint(log_file, "ERROR: event loop setup failed: %s (%d)\n", strerror(errno), errno);
+		return -1;
+	}
+
+	memset(&spec, 0, sizeof(spec));
+	spec.it_interval.tv_sec = period.count() / 1000;
+	spec.it_interval.tv_nsec = (period.count() % 1000) * 1000000;
+	spec.it_value = spec.it_interval;
+	if (timerfd_settime(timer_fd, 0, &spec, NULL) < 0) {
+		log_fprint(log_file, "ERROR: timerfd_settime failed: %s (%d)\n", strerror(errno), errno);
+		return -1;
+	}
+
+	for (int fd : {listen_sock, timer_fd, event_fd}) {
+		ev.events = EPOLLIN;
+		ev.data.fd = fd;
+		if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+			log_fprint(log_file, "ERROR: epoll_ctl failed: %s (%d)\n", strerror(errno), errno);
+			return -1;
+		}
+	}
+
+	while (!stopping) {
+		int num = epoll_wait(epoll_fd, events.data(), events.size(), -1);
+
+		if (num < 0) {
+			if (errno == EINTR)
+				continue;
+			log_fprint(log_file, "ERROR: epoll_wait failed: %s (%d)\n", strerror(errno), errno);
+			return -1;
+		}
+
+		for (int i = 0; i < num && !stopping; ++i) {
+			const int fd = events[i].data.fd;
+			uint64_t count;
+
+			if (fd == listen_sock) {
+				accept_slaves();
+				close_slaves();
+				continue;
+			}
+			if (fd == timer_fd) {
+				if (read(timer_fd, &count, sizeof(count)) < 0)
+					continue;
+				if (round_active)
+					finish_round(true);
+				start_round();
+				close_slaves();
+				continue;
+			}
+			if (fd == event_fd) {
+				if (read(event_fd, &count, sizeof(count)) < 0)
+					continue;
+				dispatch_pending();
+				close_slaves();
+				continue;
+			}
+
+			// slave may have been closed by an earlier event of this batch
+			auto it = slave_map.find(fd);
+			if (it == slave_map.end())
+				continue;
+			catpc_slave& slave = *it->second;
+
+			if (events[i].events & EPOLLOUT)
+				flush(slave);
+			if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+				handle_input(slave);
+			close_slaves();
+		}
+	}
+
+	return 0;
+}
+
+void catpc_master::accept_slaves()
+{
+	while (true) {
+		struct sockaddr_in address;
+		socklen_t addr_len = sizeof(address);
+		struct epoll_event ev;
+		const int one = 1;
+		int sock;
+
+		sock = accept4(listen_sock, (struct sockaddr*)&address, &addr_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (sock < 0) {
+			if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+				log_fprint(log_file, "ERROR: accept failed: %s (%d)\n", strerror(errno), errno);
+			if (errno == EINTR)
+				continue;
+			return;
+		}
+
+		// requests are single small frames, do not hold them back
+		setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+		ev.events = EPOLLIN;
+		ev.data.fd = sock;
+		if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, sock, &ev) < 0) {
+			log_fprint(log_file, "ERROR: epoll_ctl failed: %s (%d)\n", strerror(errno), errno);
+			close(sock);
+			continue;
+		}
+
+		auto slave = std::make_unique<catpc_slave>(sock, ++last_slave_id, address);
+		catpc_slave& ref = *slave;
+		slave_map.emplace(sock, std::move(slave));
+		log_fprint(log_file, "INFO: slave connected: %s\n", inet_ntoa(address.sin_addr));
+
+		// first thing to learn about a slave is its cache topology
+		catpc_put_request(ref.tx, CATPC_GET_CAPABILITIES);
+		flush(ref);
+	}
+}
+
+void catpc_master::fail(catpc_slave& slave)
+{
+	// closing is deferred, callers up the stack may still use the slave
+	if (!slave.closing) {
+		slave.closing = true;
+		failed.push_back(slave.sock);
+	}
+}
+
+void catpc_master::close_slaves()
+{
+	while (!failed.empty()) {
+		const int sock = failed.back();
+		failed.pop_back();
+
+		auto it = slave_map.find(sock);
+		if (it == slave_map.end())
+			continue;
+		catpc_slave& slave = *it->second;
+
+		log_fprint(log_file, "INFO: slave disconnected %s\n", inet_ntoa(slave.address.sin_addr));
+
+		if (slave.st != catpc_slave::AWAIT_CAPABILITIES)
+			ready--;
+
+		epoll_ctl(epoll_fd, EPOLL_CTL_DEL, sock, NULL);
+		close(sock);
+
+		// slave does not hold the round barrier any more
+		const bool awaited = round_active && slave.st == catpc_slave::AWAIT_VALUES && slave.round == round.id;
+		slave_map.erase(it);
+		if (awaited) {
+			round.expected--;
+			if (round.received == round.expected)
+				finish_round(false);
+		}
+	}
+}
+
+void catpc_master::flush(catpc_slave& slave)
+{
+	struct epoll_event ev;
+
+	if (slave.closing)
+		return;
+	if (slave.tx.write_to(slave.sock) < 0) {
+		log_fprint(log_file, "ERROR: send to %s: %s (%d)\n", inet_ntoa(slave.address.sin_addr), strerror(errno), errno);
+		fail(slave);
+		return;
+	}
+
+	// wait for socket to drain only while there is something left to send
+	ev.events = slave.tx.empty() ? EPOLLIN : EPOLLIN | EPOLLOUT;
+	ev.data.fd = slave.sock;
+	epoll_ctl(epoll_fd, EPOLL_CTL_MOD, slave.sock, &ev);
+}
+
+void catpc_master::handle_input(catpc_slave& slave)
+{
+	int ret = slave.rx.read_from(slave.sock);
+
+	if (ret == 0) {
+		fail(slave);
+		return;
+	}
+	if (ret < 0) {
+		log_fprint(log_file, "ERROR: recv from %s: %s (%d)\n", inet_ntoa(slave.address.sin_addr), strerror(errno), errno);
+		fail(slave);
+		return;
+	}
+
+	while (!slave.closing) {
+		catpc_frame frame;
+
+		ret = slave.rx.peek_frame(frame);
+		if (ret == 0)
+			break;	// frame incomplete, wait for more data
+
+		if (ret > 0) {
+			if (slave.st == catpc_slave::AWAIT_CAPABILITIES && frame.type == CATPC_GET_CAPABILITIES)
+				ret = parse_capabilities(slave, frame);
+			else if (slave.st == catpc_slave::AWAIT_VALUES && frame.type == CATPC_GET_MONITORING_VALUES)
+				ret = parse_values(slave, frame);
+			else
+				ret = -1;
+		}
+
+		if (ret < 0) {
+			log_fprint(log_file, "ERROR: protocol error from %s\n", inet_ntoa(slave.address.sin_addr));
+			fail(slave);
+			return;
+		}
+	}
+}
+
+int catpc_master::parse_capabilities(catpc_slave& slave, const catpc_frame& frame)
+{
+	std::vector<llc_ca> llcs;
+
+	if (!catpc_get_capabilities(frame, llcs))
+		return -1;
+	slave.rx.consume_frame(frame);
+
+	slave.llcs = std::move(llcs);
+	slave.st = catpc_slave::IDLE;
+	ready++;
+	send_events(slave);
+	flush(slave);
+
+	return 1;
+}
+
+int catpc_master::parse_values(catpc_slave& slave, const catpc_frame& frame)
+{
+	std::vector<catpc_app_values> apps;
+
+	if (!catpc_get_values(frame, apps))
+		return -1;
+	slave.rx.consume_frame(frame);
+
+	for (catpc_app_values& app : apps) {
+		// insert if not exist aka 'get or create'
+		auto it = slave.applications.find(app.cmdline);
+		if (it == slave.applications.end())
+			it = slave.applications.emplace(app.cmdline, new catpc_application(app.cmdline)).first;
+		it->second->values = app.values;
+		it->second->CLOS_id = app.CLOS_id;
+		it->second->llc_id = app.llc_id;
+	}
+
+	slave.st = catpc_slave::IDLE;
+	reply_received(slave);
+
+	return 1;
+}
+
+void catpc_master::send_events(catpc_slave& slave)
+{
+	// slave handles one request at a time, keep events until it has replied
+	if (slave.st != catpc_slave::IDLE)
+		return;
+
+	while (!slave.events.empty()) {
+		std::pair<catpc_event, std::string>& p = slave.events.front();
+
+		switch (p.first) {
+		case CATPC_EVENT_APP_REMOVED: {
+			auto it = slave.applications.find(p.second);
+			if (it != slave.applications.end()) {
+				delete it->second;
+				slave.applications.erase(it);
+			}
+			catpc_put_app(slave.tx, CATPC_REMOVE_APP_TO_MONITOR, p.second);
+			break;
+		}
+		case CATPC_EVENT_APP_ADDED:
+			catpc_put_app(slave.tx, CATPC_ADD_APP_TO_MONITOR, p.second);
+			break;
+
+		case CATPC_EVENT_PERFORM_ALLOCATION: {
+			std::vector<catpc_app_allocation> apps;
+
+			apps.reserve(slave.applications.size());
+			for (const auto& element : slave.applications) {
+				catpc_application* app_ptr = element.second;
+				apps.push_back({app_ptr->cmdline, app_ptr->CLOS_id, app_ptr->required_llc});
+			}
+			catpc_put_allocation(slave.tx, apps, slave.masks);
+			slave.masks.clear();
+			break;
+		}
+		}
+		slave.events.pop();
+	}
+}
+
+void catpc_master::dispatch_pending()
+{
+	std::vector<std::pair<catpc_event, std::string>> local;
+
+	{
+		std::lock_guard<std::mutex> lk{pending_mtx};
+		local.swap(pending);
+	}
+	if (local.empty())
+		return;
+
+	for (auto& entry : slave_map) {
+		for (const auto& p : local)
+			entry.second->events.push(p);
+		send_events(*entry.second);
+		flush(*entry.second);
+	}
+}
+
+void catpc_master::start_round()
+{
+	round.id++;
+	round.start = std::chrono::steady_clock::now();
+	round.latency = std::chrono::steady_clock::duration::zero();
+	round.expected = 0;
+	round.received = 0;
+	round.timed_out = false;
+
+	for (auto& entry : slave_map) {
+		catpc_slave& slave = *entry.second;
+
+		// slaves that still owe previous reply sit this round out
+		if (slave.st != catpc_slave::IDLE || slave.closing)
+			continue;
+		send_events(slave);
+		catpc_put_request(slave.tx, CATPC_GET_MONITORING_VALUES);
+		slave.st = catpc_slave::AWAIT_VALUES;
+		slave.round = round.id;
+		round.expected++;
+	}
+
+	if (round.expected == 0)
+		return;
+	round_active = true;
+
+	for (auto& entry : slave_map)
+		if (entry.second->st == catpc_slave::AWAIT_VALUES && entry.second->round == round.id)
+			flush(*entry.second);
+}
+
+void catpc_master::reply_received(catpc_slave& slave)
+{
+	if (round_active && slave.round == round.id) {
+		round.received++;
+		if (round.received == round.expected)
+			finish_round(false);
+	}
+
+	send_events(slave);
+	flush(slave);
+}
+
+void catpc_master::finish_round(bool timed_out)
+{
+	round_active = false;
+	round.timed_out = timed_out;
+	round.latency = std::chrono::steady_clock::now() - round.start;
+
+	if (timed_out)
+		log_fprint(log_file, "INFO: round %llu: %u of %u slaves replied\n",
+			(unsigned long long)round.id, round.received, round.expected);
+
+	if (handler)
+		handler(*this, round);
+}
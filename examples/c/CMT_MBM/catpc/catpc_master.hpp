@@ -0,0 +1,185 @@
+#ifndef __CATPC_MASTER_HPP__
+#define __CATPC_MASTER_HPP__
+
+#include <stdint.h>
+#include <stdio.h>
+#include <netinet/in.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "catpc_allocator.hpp"
+#include "catpc_monitor.hpp"
+#include "catpc_proto.hpp"
+#include "catpc_utils.hpp"
+
+/**
+ * @brief Events forwarded by the master to slaves
+ */
+enum catpc_event {
+	CATPC_EVENT_APP_ADDED = 0,		/**< application launched */
+	CATPC_EVENT_APP_REMOVED = 1,		/**< application terminated */
+	CATPC_EVENT_PERFORM_ALLOCATION = 2	/**< allocation has changed */
+};
+
+/**
+ * @brief State of a single slave connection, owned by the event loop
+ */
+struct catpc_slave {
+	enum state {
+		AWAIT_CAPABILITIES = 0,	/**< capabilities requested */
+		IDLE = 1,		/**< no reply expected */
+		AWAIT_VALUES = 2	/**< monitoring values requested */
+	};
+
+	int sock;
+	uint64_t id;				/**< unique per connection, sockets and addresses are reused */
+	struct sockaddr_in address;
+	state st;
+	bool closing;				/**< connection failed, closed by event loop */
+	uint64_t round;				/**< round of the awaited values */
+	catpc_buffer rx;
+	catpc_buffer tx;
+	std::vector<llc_ca> llcs;
+	std::vector<CLOS> masks;		/**< CLOS masks to send with next allocation */
+	std::unordered_map<std::string, catpc_application*> applications;
+	std::queue<std::pair<catpc_event, std::string>> events;	/**< not yet sent events */
+
+	catpc_slave(int s, uint64_t i, const struct sockaddr_in& addr)
+		: sock{s}, id{i}, address(addr), st{AWAIT_CAPABILITIES}, closing{false}, round{0} {}
+	~catpc_slave();
+};
+
+/**
+ * @brief Monitoring round - values requested from all idle slaves at once
+ */
+struct catpc_round {
+	uint64_t id;						/**< round number */
+	std::chrono::steady_clock::time_point start;		/**< values requested */
+	std::chrono::steady_clock::duration latency;		/**< until last reply */
+	unsigned expected;					/**< slaves asked */
+	unsigned received;					/**< replies received */
+	bool timed_out;						/**< not all slaves replied within period */
+};
+
+/**
+ * @brief CATPC master event loop
+ *
+ * All slave sockets are non-blocking and served by a single epoll loop.
+ * Every period the master requests monitoring values from all idle slaves
+ * and the round completes when the last of them replied or when the next
+ * period starts. Completed round is passed to the round handler, which runs
+ * on the event loop thread and may queue events for slaves.
+ */
+class catpc_master {
+public:
+	using round_handler = std::function<void(catpc_master&, const catpc_round&)>;
+
+	/**
+	 * @brief Constructor
+	 *
+	 * @param [in] log log file
+	 * @param [in] period monitoring round period
+	 * @param [in] handler called when a round completes
+	 */
+	catpc_master(FILE* log, std::chrono::milliseconds period, round_handler handler);
+	~catpc_master();
+
+	/**
+	 * @brief Creates listening socket
+	 *
+	 * @param [in] port TCP port, 0 to pick any
+	 * @param [in] addr address to listen on (network byte order)
+	 *
+	 * @retval 0 OK
+	 * @retval -1 error
+	 */
+	int listen(uint16_t port, in_addr_t addr);
+
+	/**
+	 * @brief Returns port the master listens on
+	 */
+	uint16_t port() const;
+
+	/**
+	 * @brief Runs the event loop until stop() is called
+	 *
+	 * @retval 0 OK
+	 * @retval -1 error
+	 */
+	int run();
+
+	/**
+	 * @brief Stops the event loop, can be called from a signal handler
+	 */
+	void stop();
+
+	/**
+	 * @brief Queues event for all slaves, can be called from any thread
+	 *
+	 * @param [in] ev event
+	 * @param [in] cmdline application command line
+	 */
+	void notify_all(catpc_event ev, const std::string& cmdline);
+
+	/**
+	 * @brief Queues event for a slave, event loop thread only
+	 *
+	 * @param [in] slave slave to notify
+	 * @param [in] ev event
+	 * @param [in] cmdline application command line
+	 */
+	void notify(catpc_slave& slave, catpc_event ev, const std::string& cmdline);
+
+	/**
+	 * @brief Connected slaves, event loop thread only
+	 */
+	const std::unordered_map<int, std::unique_ptr<catpc_slave>>& slaves() const { return slave_map; }
+
+	/**
+	 * @brief Number of slaves that reported their capabilities
+	 */
+	unsigned ready_count() const { return ready; }
+
+private:
+	void accept_slaves();
+	void fail(catpc_slave& slave);
+	void close_slaves();
+	void handle_input(catpc_slave& slave);
+	int parse_capabilities(catpc_slave& slave, const catpc_frame& frame);
+	int parse_values(catpc_slave& slave, const catpc_frame& frame);
+	void send_events(catpc_slave& slave);
+	void flush(catpc_slave& slave);
+	void start_round();
+	void finish_round(bool timed_out);
+	void reply_received(catpc_slave& slave);
+	void dispatch_pending();
+
+	FILE* log_file;
+	std::chrono::milliseconds period;
+	round_handler handler;
+	int listen_sock = -1;
+	int epoll_fd = -1;
+	int timer_fd = -1;
+	int event_fd = -1;
+	std::atomic<bool> stopping{false};
+	std::atomic<unsigned> ready{0};
+	std::unordered_map<int, std::unique_ptr<catpc_slave>> slave_map;
+	std::vector<int> failed;	/**< slaves to close after current event */
+	uint64_t last_slave_id = 0;
+
+	catpc_round round{};
+	bool round_active = false;
+
+	// events posted by other threads, moved to slaves by the event loop
+	std::mutex pending_mtx;
+	std::vector<std::pair<catpc_event, std::string>> pending;
+};
+
+#endif
@@ -66,12 +66,12 @@ int init_monitoring()
 
 int start_monitoring(const std::string& cmdline)
 {
-	pid_t pids[256];
+	std::vector<pid_t> pids = get_pids_by_cmdline(cmdline);
 	int ret;
 
-	sel_process_num = get_pids_by_cmdline(pids, cmdline.c_str());
+	sel_process_num = pids.size();
 	m_mon_grps[cmdline] = new pqos_mon_data();
-	ret = pqos_mon_start_pids(sel_process_num, pids, sel_events, NULL,
+	ret = pqos_mon_start_pids(sel_process_num, pids.data(), sel_events, NULL,
 										m_mon_grps[cmdline]);
 	if (ret != PQOS_RETVAL_OK) {
 		return -1 * ret;
@@ -96,6 +96,57 @@ int start_monitoring(const std::string& cmdline)
 	return 0;
 }
 
+/**
+ * L3 CAT domain most processes of the monitoring group last ran on,
+ * -1 if unknown
+ */
+static int get_llc_id(const struct pqos_mon_data* group)
+{
+	std::unordered_map<unsigned, unsigned> votes;
+	int llc_id = -1;
+	unsigned best = 0;
+
+	for (unsigned i = 0; i < group->num_pids; i++) {
+		const pid_t pid = group->pids[i];
+		char path[64], buf[1024];
+		FILE* f;
+		unsigned cpu;
+
+		snprintf(path, sizeof(path), "/proc/%d/stat", (int)pid);
+		f = fopen(path, "r");
+		if (f == NULL) {
+			continue;
+		}
+		if (fgets(buf, sizeof(buf), f) != NULL) {
+			// processor is field 39, the 37th after the command name
+			const char* p = strrchr(buf, ')');
+			int field = 2;
+
+			while (p != NULL && field < 39) {
+				p = strchr(p + 1, ' ');
+				field++;
+			}
+			if (p != NULL && sscanf(p, "%u", &cpu) == 1) {
+				const struct pqos_coreinfo* core = pqos_cpu_get_core_info(p_cpu, cpu);
+
+				if (core != NULL) {
+					votes[core->l3cat_id]++;
+				}
+			}
+		}
+		fclose(f);
+	}
+
+	for (const auto& v : votes) {
+		if (v.second > best) {
+			best = v.second;
+			llc_id = v.first;
+		}
+	}
+
+	return llc_id;
+}
+
 int poll_monitoring_data(std::unordered_map<std::string, catpc_application*>& applications)
 {
 	unsigned i, ret = PQOS_RETVAL_OK;
@@ -113,6 +164,7 @@ int poll_monitoring_data(std::unordered_map<std::string, catpc_application*>& ap
 			element.second->values.llc_misses = m_mon_grps[element.first]->values.llc_misses_delta;
 			element.second->values.llc_references = m_mon_grps[element.first]->intl->values.llc_references_delta; 
 		}
+		element.second->llc_id = get_llc_id(m_mon_grps[element.first]);
 	}
 
 	return 0;
@@ -14,6 +14,8 @@
 #include <map>
 
 #include "pqos.h"
+#include "catpc_mrc.hpp"
+#include "catpc_phase.hpp"
 
 /**
  * The structure to store monitoring data for all of the events
@@ -25,12 +27,6 @@ struct catpc_monitoring_values {
 	uint64_t llc_references;     /**< LLC references */
 };
 
-/**
- * @brief Miss Rate Curve entry : occupancy (in kB) and miss_rate (in [0, 1])
- * 
- */
-using MRC = std::map<unsigned, double>;
-
 /**
  * @brief HPC Application data structure characterized by its command line 
  * that will be used to find all PIDs belonging to the app 
@@ -42,12 +38,16 @@ struct catpc_application {
 	unsigned int CLOS_id;
 	bool eval_done;
 	bool smart_alloc_done;
+	bool mrc_checked;		/**< stored MRC looked up */
+	catpc_mrc_step step;		/**< samples of the current profiling step */
+	catpc_phase_detector phase;	/**< watches the allocated application */
+	int llc_id;			/**< L3 domain the application runs on, -1 unknown */
 	uint64_t required_llc;
 
-	catpc_application(std::string cl = "") : cmdline{cl}, values{}, CLOS_id{0}, eval_done{false}, smart_alloc_done{false}, required_llc{0} {}
+	catpc_application(std::string cl = "") : cmdline{cl}, values{}, CLOS_id{0}, eval_done{false}, smart_alloc_done{false}, mrc_checked{false}, step{}, phase{}, llc_id{-1}, required_llc{0} {}
 
 	catpc_application(const std::string& cl, const catpc_monitoring_values& v, const unsigned int& cid)
-		: cmdline{cl}, values{v}, CLOS_id{cid}, eval_done{false}, smart_alloc_done{false}, required_llc{0} {}
+		: cmdline{cl}, values{v}, CLOS_id{cid}, eval_done{false}, smart_alloc_done{false}, mrc_checked{false}, step{}, phase{}, llc_id{-1}, required_llc{0} {}
 };
 
 /**
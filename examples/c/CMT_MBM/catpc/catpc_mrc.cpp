@@ -0,0 +1,136 @@
+#include "catpc_mrc.hpp"
+
+#include <math.h>
+
+catpc_mrc::catpc_mrc(uint64_t bin_size, uint64_t max_occupancy) : bin{bin_size > 0 ? bin_size : 1}, max{max_occupancy}
+{
+}
+
+void catpc_mrc::add(uint64_t occupancy, double miss_rate)
+{
+	// CMT readings may overshoot the cache size a little
+	if (occupancy > max)
+		occupancy = max;
+
+	const size_t idx = occupancy / bin;
+
+	if (idx >= cells.size())
+		cells.resize(idx + 1, cell{0, 0, 0});
+
+	cell& c = cells[idx];
+	if (c.count == 0)
+		num_points++;
+	c.occupancy_sum += occupancy;
+	c.miss_rate_sum += miss_rate;
+	c.count++;
+}
+
+std::vector<catpc_mrc::point> catpc_mrc::points() const
+{
+	std::vector<point> pts;
+
+	pts.reserve(num_points);
+	for (const cell& c : cells)
+		if (c.count > 0)
+			pts.push_back({(uint64_t)(c.occupancy_sum / c.count + 0.5), c.miss_rate_sum / c.count});
+
+	return pts;
+}
+
+double catpc_mrc::miss_rate_at(uint64_t occupancy) const
+{
+	bool have_prev = false;
+	point prev{0, 0};
+
+	for (const cell& c : cells) {
+		if (c.count == 0)
+			continue;
+
+		const point cur{(uint64_t)(c.occupancy_sum / c.count + 0.5), c.miss_rate_sum / c.count};
+
+		if (cur.occupancy >= occupancy) {
+			if (!have_prev)
+				return cur.miss_rate;
+			return prev.miss_rate + (cur.miss_rate - prev.miss_rate) *
+				(double)(occupancy - prev.occupancy) / (cur.occupancy - prev.occupancy);
+		}
+		prev = cur;
+		have_prev = true;
+	}
+
+	return have_prev ? prev.miss_rate : 1.0;
+}
+
+uint64_t catpc_mrc::required_llc(uint64_t llc_size) const
+{
+	struct sums {
+		double sx, sy, sxx, sxy;
+	};
+	const std::vector<point> pts = points();
+	const size_t num = pts.size();
+	std::vector<sums> suffix(num + 1, sums{0, 0, 0, 0});
+
+	if (num == 0)
+		return 0;
+
+	// sums of every suffix, accumulated from the back so that short
+	// suffixes do not inherit rounding errors of the long ones;
+	// x is in bins relative to the first point to keep the sums small
+	for (size_t i = num; i-- > 0;) {
+		const double x = (double)(pts[i].occupancy - pts[0].occupancy) / bin;
+		const double y = pts[i].miss_rate;
+
+		suffix[i].sx = suffix[i + 1].sx + x;
+		suffix[i].sy = suffix[i + 1].sy + y;
+		suffix[i].sxx = suffix[i + 1].sxx + x * x;
+		suffix[i].sxy = suffix[i + 1].sxy + x * y;
+	}
+
+	for (size_t i = 0; i + 1 < num; ++i) {
+		const sums& s = suffix[i];
+		const double n = num - i;
+		const double den = n * s.sxx - s.sx * s.sx;
+
+		// all points at the same occupancy give no slope, skip like NaN did
+		if (den <= 0)
+			continue;
+		if ((n * s.sxy - s.sx * s.sy) / den / bin * llc_size > -0.05)
+			return pts[i].occupancy;
+	}
+
+	return pts.back().occupancy;
+}
+
+void catpc_mrc_step::add(uint64_t occupancy, double miss_rate)
+{
+	const double delta = miss_rate - mean_miss_rate;
+
+	n++;
+	mean_miss_rate += delta / n;
+	m2 += delta * (miss_rate - mean_miss_rate);
+	mean_occupancy += (occupancy - mean_occupancy) / n;
+}
+
+double catpc_mrc_step::error() const
+{
+	// two-sided 95% quantiles of Student's t for 1 to 10 degrees of freedom
+	static const double t95[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228};
+	const unsigned df = n - 1;
+
+	if (n < 2)
+		return INFINITY;
+
+	return (df <= 10 ? t95[df - 1] : 1.96) * sqrt(variance() / n);
+}
+
+bool catpc_mrc_step::done(const catpc_mrc_sampling& sampling) const
+{
+	if (n >= sampling.max_samples)
+		return true;
+	if (n < sampling.min_samples)
+		return false;
+
+	const double err = error();
+
+	return err <= sampling.min_error || err <= sampling.precision * mean_miss_rate;
+}
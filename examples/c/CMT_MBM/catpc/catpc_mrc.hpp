@@ -0,0 +1,162 @@
+#ifndef __CATPC_MRC_HPP__
+#define __CATPC_MRC_HPP__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#define CATPC_MRC_BINS_PER_WAY 16	/**< default curve resolution */
+
+/**
+ * @brief Miss rate curve of an application binned by cache occupancy
+ *
+ * Samples falling in the same bin are averaged. Bin size should divide
+ * the cache way size so that bins do not straddle way boundaries.
+ */
+class catpc_mrc {
+public:
+	struct point {
+		uint64_t occupancy;	/**< average occupancy of the bin in bytes */
+		double miss_rate;	/**< average miss rate of the bin */
+	};
+
+	/**
+	 * @brief Constructor
+	 *
+	 * @param [in] bin_size bin width in bytes
+	 * @param [in] max_occupancy cache size in bytes, larger occupancies
+	 *             are clamped to it
+	 */
+	explicit catpc_mrc(uint64_t bin_size = 1, uint64_t max_occupancy = UINT64_MAX);
+
+	/**
+	 * @brief Adds sample to the curve
+	 *
+	 * @param [in] occupancy cache occupancy in bytes, clamped to the
+	 *             cache size
+	 * @param [in] miss_rate miss rate in [0, 1]
+	 */
+	void add(uint64_t occupancy, double miss_rate);
+
+	/**
+	 * @brief Returns non-empty bins ordered by occupancy
+	 */
+	std::vector<point> points() const;
+
+	/** number of non-empty bins */
+	size_t size() const { return num_points; }
+
+	uint64_t bin_size() const { return bin; }
+
+	/**
+	 * @brief Miss rate at an occupancy
+	 *
+	 * Interpolated linearly between bins, constant beyond the first and
+	 * the last bin.
+	 *
+	 * @param [in] occupancy cache occupancy in bytes
+	 *
+	 * @return miss rate, 1 for empty curve
+	 */
+	double miss_rate_at(uint64_t occupancy) const;
+
+	/**
+	 * @brief Finds occupancy past which the curve is flat
+	 *
+	 * Fits a line to each suffix of the curve, starting from the smallest
+	 * occupancy, and returns the first point whose suffix slope scaled to
+	 * the whole cache is above -0.05. Suffix sums are kept incrementally,
+	 * so the search is linear in the number of bins.
+	 *
+	 * @param [in] llc_size total last level cache size in bytes
+	 *
+	 * @return required cache size in bytes, 0 for empty curve
+	 */
+	uint64_t required_llc(uint64_t llc_size) const;
+
+private:
+	struct cell {
+		double occupancy_sum;
+		double miss_rate_sum;
+		unsigned count;
+	};
+
+	uint64_t bin;
+	uint64_t max;
+	size_t num_points = 0;
+	std::vector<cell> cells;	/**< indexed by occupancy / bin */
+};
+
+/**
+ * @brief When profiling may leave a CLOS step
+ */
+struct catpc_mrc_sampling {
+	unsigned min_samples = 3;	/**< samples always taken in a step */
+	unsigned max_samples = 8;	/**< samples after which a step ends anyway */
+	double precision = 0.1;	/**< 95% confidence half width relative to the mean */
+	double min_error = 0.01;	/**< half width small enough whatever the mean */
+	double saturation = 0.9;	/**< occupancy share below which the partition is not filled */
+};
+
+/**
+ * @brief Samples taken in one CLOS step of MRC profiling
+ *
+ * Keeps running mean and variance of the miss rate (Welford) and mean
+ * occupancy, so the step ends once the miss rate is known well enough.
+ */
+class catpc_mrc_step {
+public:
+	/**
+	 * @brief Adds sample of the step
+	 *
+	 * @param [in] occupancy cache occupancy in bytes
+	 * @param [in] miss_rate miss rate in [0, 1]
+	 */
+	void add(uint64_t occupancy, double miss_rate);
+
+	/** starts a new step */
+	void reset() { *this = catpc_mrc_step(); }
+
+	unsigned count() const { return n; }
+	double mean() const { return mean_miss_rate; }
+	uint64_t occupancy() const { return (uint64_t)(mean_occupancy + 0.5); }
+
+	/** sample variance of the miss rate, 0 below two samples */
+	double variance() const { return n > 1 ? m2 / (n - 1) : 0.0; }
+
+	/**
+	 * @brief Half width of the 95% confidence interval of the mean
+	 *
+	 * Uses Student's t quantile, samples per step are few.
+	 */
+	double error() const;
+
+	/**
+	 * @brief Checks if enough samples were taken
+	 *
+	 * @param [in] sampling sampling policy
+	 *
+	 * @return true once min_samples were taken and the confidence interval
+	 *         is tight enough, or max_samples were taken
+	 */
+	bool done(const catpc_mrc_sampling& sampling) const;
+
+private:
+	unsigned n = 0;
+	double mean_miss_rate = 0.0;
+	double m2 = 0.0;
+	double mean_occupancy = 0.0;
+};
+
+/**
+ * @brief MRC profiling statistics
+ */
+struct catpc_mrc_stats {
+	unsigned curves;	/**< completed curves */
+	unsigned steps;		/**< CLOS steps sampled */
+	unsigned skipped_steps;	/**< CLOS steps skipped as the partition was not filled */
+	unsigned samples;	/**< samples taken */
+	unsigned saved_samples;	/**< samples below max_samples thanks to early stop */
+};
+
+#endif
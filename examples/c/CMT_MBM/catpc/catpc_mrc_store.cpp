@@ -0,0 +1,281 @@
+#include "catpc_mrc_store.hpp"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <cmath>
+
+#include "catpc_utils.hpp"
+
+#define MRC_FILE_MAGIC 0x43524d43	/**< "CMRC" */
+#define MRC_FILE_VERSION 2
+#define MRC_FILE_SUFFIX ".mrc"
+
+/**
+ * @brief Curve file header, followed by the command line and the points
+ *
+ * Files are local to the host and use its byte order.
+ */
+struct mrc_file_header {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t num_ways;
+	uint32_t way_size;
+	uint32_t num_llcs;
+	uint32_t confirmations;
+	uint64_t updated;
+	uint64_t bin_size;
+	uint32_t cmdline_len;
+	uint32_t num_points;
+	uint64_t checksum;	/**< FNV-1a hash of data after the header */
+};
+
+struct mrc_file_point {
+	uint64_t occupancy;
+	double miss_rate;
+};
+
+/**
+ * @brief FNV-1a hash
+ */
+static uint64_t hash(const void* data, size_t len, uint64_t h = 0xcbf29ce484222325ULL)
+{
+	const unsigned char* p = static_cast<const unsigned char*>(data);
+
+	for (size_t i = 0; i < len; ++i) {
+		h ^= p[i];
+		h *= 0x100000001b3ULL;
+	}
+	return h;
+}
+
+catpc_mrc_store::catpc_mrc_store(FILE* log, catpc_mrc_policy p) : log_file{log}, policy{p}
+{
+}
+
+catpc_mrc_store::~catpc_mrc_store()
+{
+	{
+		std::lock_guard<std::mutex> lk{mtx};
+		stopping = true;
+	}
+	cv.notify_one();
+	if (thread.joinable())
+		thread.join();
+}
+
+std::string catpc_mrc_store::file_name(const std::string& cmdline, const catpc_platform& platform) const
+{
+	const uint32_t geometry[] = {platform.num_ways, platform.way_size, platform.num_llcs};
+	char name[64];
+
+	snprintf(name, sizeof(name), "%016llx-%08llx" MRC_FILE_SUFFIX,
+		 (unsigned long long)hash(cmdline.data(), cmdline.size()),
+		 (unsigned long long)(hash(geometry, sizeof(geometry)) & 0xffffffff));
+	return name;
+}
+
+int catpc_mrc_store::open(const std::string& directory)
+{
+	DIR* d;
+	struct dirent* de;
+
+	if (mkdir(directory.c_str(), 0755) < 0 && errno != EEXIST) {
+		log_fprint(log_file, "ERROR: MRC store %s: %s (%d)\n", directory.c_str(), strerror(errno), errno);
+		return -1;
+	}
+	d = opendir(directory.c_str());
+	if (d == NULL) {
+		log_fprint(log_file, "ERROR: MRC store %s: %s (%d)\n", directory.c_str(), strerror(errno), errno);
+		return -1;
+	}
+	dir = directory;
+
+	while ((de = readdir(d)) != NULL) {
+		const std::string name = de->d_name;
+		const size_t suffix = strlen(MRC_FILE_SUFFIX);
+
+		if (name.size() > suffix && name.compare(name.size() - suffix, suffix, MRC_FILE_SUFFIX) == 0 &&
+		    load(name) < 0)
+			log_fprint(log_file, "ERROR: MRC store: ignoring invalid file %s\n", name.c_str());
+	}
+	closedir(d);
+
+	log_fprint(log_file, "INFO: MRC store %s: %zu curves loaded\n", dir.c_str(), entries.size());
+	thread = std::thread(&catpc_mrc_store::writer, this);
+	return 0;
+}
+
+int catpc_mrc_store::load(const std::string& name)
+{
+	const std::string file = dir + "/" + name;
+	struct mrc_file_header hdr;
+	std::vector<mrc_file_point> pts;
+	std::string cmdline;
+	FILE* fp = fopen(file.c_str(), "rb");
+	uint64_t llc_size;
+	bool ok;
+
+	if (fp == NULL)
+		return -1;
+
+	ok = fread(&hdr, sizeof(hdr), 1, fp) == 1 && hdr.magic == MRC_FILE_MAGIC &&
+	     hdr.version == MRC_FILE_VERSION && hdr.cmdline_len <= 65536 && hdr.num_points <= (1u << 24);
+	if (ok) {
+		cmdline.resize(hdr.cmdline_len);
+		pts.resize(hdr.num_points);
+		ok = fread(&cmdline[0], 1, hdr.cmdline_len, fp) == hdr.cmdline_len &&
+		     fread(pts.data(), sizeof(mrc_file_point), pts.size(), fp) == pts.size();
+	}
+	fclose(fp);
+	if (!ok || hdr.checksum != hash(pts.data(), pts.size() * sizeof(mrc_file_point),
+					hash(cmdline.data(), cmdline.size())))
+		return -1;
+
+	// curves are binned by the profiler, occupancy cannot exceed the cache
+	llc_size = (uint64_t)hdr.num_llcs * hdr.num_ways * hdr.way_size;
+	if (hdr.way_size == 0 || hdr.bin_size != hdr.way_size / CATPC_MRC_BINS_PER_WAY)
+		return -1;
+	for (const mrc_file_point& p : pts)
+		if (p.occupancy > llc_size || !std::isfinite(p.miss_rate) || p.miss_rate < 0 || p.miss_rate > 1)
+			return -1;
+
+	entry e{cmdline, {hdr.num_ways, hdr.way_size, hdr.num_llcs}, (time_t)hdr.updated, hdr.confirmations,
+		catpc_mrc{hdr.bin_size, llc_size}};
+	for (const mrc_file_point& p : pts)
+		e.mrc.add(p.occupancy, p.miss_rate);
+
+	// file written for another command line or platform with the same hash
+	if (file_name(e.cmdline, e.platform) != name)
+		return -1;
+	entries.insert_or_assign(name, std::move(e));
+	return 0;
+}
+
+const catpc_mrc_store::entry* catpc_mrc_store::find(const std::string& cmdline, const catpc_platform& platform) const
+{
+	auto it = entries.find(file_name(cmdline, platform));
+
+	if (it == entries.end() || it->second.cmdline != cmdline || !(it->second.platform == platform))
+		return NULL;
+	return &it->second;
+}
+
+catpc_mrc_decision catpc_mrc_store::lookup(const std::string& cmdline, const catpc_platform& platform, time_t now,
+					    const entry** stored) const
+{
+	const entry* e = find(cmdline, platform);
+	time_t age;
+
+	if (e == NULL || e->mrc.size() == 0)
+		return CATPC_MRC_PROFILE;
+
+	*stored = e;
+	age = now - e->updated;
+	if (age < 0 || age > policy.max_age)
+		return CATPC_MRC_PROFILE;
+	if (age <= policy.fresh_age * (time_t)std::min(std::max(e->confirmations, 1u), policy.max_confirmations))
+		return CATPC_MRC_USE;
+	return CATPC_MRC_VALIDATE;
+}
+
+bool catpc_mrc_store::validate(const std::string& cmdline, const catpc_platform& platform, uint64_t occupancy,
+			       double miss_rate, time_t now)
+{
+	auto it = entries.find(file_name(cmdline, platform));
+	entry* e = it != entries.end() && find(cmdline, platform) != NULL ? &it->second : NULL;
+
+	if (e == NULL || std::isnan(miss_rate) || std::fabs(e->mrc.miss_rate_at(occupancy) - miss_rate) > policy.tolerance)
+		return false;
+
+	e->updated = now;
+	e->confirmations++;
+	write(*e);
+	return true;
+}
+
+void catpc_mrc_store::save(const std::string& cmdline, const catpc_platform& platform, const catpc_mrc& mrc, time_t now)
+{
+	const std::string name = file_name(cmdline, platform);
+
+	entries.insert_or_assign(name, entry{cmdline, platform, now, 1, mrc});
+	write(entries.at(name));
+}
+
+void catpc_mrc_store::write(const entry& e)
+{
+	const std::vector<catpc_mrc::point> pts = e.mrc.points();
+	struct mrc_file_header hdr;
+	std::vector<char> data;
+
+	if (dir.empty())
+		return;
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = MRC_FILE_MAGIC;
+	hdr.version = MRC_FILE_VERSION;
+	hdr.num_ways = e.platform.num_ways;
+	hdr.way_size = e.platform.way_size;
+	hdr.num_llcs = e.platform.num_llcs;
+	hdr.confirmations = e.confirmations;
+	hdr.updated = e.updated;
+	hdr.bin_size = e.mrc.bin_size();
+	hdr.cmdline_len = e.cmdline.size();
+	hdr.num_points = pts.size();
+
+	data.reserve(sizeof(hdr) + e.cmdline.size() + pts.size() * sizeof(mrc_file_point));
+	data.insert(data.end(), (const char*)&hdr, (const char*)&hdr + sizeof(hdr));
+	data.insert(data.end(), e.cmdline.begin(), e.cmdline.end());
+	for (const catpc_mrc::point& p : pts) {
+		const mrc_file_point fp{p.occupancy, p.miss_rate};
+
+		data.insert(data.end(), (const char*)&fp, (const char*)&fp + sizeof(fp));
+	}
+	hdr.checksum = hash(data.data() + sizeof(hdr), data.size() - sizeof(hdr));
+	memcpy(data.data() + offsetof(mrc_file_header, checksum), &hdr.checksum, sizeof(hdr.checksum));
+
+	{
+		std::lock_guard<std::mutex> lk{mtx};
+		queue.emplace_back(dir + "/" + file_name(e.cmdline, e.platform), std::move(data));
+	}
+	cv.notify_one();
+}
+
+void catpc_mrc_store::writer()
+{
+	std::unique_lock<std::mutex> lk{mtx};
+
+	while (true) {
+		cv.wait(lk, [this]() { return stopping || !queue.empty(); });
+		if (queue.empty())
+			return;	// stopping and everything written
+
+		std::pair<std::string, std::vector<char>> item = std::move(queue.front());
+		queue.pop_front();
+		lk.unlock();
+
+		// write aside and rename, readers never see a partial file
+		const std::string tmp = item.first + ".tmp";
+		int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+		bool ok = fd >= 0;
+
+		if (ok) {
+			ok = ::write(fd, item.second.data(), item.second.size()) == (ssize_t)item.second.size();
+			ok = close(fd) == 0 && ok;
+		}
+		if (ok)
+			ok = rename(tmp.c_str(), item.first.c_str()) == 0;
+		if (!ok) {
+			log_fprint(log_file, "ERROR: MRC store: writing %s failed: %s (%d)\n", item.first.c_str(),
+				   strerror(errno), errno);
+			unlink(tmp.c_str());
+		}
+
+		lk.lock();
+	}
+}
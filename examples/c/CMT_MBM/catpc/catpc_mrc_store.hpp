@@ -0,0 +1,140 @@
+#ifndef __CATPC_MRC_STORE_HPP__
+#define __CATPC_MRC_STORE_HPP__
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "catpc_mrc.hpp"
+
+/**
+ * @brief Cache geometry an MRC was measured on
+ */
+struct catpc_platform {
+	uint32_t num_ways;
+	uint32_t way_size;
+	uint32_t num_llcs;
+
+	bool operator==(const catpc_platform& p) const
+	{
+		return num_ways == p.num_ways && way_size == p.way_size && num_llcs == p.num_llcs;
+	}
+};
+
+/**
+ * @brief What to do with an application starting on a platform
+ */
+enum catpc_mrc_decision {
+	CATPC_MRC_PROFILE = 0,	/**< no usable curve, walk through all CLOS */
+	CATPC_MRC_VALIDATE = 1,	/**< check stored curve against one sample */
+	CATPC_MRC_USE = 2	/**< use stored curve as it is */
+};
+
+/**
+ * @brief When a stored curve can be trusted
+ *
+ * A curve is used as it is while younger than fresh_age multiplied by the
+ * number of times it was confirmed (at most max_confirmations). Older
+ * curves, up to max_age, are checked against the first sample of the
+ * application; sample within tolerance confirms the curve.
+ */
+struct catpc_mrc_policy {
+	time_t fresh_age = 24 * 3600;		/**< trust of a curve confirmed once */
+	unsigned max_confirmations = 7;		/**< confirmations extending the trust */
+	time_t max_age = 30 * 24 * 3600;	/**< older curves are profiled again */
+	double tolerance = 0.05;		/**< accepted miss rate difference */
+};
+
+/**
+ * @brief Persistent store of application miss rate curves
+ *
+ * Each curve is kept in its own file named after hashes of the command
+ * line and of the platform. Files are loaded when the store is opened and
+ * written by a background thread, replacing the previous file atomically.
+ * Apart from the writer thread, the store is used from a single thread.
+ */
+class catpc_mrc_store {
+public:
+	struct entry {
+		std::string cmdline;
+		catpc_platform platform;
+		time_t updated;		/**< last profiling or confirmation */
+		uint32_t confirmations;	/**< times the curve was measured or confirmed */
+		catpc_mrc mrc;
+	};
+
+	catpc_mrc_store(FILE* log, catpc_mrc_policy policy = catpc_mrc_policy());
+
+	/**
+	 * @brief Waits for pending writes
+	 */
+	~catpc_mrc_store();
+
+	/**
+	 * @brief Opens store directory and loads all curves
+	 *
+	 * @param [in] dir store directory, created if missing
+	 *
+	 * @retval 0 OK
+	 * @retval -1 directory cannot be used, store stays disabled
+	 */
+	int open(const std::string& dir);
+
+	/**
+	 * @brief Decides how to get curve of an application
+	 *
+	 * @param [in] cmdline application command line
+	 * @param [in] platform cache geometry
+	 * @param [in] now current time
+	 * @param [out] stored stored curve, unless CATPC_MRC_PROFILE
+	 */
+	catpc_mrc_decision lookup(const std::string& cmdline, const catpc_platform& platform, time_t now,
+				  const entry** stored) const;
+
+	/**
+	 * @brief Checks sample against stored curve
+	 *
+	 * Confirmed curve gets its age reset and is written back.
+	 *
+	 * @return true if the sample confirms the curve
+	 */
+	bool validate(const std::string& cmdline, const catpc_platform& platform, uint64_t occupancy,
+		      double miss_rate, time_t now);
+
+	/**
+	 * @brief Stores newly profiled curve
+	 */
+	void save(const std::string& cmdline, const catpc_platform& platform, const catpc_mrc& mrc, time_t now);
+
+	/** number of stored curves */
+	size_t size() const { return entries.size(); }
+
+private:
+	std::string file_name(const std::string& cmdline, const catpc_platform& platform) const;
+	const entry* find(const std::string& cmdline, const catpc_platform& platform) const;
+	int load(const std::string& file);
+	void write(const entry& e);
+	void writer();
+
+	FILE* log_file;
+	catpc_mrc_policy policy;
+	std::string dir;
+	std::unordered_map<std::string, entry> entries;	/**< by file name */
+
+	// files queued for the writer thread
+	std::mutex mtx;
+	std::condition_variable cv;
+	std::deque<std::pair<std::string, std::vector<char>>> queue;
+	bool stopping = false;
+	std::thread thread;
+};
+
+#endif
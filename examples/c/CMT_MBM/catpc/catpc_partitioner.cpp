@@ -0,0 +1,221 @@
+#include "catpc_partitioner.hpp"
+
+#include <algorithm>
+#include <limits>
+
+int catpc_greedy_partitioner::partition(const llc_ca& llc, unsigned num_llcs, std::vector<catpc_partition_app>& apps,
+					std::vector<CLOS>& masks)
+{
+	const double way_bytes = (double)num_llcs * llc.way_size;
+	std::vector<double> way_ratios(llc.num_ways, 0.0);
+	std::vector<std::vector<unsigned>> clos_ways(llc.clos_list.size());
+	unsigned selected_CLOS_id = 0;
+
+	if (llc.clos_list.size() < 2 || llc.num_ways == 0 || llc.num_ways > 64)
+		return -1;
+
+	for (unsigned i = 0; i < llc.clos_list.size(); ++i)
+		for (unsigned j = 0; j < llc.num_ways; ++j)
+			if (llc.clos_list[i].mask & (1ULL << j))
+				clos_ways[i].push_back(j);
+
+	for (catpc_partition_app& app : apps) {
+		double target_occupancy_ratio = -1, curr_occupancy_ratio = 0;
+
+		// Search for the best fitting CLOS, the last one is kept for the rest
+		selected_CLOS_id = 0;
+		for (unsigned i = 0; i < clos_ways.size() - 1; ++i) {
+			double CLOS_occupancy = 0;
+
+			if (clos_ways[i].empty())
+				continue;
+			for (unsigned w : clos_ways[i])
+				CLOS_occupancy += way_ratios[w];
+			curr_occupancy_ratio = (app.required_llc + CLOS_occupancy * way_bytes) / (clos_ways[i].size() * way_bytes);
+
+			if ((target_occupancy_ratio < 0) ||
+			    ((curr_occupancy_ratio < target_occupancy_ratio) && (target_occupancy_ratio >= 1)) ||
+			    ((curr_occupancy_ratio < 1) && (target_occupancy_ratio < 1) && (curr_occupancy_ratio > target_occupancy_ratio))) {
+				selected_CLOS_id = i;
+				target_occupancy_ratio = curr_occupancy_ratio;
+			}
+		}
+		app.CLOS_id = llc.clos_list[selected_CLOS_id].id;
+
+		// Update CLOS occupancy
+		for (unsigned w : clos_ways[selected_CLOS_id])
+			way_ratios[w] += app.required_llc / (way_bytes * clos_ways[selected_CLOS_id].size());
+	}
+
+	if (!apps.empty()) {
+		const uint64_t all = llc.num_ways == 64 ? ~0ULL : (1ULL << llc.num_ways) - 1;
+		const uint64_t top = 1ULL << (llc.num_ways - 1);
+
+		masks.push_back({llc.clos_list.back().id, (all ^ llc.clos_list[selected_CLOS_id].mask) | top});
+	}
+
+	return 0;
+}
+
+double catpc_ucp_partitioner::misses(const std::vector<const catpc_partition_app*>& apps, unsigned ways,
+				     uint64_t way_bytes)
+{
+	double total = 0;
+
+	if (apps.empty())
+		return 0;
+
+	// applications of a shared partition are assumed to split it evenly
+	const uint64_t occupancy = (uint64_t)ways * way_bytes / apps.size();
+
+	for (const catpc_partition_app* app : apps) {
+		const double refs = app->references > 0 ? app->references : 1.0;
+		double miss_rate;
+
+		if (app->mrc != NULL && app->mrc->size() > 0)
+			miss_rate = app->mrc->miss_rate_at(occupancy);
+		else if (app->required_llc > 0)
+			miss_rate = 1.0 - std::min(1.0, (double)occupancy / app->required_llc);
+		else
+			miss_rate = 0;
+		total += refs * miss_rate;
+	}
+
+	return total;
+}
+
+int catpc_ucp_partitioner::partition(const llc_ca& llc, unsigned num_llcs, std::vector<catpc_partition_app>& apps,
+				     std::vector<CLOS>& masks)
+{
+	const unsigned num_ways = llc.num_ways;
+	const uint64_t way_bytes = (uint64_t)num_llcs * llc.way_size;
+	const double inf = std::numeric_limits<double>::infinity();
+
+	if (llc.clos_list.size() < 2 || num_ways == 0 || num_ways > 64)
+		return -1;
+	if (apps.empty())
+		return 0;
+
+	// CLOS 0 stays with unmanaged tasks
+	const unsigned slots = std::min<unsigned>(llc.clos_list.size() - 1, num_ways);
+
+	// applications that gain the most from the cache get partitions of their own
+	std::vector<std::pair<double, unsigned>> utility;
+	for (unsigned i = 0; i < apps.size(); ++i) {
+		const std::vector<const catpc_partition_app*> one{&apps[i]};
+
+		utility.emplace_back(misses(one, 1, way_bytes) - misses(one, num_ways, way_bytes), i);
+	}
+	std::stable_sort(utility.begin(), utility.end(),
+			 [](const auto& a, const auto& b) { return a.first > b.first; });
+
+	std::vector<std::vector<const catpc_partition_app*>> groups;
+	std::vector<std::vector<unsigned>> members;
+	for (unsigned i = 0; i < utility.size(); ++i) {
+		if (groups.size() < slots) {
+			groups.emplace_back();
+			members.emplace_back();
+		}
+		groups.back().push_back(&apps[utility[i].second]);
+		members.back().push_back(utility[i].second);
+	}
+
+	// cost[g][w] - misses of group g with w ways
+	const unsigned num_groups = groups.size();
+	std::vector<std::vector<double>> cost(num_groups, std::vector<double>(num_ways + 1, inf));
+	for (unsigned g = 0; g < num_groups; ++g)
+		for (unsigned w = 1; w <= num_ways; ++w)
+			cost[g][w] = misses(groups[g], w, way_bytes);
+
+	// best[g][w] - least misses of groups 0..g-1 sharing w ways, every group
+	// has at least one way; choice[g][w] - ways given to group g-1
+	std::vector<std::vector<double>> best(num_groups + 1, std::vector<double>(num_ways + 1, inf));
+	std::vector<std::vector<unsigned>> choice(num_groups + 1, std::vector<unsigned>(num_ways + 1, 0));
+	best[0][0] = 0;
+	for (unsigned g = 1; g <= num_groups; ++g)
+		for (unsigned w = g; w <= num_ways; ++w)
+			for (unsigned k = 1; k <= w - (g - 1); ++k) {
+				const double c = best[g - 1][w - k] + cost[g - 1][k];
+
+				if (c < best[g][w]) {
+					best[g][w] = c;
+					choice[g][w] = k;
+				}
+			}
+
+	std::vector<unsigned> ways(num_groups);
+	for (unsigned g = num_groups, w = num_ways; g > 0; --g) {
+		ways[g - 1] = choice[g][w];
+		w -= choice[g][w];
+	}
+
+	// contiguous masks from the lowest way up, CLOS from the highest down
+	unsigned first_way = 0;
+	for (unsigned g = 0; g < num_groups; ++g) {
+		const unsigned id = llc.clos_list[llc.clos_list.size() - 1 - g].id;
+		const uint64_t mask = (ways[g] == 64 ? ~0ULL : ((1ULL << ways[g]) - 1)) << first_way;
+
+		masks.push_back({id, mask});
+		for (unsigned i : members[g])
+			apps[i].CLOS_id = id;
+		first_way += ways[g];
+	}
+
+	return 0;
+}
+
+std::unique_ptr<catpc_partitioner> catpc_make_partitioner(const std::string& name)
+{
+	if (name == "greedy")
+		return std::make_unique<catpc_greedy_partitioner>();
+	if (name == "ucp")
+		return std::make_unique<catpc_ucp_partitioner>();
+	return nullptr;
+}
+
+void catpc_update_masks(std::vector<llc_ca>& llcs, const std::vector<CLOS>& masks)
+{
+	for (llc_ca& llc : llcs)
+		for (const CLOS& m : masks)
+			if (m.llc_id < 0 || m.llc_id == llc.id)
+				for (CLOS& clos : llc.clos_list)
+					if (clos.id == m.id)
+						clos.mask = m.mask;
+}
+
+int catpc_partition_domains(catpc_partitioner& partitioner, const std::vector<llc_ca>& llcs,
+			    std::vector<catpc_partition_app>& apps, std::vector<CLOS>& masks)
+{
+	const bool pinned = std::all_of(apps.begin(), apps.end(), [&llcs](const catpc_partition_app& app) {
+		return std::any_of(llcs.begin(), llcs.end(), [&app](const llc_ca& llc) { return llc.id == app.llc_id; });
+	});
+
+	if (!pinned)
+		return partitioner.partition(llcs[0], llcs.size(), apps, masks);
+
+	for (const llc_ca& llc : llcs) {
+		std::vector<catpc_partition_app> domain;
+		std::vector<size_t> index;
+		std::vector<CLOS> domain_masks;
+
+		for (size_t i = 0; i < apps.size(); ++i) {
+			if (apps[i].llc_id == llc.id) {
+				domain.push_back(apps[i]);
+				index.push_back(i);
+			}
+		}
+		if (domain.empty())
+			continue;
+		if (partitioner.partition(llc, 1, domain, domain_masks) < 0)
+			return -1;
+
+		for (size_t i = 0; i < domain.size(); ++i)
+			apps[index[i]].CLOS_id = domain[i].CLOS_id;
+		for (CLOS& clos : domain_masks) {
+			clos.llc_id = llc.id;
+			masks.push_back(clos);
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,126 @@
+#ifndef __CATPC_PARTITIONER_HPP__
+#define __CATPC_PARTITIONER_HPP__
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "catpc_allocator.hpp"
+#include "catpc_mrc.hpp"
+
+/**
+ * @brief Application to place in the cache
+ */
+struct catpc_partition_app {
+	std::string cmdline;
+	const catpc_mrc* mrc;		/**< miss rate curve, may be NULL */
+	uint64_t required_llc;		/**< knee of the curve in bytes */
+	double references;		/**< LLC references per period, weights misses */
+	unsigned CLOS_id;		/**< [out] selected CLOS */
+	int llc_id = -1;		/**< L3 domain the application runs on, -1 spreads over all */
+};
+
+/**
+ * @brief Cache partitioning policy
+ *
+ * Assigns applications sharing an LLC to CLOS and computes CLOS masks.
+ * Policies are pure, the caller programs the masks and associations.
+ */
+class catpc_partitioner {
+public:
+	virtual ~catpc_partitioner() = default;
+
+	/** policy name */
+	virtual const char* name() const = 0;
+
+	/**
+	 * @brief Partitions the cache
+	 *
+	 * @param [in] llc cache geometry and current CLOS masks
+	 * @param [in] num_llcs number of caches an application spreads over
+	 * @param [in,out] apps applications, CLOS_id is set on return
+	 * @param [out] masks CLOS masks to program, only changed ones
+	 *
+	 * @retval 0 OK
+	 * @retval -1 error
+	 */
+	virtual int partition(const llc_ca& llc, unsigned num_llcs, std::vector<catpc_partition_app>& apps,
+			      std::vector<CLOS>& masks) = 0;
+};
+
+/**
+ * @brief Greedy placement by required LLC
+ *
+ * Applications are placed one by one into the CLOS whose ways fit the
+ * required LLC best, CLOS masks stay as they are except the last CLOS
+ * which gets the ways not used by the last placed application.
+ */
+class catpc_greedy_partitioner : public catpc_partitioner {
+public:
+	const char* name() const override { return "greedy"; }
+	int partition(const llc_ca& llc, unsigned num_llcs, std::vector<catpc_partition_app>& apps,
+		      std::vector<CLOS>& masks) override;
+};
+
+/**
+ * @brief Utility-based cache partitioning
+ *
+ * Splits the ways among applications so that the total number of misses
+ * estimated from their miss rate curves is minimal, using a dynamic
+ * program over ways. Every partition is a contiguous mask of its own
+ * CLOS, CLOS are taken from the highest one down and CLOS 0 is left to
+ * unmanaged tasks. When there are more applications than CLOS or ways,
+ * applications with the least utility share the last partition.
+ */
+class catpc_ucp_partitioner : public catpc_partitioner {
+public:
+	const char* name() const override { return "ucp"; }
+	int partition(const llc_ca& llc, unsigned num_llcs, std::vector<catpc_partition_app>& apps,
+		      std::vector<CLOS>& masks) override;
+
+	/**
+	 * @brief Estimated misses of applications sharing a number of ways
+	 *
+	 * @param [in] apps applications
+	 * @param [in] ways number of ways
+	 * @param [in] way_bytes bytes of one way across all caches
+	 */
+	static double misses(const std::vector<const catpc_partition_app*>& apps, unsigned ways, uint64_t way_bytes);
+};
+
+/**
+ * @brief Records programmed CLOS masks in the cache list
+ *
+ * @param [in,out] llcs last level caches
+ * @param [in] masks programmed masks, each on its llc_id or on all caches
+ */
+void catpc_update_masks(std::vector<llc_ca>& llcs, const std::vector<CLOS>& masks);
+
+/**
+ * @brief Partitions each L3 domain among the applications running on it
+ *
+ * Returned masks apply to their domain only. When the domain of any
+ * application is unknown, all caches are partitioned as one.
+ *
+ * @param [in] partitioner partitioning policy
+ * @param [in] llcs caches of the slave with their current masks
+ * @param [in,out] apps applications, CLOS_id is set on return
+ * @param [out] masks CLOS masks to program, only changed ones
+ *
+ * @retval 0 OK
+ * @retval -1 error
+ */
+int catpc_partition_domains(catpc_partitioner& partitioner, const std::vector<llc_ca>& llcs,
+			    std::vector<catpc_partition_app>& apps, std::vector<CLOS>& masks);
+
+/**
+ * @brief Creates partitioner by name
+ *
+ * @param [in] name "greedy" or "ucp"
+ *
+ * @return partitioner or NULL for unknown name
+ */
+std::unique_ptr<catpc_partitioner> catpc_make_partitioner(const std::string& name);
+
+#endif
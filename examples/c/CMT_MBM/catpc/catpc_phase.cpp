@@ -0,0 +1,62 @@
+#include "catpc_phase.hpp"
+
+#include <math.h>
+#include <algorithm>
+
+void catpc_phase_detector::reset()
+{
+	for (cusum& m : metrics)
+		m = cusum{0, 0, 0, 0, 0};
+	n = 0;
+}
+
+unsigned catpc_phase_detector::update(const double sample[CATPC_PHASE_METRICS], const catpc_phase_params& params)
+{
+	unsigned changed = 0;
+
+	if (n < params.warmup) {
+		n++;
+		for (unsigned i = 0; i < CATPC_PHASE_METRICS; ++i) {
+			cusum& m = metrics[i];
+			const double delta = sample[i] - m.mean;
+
+			m.mean += delta / n;
+			m.m2 += delta * (sample[i] - m.mean);
+			if (n == params.warmup) {
+				// steady metric would alarm on any jitter without a floor
+				m.sigma = std::max(sqrt(m.m2 / std::max(n - 1, 1u)), params.min_deviation * fabs(m.mean));
+			}
+		}
+		return 0;
+	}
+
+	for (unsigned i = 0; i < CATPC_PHASE_METRICS; ++i) {
+		cusum& m = metrics[i];
+
+		if (m.sigma <= 0)
+			continue;
+
+		const double z = std::clamp((sample[i] - m.mean) / m.sigma, -params.clip, params.clip);
+
+		m.high = std::max(0.0, m.high + z - params.drift);
+		m.low = std::max(0.0, m.low - z - params.drift);
+		if (m.high > params.threshold || m.low > params.threshold)
+			changed |= 1u << i;
+	}
+
+	if (changed)
+		reset();
+
+	return changed;
+}
+
+const char* catpc_phase_metric_name(unsigned mask)
+{
+	if (mask & (1u << CATPC_PHASE_MISS_RATIO))
+		return "miss ratio";
+	if (mask & (1u << CATPC_PHASE_OCCUPANCY))
+		return "occupancy";
+	if (mask & (1u << CATPC_PHASE_IPC))
+		return "IPC";
+	return "none";
+}
@@ -0,0 +1,74 @@
+#ifndef __CATPC_PHASE_HPP__
+#define __CATPC_PHASE_HPP__
+
+/**
+ * @brief Metrics watched for phase changes
+ */
+enum catpc_phase_metric {
+	CATPC_PHASE_IPC = 0,		/**< instructions per cycle */
+	CATPC_PHASE_MISS_RATIO = 1,	/**< LLC misses per reference */
+	CATPC_PHASE_OCCUPANCY = 2,	/**< LLC occupancy */
+	CATPC_PHASE_METRICS = 3
+};
+
+/**
+ * @brief Phase change detection parameters
+ *
+ * Deviations are in standard deviations of the metric within the phase.
+ */
+struct catpc_phase_params {
+	unsigned warmup = 16;		/**< samples learning the reference of a phase */
+	double drift = 1.0;		/**< shift tolerated by the CUSUM */
+	double threshold = 10.0;	/**< CUSUM level raising an alarm */
+	double clip = 4.0;		/**< largest deviation a sample adds, outliers alone do not alarm */
+	double min_deviation = 0.05;	/**< floor of the standard deviation relative to the mean */
+};
+
+/**
+ * @brief Online phase change detector of an application
+ *
+ * Learns mean and standard deviation of each metric over the first
+ * samples of a phase, then runs a two-sided CUSUM per metric against
+ * that reference. A change of any metric ends the phase and the next
+ * samples learn the new reference. Memory is constant, an update is a
+ * few arithmetic operations per metric.
+ */
+class catpc_phase_detector {
+public:
+	catpc_phase_detector() { reset(); }
+
+	/**
+	 * @brief Feeds one monitoring sample
+	 *
+	 * @param [in] sample metric values indexed by catpc_phase_metric
+	 * @param [in] params detection parameters
+	 *
+	 * @return bitmask of changed metrics (1 << catpc_phase_metric), 0 if none
+	 */
+	unsigned update(const double sample[CATPC_PHASE_METRICS], const catpc_phase_params& params);
+
+	/** starts a new phase, the reference is learned again */
+	void reset();
+
+	/** true while the reference of the phase is learned */
+	bool learning(const catpc_phase_params& params) const { return n < params.warmup; }
+
+private:
+	struct cusum {
+		double mean;
+		double m2;
+		double sigma;
+		double high;	/**< upward cumulative sum */
+		double low;	/**< downward cumulative sum */
+	};
+
+	cusum metrics[CATPC_PHASE_METRICS];
+	unsigned n;
+};
+
+/**
+ * @brief Name of metrics set in a mask returned by catpc_phase_detector::update()
+ */
+const char* catpc_phase_metric_name(unsigned mask);
+
+#endif
@@ -0,0 +1,216 @@
+#include "catpc_profiler.hpp"
+
+#include <math.h>
+#include <algorithm>
+
+catpc_profiler::catpc_profiler(const catpc_mrc_sampling& s, unsigned l, bool p)
+	: sampling{s}, levels{l > 1 ? l : 2}, parallel{p}
+{
+}
+
+void catpc_profiler::add(const std::string& cmdline)
+{
+	if (std::find(waiting.begin(), waiting.end(), cmdline) != waiting.end())
+		return;
+	for (const job& j : jobs)
+		if (j.cmdline == cmdline)
+			return;
+	waiting.push_back(cmdline);
+}
+
+std::vector<unsigned> catpc_profiler::level_ways(unsigned num_ways) const
+{
+	std::vector<unsigned> ways;
+
+	// one way at least stays with the other CLOS
+	if (num_ways < 2)
+		return {num_ways};
+
+	for (unsigned i = 0; i < levels; ++i) {
+		const unsigned w = num_ways - 1 - (unsigned)lround((double)i * (num_ways - 2) / (levels - 1));
+
+		if (ways.empty() || ways.back() != w)
+			ways.push_back(w);
+	}
+
+	return ways;
+}
+
+bool catpc_profiler::held(int llc_id) const
+{
+	for (const job& j : jobs)
+		if (std::find(j.domains.begin(), j.domains.end(), llc_id) != j.domains.end())
+			return true;
+	return false;
+}
+
+void catpc_profiler::program(const std::vector<llc_ca>& llcs, const job& j, std::vector<CLOS>& masks) const
+{
+	for (const llc_ca& llc : llcs) {
+		if (std::find(j.domains.begin(), j.domains.end(), llc.id) == j.domains.end())
+			continue;
+
+		const unsigned n = llc.num_ways;
+		const unsigned k = level_ways(n)[j.level];
+		const uint64_t all = n < 64 ? (1ull << n) - 1 : ~0ull;
+		const uint64_t profiled = all & ~((1ull << (n - k)) - 1);	// top k ways
+
+		for (const CLOS& c : j.saved) {
+			if (c.llc_id != llc.id)
+				continue;
+			if (c.id == llc.clos_count - 1) {
+				masks.push_back({c.id, profiled, llc.id});
+				continue;
+			}
+
+			// contiguous mask stays contiguous without its top ways
+			uint64_t m = c.mask & ~profiled;
+
+			if (m == 0)
+				m = (all & ~profiled) != 0 ? all & ~profiled : c.mask;
+			masks.push_back({c.id, m, llc.id});
+		}
+	}
+}
+
+bool catpc_profiler::start(const std::vector<llc_ca>& llcs, std::unordered_map<std::string, catpc_application*>& apps,
+			   const std::string& cmdline, std::vector<CLOS>& masks)
+{
+	catpc_application* app_ptr = apps.at(cmdline);
+	job j{cmdline, {}, 0, true, {}};
+
+	for (const llc_ca& llc : llcs)
+		if (llc.id == app_ptr->llc_id)
+			j.domains.push_back(llc.id);
+	if (j.domains.empty())
+		for (const llc_ca& llc : llcs)
+			j.domains.push_back(llc.id);
+
+	for (int id : j.domains)
+		if (held(id))
+			return false;
+
+	for (const llc_ca& llc : llcs) {
+		if (std::find(j.domains.begin(), j.domains.end(), llc.id) == j.domains.end())
+			continue;
+		for (const CLOS& c : llc.clos_list)
+			j.saved.push_back({c.id, c.mask, llc.id});
+	}
+
+	// the profiling CLOS is for the profiled application alone
+	const unsigned profiling_clos = llcs[0].clos_count - 1;
+
+	for (const auto& entry : apps) {
+		catpc_application* other = entry.second;
+		const bool on_domain = other->llc_id < 0 ||
+			std::find(j.domains.begin(), j.domains.end(), other->llc_id) != j.domains.end();
+		const bool profiled = std::any_of(jobs.begin(), jobs.end(),
+						  [&entry](const job& o) { return o.cmdline == entry.first; });
+
+		if (other != app_ptr && other->CLOS_id == profiling_clos && on_domain && !profiled)
+			other->CLOS_id = 0;
+	}
+
+	app_ptr->CLOS_id = profiling_clos;
+	app_ptr->step.reset();
+	program(llcs, j, masks);
+	jobs.push_back(std::move(j));
+
+	return true;
+}
+
+bool catpc_profiler::round(const std::vector<llc_ca>& llcs, std::unordered_map<std::string, catpc_application*>& apps,
+			   std::unordered_map<std::string, catpc_mrc>& mrc, std::vector<CLOS>& masks,
+			   std::vector<catpc_application*>& completed)
+{
+	bool changed = false;
+
+	if (llcs.empty())
+		return false;
+
+	for (size_t i = 0; i < jobs.size();) {
+		job& j = jobs[i];
+		auto it = apps.find(j.cmdline);
+
+		if (it == apps.end()) {
+			// terminated while profiled
+			masks.insert(masks.end(), j.saved.begin(), j.saved.end());
+			jobs.erase(jobs.begin() + i);
+			changed = true;
+			continue;
+		}
+
+		catpc_application* app_ptr = it->second;
+		const catpc_monitoring_values& v = app_ptr->values;
+		catpc_mrc_step& step = app_ptr->step;
+
+		// occupancy lags behind a mask change, first sample is not representative
+		if (j.settle || v.llc_references == 0) {
+			j.settle = false;
+			i++;
+			continue;
+		}
+
+		step.add(v.llc, (double)v.llc_misses / v.llc_references);
+		st.samples++;
+		if (!step.done(sampling)) {
+			i++;
+			continue;
+		}
+
+		const std::vector<unsigned> ways = level_ways(llcs[0].num_ways);
+		const uint64_t unit = (uint64_t)llcs[0].way_size * j.domains.size();
+		unsigned next = j.level + 1;
+
+		mrc.try_emplace(j.cmdline, llcs[0].way_size / CATPC_MRC_BINS_PER_WAY,
+				(uint64_t)llcs.size() * llcs[0].num_ways * llcs[0].way_size)
+			.first->second.add(step.occupancy(), step.mean());
+		st.steps++;
+		st.saved_samples += sampling.max_samples - step.count();
+
+		// alone in its ways, an application not filling them needs none of the levels it would not fill either
+		if (step.occupancy() < sampling.saturation * ways[j.level] * unit) {
+			while (next < ways.size() && step.occupancy() < sampling.saturation * ways[next] * unit)
+				next++;
+		}
+		st.skipped_steps += next - j.level - 1;
+		step.reset();
+		changed = true;
+
+		if (next < ways.size()) {
+			j.level = next;
+			j.settle = true;
+			program(llcs, j, masks);
+			i++;
+			continue;
+		}
+
+		masks.insert(masks.end(), j.saved.begin(), j.saved.end());
+		app_ptr->CLOS_id = 0;
+		completed.push_back(app_ptr);
+		st.curves++;
+		jobs.erase(jobs.begin() + i);
+	}
+
+	for (auto it = waiting.begin(); it != waiting.end();) {
+		auto app = apps.find(*it);
+
+		if (app == apps.end()) {
+			it = waiting.erase(it);
+			continue;
+		}
+		if (!parallel && !jobs.empty())
+			break;
+		if (start(llcs, apps, *it, masks)) {
+			it = waiting.erase(it);
+			changed = true;
+			continue;
+		}
+		// application of unknown domain waits for all domains, nothing may overtake it
+		if (app->second->llc_id < 0)
+			break;
+		++it;
+	}
+
+	return changed;
+}
@@ -0,0 +1,95 @@
+#ifndef __CATPC_PROFILER_HPP__
+#define __CATPC_PROFILER_HPP__
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "catpc_allocator.hpp"
+#include "catpc_monitor.hpp"
+#include "catpc_mrc.hpp"
+
+/**
+ * @brief Schedules MRC profiling of the applications of a slave
+ *
+ * One application at a time is profiled on each L3 domain. It runs alone
+ * in the profiling CLOS, the last one, whose ways shrink level by level
+ * while the other CLOS of the domain are kept off those ways, so that
+ * no other application distorts its curve. Masks are programmed on the
+ * profiled domain only: domains are independent and profile their
+ * applications in parallel. An application whose domain is unknown holds
+ * all domains.
+ */
+class catpc_profiler {
+public:
+	/**
+	 * @brief Constructor
+	 *
+	 * @param [in] sampling when a level may end
+	 * @param [in] levels partition sizes profiled, from all ways but one down to one way
+	 * @param [in] parallel profile domains in parallel, else one application at a time
+	 */
+	explicit catpc_profiler(const catpc_mrc_sampling& sampling = catpc_mrc_sampling(), unsigned levels = 6,
+				bool parallel = true);
+
+	/**
+	 * @brief Queues application for profiling
+	 *
+	 * @param [in] cmdline application command line
+	 */
+	void add(const std::string& cmdline);
+
+	/**
+	 * @brief Processes the monitoring values of a round
+	 *
+	 * Adds samples of the profiled applications, moves them to their
+	 * next level and starts waiting applications on free domains.
+	 * Profiled applications are moved to the profiling CLOS, others
+	 * found there on a profiled domain to CLOS 0. Masks of a domain are
+	 * restored once its application is done or gone.
+	 *
+	 * @param [in] llcs caches of the slave with their current masks
+	 * @param [in,out] apps applications of the slave, CLOS_id is updated
+	 * @param [in,out] mrc curves by command line, completed levels are added
+	 * @param [out] masks CLOS masks to program, appended
+	 * @param [out] completed applications whose curve is complete, appended
+	 *
+	 * @return true when masks or CLOS of applications changed
+	 */
+	bool round(const std::vector<llc_ca>& llcs, std::unordered_map<std::string, catpc_application*>& apps,
+		   std::unordered_map<std::string, catpc_mrc>& mrc, std::vector<CLOS>& masks,
+		   std::vector<catpc_application*>& completed);
+
+	/** no application profiled nor waiting */
+	bool idle() const { return jobs.empty() && waiting.empty(); }
+
+	/** applications being profiled */
+	size_t active() const { return jobs.size(); }
+
+	const catpc_mrc_stats& stats() const { return st; }
+
+private:
+	struct job {
+		std::string cmdline;
+		std::vector<int> domains;	/**< L3 domains held */
+		unsigned level;			/**< index in level_ways() */
+		bool settle;			/**< first round of a level, sample dropped */
+		std::vector<CLOS> saved;	/**< masks of held domains before profiling */
+	};
+
+	std::vector<unsigned> level_ways(unsigned num_ways) const;
+	void program(const std::vector<llc_ca>& llcs, const job& j, std::vector<CLOS>& masks) const;
+	bool held(int llc_id) const;
+	bool start(const std::vector<llc_ca>& llcs, std::unordered_map<std::string, catpc_application*>& apps,
+		   const std::string& cmdline, std::vector<CLOS>& masks);
+
+	catpc_mrc_sampling sampling;
+	unsigned levels;
+	bool parallel;
+	std::deque<std::string> waiting;
+	std::vector<job> jobs;
+	catpc_mrc_stats st{};
+};
+
+#endif
@@ -0,0 +1,364 @@
+#include "catpc_proto.hpp"
+
+#include <errno.h>
+#include <sys/socket.h>
+
+void catpc_buffer::put(const void* data, size_t len)
+{
+	const char* p = static_cast<const char*>(data);
+
+	buf.insert(buf.end(), p, p + len);
+}
+
+void catpc_buffer::put_u16(uint16_t value)
+{
+	const uint8_t b[2] = {(uint8_t)(value >> 8), (uint8_t)value};
+
+	put(b, sizeof(b));
+}
+
+void catpc_buffer::put_u32(uint32_t value)
+{
+	put_u16(value >> 16);
+	put_u16(value);
+}
+
+void catpc_buffer::put_u64(uint64_t value)
+{
+	put_u32(value >> 32);
+	put_u32(value);
+}
+
+void catpc_buffer::put_double(double value)
+{
+	uint64_t bits;
+
+	memcpy(&bits, &value, sizeof(bits));
+	put_u64(bits);
+}
+
+void catpc_buffer::put_string(const std::string& str)
+{
+	put_u32(str.size());
+	put(str.data(), str.size());
+}
+
+size_t catpc_buffer::begin_frame(enum catpc_message type)
+{
+	size_t offset = buf.size();
+
+	put_u16(CATPC_PROTO_MAGIC);
+	put_u8(CATPC_PROTO_VERSION);
+	put_u8(type);
+	put_u32(0);	// payload length, set by end_frame()
+
+	return offset;
+}
+
+void catpc_buffer::end_frame(size_t offset)
+{
+	const uint32_t len = buf.size() - offset - CATPC_FRAME_HEADER_SIZE;
+
+	for (int i = 0; i < 4; ++i)
+		buf[offset + 4 + i] = (char)(len >> (24 - 8 * i));
+}
+
+int catpc_buffer::peek_frame(catpc_frame& frame) const
+{
+	const uint8_t* p = reinterpret_cast<const uint8_t*>(data());
+	uint32_t len;
+
+	if (size() < CATPC_FRAME_HEADER_SIZE)
+		return 0;
+	if (((p[0] << 8) | p[1]) != CATPC_PROTO_MAGIC || p[2] != CATPC_PROTO_VERSION)
+		return -1;
+
+	len = ((uint32_t)p[4] << 24) | ((uint32_t)p[5] << 16) | ((uint32_t)p[6] << 8) | p[7];
+	if (len > CATPC_MAX_PAYLOAD)
+		return -1;
+	if (size() - CATPC_FRAME_HEADER_SIZE < len)
+		return 0;
+
+	frame.type = (enum catpc_message)p[3];
+	frame.payload = data() + CATPC_FRAME_HEADER_SIZE;
+	frame.len = len;
+	return 1;
+}
+
+void catpc_buffer::consume(size_t len)
+{
+	head += len;
+	if (head >= buf.size()) {
+		buf.clear();
+		head = 0;
+	}
+	else if (head > 4096 && head > buf.size() / 2) {
+		// Move remaining data to the front once most of the buffer is consumed
+		buf.erase(buf.begin(), buf.begin() + head);
+		head = 0;
+	}
+}
+
+int catpc_buffer::read_from(int fd)
+{
+	int flags = 0;
+
+	while (true) {
+		const size_t chunk = 16384;
+		size_t old_size = buf.size();
+		ssize_t len;
+
+		buf.resize(old_size + chunk);
+		len = recv(fd, buf.data() + old_size, chunk, flags);
+		buf.resize(old_size + (len > 0 ? len : 0));
+
+		if (len > 0) {
+			// drain the rest without blocking
+			flags = MSG_DONTWAIT;
+			continue;
+		}
+		if (len == 0)
+			return 0;
+		if (errno == EINTR)
+			continue;
+		if (errno == EAGAIN || errno == EWOULDBLOCK)
+			return 1;
+		return -1;
+	}
+}
+
+int catpc_buffer::write_to(int fd)
+{
+	while (!empty()) {
+		ssize_t len = send(fd, data(), size(), MSG_NOSIGNAL);
+
+		if (len > 0) {
+			consume(len);
+			continue;
+		}
+		if (len < 0 && errno == EINTR)
+			continue;
+		if (len < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+			return 0;
+		return -1;
+	}
+
+	return 0;
+}
+
+bool catpc_reader::take(void* data, size_t len)
+{
+	if (failed || (size_t)(end - cur) < len) {
+		failed = true;
+		memset(data, 0, len);
+		return false;
+	}
+	memcpy(data, cur, len);
+	cur += len;
+	return true;
+}
+
+uint8_t catpc_reader::get_u8()
+{
+	uint8_t value;
+
+	take(&value, sizeof(value));
+	return value;
+}
+
+uint16_t catpc_reader::get_u16()
+{
+	uint8_t b[2];
+
+	take(b, sizeof(b));
+	return (b[0] << 8) | b[1];
+}
+
+uint32_t catpc_reader::get_u32()
+{
+	uint32_t hi = get_u16();
+
+	return (hi << 16) | get_u16();
+}
+
+uint64_t catpc_reader::get_u64()
+{
+	uint64_t hi = get_u32();
+
+	return (hi << 32) | get_u32();
+}
+
+double catpc_reader::get_double()
+{
+	uint64_t bits = get_u64();
+	double value;
+
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+std::string catpc_reader::get_string(size_t max_len)
+{
+	uint32_t len = get_u32();
+
+	if (failed || len > max_len || (size_t)(end - cur) < len) {
+		failed = true;
+		return std::string();
+	}
+	cur += len;
+	return std::string(cur - len, len);
+}
+
+uint32_t catpc_reader::get_count(size_t entry_size)
+{
+	uint32_t count = get_u32();
+
+	if (failed || (size_t)(end - cur) / entry_size < count) {
+		failed = true;
+		return 0;
+	}
+	return count;
+}
+
+void catpc_put_request(catpc_buffer& buf, enum catpc_message type)
+{
+	buf.end_frame(buf.begin_frame(type));
+}
+
+void catpc_put_app(catpc_buffer& buf, enum catpc_message type, const std::string& cmdline)
+{
+	size_t frame = buf.begin_frame(type);
+
+	buf.put_string(cmdline);
+	buf.end_frame(frame);
+}
+
+void catpc_put_capabilities(catpc_buffer& buf, const std::vector<llc_ca>& llcs)
+{
+	size_t frame = buf.begin_frame(CATPC_GET_CAPABILITIES);
+
+	buf.put_u32(llcs.size());
+	for (const llc_ca& llc : llcs) {
+		buf.put_u32(llc.id);
+		buf.put_u32(llc.num_ways);
+		buf.put_u32(llc.way_size);
+		buf.put_u32(llc.clos_list.size());
+		for (const CLOS& clos : llc.clos_list) {
+			buf.put_u32(clos.id);
+			buf.put_u64(clos.mask);
+		}
+	}
+	buf.end_frame(frame);
+}
+
+bool catpc_get_capabilities(const catpc_frame& frame, std::vector<llc_ca>& llcs)
+{
+	catpc_reader rd{frame};
+	uint32_t num = rd.get_count(16);
+
+	llcs.clear();
+	for (uint32_t i = 0; i < num && !rd.error(); ++i) {
+		llc_ca llc;
+
+		llc.id = rd.get_u32();
+		llc.num_ways = rd.get_u32();
+		llc.way_size = rd.get_u32();
+		llc.clos_count = rd.get_count(12);
+		for (unsigned j = 0; j < llc.clos_count && !rd.error(); ++j) {
+			CLOS clos;
+
+			clos.id = rd.get_u32();
+			clos.mask = rd.get_u64();
+			llc.clos_list.push_back(clos);
+		}
+		llcs.push_back(std::move(llc));
+	}
+
+	return rd.done();
+}
+
+void catpc_put_values(catpc_buffer& buf, const std::vector<catpc_app_values>& apps)
+{
+	size_t frame = buf.begin_frame(CATPC_GET_MONITORING_VALUES);
+
+	buf.put_u32(apps.size());
+	for (const catpc_app_values& app : apps) {
+		buf.put_string(app.cmdline);
+		buf.put_u64(app.values.llc);
+		buf.put_double(app.values.ipc);
+		buf.put_u64(app.values.llc_misses);
+		buf.put_u64(app.values.llc_references);
+		buf.put_u32(app.CLOS_id);
+		buf.put_u32(app.llc_id);
+	}
+	buf.end_frame(frame);
+}
+
+bool catpc_get_values(const catpc_frame& frame, std::vector<catpc_app_values>& apps)
+{
+	catpc_reader rd{frame};
+	uint32_t num = rd.get_count(44);
+
+	apps.resize(num);
+	for (catpc_app_values& app : apps) {
+		app.cmdline = rd.get_string();
+		app.values.llc = rd.get_u64();
+		app.values.ipc = rd.get_double();
+		app.values.llc_misses = rd.get_u64();
+		app.values.llc_references = rd.get_u64();
+		app.CLOS_id = rd.get_u32();
+		app.llc_id = (int32_t)rd.get_u32();
+	}
+
+	return rd.done();
+}
+
+void catpc_put_allocation(catpc_buffer& buf, const std::vector<catpc_app_allocation>& apps,
+			  const std::vector<CLOS>& masks)
+{
+	size_t frame = buf.begin_frame(CATPC_PERFORM_ALLOCATION);
+
+	buf.put_u32(apps.size());
+	for (const catpc_app_allocation& app : apps) {
+		buf.put_string(app.cmdline);
+		buf.put_u32(app.CLOS_id);
+		buf.put_u64(app.required_llc);
+	}
+	buf.put_u32(masks.size());
+	for (const CLOS& clos : masks) {
+		buf.put_u32(clos.llc_id);
+		buf.put_u32(clos.id);
+		buf.put_u64(clos.mask);
+	}
+	buf.end_frame(frame);
+}
+
+bool catpc_get_allocation(const catpc_frame& frame, std::vector<catpc_app_allocation>& apps,
+			  std::vector<CLOS>& masks)
+{
+	catpc_reader rd{frame};
+	uint32_t num = rd.get_count(16);
+
+	apps.resize(num);
+	for (catpc_app_allocation& app : apps) {
+		app.cmdline = rd.get_string();
+		app.CLOS_id = rd.get_u32();
+		app.required_llc = rd.get_u64();
+	}
+	masks.resize(rd.get_count(16));
+	for (CLOS& clos : masks) {
+		clos.llc_id = (int32_t)rd.get_u32();
+		clos.id = rd.get_u32();
+		clos.mask = rd.get_u64();
+	}
+
+	return rd.done();
+}
+
+bool catpc_get_app(const catpc_frame& frame, std::string& cmdline)
+{
+	catpc_reader rd{frame};
+
+	cmdline = rd.get_string();
+	return rd.done();
+}
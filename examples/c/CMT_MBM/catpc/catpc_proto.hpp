@@ -0,0 +1,251 @@
+#ifndef __CATPC_PROTO_HPP__
+#define __CATPC_PROTO_HPP__
+
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+#include <string>
+#include <vector>
+
+#include "catpc_allocator.hpp"
+#include "catpc_monitor.hpp"
+
+/*
+ * Every message is a frame: fixed size header followed by the payload.
+ *
+ *   uint16 magic | uint8 version | uint8 type | uint32 payload length
+ *
+ * All integers are big-endian, doubles are sent as their IEEE 754 bits,
+ * strings as uint32 length followed by the chars. A reply uses the type
+ * of its request.
+ */
+#define CATPC_PROTO_MAGIC 0x4350	/**< "CP" */
+#define CATPC_PROTO_VERSION 3	/**< 3: L3 domain of applications and masks */
+#define CATPC_FRAME_HEADER_SIZE 8
+#define CATPC_MAX_PAYLOAD (16u << 20)	/**< largest accepted payload */
+#define CATPC_MAX_CMDLINE_LEN 4096	/**< longest accepted command line */
+
+/**
+ * @brief CATPC message values
+ *
+ */
+enum catpc_message {
+	CATPC_GET_MONITORING_VALUES = 0, /**< retrieve monitoring values */
+	CATPC_GET_CAPABILITIES = 1,   /**< retrieve system capabilities */
+	CATPC_PERFORM_ALLOCATION = 2,    /**< perform allocation */
+	CATPC_ADD_APP_TO_MONITOR = 3,		/**< add application to monitor */
+	CATPC_REMOVE_APP_TO_MONITOR = 4		/**< remove application to monitor */
+};
+
+/**
+ * @brief Monitoring values of an application, CATPC_GET_MONITORING_VALUES reply
+ */
+struct catpc_app_values {
+	std::string cmdline;
+	catpc_monitoring_values values;
+	unsigned int CLOS_id;
+	int llc_id;		/**< L3 domain the application runs on, -1 unknown */
+};
+
+/**
+ * @brief Allocation of an application, CATPC_PERFORM_ALLOCATION request
+ *
+ * The request also carries CLOS masks to program before applications
+ * are associated, empty when masks stay as they are. A mask applies to
+ * one cache or, with llc_id -1, to all of them.
+ */
+struct catpc_app_allocation {
+	std::string cmdline;
+	unsigned int CLOS_id;
+	uint64_t required_llc;
+};
+
+/**
+ * @brief Received frame, points into the receive buffer
+ */
+struct catpc_frame {
+	enum catpc_message type;
+	const char* payload;
+	uint32_t len;
+};
+
+/**
+ * @brief Byte buffer of a connection
+ *
+ * Data is appended at the end and consumed from the front.
+ */
+class catpc_buffer {
+public:
+	/**
+	 * @brief Appends raw bytes
+	 *
+	 * @param [in] data bytes to append
+	 * @param [in] len number of bytes
+	 */
+	void put(const void* data, size_t len);
+
+	/**
+	 * @brief Appends big-endian integers
+	 */
+	void put_u8(uint8_t value) { put(&value, 1); }
+	void put_u16(uint16_t value);
+	void put_u32(uint32_t value);
+	void put_u64(uint64_t value);
+
+	/**
+	 * @brief Appends double as its IEEE 754 bits
+	 */
+	void put_double(double value);
+
+	/**
+	 * @brief Appends string as its length (uint32) followed by the chars
+	 *
+	 * @param [in] str string to append
+	 */
+	void put_string(const std::string& str);
+
+	/**
+	 * @brief Starts a frame, payload is appended by put_*()
+	 *
+	 * @param [in] type message type
+	 *
+	 * @return frame offset to pass to end_frame()
+	 */
+	size_t begin_frame(enum catpc_message type);
+
+	/**
+	 * @brief Completes frame started by begin_frame()
+	 *
+	 * @param [in] offset frame offset
+	 */
+	void end_frame(size_t offset);
+
+	/**
+	 * @brief Checks if a complete frame is at the front of the buffer
+	 *
+	 * @param [out] frame received frame, valid until the buffer is modified
+	 *
+	 * @retval 1 frame is complete, drop it with consume_frame()
+	 * @retval 0 frame incomplete, more data is needed
+	 * @retval -1 invalid header, wrong version or oversized frame
+	 */
+	int peek_frame(catpc_frame& frame) const;
+
+	/**
+	 * @brief Drops frame returned by peek_frame()
+	 *
+	 * @param [in] frame frame to drop
+	 */
+	void consume_frame(const catpc_frame& frame) { consume(CATPC_FRAME_HEADER_SIZE + frame.len); }
+
+	/**
+	 * @brief Drops \a len bytes from the front of the buffer
+	 *
+	 * @param [in] len number of bytes
+	 */
+	void consume(size_t len);
+
+	const char* data() const { return buf.data() + head; }
+	size_t size() const { return buf.size() - head; }
+	bool empty() const { return size() == 0; }
+
+	/**
+	 * @brief Reads data available on a socket
+	 *
+	 * Blocking socket waits until some data arrives, then anything
+	 * else already received is read without waiting.
+	 *
+	 * @param [in] fd socket
+	 *
+	 * @retval 1 OK, all available data has been read
+	 * @retval 0 peer closed the connection
+	 * @retval -1 error
+	 */
+	int read_from(int fd);
+
+	/**
+	 * @brief Writes as much buffered data as the socket accepts
+	 *
+	 * Blocking socket returns once all data has been written, so all
+	 * frames queued for a round leave in one send() call.
+	 *
+	 * @param [in] fd socket
+	 *
+	 * @retval 0 OK, check empty() to know if all data was written
+	 * @retval -1 error
+	 */
+	int write_to(int fd);
+
+private:
+	std::vector<char> buf;
+	size_t head = 0;
+};
+
+/**
+ * @brief Parser of a received frame payload
+ *
+ * Reading past the end of the payload marks the payload as malformed.
+ */
+class catpc_reader {
+public:
+	explicit catpc_reader(const catpc_frame& frame)
+		: cur{frame.payload}, end{frame.payload + frame.len} {}
+
+	uint8_t get_u8();
+	uint16_t get_u16();
+	uint32_t get_u32();
+	uint64_t get_u64();
+	double get_double();
+
+	/**
+	 * @brief Reads string written by catpc_buffer::put_string()
+	 *
+	 * @param [in] max_len maximal accepted length, longer string is an error
+	 */
+	std::string get_string(size_t max_len = CATPC_MAX_CMDLINE_LEN);
+
+	/**
+	 * @brief Reads number of entries, each at least \a entry_size long
+	 *
+	 * Count that cannot fit in the remaining payload is an error.
+	 */
+	uint32_t get_count(size_t entry_size);
+
+	/** true when payload was malformed */
+	bool error() const { return failed; }
+
+	/** true when whole payload was read without error */
+	bool done() const { return !failed && cur == end; }
+
+private:
+	bool take(void* data, size_t len);
+
+	const char* cur;
+	const char* end;
+	bool failed = false;
+};
+
+/**
+ * @brief Message encoders
+ *
+ * Each appends a complete frame to \a buf.
+ */
+void catpc_put_request(catpc_buffer& buf, enum catpc_message type);
+void catpc_put_app(catpc_buffer& buf, enum catpc_message type, const std::string& cmdline);
+void catpc_put_capabilities(catpc_buffer& buf, const std::vector<llc_ca>& llcs);
+void catpc_put_values(catpc_buffer& buf, const std::vector<catpc_app_values>& apps);
+void catpc_put_allocation(catpc_buffer& buf, const std::vector<catpc_app_allocation>& apps,
+			  const std::vector<CLOS>& masks);
+
+/**
+ * @brief Message decoders
+ *
+ * @return false if payload is malformed
+ */
+bool catpc_get_app(const catpc_frame& frame, std::string& cmdline);
+bool catpc_get_capabilities(const catpc_frame& frame, std::vector<llc_ca>& llcs);
+bool catpc_get_values(const catpc_frame& frame, std::vector<catpc_app_values>& apps);
+bool catpc_get_allocation(const catpc_frame& frame, std::vector<catpc_app_allocation>& apps,
+			  std::vector<CLOS>& masks);
+
+#endif
@@ -0,0 +1,429 @@
+#include "catpc_sim.hpp"
+#include "catpc_partitioner.hpp"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+/*
+ * =======================================
+ * Scenario
+ * =======================================
+ */
+
+static bool parse_reuse(const std::string& value, std::vector<catpc_sim_reuse>& reuse)
+{
+	std::stringstream ss{value};
+	std::string item;
+
+	reuse.clear();
+	while (std::getline(ss, item, ',')) {
+		char* end = NULL;
+		catpc_sim_reuse r;
+
+		r.distance = strtoull(item.c_str(), &end, 0);
+		if (*end != ':' || r.distance == 0)
+			return false;
+		r.weight = strtod(end + 1, &end);
+		if (*end != '\0' || r.weight < 0)
+			return false;
+		reuse.push_back(r);
+	}
+	std::sort(reuse.begin(), reuse.end(), [](const auto& a, const auto& b) { return a.distance < b.distance; });
+
+	return !reuse.empty();
+}
+
+static bool parse_number(const std::string& value, double& number)
+{
+	char* end = NULL;
+
+	number = strtod(value.c_str(), &end);
+	return !value.empty() && *end == '\0' && number >= 0;
+}
+
+int catpc_load_scenario(const std::string& path, catpc_sim_scenario& scenario, std::string& error)
+{
+	const std::string dir = path.find('/') != std::string::npos ? path.substr(0, path.rfind('/') + 1) : "";
+	std::ifstream ifs{path};
+	std::string line;
+	unsigned line_no = 0;
+
+	if (!ifs) {
+		error = path + ": " + strerror(errno);
+		return -1;
+	}
+
+	scenario = catpc_sim_scenario();
+	while (std::getline(ifs, line)) {
+		std::stringstream ss{line.substr(0, line.find('#'))};
+		std::string directive, token;
+		bool ok = true;
+
+		line_no++;
+		if (!(ss >> directive))
+			continue;
+
+		if (directive == "cache") {
+			catpc_sim_geometry& g = scenario.geometry;
+
+			while (ok && ss >> token) {
+				const size_t eq = token.find('=');
+				const std::string key = token.substr(0, eq);
+				double v = 0;
+
+				ok = eq != std::string::npos && parse_number(token.substr(eq + 1), v) && v >= 1;
+				if (key == "sets")
+					g.num_sets = v;
+				else if (key == "ways")
+					g.num_ways = v;
+				else if (key == "line")
+					g.line_size = v;
+				else if (key == "clos")
+					g.clos_count = v;
+				else if (key == "llcs")
+					g.num_llcs = v;
+				else
+					ok = false;
+			}
+			ok = ok && g.num_ways <= 64;
+		}
+		else if (directive == "rounds") {
+			ok = (ss >> scenario.rounds) && scenario.rounds > 0;
+		}
+		else if (directive == "policy") {
+			while (ss >> token)
+				scenario.policies.push_back(token);
+		}
+		else if (directive == "expect") {
+			std::pair<std::string, double> e;
+
+			ok = (bool)(ss >> e.first >> e.second);
+			scenario.expect.push_back(e);
+		}
+		else if (directive == "app") {
+			catpc_sim_workload w;
+
+			ok = (bool)(ss >> w.cmdline);
+			while (ok && ss >> token) {
+				const size_t eq = token.find('=');
+				const std::string key = token.substr(0, eq);
+				const std::string value = eq != std::string::npos ? token.substr(eq + 1) : "";
+				double v = 0;
+
+				if (key == "reuse")
+					ok = parse_reuse(value, w.reuse);
+				else if (key == "trace")
+					w.trace = value[0] == '/' ? value : dir + value;
+				else if (!parse_number(value, v))
+					ok = false;
+				else if (key == "accesses")
+					w.accesses = v;
+				else if (key == "ipc")
+					w.base_ipc = v;
+				else if (key == "rpi")
+					w.refs_per_instr = v;
+				else if (key == "penalty")
+					w.miss_penalty = v;
+				else if (key == "cold")
+					w.cold = v;
+				else if (key == "llc")
+					w.llc = v;
+				else
+					ok = false;
+			}
+			ok = ok && w.base_ipc > 0 && (!w.reuse.empty() || w.cold > 0 || !w.trace.empty());
+			scenario.workloads.push_back(w);
+		}
+		else {
+			ok = false;
+		}
+
+		if (!ok) {
+			error = path + ":" + std::to_string(line_no) + ": invalid \"" + directive + "\" directive";
+			return -1;
+		}
+	}
+
+	if (scenario.workloads.empty()) {
+		error = path + ": no application";
+		return -1;
+	}
+	for (const catpc_sim_workload& w : scenario.workloads) {
+		if (w.llc >= scenario.geometry.num_llcs) {
+			error = path + ": " + w.cmdline + " runs on missing llc " + std::to_string(w.llc);
+			return -1;
+		}
+	}
+	if (scenario.policies.empty())
+		scenario.policies = {"greedy", "ucp"};
+
+	return 0;
+}
+
+/*
+ * =======================================
+ * Cache
+ * =======================================
+ */
+
+catpc_llc_sim::catpc_llc_sim(const catpc_sim_geometry& geometry)
+	: geom{geometry}, ways((size_t)geometry.num_sets * geometry.num_ways, way{0, 0, no_owner}),
+	  masks(geometry.clos_count, geometry.num_ways < 64 ? (1ull << geometry.num_ways) - 1 : ~0ull)
+{
+}
+
+bool catpc_llc_sim::access(unsigned app, unsigned clos, uint64_t line)
+{
+	way* set = &ways[(line % geom.num_sets) * geom.num_ways];
+	const uint64_t mask = clos < masks.size() ? masks[clos] : masks[0];
+	way* victim = NULL;
+
+	clock++;
+	for (unsigned i = 0; i < geom.num_ways; ++i) {
+		if (set[i].owner != no_owner && set[i].line == line) {
+			set[i].stamp = clock;
+			return true;
+		}
+	}
+
+	// fill goes to the ways of the CLOS only
+	for (unsigned i = 0; i < geom.num_ways; ++i) {
+		if (!(mask & (1ull << i)))
+			continue;
+		if (set[i].owner == no_owner) {
+			victim = &set[i];
+			break;
+		}
+		if (victim == NULL || set[i].stamp < victim->stamp)
+			victim = &set[i];
+	}
+	if (victim == NULL)
+		return false;	// empty mask, nothing is cached
+
+	if (victim->owner != no_owner)
+		owned[victim->owner]--;
+	if (app >= owned.size())
+		owned.resize(app + 1, 0);
+	owned[app]++;
+	*victim = way{line, clock, (uint16_t)app};
+
+	return false;
+}
+
+/*
+ * =======================================
+ * Workloads
+ * =======================================
+ */
+
+catpc_sim_stream::catpc_sim_stream(const catpc_sim_workload& workload, uint64_t seed) : wl{workload}, rng{seed}
+{
+	std::vector<double> weights{wl.cold};
+	uint64_t max_distance = 1;
+
+	for (const catpc_sim_reuse& r : wl.reuse) {
+		weights.push_back(r.weight);
+		max_distance = std::max(max_distance, r.distance);
+	}
+	bucket = std::discrete_distribution<unsigned>(weights.begin(), weights.end());
+	history.resize(max_distance);
+}
+
+int catpc_sim_stream::load(unsigned line_size)
+{
+	if (wl.trace.empty())
+		return 0;
+
+	std::ifstream ifs{wl.trace};
+	std::string line;
+
+	trace.clear();
+	while (std::getline(ifs, line)) {
+		if (line.empty() || line[0] == '#')
+			continue;
+		trace.push_back(strtoull(line.c_str(), NULL, 0) / line_size);
+	}
+
+	return ifs.eof() && !trace.empty() ? 0 : -1;
+}
+
+uint64_t catpc_sim_stream::next()
+{
+	uint64_t line;
+
+	if (!trace.empty())
+		return trace[count++ % trace.size()];
+
+	const unsigned b = bucket(rng);
+
+	if (b == 0) {
+		line = new_line++;
+	}
+	else {
+		const uint64_t low = b > 1 ? wl.reuse[b - 2].distance : 0;
+		const uint64_t distance = std::uniform_int_distribution<uint64_t>{low + 1, wl.reuse[b - 1].distance}(rng);
+
+		// nothing to reuse that far back yet
+		line = distance <= count ? history[(count - distance) % history.size()] : new_line++;
+	}
+	history[count++ % history.size()] = line;
+
+	return line;
+}
+
+/*
+ * =======================================
+ * Backend
+ * =======================================
+ */
+
+catpc_sim_backend::catpc_sim_backend(const catpc_sim_scenario& sc, uint64_t seed)
+	: scenario{sc}, caches(sc.geometry.num_llcs, catpc_llc_sim{sc.geometry})
+{
+	apps.reserve(scenario.workloads.size());
+	for (const catpc_sim_workload& w : scenario.workloads)
+		apps.push_back({&w, catpc_sim_stream{w, seed++}, 0, false, 0, 0});
+}
+
+int catpc_sim_backend::init()
+{
+	for (sim_app& app : apps) {
+		if (app.stream.load(scenario.geometry.line_size) < 0)
+			return -1;
+	}
+
+	return 0;
+}
+
+std::vector<llc_ca> catpc_sim_backend::get_allocation_config()
+{
+	const catpc_sim_geometry& g = scenario.geometry;
+	std::vector<llc_ca> llcs;
+
+	for (unsigned id = 0; id < caches.size(); ++id) {
+		llc_ca ca;
+
+		ca.id = id;
+		ca.way_size = g.num_sets * g.line_size;
+		ca.num_ways = g.num_ways;
+		ca.clos_count = g.clos_count;
+		for (unsigned i = 0; i < g.clos_count; ++i)
+			ca.clos_list.push_back({i, caches[id].mask(i)});
+		llcs.push_back(std::move(ca));
+	}
+
+	return llcs;
+}
+
+catpc_sim_backend::sim_app* catpc_sim_backend::find(const std::string& cmdline)
+{
+	for (sim_app& app : apps) {
+		if (app.workload->cmdline == cmdline)
+			return &app;
+	}
+
+	return NULL;
+}
+
+int catpc_sim_backend::start_monitoring(const std::string& cmdline)
+{
+	sim_app* app = find(cmdline);
+
+	if (app == NULL)
+		return -1;
+	app->active = true;
+
+	return 0;
+}
+
+void catpc_sim_backend::run_round()
+{
+	const unsigned chunk = 64;
+	uint64_t slices = 1;
+
+	for (sim_app& app : apps) {
+		app.references = app.misses = 0;
+		if (app.active)
+			slices = std::max<uint64_t>(slices, (app.workload->accesses + chunk - 1) / chunk);
+	}
+
+	// applications run side by side, each spreads its references over the round
+	for (uint64_t s = 0; s < slices; ++s) {
+		for (unsigned idx = 0; idx < apps.size(); ++idx) {
+			sim_app& app = apps[idx];
+			const uint64_t n = app.workload->accesses * (s + 1) / slices - app.references;
+
+			if (!app.active)
+				continue;
+			for (uint64_t i = 0; i < n; ++i) {
+				// applications never share lines
+				if (!caches[app.workload->llc].access(idx, app.clos, ((uint64_t)idx << 48) | app.stream.next()))
+					app.misses++;
+			}
+			app.references += n;
+		}
+	}
+}
+
+int catpc_sim_backend::poll_monitoring_data(std::unordered_map<std::string, catpc_application*>& applications)
+{
+	run_round();
+
+	for (const auto& entry : applications) {
+		sim_app* app = find(entry.first);
+
+		if (app == NULL || !app->active)
+			continue;
+
+		const catpc_sim_workload& w = *app->workload;
+		const double miss_rate = app->references ? (double)app->misses / app->references : 0.0;
+		catpc_monitoring_values& v = entry.second->values;
+
+		v.llc = caches[w.llc].occupancy(app - apps.data()) * scenario.geometry.line_size;
+		v.llc_references = app->references;
+		v.llc_misses = app->misses;
+		v.ipc = 1.0 / (1.0 / w.base_ipc + w.refs_per_instr * miss_rate * w.miss_penalty);
+		entry.second->llc_id = w.llc;
+	}
+
+	return 0;
+}
+
+int catpc_sim_backend::set_clos_masks(std::vector<llc_ca>& llcs, const std::vector<CLOS>& masks)
+{
+	for (const CLOS& clos : masks) {
+		if (clos.id >= scenario.geometry.clos_count || clos.llc_id >= (int)caches.size())
+			return -1;
+		for (unsigned id = 0; id < caches.size(); ++id)
+			if (clos.llc_id < 0 || clos.llc_id == (int)id)
+				caches[id].set_mask(clos.id, clos.mask);
+	}
+	catpc_update_masks(llcs, masks);
+
+	return 0;
+}
+
+int catpc_sim_backend::perform_allocation(catpc_application* application_ptr)
+{
+	sim_app* app = find(application_ptr->cmdline);
+
+	if (app == NULL || application_ptr->CLOS_id >= scenario.geometry.clos_count)
+		return -1;
+	app->clos = application_ptr->CLOS_id;
+
+	return 0;
+}
+
+void catpc_sim_backend::stop_monitoring(std::unordered_map<std::string, catpc_application*>& applications)
+{
+	for (const auto& entry : applications) {
+		sim_app* app = find(entry.first);
+
+		if (app != NULL)
+			app->active = false;
+	}
+}
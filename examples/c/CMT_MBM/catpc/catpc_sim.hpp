@@ -0,0 +1,217 @@
+#ifndef __CATPC_SIM_HPP__
+#define __CATPC_SIM_HPP__
+
+#include <stdint.h>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "catpc_backend.hpp"
+
+/**
+ * @brief Geometry of the simulated LLC
+ *
+ * Real caches are scaled down, working sets of the workloads are scaled
+ * the same way.
+ */
+struct catpc_sim_geometry {
+	unsigned num_sets = 2048;
+	unsigned num_ways = 11;
+	unsigned line_size = 64;
+	unsigned clos_count = 4;
+	unsigned num_llcs = 1;		/**< L3 domains, one cache each */
+};
+
+/**
+ * @brief Reuse bucket of a synthetic workload
+ *
+ * An access of the bucket reuses the line accessed between the previous
+ * bucket distance and \a distance accesses of the application ago.
+ */
+struct catpc_sim_reuse {
+	uint64_t distance;
+	double weight;
+};
+
+/**
+ * @brief Application of a scenario
+ */
+struct catpc_sim_workload {
+	std::string cmdline;
+	unsigned accesses = 100000;	/**< LLC references per round */
+	double base_ipc = 1.5;		/**< IPC when all references hit */
+	double refs_per_instr = 0.02;	/**< LLC references per instruction */
+	double miss_penalty = 200;	/**< cycles per LLC miss */
+	double cold = 0.0;		/**< share of references to lines never used */
+	std::vector<catpc_sim_reuse> reuse;
+	std::string trace;		/**< address trace replayed instead of reuse buckets */
+	unsigned llc = 0;		/**< L3 domain the application runs on */
+};
+
+/**
+ * @brief Scenario run by the simulator
+ *
+ * Text file, one directive per line, '#' starts a comment:
+ *
+ *   cache sets=2048 ways=11 line=64 clos=4 llcs=1
+ *   rounds 40
+ *   policy greedy ucp
+ *   app CMDLINE llc=N accesses=N ipc=X rpi=X penalty=X cold=X reuse=D:W,D:W...
+ *   app CMDLINE llc=N trace=FILE
+ *   expect POLICY RATIO
+ *
+ * A trace file holds one address per line, paths are relative to the
+ * scenario file. "expect" fails the run when misses under POLICY exceed
+ * RATIO times the misses with a shared cache.
+ */
+struct catpc_sim_scenario {
+	catpc_sim_geometry geometry;
+	std::vector<catpc_sim_workload> workloads;
+	unsigned rounds = 40;				/**< measured rounds per policy */
+	std::vector<std::string> policies;
+	std::vector<std::pair<std::string, double>> expect;
+};
+
+/**
+ * @brief Loads scenario file
+ *
+ * @param [in] path scenario file
+ * @param [out] scenario loaded scenario
+ * @param [out] error reason of a failure
+ *
+ * @retval 0 OK
+ * @retval -1 error
+ */
+int catpc_load_scenario(const std::string& path, catpc_sim_scenario& scenario, std::string& error);
+
+/**
+ * @brief Set-associative, way-partitioned LLC
+ *
+ * A line hits in any way of its set, a miss fills one of the ways of the
+ * CLOS mask, replacing an invalid or else the least recently used line,
+ * as Intel CAT does.
+ */
+class catpc_llc_sim {
+public:
+	explicit catpc_llc_sim(const catpc_sim_geometry& geometry);
+
+	/**
+	 * @brief Accesses a line
+	 *
+	 * @param [in] app application index, owner of the line on fill
+	 * @param [in] clos CLOS of the application
+	 * @param [in] line line address, unique across applications
+	 *
+	 * @return true on hit
+	 */
+	bool access(unsigned app, unsigned clos, uint64_t line);
+
+	void set_mask(unsigned clos, uint64_t mask) { masks[clos] = mask; }
+	uint64_t mask(unsigned clos) const { return masks[clos]; }
+
+	/** lines held by an application */
+	uint64_t occupancy(unsigned app) const { return app < owned.size() ? owned[app] : 0; }
+
+	const catpc_sim_geometry& geometry() const { return geom; }
+
+private:
+	static const uint16_t no_owner = 0xffff;
+
+	struct way {
+		uint64_t line;
+		uint64_t stamp;		/**< last access */
+		uint16_t owner;
+	};
+
+	catpc_sim_geometry geom;
+	std::vector<way> ways;		/**< num_sets x num_ways */
+	std::vector<uint64_t> masks;	/**< indexed by CLOS */
+	std::vector<uint64_t> owned;	/**< indexed by application */
+	uint64_t clock = 0;
+};
+
+/**
+ * @brief Line address stream of a workload
+ */
+class catpc_sim_stream {
+public:
+	/**
+	 * @brief Constructor
+	 *
+	 * @param [in] workload workload to generate
+	 * @param [in] seed random seed
+	 */
+	catpc_sim_stream(const catpc_sim_workload& workload, uint64_t seed);
+
+	/**
+	 * @brief Loads address trace of the workload, if any
+	 *
+	 * @param [in] line_size cache line size, trace holds byte addresses
+	 *
+	 * @retval 0 OK
+	 * @retval -1 error
+	 */
+	int load(unsigned line_size);
+
+	/** next line address, private to the workload */
+	uint64_t next();
+
+private:
+	const catpc_sim_workload& wl;
+	std::mt19937_64 rng;
+	std::discrete_distribution<unsigned> bucket;	/**< 0: cold, i: reuse[i - 1] */
+	std::vector<uint64_t> history;			/**< ring of past lines */
+	uint64_t count = 0;				/**< accesses so far */
+	uint64_t new_line = 0;
+	std::vector<uint64_t> trace;
+};
+
+/**
+ * @brief Backend simulating the applications of a scenario
+ *
+ * Every poll runs one round: the active applications issue their
+ * references interleaved, each on the cache of its L3 domain, then
+ * occupancy, misses, references and IPC modelled from the miss rate are
+ * reported.
+ */
+class catpc_sim_backend : public catpc_backend {
+public:
+	/**
+	 * @brief Constructor
+	 *
+	 * @param [in] scenario scenario to run
+	 * @param [in] seed random seed of the workloads
+	 */
+	explicit catpc_sim_backend(const catpc_sim_scenario& scenario, uint64_t seed = 1);
+
+	const char* name() const override { return "sim"; }
+	int init() override;
+	std::vector<llc_ca> get_allocation_config() override;
+	int start_monitoring(const std::string& cmdline) override;
+	int poll_monitoring_data(std::unordered_map<std::string, catpc_application*>& applications) override;
+	int set_clos_masks(std::vector<llc_ca>& llcs, const std::vector<CLOS>& masks) override;
+	int perform_allocation(catpc_application* application_ptr) override;
+	void stop_monitoring(std::unordered_map<std::string, catpc_application*>& applications) override;
+
+private:
+	struct sim_app {
+		const catpc_sim_workload* workload;
+		catpc_sim_stream stream;
+		unsigned clos;
+		bool active;
+		uint64_t references;	/**< of the last round */
+		uint64_t misses;	/**< of the last round */
+	};
+
+	/** runs one round of all active applications */
+	void run_round();
+
+	sim_app* find(const std::string& cmdline);
+
+	catpc_sim_scenario scenario;
+	std::vector<catpc_llc_sim> caches;	/**< indexed by L3 domain */
+	std::vector<sim_app> apps;
+};
+
+#endif
@@ -6,48 +6,174 @@
 #include <errno.h>
 #include <ctype.h>
 #include <stdio.h>
+#include <fcntl.h>
+#include <sys/syscall.h>
 
-int get_pids_by_cmdline(pid_t* pids, const char* cmdline)
+struct linux_dirent64 {
+	ino64_t d_ino;
+	off64_t d_off;
+	unsigned short d_reclen;
+	unsigned char d_type;
+	char d_name[];
+};
+
+/**
+ * @brief Reads command line of a process with argument separators removed
+ *
+ * @return false if process is gone
+ */
+static bool read_cmdline(int proc_fd, const char* pid, std::string& cmdline)
 {
-	char filepath[32];
+	char path[32];
 	char buf[4096];
-	char c = '\0';
-	int i = 0, sz = 0;
-	pid_t pid;
-	FILE* fp = popen("/bin/ps -A -o pid=", "r");	// list of all pids
-	FILE* cmdfile = NULL;
-	
-	if (fp == NULL) {
-		return -1;
+	ssize_t len;
+	int fd;
+
+	snprintf(path, sizeof(path), "%s/cmdline", pid);
+	fd = openat(proc_fd, path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return false;
+
+	cmdline.clear();
+	while ((len = read(fd, buf, sizeof(buf))) > 0) {
+		for (ssize_t i = 0; i < len; ++i)
+			if (buf[i] != '\0')
+				cmdline.push_back(buf[i]);
 	}
+	close(fd);
 
-	while (fscanf(fp, "%d", &pid) != EOF) {
-		sprintf(filepath, "/proc/%d/cmdline", pid);
-		cmdfile = fopen(filepath, "r");
-		
-		if (cmdfile == NULL)
-			continue;
+	return len == 0;
+}
+
+void catpc_proc_index::remove(pid_t pid, const proc& p)
+{
+	auto it = by_cmdline.find(p.cmdline);
+
+	if (it == by_cmdline.end())
+		return;
+	it->second.erase(pid);
+	if (it->second.empty())
+		by_cmdline.erase(it);
+}
+
+int catpc_proc_index::refresh()
+{
+	int proc_fd = open("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	long len;
+
+	if (proc_fd < 0)
+		return -1;
 
-		// read command of the process
-		i = 0;
-		while ( fscanf(cmdfile, "%c", &c) != EOF) {
-			if (c == '\0') {
+	gen++;
+	num_read = 0;
+	dirents.resize(1 << 16);
+
+	while ((len = syscall(SYS_getdents64, proc_fd, dirents.data(), dirents.size())) > 0) {
+		for (long off = 0; off < len;) {
+			const struct linux_dirent64* d = (const struct linux_dirent64*)(dirents.data() + off);
+			char* end;
+			pid_t pid;
+
+			off += d->d_reclen;
+			if (d->d_type != DT_DIR || !isdigit(d->d_name[0]))
+				continue;
+			pid = strtol(d->d_name, &end, 10);
+			if (*end != '\0')
 				continue;
-				//c = ' ';	
+
+			auto it = procs.find(pid);
+			if (it != procs.end()) {
+				if (it->second.ino == d->d_ino) {
+					it->second.gen = gen;
+					// second look at processes new in the previous
+					// pass, launchers usually exec right after fork
+					if (it->second.first == gen - 1 &&
+					    !reread(pid, it->second)) {
+						remove(pid, it->second);
+						procs.erase(it);
+					}
+					continue;
+				}
+				// pid reused, or inode evicted and recreated - read again
+				remove(pid, it->second);
+				procs.erase(it);
 			}
-			buf[i++] = c;
+
+			proc p{d->d_ino, gen, gen, std::string()};
+			if (!read_cmdline(proc_fd, d->d_name, p.cmdline))
+				continue;
+			num_read++;
+			// kernel threads have empty command line
+			if (!p.cmdline.empty())
+				by_cmdline[p.cmdline].insert(pid);
+			procs.emplace(pid, std::move(p));
+		}
+	}
+	close(proc_fd);
+	if (len < 0)
+		return -1;
+
+	for (auto it = procs.begin(); it != procs.end();) {
+		if (it->second.gen == gen) {
+			++it;
+			continue;
 		}
-		buf[i] = '\0';
+		remove(it->first, it->second);
+		it = procs.erase(it);
+	}
+
+	return 0;
+}
+
+bool catpc_proc_index::reread(pid_t pid, proc& p)
+{
+	char dir[24];
+	std::string cmdline;
+
+	snprintf(dir, sizeof(dir), "/proc/%d", (int)pid);
+	if (!read_cmdline(AT_FDCWD, dir, cmdline))
+		return false;
+	num_read++;
+	if (cmdline == p.cmdline)
+		return true;
+	// process called exec
+	remove(pid, p);
+	p.cmdline = std::move(cmdline);
+	if (!p.cmdline.empty())
+		by_cmdline[p.cmdline].insert(pid);
+	return true;
+}
+
+std::vector<pid_t> catpc_proc_index::find(const std::string& cmdline)
+{
+	std::vector<pid_t> pids;
+	auto it = by_cmdline.find(cmdline);
 
-		if (strcmp(buf, cmdline) == 0) {
-			pids[sz++] = pid;
+	// verify hits, the process may have called exec since it was indexed
+	if (it != by_cmdline.end()) {
+		std::vector<pid_t> hits(it->second.begin(), it->second.end());
+
+		for (pid_t pid : hits) {
+			auto p = procs.find(pid);
+
+			if (!reread(pid, p->second)) {
+				remove(pid, p->second);
+				procs.erase(p);
+			} else if (p->second.cmdline == cmdline)
+				pids.push_back(pid);
 		}
-		fclose(cmdfile);
 	}
 
-	pclose(fp);
+	return pids;
+}
+
+std::vector<pid_t> get_pids_by_cmdline(const std::string& cmdline)
+{
+	static catpc_proc_index index;
 
-	return sz;
+	if (index.refresh() < 0)
+		return {};
+	return index.find(cmdline);
 }
 
 void log_fprint(FILE* fp, const char* fmt, ...)
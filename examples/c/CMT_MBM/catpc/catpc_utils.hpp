@@ -12,6 +12,10 @@
 #include <string.h>
 #include <stdlib.h>
 #include <queue>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #include <mutex>
 #include <cassert>
 #include <ostream>
@@ -19,50 +23,69 @@
 #include "catpc_monitor.hpp"
 
 /**
- * @brief CATPC message values
- * 
+ * @brief Index of running processes by command line
+ *
+ * Built from a single pass over /proc. Refresh only reads command lines
+ * of processes that appeared since the previous pass, and once more on the
+ * following pass to catch a launcher that called exec right after fork.
+ * Vanished processes are dropped. Not thread-safe.
  */
-enum catpc_message {
-	CATPC_GET_MONITORING_VALUES = 0, /**< retrieve monitoring values */
-	CATPC_GET_CAPABILITIES = 1,   /**< retrieve system capabilities */
-	CATPC_PERFORM_ALLOCATION = 2,    /**< perform allocation */
-	CATPC_ADD_APP_TO_MONITOR = 3,		/**< add application to monitor */
-	CATPC_REMOVE_APP_TO_MONITOR = 4		/**< remove application to monitor */
-};
+class catpc_proc_index {
+public:
+	/**
+	 * @brief Rescans /proc
+	 *
+	 * @retval 0 OK
+	 * @retval -1 /proc cannot be read
+	 */
+	int refresh();
 
-struct connection_t {
-	int sock;
-	struct sockaddr_in address;
-	socklen_t addr_len;
-};
+	/**
+	 * @brief Returns processes running with a command line
+	 *
+	 * Only command lines of matching processes are read again, to drop
+	 * processes that called exec after they were indexed. A miss costs
+	 * no reads.
+	 *
+	 * @param [in] cmdline command line with argument separators removed
+	 *
+	 * @return process ids, empty if none
+	 */
+	std::vector<pid_t> find(const std::string& cmdline);
 
-struct notification_t {
-	std::mutex mtx;
-	enum event {
-		APP_ADDED = 0,
-		APP_REMOVED = 1,
-		PERFORM_ALLOCATION = 2
+	/** number of indexed processes */
+	size_t size() const { return procs.size(); }
+
+	/** command lines read by the last refresh() and find() calls */
+	size_t last_read() const { return num_read; }
+
+private:
+	struct proc {
+		uint64_t ino;		/**< /proc/<pid> inode, changes when pid is reused */
+		uint64_t first;		/**< refresh that indexed the process */
+		uint64_t gen;		/**< last refresh that saw the process */
+		std::string cmdline;
 	};
-	std::queue<std::pair<event, std::string>> event_queue;
 
-	notification_t(): event_queue() {
-		assert(event_queue.empty());
-	}
+	void remove(pid_t pid, const proc& p);
+	bool reread(pid_t pid, proc& p);
 
-	notification_t(const notification_t&& other)
-	{
-		this->event_queue = other.event_queue;
-	}
+	std::unordered_map<pid_t, proc> procs;
+	std::unordered_map<std::string, std::unordered_set<pid_t>> by_cmdline;
+	std::vector<char> dirents;
+	uint64_t gen = 0;
+	size_t num_read = 0;
 };
 
 /**
  * @brief Retrieve process ids created from a command line
- * 
+ *
+ * Uses process wide catpc_proc_index refreshed on every call.
+ *
  * @param [in] cmdline full command line with spaces removed
- * @param [out] pids array of pids
- * @return number of pids
+ * @return process ids
  */
-int get_pids_by_cmdline(pid_t* pids, const char* cmdline);
+std::vector<pid_t> get_pids_by_cmdline(const std::string& cmdline);
 
 /**
  * @brief logging function
@@ -10,43 +10,47 @@
 #include <vector>
 #include <memory>
 #include <string>
-#include <mutex>
 #include <unordered_map>
 #include <cassert>
 #include <chrono>
-#include <condition_variable>
 #include <atomic>
 #include <fstream>
 #include <iostream>
+#include <algorithm>
+#include <getopt.h>
 
 #include "catpc_utils.hpp"
 #include "catpc_monitor.hpp"
 #include "catpc_allocator.hpp"
+#include "catpc_master.hpp"
+#include "catpc_mrc.hpp"
+#include "catpc_mrc_store.hpp"
+#include "catpc_partitioner.hpp"
+#include "catpc_profiler.hpp"
 
-#define MAX_CLIENTS 16			// Maximum number of slaves managed by CATPC master
 #define SERVER_PORT 10000
 
-void connection_handler(connection_t*);
-void processing_loop();
+void process_round(catpc_master& master, const catpc_round& round);
+void partition_slave(catpc_slave& slave);
+bool mrc_from_store(const catpc_application* app_ptr, const catpc_platform& platform, double miss_rate);
+void export_mrc(const std::string& cmdline);
+bool phase_changed(catpc_application* app_ptr);
 void termination_handler(int signum);
 void watch_started_app();
 void watch_terminated_app();
 
 const std::chrono::milliseconds period{500};
 
-int sock;
 FILE* log_file = NULL;
-std::atomic<unsigned int> client_count = 0;
-std::vector<connection_t*> connections;
 sig_atomic_t terminate = 0;
-std::mutex global_mtx;
-std::condition_variable global_cv;
-std::chrono::time_point<std::chrono::steady_clock> start_time;
+catpc_master* master = NULL;
+std::unique_ptr<catpc_partitioner> partitioner;
+catpc_mrc_store* store = NULL;
 
-std::unordered_map<int, std::unordered_map<std::string, catpc_application*>> sock_to_application;
-std::unordered_map<int, notification_t> sock_to_notification;
-std::unordered_map<int, std::vector<llc_ca>> sock_to_llcs;
-std::unordered_map<int, std::unordered_map<std::string, std::map<uint64_t, double>>> sock_to_mrc;
+std::unordered_map<std::string, catpc_mrc> mrc;
+const catpc_mrc_sampling sampling{};
+std::unordered_map<uint64_t, catpc_profiler> profilers;	/**< by slave connection id */
+const catpc_phase_params phase_params{};
 
 /*
 * =======================================
@@ -55,6 +59,30 @@ std::unordered_map<int, std::unordered_map<std::string, std::map<uint64_t, doubl
 */
 int main(int argc, char** argv)
 {
+	const char* policy = "greedy";
+	const char* store_dir = "/var/lib/catpc";
+	int opt;
+
+	while ((opt = getopt(argc, argv, "p:s:h")) != -1) {
+		switch (opt) {
+		case 'p':
+			policy = optarg;
+			break;
+		case 's':
+			store_dir = optarg;
+			break;
+		default:
+			printf("Usage : %s [-p greedy|ucp] [-s MRC_STORE_DIR]\n", argv[0]);
+			exit(opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+	}
+
+	partitioner = catpc_make_partitioner(policy);
+	if (partitioner == NULL) {
+		fprintf(stderr, "unknown partitioning policy: %s\n", policy);
+		exit(EXIT_FAILURE);
+	}
+
 	pid_t pid = fork();
 
 	if (pid < 0) {
@@ -84,92 +112,43 @@ int main(int argc, char** argv)
 	close(STDIN_FILENO);
 	close(STDOUT_FILENO);
 	close(STDERR_FILENO);
-	
-	// handle termination signals
-	signal(SIGINT, termination_handler);
-	signal(SIGTERM, termination_handler);
-
-	std::vector<std::thread> threads;
-	sockaddr_in address;
-	const int reuse = 1;		// reuse socket
 
 	log_file = fopen("/var/log/catpc.master.log", "w");
 	if (log_file == NULL) {
 		exit(EXIT_FAILURE);
 	}
-	
-	address.sin_family = AF_INET;
-	address.sin_addr.s_addr = htonl(INADDR_ANY);
-	address.sin_port = htons(SERVER_PORT);
 
-	sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
-	if (setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(int)) < 0)
-		log_fprint(log_file, "ERROR: setsockopt (SO_REUSEADDR) failed: %s (%d)\n", strerror(errno), errno);
-	
-	// Bind
-	if (bind(sock, (struct sockaddr*)&address, sizeof(address)) < 0) {
-		log_fprint(log_file, "ERROR: bind failed: %s (%d)\n", strerror(errno), errno);
+	// Known curves let applications skip profiling, without the store all are profiled
+	catpc_mrc_store mrc_store{log_file};
+	mrc_store.open(store_dir);
+	store = &mrc_store;
+
+	// All slaves are served by a single event loop on this thread
+	catpc_master server{log_file, period, process_round};
+	if (server.listen(SERVER_PORT, htonl(INADDR_ANY)) < 0) {
 		exit(EXIT_FAILURE);
 	}
+	master = &server;
+
+	// handle termination signals
+	signal(SIGINT, termination_handler);
+	signal(SIGTERM, termination_handler);
 
-	// Listen
-	if (listen(sock, MAX_CLIENTS)) {
-		log_fprint(log_file, "ERROR: listen failed: %s (%d)\n", strerror(errno), errno);
-	}
-	
 	// start fifo monitoring thread
 	std::thread started_app_watcher(watch_started_app);
 	std::thread terminated_app_watcher(watch_terminated_app);
 
-	// start procressing loop thread
-	std::thread processing_thread(processing_loop);
-
-	// Loop to accept incomming connections
-	start_time = std::chrono::steady_clock::now();
-	while (!terminate) {
-		connection_t conn;
-		conn.sock = accept(sock, (struct sockaddr*)&conn.address, &conn.addr_len);
-		if (conn.sock < 0) {
-			log_fprint(log_file, "ERROR: accept failed: %s (%d)\n", strerror(errno), errno);
-			continue;
-		}
-		connections.push_back(new connection_t(conn));
-		client_count++;
-
-		// insert corresponding map elements
-		sock_to_notification.emplace(connections.back()->sock, notification_t());
-		
-		log_fprint(log_file, "INFO: slave connected: %s\n", inet_ntoa(connections.back()->address.sin_addr));
-
-		// Launch connection handler on a thread
-		threads.push_back(std::thread(connection_handler, connections.back()));
-		if (!threads.back().joinable()) {
-			log_fprint(log_file, "ERROR: could not create thread for slave %s\n", inet_ntoa(connections.back()->address.sin_addr));
-		}
+	if (server.run() < 0) {
+		log_fprint(log_file, "ERROR: event loop failed\n");
 	}
 	
 	// Close everything
-
-	for (connection_t* conn : connections) {
-		close(conn->sock);
-		delete conn;
-	}
-
 	if (started_app_watcher.joinable()) {
 		started_app_watcher.join();
 	}
 	if (terminated_app_watcher.joinable()) {
 		terminated_app_watcher.join();
 	}
-	if (processing_thread.joinable()) {
-		processing_thread.join();
-	}
-
-	for (std::thread& thd : threads) {
-		if (thd.joinable()) {
-			thd.join();
-		}
-	}
 
 	log_fprint(log_file, "INFO: Done.\n");
 	fclose(log_file);
@@ -182,225 +161,210 @@ int main(int argc, char** argv)
 * =======================================
 */
 
-void connection_handler(connection_t* conn)
+void partition_slave(catpc_slave& slave)
 {
-	notification_t& notif = sock_to_notification[conn->sock];
-	int bytes_read = 0, bytes_sent = 0;
-	enum catpc_message msg = CATPC_GET_CAPABILITIES;
-	std::string cmdline;
-	catpc_application app;
-	size_t sz, len;
-	char buf[512];
+	std::vector<catpc_partition_app> apps;
+	std::vector<CLOS> masks;
 
-	while (true) {
-		{
-			// Read the notification object to know if there is a new app or if an app has been removed/terminated
-			std::scoped_lock<std::mutex> lk(notif.mtx);
-			if (!notif.event_queue.empty()) {
-				std::pair<notification_t::event, std::string>& p = notif.event_queue.front();
-				cmdline = p.second;
-				switch (p.first) {
-				case notification_t::event::APP_ADDED:
-					msg = CATPC_ADD_APP_TO_MONITOR;
-					break;
-				case notification_t::event::APP_REMOVED:
-					msg = CATPC_REMOVE_APP_TO_MONITOR;
-					break;
-				case notification_t::event::PERFORM_ALLOCATION:
-					msg = CATPC_PERFORM_ALLOCATION;
-					break;
-				}
-				notif.event_queue.pop();
-			}
+	for (const auto& entry : slave.applications) {
+		catpc_application* app_ptr = entry.second;
+		auto it = mrc.find(app_ptr->cmdline);
+
+		// curve of an application pinned to a domain was profiled in that cache alone
+		if (it == mrc.end()) {
+			app_ptr->required_llc = 0;
 		}
+		else if (app_ptr->llc_id >= 0) {
+			app_ptr->required_llc = it->second.required_llc((uint64_t)slave.llcs[0].num_ways * slave.llcs[0].way_size);
+		}
+		else {
+			app_ptr->required_llc = get_required_llc(it->second, slave.llcs);
+		}
+		app_ptr->smart_alloc_done = true;
+		// placement changes what all applications of the slave see
+		app_ptr->phase.reset();
+		log_fprint(log_file, "INFO: required llc of %s is %.1fKB\n", entry.first.c_str(), app_ptr->required_llc / 1024.0);
 
-		// Message management
-		switch (msg) {
-		case CATPC_REMOVE_APP_TO_MONITOR:
-			delete sock_to_application[conn->sock][cmdline];
-			sock_to_application[conn->sock].erase(cmdline);
-			sock_to_mrc[conn->sock].erase(cmdline);
-			[[gnu::fallthrough]];
-
-		case CATPC_ADD_APP_TO_MONITOR:
-			if ((bytes_sent = send(conn->sock, &msg, sizeof(msg), 0)) > 0) {
-				len = cmdline.size();
-				send(conn->sock, &len, sizeof(size_t), 0);
-				send(conn->sock, cmdline.c_str(), len * sizeof(char), 0);
-			}
-			break;
-		
-		case CATPC_GET_MONITORING_VALUES:
-			if ((bytes_sent = send(conn->sock, &msg, sizeof(msg), 0)) > 0) {
-				// Read the number of applications
-				bytes_read = recv(conn->sock, &sz, sizeof(size_t), 0);
-
-				for (size_t i = 0; i < sz && bytes_read > 0; ++i) {
-
-					// Read the cmdline (size then chars)
-					bytes_read = recv(conn->sock, &len, sizeof(size_t), 0);
-					bytes_read = recv(conn->sock, buf, len * sizeof(char), 0);
-					cmdline.assign(buf, len);
-					
-					// insert if not exist aka 'get or create'
-					sock_to_application[conn->sock].try_emplace(cmdline, new catpc_application(cmdline));
-					catpc_application* ptr = sock_to_application[conn->sock][cmdline];
-
-					// Read monitoring data
-					bytes_read = recv(conn->sock, &ptr->values, sizeof(catpc_monitoring_values), 0);
-
-					// Read CLOS id
-					bytes_read = recv(conn->sock, &ptr->CLOS_id, sizeof(unsigned int), 0);
-
-					//log_fprint(log_file, "[DEBUG] : MRC[%s][%fKB] = %f\n", 
-					//	ptr->cmdline.c_str(), ptr->values.llc / 1024.0, 
-					//	(double)ptr->values.llc_misses / ptr->values.llc_references);
-				}
-				// Notify the loop processing thread
-				{
-					std::scoped_lock<std::mutex> lk(global_mtx);
-					global_cv.notify_one();
+		apps.push_back({app_ptr->cmdline, it != mrc.end() ? &it->second : NULL, app_ptr->required_llc,
+				(double)app_ptr->values.llc_references, app_ptr->CLOS_id, app_ptr->llc_id});
+	}
+	if (apps.empty()) {
+		return;
+	}
+
+	// same input order gives same placement whatever the hash order
+	std::sort(apps.begin(), apps.end(), [](const auto& a, const auto& b) { return a.cmdline < b.cmdline; });
+
+	if (catpc_partition_domains(*partitioner, slave.llcs, apps, masks) < 0) {
+		log_fprint(log_file, "ERROR: %s partitioning failed\n", partitioner->name());
+		return;
+	}
+
+	for (const catpc_partition_app& app : apps) {
+		slave.applications[app.cmdline]->CLOS_id = app.CLOS_id;
+		log_fprint(log_file, "INFO: %s: %s placed in COS%u\n", partitioner->name(), app.cmdline.c_str(), app.CLOS_id);
+	}
+	catpc_update_masks(slave.llcs, masks);
+	slave.masks.insert(slave.masks.end(), masks.begin(), masks.end());
+}
+
+void process_round(catpc_master& master, const catpc_round& round)
+{
+	bool allocation_changed = false;
+	bool mrc_completed = false;
+
+	log_fprint(log_file, "DEBUG: round %llu: %u/%u slaves in %.3f ms\n", (unsigned long long)round.id,
+		round.received, round.expected, std::chrono::duration<double, std::milli>(round.latency).count());
+
+	for (auto it = profilers.begin(); it != profilers.end();) {
+		const bool connected = std::any_of(master.slaves().begin(), master.slaves().end(),
+						   [&it](const auto& s) { return s.second->id == it->first; });
+
+		it = connected ? std::next(it) : profilers.erase(it);
+	}
+
+	for (const auto& s : master.slaves()) {
+		catpc_slave& slave = *s.second;
+
+		if (slave.llcs.empty()) {
+			continue;
+		}
+
+		catpc_profiler& profiler = profilers.try_emplace(slave.id, sampling).first->second;
+		// values of a slave that did not reply to this round are stale
+		const bool replied = slave.round == round.id && slave.st == catpc_slave::IDLE;
+
+		for (const auto& entry : slave.applications) {
+			catpc_application* app_ptr = entry.second;
+			// First sample decides if the application needs profiling at all
+			if (!app_ptr->eval_done) {
+				if (app_ptr->mrc_checked) {
+					continue;
 				}
-			}	
-		break;
 
-		case CATPC_GET_CAPABILITIES:
-		if ((bytes_sent = send(conn->sock, &msg, sizeof(msg), 0)) > 0) {
-			sock_to_llcs[conn->sock].clear();								// Clear the llc_ca list
-			bytes_read = recv(conn->sock, &sz, sizeof(size_t), 0);	// read the number of llc/sockets
-			for (size_t i = 0; i < sz; ++i) {
-				sock_to_llcs[conn->sock].push_back(llc_ca());
-				llc_ca& llc = sock_to_llcs[conn->sock].back();			// reference to the new element for better readability
-				
-				bytes_read = recv(conn->sock, &llc.id, sizeof(int), 0);
-				bytes_read = recv(conn->sock, &llc.num_ways, sizeof(unsigned), 0);
-				bytes_read = recv(conn->sock, &llc.way_size, sizeof(unsigned), 0);
-				bytes_read = recv(conn->sock, &llc.clos_count, sizeof(unsigned), 0);
-
-				for (unsigned j = 0; j < llc.clos_count; ++j) {
-					llc.clos_list.push_back(CLOS());
-					bytes_read = recv(conn->sock, &llc.clos_list.back(), sizeof(CLOS), 0);
+				const catpc_platform platform{slave.llcs[0].num_ways, slave.llcs[0].way_size, (uint32_t)slave.llcs.size()};
+				const double miss_rate = (double)app_ptr->values.llc_misses / app_ptr->values.llc_references;
+
+				app_ptr->mrc_checked = true;
+				if (mrc_from_store(app_ptr, platform, miss_rate)) {
+					app_ptr->eval_done = true;
+					export_mrc(app_ptr->cmdline);
+					continue;
 				}
+				mrc.erase(app_ptr->cmdline);
+				profiler.add(app_ptr->cmdline);
+			}
+			else if (!app_ptr->smart_alloc_done) {	// eval done => MRC is completed
+				mrc_completed = true;
+				allocation_changed = true;
+			}
+			else if (replied && phase_changed(app_ptr)) {
+				// Curve no longer describes the application, profile it again
+				app_ptr->eval_done = false;
+				app_ptr->smart_alloc_done = false;
+				mrc.erase(app_ptr->cmdline);
+				profiler.add(app_ptr->cmdline);
 			}
 		}
-		break;
 
-		case CATPC_PERFORM_ALLOCATION:
-			if ((bytes_sent = send(conn->sock, &msg, sizeof(msg), 0)) > 0) {
-				for (const std::pair<std::string, catpc_application*>& element : sock_to_application[conn->sock]) {
-					catpc_application* app_ptr = element.second;
-					len = app_ptr->cmdline.size();
-					send(conn->sock, &len, sizeof(size_t), 0);
-					send(conn->sock, app_ptr->cmdline.c_str(), len * sizeof(char), 0);
-					send(conn->sock, &app_ptr->CLOS_id, sizeof(unsigned int), 0);
-					send(conn->sock, &app_ptr->required_llc, sizeof(uint64_t), 0);
-				}
-			}
-		break;
+		// Applications of different L3 domains are profiled in parallel
+		std::vector<CLOS> masks;
+		std::vector<catpc_application*> completed;
 
-		default:
-			log_fprint(log_file, "unknow message value: %d\n", msg);
+		if (replied && profiler.round(slave.llcs, slave.applications, mrc, masks, completed)) {
+			catpc_update_masks(slave.llcs, masks);
+			slave.masks.insert(slave.masks.end(), masks.begin(), masks.end());
+			allocation_changed = true;
 		}
-		
-		// Error handling
-		if (bytes_read < 0) {
-			log_fprint(log_file, "ERROR: recv from %s: %s (%d)\n", inet_ntoa(conn->address.sin_addr), strerror(errno), errno);
-			break;
+		for (catpc_application* app_ptr : completed) {
+			const catpc_platform platform{slave.llcs[0].num_ways, slave.llcs[0].way_size, (uint32_t)slave.llcs.size()};
+			const catpc_mrc_stats& st = profiler.stats();
+
+			app_ptr->eval_done = true;
+			log_fprint(log_file, "INFO: MRC of %s completed, %u curves: %u steps sampled, %u skipped, "
+				"%u samples, %u saved by early stop\n", app_ptr->cmdline.c_str(), st.curves,
+				st.steps, st.skipped_steps, st.samples, st.saved_samples);
+			store->save(app_ptr->cmdline, platform, mrc.at(app_ptr->cmdline), time(NULL));
+			export_mrc(app_ptr->cmdline);
 		}
+	}
 
-		if (bytes_sent == 0) {
-			log_fprint(log_file, "INFO: recv: slave disconnected %s\n", inet_ntoa(conn->address.sin_addr));
-			break;
+	// Send notification and get required llc if MRC is completed
+	for (const auto& s : master.slaves()) {
+		catpc_slave& slave = *s.second;
+
+		// Partition only once no application on the slave is still sampling its MRC
+		if (mrc_completed && std::all_of(slave.applications.begin(), slave.applications.end(),
+						 [](const auto& entry) { return entry.second->eval_done; })) {
+			partition_slave(slave);
 		}
-		else if (bytes_sent < 0) {	// bytes_sent < 0
-			log_fprint(log_file, "ERROR: send to %s: %s (%d)\n", inet_ntoa(conn->address.sin_addr), strerror(errno), errno);
-			break;
+
+		if (allocation_changed) {
+			// Push perform allocation notification message
+			master.notify(slave, CATPC_EVENT_PERFORM_ALLOCATION, "");
 		}
+	}
+}
+
+bool mrc_from_store(const catpc_application* app_ptr, const catpc_platform& platform, double miss_rate)
+{
+	const catpc_mrc_store::entry* stored = NULL;
+	const time_t now = time(NULL);
 
-		msg = CATPC_GET_MONITORING_VALUES;	// set to the default message value
-		std::this_thread::sleep_for(period - (std::chrono::steady_clock::now() - start_time) % period);
+	switch (store->lookup(app_ptr->cmdline, platform, now, &stored)) {
+	case CATPC_MRC_USE:
+		log_fprint(log_file, "INFO: using stored MRC of %s\n", app_ptr->cmdline.c_str());
+		break;
+	case CATPC_MRC_VALIDATE:
+		if (!store->validate(app_ptr->cmdline, platform, app_ptr->values.llc, miss_rate, now)) {
+			log_fprint(log_file, "INFO: stored MRC of %s does not match, profiling again\n", app_ptr->cmdline.c_str());
+			return false;
+		}
+		log_fprint(log_file, "INFO: stored MRC of %s confirmed\n", app_ptr->cmdline.c_str());
+		break;
+	default:
+		return false;
 	}
 
-	client_count--;
-	close(conn->sock);
+	mrc.insert_or_assign(app_ptr->cmdline, stored->mrc);
+	return true;
 }
 
-void processing_loop()
+void export_mrc(const std::string& cmdline)
 {
-	std::unordered_map<std::string, std::map<uint64_t, double>> mrc;
-	
-	while (!terminate) {
-		// Wait for the signal of each worker thread
-		unsigned i = 0;
-		do {
-			std::unique_lock<std::mutex> lk{global_mtx};
-			global_cv.wait(lk);
-		} while (++i < client_count);
-
-		bool allocation_changed = false;
-		bool mrc_completed = false;
-		for (connection_t* conn : connections) {
-			for (const auto& entry : sock_to_application[conn->sock]) {
-				catpc_application* app_ptr = entry.second;
-				// If the CLOS_id done is less than the last CLOS_id, continue MRC evaluation to the next CLOS
-				if (!app_ptr->eval_done) {
-					mrc[app_ptr->cmdline][app_ptr->values.llc] = (double)app_ptr->values.llc_misses / app_ptr->values.llc_references;
-					log_fprint(log_file, "DEBUG: MRC[%.1fKB] = %.3f\n", app_ptr->values.llc / 1024.0, (double)app_ptr->values.llc_misses / app_ptr->values.llc_references);
-					if (app_ptr->CLOS_id < sock_to_llcs[conn->sock][0].clos_count - 1) {
-						// Go to the next CLOS
-						app_ptr->CLOS_id++;
-						
-						// Avoid out of bound CLOS_id
-						assert(app_ptr->CLOS_id < sock_to_llcs[conn->sock][0].clos_count);
-
-						allocation_changed = true;
-					}
-					else { // (app_ptr->CLOS_id == sock_to_llcs[conn->sock][0].clos_count - 1)
-						app_ptr->eval_done = true;
-					}
-				}
-				else if (!app_ptr->smart_alloc_done) {	// eval done => MRC is completed
-					mrc_completed = true;
-					allocation_changed = true;
-				}
-			}
-		}
+	std::ofstream ofs{"/tmp/" + cmdline.substr(cmdline.rfind('/') + 1) + ".csv", std::ios::trunc};
 
-		// Send notification and get required llc if MRC is completed
-		for (connection_t* conn : connections) {
-			if (mrc_completed) {
-				for (const auto& entry : sock_to_application[conn->sock]) {
-					catpc_application* app_ptr = entry.second;
-					app_ptr->required_llc = get_required_llc(mrc[app_ptr->cmdline], sock_to_llcs[conn->sock]);
-					app_ptr->smart_alloc_done = true;
-					log_fprint(log_file, "INFO: required llc of %s is %.1fKB\n", entry.first.c_str(), app_ptr->required_llc / 1024.0);
-				}
-			}
+	for (const catpc_mrc::point& p : mrc.at(cmdline).points()) {
+		ofs << (p.occupancy / 1024.0) << ", " << p.miss_rate << "\n";
+	}
+}
 
-			if (allocation_changed) {
-				// Push perform allocation notification message
-				notification_t& notif = sock_to_notification[conn->sock];
-				std::lock_guard<std::mutex> lk{notif.mtx};
-				notif.event_queue.push(std::make_pair(notification_t::event::PERFORM_ALLOCATION, ""));
-			}
-		}
+bool phase_changed(catpc_application* app_ptr)
+{
+	const catpc_monitoring_values& v = app_ptr->values;
 
-		// Print on file
-		for (const std::pair<std::string, std::map<uint64_t, double>>& entry : mrc) {
-			std::ofstream ofs{"/tmp/" + entry.first.substr(entry.first.rfind('/') + 1) + ".csv", std::ios::trunc};
-			for (const auto& e : entry.second) {
-				ofs << (e.first / 1024.0) << ", " << e.second << "\n";
-			}
-			ofs.close();
-		}
+	if (v.llc_references == 0) {
+		return false;
+	}
+
+	const double sample[CATPC_PHASE_METRICS] = {v.ipc, (double)v.llc_misses / v.llc_references, (double)v.llc};
+	const unsigned changed = app_ptr->phase.update(sample, phase_params);
+
+	if (changed == 0) {
+		return false;
 	}
+	log_fprint(log_file, "INFO: %s changed phase (%s), profiling again\n", app_ptr->cmdline.c_str(),
+		catpc_phase_metric_name(changed));
+	return true;
 }
 
 void termination_handler(int signum) 
 {
 	if (signum == SIGTERM) {
 		terminate = 1;
-		close(sock);
+		if (master != NULL) {
+			master->stop();
+		}
 	}
 }
 
@@ -416,21 +380,16 @@ void watch_started_app()
 
 	while (!terminate) {
 		fd = open(catpc_fifo, O_RDONLY);
-		bytes_read = read(fd, buf, sizeof(buf));
+		bytes_read = read(fd, buf, sizeof(buf) - 1);
 		if ( bytes_read > 0) {
+			buf[bytes_read] = '\0';
 			log_fprint(log_file, "INFO: app launched: \"%s\"\n", buf);
-			for (std::pair<const int, notification_t>& it : sock_to_notification) {
-				{
-					std::scoped_lock<std::mutex> lk(it.second.mtx);
-					it.second.event_queue.push(std::make_pair(notification_t::event::APP_ADDED, std::string(buf)));
-				}
-			}
+			master->notify_all(CATPC_EVENT_APP_ADDED, std::string(buf));
 		}
 		else if (bytes_read < 0) {
 			log_fprint(log_file, "ERROR: read failed: %s(%d)\n", strerror(errno), errno);
 			return;
 		}
-		memset(buf, 0, sizeof(buf));
 		close(fd);
 	}
 }
@@ -447,21 +406,16 @@ void watch_terminated_app()
 
 	while (!terminate) {
 		fd = open(catpc_fifo, O_RDONLY);
-		bytes_read = read(fd, buf, sizeof(buf));
+		bytes_read = read(fd, buf, sizeof(buf) - 1);
 		if ( bytes_read > 0) {
+			buf[bytes_read] = '\0';
 			log_fprint(log_file, "INFO: app terminated: \"%s\"\n", buf);
-			for (std::pair<const int, notification_t>& it : sock_to_notification) {
-				{
-					std::scoped_lock<std::mutex> lk(it.second.mtx);
-					it.second.event_queue.push(std::make_pair(notification_t::event::APP_REMOVED, std::string(buf)));
-				}
-			}
+			master->notify_all(CATPC_EVENT_APP_REMOVED, std::string(buf));
 		}
 		else if (bytes_read < 0) {
 			log_fprint(log_file, "ERROR: read failed: %s(%d)\n", strerror(errno), errno);
 			return;
 		}
-		memset(buf, 0, sizeof(buf));
 		close(fd);
 	}
-}
\ No newline at end of file
+}
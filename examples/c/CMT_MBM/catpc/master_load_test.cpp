@@ -0,0 +1,283 @@
+/*
+ * Load test of the CATPC master event loop.
+ *
+ * Runs the master on loopback and drives many simulated slaves speaking the
+ * slave protocol from a few client threads. Reports latency of monitoring
+ * rounds, i.e. time from values request to the last slave reply.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <getopt.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catpc_master.hpp"
+#include "catpc_proto.hpp"
+
+struct load_config {
+	unsigned slaves = 1000;		/**< number of simulated slaves */
+	unsigned apps = 4;		/**< applications per slave */
+	unsigned rounds = 20;		/**< rounds to measure */
+	unsigned period_ms = 200;	/**< round period */
+	unsigned threads = 4;		/**< slave client threads */
+	bool allocate = false;		/**< request allocation after each round */
+};
+
+/**
+ * @brief Simulated slave connection
+ */
+struct sim_slave {
+	int sock;
+	unsigned id;
+	catpc_buffer rx;
+	catpc_buffer tx;
+};
+
+static load_config cfg;
+static std::atomic<bool> stop_slaves{false};
+static std::atomic<bool> measuring{false};
+static std::atomic<unsigned> connected{0};
+static std::mutex rounds_mtx;
+static std::vector<catpc_round> rounds;
+
+/**
+ * @brief Builds replies to received master messages
+ *
+ * @param [in,out] s slave
+ *
+ * @retval 0 OK
+ * @retval -1 protocol error
+ */
+static int sim_handle(sim_slave& s)
+{
+	catpc_frame frame;
+	std::string cmdline;
+	std::vector<catpc_app_allocation> allocation;
+	std::vector<CLOS> masks;
+	int ret;
+
+	while ((ret = s.rx.peek_frame(frame)) > 0) {
+		switch (frame.type) {
+		case CATPC_GET_CAPABILITIES: {
+			llc_ca llc{0, 1u << 20, 11, 4, {}};
+
+			for (unsigned i = 0; i < llc.clos_count; ++i)
+				llc.clos_list.push_back({i, (1ULL << (i + 2)) - 1});
+			catpc_put_capabilities(s.tx, {llc});
+			break;
+		}
+		case CATPC_GET_MONITORING_VALUES: {
+			std::vector<catpc_app_values> values;
+
+			for (unsigned i = 0; i < cfg.apps; ++i)
+				values.push_back({"/usr/bin/app" + std::to_string(i),
+						  {(uint64_t)(s.id + i) << 10, 1.0, 1000, 10000}, 0, 0});
+			catpc_put_values(s.tx, values);
+			break;
+		}
+		case CATPC_ADD_APP_TO_MONITOR:
+		case CATPC_REMOVE_APP_TO_MONITOR:
+			if (!catpc_get_app(frame, cmdline))
+				return -1;
+			break;
+		case CATPC_PERFORM_ALLOCATION:
+			if (!catpc_get_allocation(frame, allocation, masks) || allocation.size() != cfg.apps)
+				return -1;
+			break;
+		default:
+			return -1;
+		}
+		s.rx.consume_frame(frame);
+	}
+
+	return ret;
+}
+
+/**
+ * @brief Client thread serving a share of simulated slaves
+ *
+ * @param [in] port master port
+ * @param [in] first id of the first slave
+ * @param [in] num number of slaves
+ */
+static void sim_thread(uint16_t port, unsigned first, unsigned num)
+{
+	std::vector<sim_slave> slaves(num);
+	std::vector<struct epoll_event> events(256);
+	int epfd = epoll_create1(0);
+
+	for (unsigned i = 0; i < num; ++i) {
+		struct sockaddr_in addr;
+		struct epoll_event ev;
+		const int one = 1;
+		sim_slave& s = slaves[i];
+
+		s.id = first + i;
+		s.sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+		memset(&addr, 0, sizeof(addr));
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		addr.sin_port = htons(port);
+		if (s.sock < 0 || connect(s.sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+			fprintf(stderr, "slave %u: connect failed: %s\n", s.id, strerror(errno));
+			exit(EXIT_FAILURE);
+		}
+		setsockopt(s.sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+		fcntl(s.sock, F_SETFL, fcntl(s.sock, F_GETFL) | O_NONBLOCK);
+
+		ev.events = EPOLLIN;
+		ev.data.u32 = i;
+		epoll_ctl(epfd, EPOLL_CTL_ADD, s.sock, &ev);
+		connected++;
+	}
+
+	while (!stop_slaves) {
+		int n = epoll_wait(epfd, events.data(), events.size(), 100);
+
+		for (int i = 0; i < n; ++i) {
+			sim_slave& s = slaves[events[i].data.u32];
+			struct epoll_event ev;
+
+			if (s.rx.read_from(s.sock) <= 0) {
+				if (!stop_slaves)
+					fprintf(stderr, "slave %u: master closed connection\n", s.id);
+				epoll_ctl(epfd, EPOLL_CTL_DEL, s.sock, NULL);
+				continue;
+			}
+			if (sim_handle(s) < 0) {
+				fprintf(stderr, "slave %u: protocol error\n", s.id);
+				exit(EXIT_FAILURE);
+			}
+			if (s.tx.write_to(s.sock) < 0) {
+				fprintf(stderr, "slave %u: send failed: %s\n", s.id, strerror(errno));
+				exit(EXIT_FAILURE);
+			}
+			ev.events = s.tx.empty() ? EPOLLIN : EPOLLIN | EPOLLOUT;
+			ev.data.u32 = events[i].data.u32;
+			epoll_ctl(epfd, EPOLL_CTL_MOD, s.sock, &ev);
+		}
+	}
+
+	for (sim_slave& s : slaves)
+		close(s.sock);
+	close(epfd);
+}
+
+static void usage(const char* app)
+{
+	printf("Usage: %s [-n SLAVES] [-a APPS] [-r ROUNDS] [-p PERIOD_MS] [-t THREADS] [-A]\n"
+	       "  -n   number of simulated slaves (default: %u)\n"
+	       "  -a   applications per slave (default: %u)\n"
+	       "  -r   number of rounds to measure (default: %u)\n"
+	       "  -p   round period in ms (default: %u)\n"
+	       "  -t   slave client threads (default: %u)\n"
+	       "  -A   request allocation from all slaves after each round\n",
+	       app, cfg.slaves, cfg.apps, cfg.rounds, cfg.period_ms, cfg.threads);
+}
+
+int main(int argc, char** argv)
+{
+	struct rlimit rl;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "n:a:r:p:t:Ah")) != -1) {
+		switch (opt) {
+		case 'n': cfg.slaves = strtoul(optarg, NULL, 0); break;
+		case 'a': cfg.apps = strtoul(optarg, NULL, 0); break;
+		case 'r': cfg.rounds = strtoul(optarg, NULL, 0); break;
+		case 'p': cfg.period_ms = strtoul(optarg, NULL, 0); break;
+		case 't': cfg.threads = strtoul(optarg, NULL, 0); break;
+		case 'A': cfg.allocate = true; break;
+		default:
+			usage(argv[0]);
+			return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+	}
+	if (cfg.slaves == 0 || cfg.threads == 0 || cfg.rounds == 0 || cfg.period_ms == 0) {
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	// both ends of every connection live in this process
+	if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < 2 * cfg.slaves + 64) {
+		rl.rlim_cur = std::min<rlim_t>(rl.rlim_max, 2 * cfg.slaves + 64);
+		setrlimit(RLIMIT_NOFILE, &rl);
+	}
+
+	FILE* log = fopen("/dev/null", "w");
+	catpc_master master{log, std::chrono::milliseconds(cfg.period_ms),
+		[](catpc_master& m, const catpc_round& round) {
+			if (!measuring)
+				return;
+			std::lock_guard<std::mutex> lk{rounds_mtx};
+			rounds.push_back(round);
+			if (rounds.size() >= cfg.rounds) {
+				m.stop();
+				return;
+			}
+			if (cfg.allocate)
+				for (const auto& s : m.slaves())
+					m.notify(*s.second, CATPC_EVENT_PERFORM_ALLOCATION, "");
+		}};
+
+	if (master.listen(0, htonl(INADDR_LOOPBACK)) < 0) {
+		fprintf(stderr, "listen failed\n");
+		return EXIT_FAILURE;
+	}
+
+	std::thread master_thread([&master]() { master.run(); });
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> threads;
+	for (unsigned t = 0; t < cfg.threads; ++t) {
+		unsigned first = cfg.slaves * t / cfg.threads;
+		unsigned last = cfg.slaves * (t + 1) / cfg.threads;
+		threads.emplace_back(sim_thread, master.port(), first, last - first);
+	}
+
+	while (master.ready_count() < cfg.slaves)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	auto ready = std::chrono::steady_clock::now();
+	measuring = true;
+
+	master_thread.join();
+	stop_slaves = true;
+	for (std::thread& t : threads)
+		t.join();
+	fclose(log);
+
+	std::vector<double> lat;
+	unsigned timed_out = 0;
+	for (const catpc_round& r : rounds) {
+		lat.push_back(std::chrono::duration<double, std::milli>(r.latency).count());
+		if (r.timed_out)
+			timed_out++;
+	}
+	std::sort(lat.begin(), lat.end());
+
+	double sum = 0;
+	for (double l : lat)
+		sum += l;
+
+	printf("Slaves: %u, applications per slave: %u, client threads: %u\n", cfg.slaves, cfg.apps, cfg.threads);
+	printf("All slaves ready in %.1f ms\n", std::chrono::duration<double, std::milli>(ready - start).count());
+	printf("Rounds: %zu, timed out: %u\n", lat.size(), timed_out);
+	printf("Round latency [ms] min %.3f avg %.3f p50 %.3f p99 %.3f max %.3f\n", lat.front(), sum / lat.size(),
+	       lat[lat.size() / 2], lat[std::min(lat.size() - 1, lat.size() * 99 / 100)], lat.back());
+
+	return timed_out == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
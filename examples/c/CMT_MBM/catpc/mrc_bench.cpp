@@ -0,0 +1,183 @@
+/*
+ * Benchmark of required LLC computation on synthetic miss rate curves.
+ *
+ * Compares the former per-suffix least squares fit with catpc_mrc and
+ * checks that both pick the same point. Then simulates profiling of noisy
+ * applications with one sample per CLOS against catpc_mrc_step sampling.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <getopt.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <random>
+#include <vector>
+
+#include <boost/math/statistics/linear_regression.hpp>
+
+#include "catpc_mrc.hpp"
+
+/**
+ * @brief Former computation: least squares over each suffix of the curve
+ */
+static uint64_t legacy_required_llc(const std::map<uint64_t, double>& mrc, uint64_t llc_size)
+{
+	std::vector<double> x{};
+	std::vector<double> y{};
+
+	for (const auto& [k, v] : mrc) {
+		x.push_back(k);
+		y.push_back(v);
+	}
+
+	while (x.size() > 1) {
+		auto [c, slope] = boost::math::statistics::simple_ordinary_least_squares(x, y);
+		if (slope * llc_size > -0.05) {
+			return x[0];
+		}
+
+		x.erase(x.begin());
+		y.erase(y.begin());
+	}
+
+	return x[0];
+}
+
+/**
+ * @brief Simulated application, occupancy fills the partition up to its working set
+ */
+struct sim_app {
+	uint64_t working_set;
+	double noise;		/**< standard deviation of a miss rate sample */
+
+	double true_miss_rate(uint64_t occupancy) const
+	{
+		return 0.05 + 0.9 * exp(-3.0 * occupancy / working_set);
+	}
+};
+
+struct sim_result {
+	unsigned samples = 0;
+	unsigned steps = 0;
+	double sq_error = 0.0;
+};
+
+/**
+ * @brief Profiles \a app over CLOS of decreasing size, one way less each
+ *
+ * Takes \a samples per CLOS, or samples as \a sampling says when set.
+ */
+static void simulate_profiling(const sim_app& app, uint64_t way_size, unsigned num_ways, unsigned samples,
+			       const catpc_mrc_sampling* sampling, std::mt19937_64& rng, sim_result& res)
+{
+	std::normal_distribution<double> noise{0.0, app.noise};
+	std::normal_distribution<double> occ_noise{0.97, 0.02};
+	uint64_t occupied = 0;	/**< occupancy of the application not filling a partition */
+
+	for (unsigned ways = num_ways; ways > 0; --ways) {
+		const uint64_t capacity = way_size * ways;
+		catpc_mrc_step step;
+
+		// partition the application would not fill either
+		if (occupied != 0 && occupied < sampling->saturation * capacity)
+			continue;
+
+		do {
+			const uint64_t occupancy = std::min(capacity, app.working_set) * occ_noise(rng);
+			const double miss_rate = std::clamp(app.true_miss_rate(occupancy) + noise(rng), 0.0, 1.0);
+
+			step.add(occupancy, miss_rate);
+			res.samples++;
+		} while (sampling != NULL ? !step.done(*sampling) : step.count() < samples);
+
+		const double err = step.mean() - app.true_miss_rate(step.occupancy());
+
+		res.sq_error += err * err;
+		res.steps++;
+		if (sampling != NULL && step.occupancy() < sampling->saturation * capacity)
+			occupied = step.occupancy();
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const uint64_t way_size = 2816 * 1024;
+	const unsigned num_ways = 11;
+	const uint64_t llc_size = (uint64_t)way_size * num_ways;
+	unsigned iter = 5;
+	std::vector<unsigned> sizes{64, 256, 1024, 4096, 16384};
+	std::mt19937_64 rng{1};
+	std::normal_distribution<double> noise{0.0, 0.005};
+	int opt;
+
+	while ((opt = getopt(argc, argv, "i:n:h")) != -1) {
+		switch (opt) {
+		case 'i': iter = strtoul(optarg, NULL, 0); break;
+		case 'n': sizes = {(unsigned)strtoul(optarg, NULL, 0)}; break;
+		default:
+			printf("Usage: %s [-n POINTS] [-i ITERATIONS]\n"
+			       "  -n   points per curve (default: 64 to 16384)\n"
+			       "  -i   iterations (default: 5)\n", argv[0]);
+			return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+	}
+	if (iter == 0)
+		iter = 1;
+
+	printf("%8s %14s %14s %10s\n", "points", "legacy [ms]", "binned [ms]", "result");
+	for (unsigned num : sizes) {
+		// occupancy sampled evenly over the cache, one sample per bin
+		const uint64_t bin = llc_size / num;
+		std::map<uint64_t, double> legacy_mrc;
+		catpc_mrc mrc{bin};
+		uint64_t legacy_res = 0, res = 0;
+
+		for (unsigned i = 0; i < num; ++i) {
+			const uint64_t occupancy = bin * i + bin / 2;
+			const double miss_rate = 0.05 + 0.9 * exp(-(double)occupancy / (llc_size / 6.0)) + noise(rng);
+
+			legacy_mrc[occupancy] = miss_rate;
+			mrc.add(occupancy, miss_rate);
+		}
+
+		auto t0 = std::chrono::steady_clock::now();
+		for (unsigned i = 0; i < iter; ++i)
+			legacy_res = legacy_required_llc(legacy_mrc, llc_size);
+		auto t1 = std::chrono::steady_clock::now();
+		for (unsigned i = 0; i < iter; ++i)
+			res = mrc.required_llc(llc_size);
+		auto t2 = std::chrono::steady_clock::now();
+
+		printf("%8u %14.3f %14.3f %10s\n", num,
+		       std::chrono::duration<double, std::milli>(t1 - t0).count() / iter,
+		       std::chrono::duration<double, std::milli>(t2 - t1).count() / iter,
+		       legacy_res == res ? "same" : "DIFFERENT");
+		if (legacy_res != res)
+			printf("  legacy %.1fKB, binned %.1fKB\n", legacy_res / 1024.0, res / 1024.0);
+	}
+
+	const catpc_mrc_sampling sampling{};
+	const unsigned num_apps = 1000;
+	std::uniform_int_distribution<uint64_t> working_set{way_size, 2 * llc_size};
+	std::uniform_real_distribution<double> app_noise{0.002, 0.04};
+	sim_result single, fixed, adaptive;
+
+	for (unsigned i = 0; i < num_apps; ++i) {
+		const sim_app app{working_set(rng), app_noise(rng)};
+
+		simulate_profiling(app, way_size, num_ways, 1, NULL, rng, single);
+		simulate_profiling(app, way_size, num_ways, sampling.max_samples, NULL, rng, fixed);
+		simulate_profiling(app, way_size, num_ways, 0, &sampling, rng, adaptive);
+	}
+
+	printf("\nprofiling of %u apps, %u CLOS each\n", num_apps, num_ways);
+	printf("%10s %10s %10s %14s\n", "sampling", "steps", "rounds", "rms error");
+	for (const auto& [name, res] : {std::make_pair("single", single), std::make_pair("fixed", fixed),
+					 std::make_pair("adaptive", adaptive)})
+		printf("%10s %10u %10u %14.4f\n", name, res.steps, res.samples, sqrt(res.sq_error / res.steps));
+
+	return EXIT_SUCCESS;
+}
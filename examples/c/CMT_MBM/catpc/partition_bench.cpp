@@ -0,0 +1,130 @@
+/*
+ * Comparison of cache partitioning policies on synthetic application mixes.
+ *
+ * Every application has an exponential miss rate curve with its own knee
+ * and access rate. Misses of a placement are estimated by splitting each
+ * way evenly among applications whose CLOS mask covers it.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <getopt.h>
+#include <math.h>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "catpc_partitioner.hpp"
+
+/**
+ * @brief Estimated misses of a placement
+ */
+static double placement_misses(const llc_ca& llc, const std::vector<catpc_partition_app>& apps,
+			       const std::vector<CLOS>& changed)
+{
+	std::vector<uint64_t> masks(llc.clos_list.size());
+	std::vector<unsigned> sharers(llc.num_ways, 0);
+	double total = 0;
+
+	for (unsigned i = 0; i < llc.clos_list.size(); ++i) {
+		masks[i] = llc.clos_list[i].mask;
+		for (const CLOS& c : changed)
+			if (c.id == llc.clos_list[i].id)
+				masks[i] = c.mask;
+	}
+
+	for (const catpc_partition_app& app : apps)
+		for (unsigned w = 0; w < llc.num_ways; ++w)
+			if (masks[app.CLOS_id] & (1ULL << w))
+				sharers[w]++;
+
+	for (const catpc_partition_app& app : apps) {
+		double occupancy = 0;
+
+		for (unsigned w = 0; w < llc.num_ways; ++w)
+			if (masks[app.CLOS_id] & (1ULL << w))
+				occupancy += (double)llc.way_size / sharers[w];
+		total += app.references * app.mrc->miss_rate_at((uint64_t)occupancy);
+	}
+
+	return total;
+}
+
+int main(int argc, char** argv)
+{
+	unsigned mixes = 100, max_apps = 6;
+	std::mt19937_64 rng{1};
+	int opt;
+
+	while ((opt = getopt(argc, argv, "m:a:h")) != -1) {
+		switch (opt) {
+		case 'm': mixes = strtoul(optarg, NULL, 0); break;
+		case 'a': max_apps = strtoul(optarg, NULL, 0); break;
+		default:
+			printf("Usage: %s [-m MIXES] [-a MAX_APPS]\n"
+			       "  -m   number of application mixes (default: 100)\n"
+			       "  -a   most applications in a mix (default: 6)\n", argv[0]);
+			return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+	}
+	if (max_apps < 2)
+		max_apps = 2;
+
+	// 11 ways, CLOS masks as set up by reset.sh
+	llc_ca llc{0, 2816 * 1024, 11, 8, {}};
+	const uint64_t reset_masks[] = {0x7ff, 0x1ff, 0x07f, 0x01f, 0x00f, 0x002, 0x001, 0x7ff};
+	for (unsigned i = 0; i < 8; ++i)
+		llc.clos_list.push_back({i, reset_masks[i]});
+	const uint64_t llc_size = (uint64_t)llc.num_ways * llc.way_size;
+
+	catpc_greedy_partitioner greedy;
+	catpc_ucp_partitioner ucp;
+	std::uniform_real_distribution<double> knee_dist{0.02, 0.8}, floor_dist{0.01, 0.3}, refs_dist{1e5, 1e7};
+	std::uniform_int_distribution<unsigned> apps_dist{2, max_apps};
+	double greedy_total = 0, ucp_total = 0, ucp_time = 0;
+	unsigned ucp_better = 0, ucp_worse = 0;
+
+	for (unsigned m = 0; m < mixes; ++m) {
+		const unsigned num = apps_dist(rng);
+		std::vector<catpc_mrc> mrcs(num, catpc_mrc{llc.way_size / CATPC_MRC_BINS_PER_WAY, llc_size});
+		std::vector<catpc_partition_app> apps;
+
+		for (unsigned i = 0; i < num; ++i) {
+			const double knee = knee_dist(rng) * llc_size, floor = floor_dist(rng);
+
+			for (unsigned b = 0; b <= llc.num_ways * CATPC_MRC_BINS_PER_WAY; ++b) {
+				const uint64_t occupancy = (uint64_t)b * mrcs[i].bin_size();
+
+				mrcs[i].add(occupancy, floor + (1 - floor) * exp(-(double)occupancy / (knee / 3)));
+			}
+			apps.push_back({"app" + std::to_string(i), &mrcs[i], 0, refs_dist(rng), 0});
+			apps.back().required_llc = mrcs[i].required_llc(llc_size);
+		}
+
+		std::vector<catpc_partition_app> greedy_apps = apps, ucp_apps = apps;
+		std::vector<CLOS> greedy_masks, ucp_masks;
+
+		greedy.partition(llc, 1, greedy_apps, greedy_masks);
+		auto t0 = std::chrono::steady_clock::now();
+		ucp.partition(llc, 1, ucp_apps, ucp_masks);
+		ucp_time += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+
+		const double g = placement_misses(llc, greedy_apps, greedy_masks);
+		const double u = placement_misses(llc, ucp_apps, ucp_masks);
+
+		greedy_total += g;
+		ucp_total += u;
+		if (u < g * 0.999)
+			ucp_better++;
+		else if (u > g * 1.001)
+			ucp_worse++;
+	}
+
+	printf("Mixes: %u, 2 to %u applications, %u ways, %zu CLOS\n", mixes, max_apps, llc.num_ways, llc.clos_list.size());
+	printf("Estimated misses, greedy: %.4g, ucp: %.4g (%.1f%% fewer)\n", greedy_total, ucp_total,
+	       100.0 * (greedy_total - ucp_total) / greedy_total);
+	printf("ucp fewer misses in %u mixes, more in %u\n", ucp_better, ucp_worse);
+	printf("ucp partitioning time: %.1f us per mix\n", ucp_time / mixes);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,127 @@
+/*
+ * Benchmark of catpc_phase_detector on synthetic monitoring streams.
+ *
+ * Each application alternates phases of random length whose metrics
+ * differ by a random shift, samples carry gaussian noise and rare
+ * outliers. Reports detected changes, detection delay, false alarms and
+ * the cost of an update.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <getopt.h>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "catpc_phase.hpp"
+
+struct sim_phase {
+	double mean[CATPC_PHASE_METRICS];
+	unsigned length;
+};
+
+int main(int argc, char** argv)
+{
+	unsigned num_apps = 500;
+	unsigned rounds = 2000;
+	double noise = 0.05;
+	double min_shift = 0.2;
+	catpc_phase_params params{};
+	std::mt19937_64 rng{1};
+	int opt;
+
+	while ((opt = getopt(argc, argv, "a:r:n:s:h")) != -1) {
+		switch (opt) {
+		case 'a': num_apps = strtoul(optarg, NULL, 0); break;
+		case 'r': rounds = strtoul(optarg, NULL, 0); break;
+		case 'n': noise = strtod(optarg, NULL); break;
+		case 's': min_shift = strtod(optarg, NULL); break;
+		default:
+			printf("Usage: %s [-a APPS] [-r ROUNDS] [-n NOISE] [-s SHIFT]\n"
+			       "  -a   applications (default: 500)\n"
+			       "  -r   rounds per application (default: 2000)\n"
+			       "  -n   sample noise relative to the mean (default: 0.05)\n"
+			       "  -s   smallest phase shift relative to the mean (default: 0.2)\n", argv[0]);
+			return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+	}
+
+	std::uniform_int_distribution<unsigned> phase_length{100, 600};
+	std::uniform_real_distribution<double> shift{min_shift, 1.0};
+	std::uniform_int_distribution<unsigned> metric{0, CATPC_PHASE_METRICS - 1};
+	std::normal_distribution<double> gauss{0.0, 1.0};
+	std::uniform_real_distribution<double> uniform{0.0, 1.0};
+	const double base[CATPC_PHASE_METRICS] = {1.2, 0.3, 8 << 20};
+	std::vector<catpc_phase_detector> detectors(num_apps);
+	std::vector<std::vector<double>> samples(num_apps);
+	std::vector<std::vector<unsigned>> changes(num_apps);
+	unsigned num_changes = 0, detected = 0, false_alarms = 0;
+	unsigned long delay = 0;
+
+	// streams are generated first so that only updates are timed
+	for (unsigned a = 0; a < num_apps; ++a) {
+		sim_phase phase{{base[0], base[1], base[2]}, phase_length(rng)};
+		unsigned start = 0;
+
+		for (unsigned r = 0; r < rounds; ++r) {
+			if (r - start == phase.length) {
+				// one metric moves up or down, the others follow partly
+				const unsigned m = metric(rng);
+				const double s = (uniform(rng) < 0.5 ? 1 + shift(rng) : 1 / (1 + shift(rng)));
+
+				phase.mean[m] = base[m] * (phase.mean[m] == base[m] ? s : 1.0);
+				phase.length = phase_length(rng);
+				start = r;
+				changes[a].push_back(r);
+			}
+			for (unsigned i = 0; i < CATPC_PHASE_METRICS; ++i) {
+				double v = phase.mean[i] * (1 + noise * gauss(rng));
+
+				if (uniform(rng) < 0.002)
+					v *= 3;	// outlier
+				samples[a].push_back(v);
+			}
+		}
+	}
+
+	std::vector<unsigned> alarms;
+	auto t0 = std::chrono::steady_clock::now();
+	for (unsigned r = 0; r < rounds; ++r) {
+		for (unsigned a = 0; a < num_apps; ++a) {
+			if (detectors[a].update(&samples[a][r * CATPC_PHASE_METRICS], params))
+				alarms.push_back(a * rounds + r);
+		}
+	}
+	auto t1 = std::chrono::steady_clock::now();
+
+	// an alarm before the next change detects the last one, others are false
+	for (unsigned a = 0; a < num_apps; ++a) {
+		num_changes += changes[a].size();
+		for (size_t c = 0; c < changes[a].size(); ++c) {
+			const unsigned from = changes[a][c];
+			const unsigned to = c + 1 < changes[a].size() ? changes[a][c + 1] : rounds;
+
+			for (unsigned id : alarms) {
+				if (id / rounds == a && id % rounds >= from && id % rounds < to) {
+					detected++;
+					delay += id % rounds - from;
+					break;
+				}
+			}
+		}
+	}
+	false_alarms = alarms.size() - detected;
+
+	printf("%u apps, %u rounds, noise %.0f%%, shifts from %.0f%%\n", num_apps, rounds, noise * 100, min_shift * 100);
+	printf("phase changes     %u\n", num_changes);
+	printf("detected          %u (%.1f%%)\n", detected, 100.0 * detected / num_changes);
+	printf("mean delay        %.1f rounds\n", detected ? (double)delay / detected : 0.0);
+	printf("false alarms      %u (%.2f per 1000 rounds of an app)\n", false_alarms,
+	       1000.0 * false_alarms / ((double)num_apps * rounds));
+	printf("update            %.1f ns per app, %.1f us per round of all apps\n",
+	       std::chrono::duration<double, std::nano>(t1 - t0).count() / ((double)num_apps * rounds),
+	       std::chrono::duration<double, std::micro>(t1 - t0).count() / rounds);
+
+	return EXIT_SUCCESS;
+}
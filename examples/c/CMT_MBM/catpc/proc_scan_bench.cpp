@@ -0,0 +1,138 @@
+/*
+ * Benchmark of process discovery by command line.
+ *
+ * Compares the former "ps + fscanf" lookup with catpc_proc_index full and
+ * incremental scans. Optionally spawns idle processes to grow the process
+ * table.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "catpc_utils.hpp"
+
+/**
+ * @brief Former lookup: ps for the pid list, cmdline read char by char
+ */
+static int legacy_get_pids(std::vector<pid_t>& pids, const char* cmdline)
+{
+	char filepath[32];
+	std::string buf;
+	char c = '\0';
+	pid_t pid;
+	FILE* fp = popen("/bin/ps -A -o pid=", "r");
+	FILE* cmdfile = NULL;
+
+	if (fp == NULL)
+		return -1;
+
+	while (fscanf(fp, "%d", &pid) != EOF) {
+		snprintf(filepath, sizeof(filepath), "/proc/%d/cmdline", pid);
+		cmdfile = fopen(filepath, "r");
+		if (cmdfile == NULL)
+			continue;
+
+		buf.clear();
+		while (fscanf(cmdfile, "%c", &c) != EOF)
+			if (c != '\0')
+				buf.push_back(c);
+		if (buf == cmdline)
+			pids.push_back(pid);
+		fclose(cmdfile);
+	}
+	pclose(fp);
+
+	return pids.size();
+}
+
+/**
+ * @brief Runs \a fn \a iter times, returns average time in ms
+ */
+static double measure(unsigned iter, const std::function<void()>& fn)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	for (unsigned i = 0; i < iter; ++i)
+		fn();
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iter;
+}
+
+int main(int argc, char** argv)
+{
+	unsigned spawn = 0, iter = 10;
+	std::vector<pid_t> children;
+	std::string self;
+	size_t found = 0;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "n:i:h")) != -1) {
+		switch (opt) {
+		case 'n': spawn = strtoul(optarg, NULL, 0); break;
+		case 'i': iter = strtoul(optarg, NULL, 0); break;
+		default:
+			printf("Usage: %s [-n PROCESSES] [-i ITERATIONS]\n"
+			       "  -n   idle processes to spawn (default: 0)\n"
+			       "  -i   iterations of each method (default: 10)\n", argv[0]);
+			return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+	}
+	if (iter == 0)
+		iter = 1;
+
+	for (unsigned i = 0; i < spawn; ++i) {
+		pid_t pid = fork();
+
+		if (pid == 0) {
+			pause();
+			_exit(EXIT_SUCCESS);
+		}
+		if (pid < 0) {
+			perror("fork");
+			break;
+		}
+		children.push_back(pid);
+	}
+
+	// children share our command line
+	for (int i = 0; i < argc; ++i)
+		self += argv[i];
+
+	catpc_proc_index index;
+	index.refresh();
+	printf("Processes: %zu\n", index.size());
+
+	double legacy = measure(iter, [&]() {
+		std::vector<pid_t> pids;
+		found = legacy_get_pids(pids, self.c_str());
+	});
+	printf("ps + fscanf lookup:      %9.3f ms (%zu found)\n", legacy, found);
+
+	double full = measure(iter, [&]() {
+		catpc_proc_index fresh;
+		fresh.refresh();
+		found = fresh.find(self).size();
+	});
+	printf("index full scan:         %9.3f ms (%zu found)\n", full, found);
+
+	double incr = measure(iter, [&]() {
+		index.refresh();
+		found = index.find(self).size();
+	});
+	printf("index incremental scan:  %9.3f ms (%zu found, %zu cmdlines read)\n", incr, found, index.last_read());
+
+	for (pid_t pid : children)
+		kill(pid, SIGKILL);
+	for (pid_t pid : children)
+		waitpid(pid, NULL, 0);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,242 @@
+/*
+ * Runs a scenario on the simulated LLC and compares partitioning policies.
+ *
+ * Applications first share the whole cache. Their miss rate curves are
+ * then profiled as the master does, one application per L3 domain at a
+ * time, domains in parallel unless -S is given, and every policy of
+ * the scenario partitions the cache before the applications run again.
+ * Reports misses, throughput and decision latency of each policy, and
+ * fails when an "expect" line of the scenario is not met.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <getopt.h>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "catpc_sim.hpp"
+#include "catpc_mrc.hpp"
+#include "catpc_partitioner.hpp"
+#include "catpc_profiler.hpp"
+
+struct run_result {
+	uint64_t misses = 0;
+	uint64_t references = 0;
+	double ipc = 0;		/**< sum of application IPC, averaged over rounds */
+	double decision_us = 0;
+};
+
+/**
+ * @brief Runs applications with their current CLOS
+ */
+static int run(catpc_sim_backend& sim, std::unordered_map<std::string, catpc_application*>& apps,
+	       unsigned warmup, unsigned rounds, run_result& res, bool verbose)
+{
+	std::map<std::string, std::pair<uint64_t, uint64_t>> per_app;
+
+	for (unsigned r = 0; r < warmup + rounds; ++r) {
+		if (sim.poll_monitoring_data(apps) < 0)
+			return -1;
+		if (r < warmup)
+			continue;
+		for (const auto& entry : apps) {
+			res.misses += entry.second->values.llc_misses;
+			res.references += entry.second->values.llc_references;
+			res.ipc += entry.second->values.ipc / rounds;
+			per_app[entry.first].first += entry.second->values.llc_misses;
+			per_app[entry.first].second += entry.second->values.llc_references;
+		}
+	}
+	for (const auto& [cmdline, counts] : per_app) {
+		if (verbose)
+			printf("    %s: miss rate %.4f\n", cmdline.c_str(), (double)counts.first / counts.second);
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Masks giving all ways to every CLOS
+ */
+static std::vector<CLOS> shared_masks(const llc_ca& llc)
+{
+	std::vector<CLOS> masks;
+
+	for (unsigned i = 0; i < llc.clos_count; ++i)
+		masks.push_back({i, llc.num_ways < 64 ? (1ull << llc.num_ways) - 1 : ~0ull});
+
+	return masks;
+}
+
+int main(int argc, char** argv)
+{
+	const unsigned warmup = 5;
+	uint64_t seed = 1;
+	bool verbose = false;
+	bool parallel = true;
+	catpc_sim_scenario scenario;
+	std::string error;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "s:Svh")) != -1) {
+		switch (opt) {
+		case 's': seed = strtoull(optarg, NULL, 0); break;
+		case 'S': parallel = false; break;
+		case 'v': verbose = true; break;
+		default:
+			printf("Usage: %s [-s SEED] [-S] [-v] SCENARIO\n"
+			       "  -s   random seed of the workloads (default: 1)\n"
+			       "  -S   profile one application at a time, not one per L3 domain\n"
+			       "  -v   print miss rate curves and placements\n", argv[0]);
+			return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+	}
+	if (optind >= argc || catpc_load_scenario(argv[optind], scenario, error) < 0) {
+		fprintf(stderr, "%s\n", optind >= argc ? "scenario file missing" : error.c_str());
+		return EXIT_FAILURE;
+	}
+
+	catpc_sim_backend sim{scenario, seed};
+	std::vector<llc_ca> llcs;
+	std::vector<std::unique_ptr<catpc_application>> owned;
+	std::unordered_map<std::string, catpc_application*> apps;
+
+	if (sim.init() < 0) {
+		fprintf(stderr, "unable to load traces of %s\n", argv[optind]);
+		return EXIT_FAILURE;
+	}
+	llcs = sim.get_allocation_config();
+	for (const catpc_sim_workload& w : scenario.workloads) {
+		owned.push_back(std::make_unique<catpc_application>(w.cmdline));
+		apps[w.cmdline] = owned.back().get();
+		sim.start_monitoring(w.cmdline);
+	}
+
+	const llc_ca& llc = llcs[0];
+	const uint64_t llc_size = (uint64_t)llc.num_ways * llc.way_size;
+	std::map<std::string, run_result> results;
+
+	printf("%zu apps, %zu x %u sets x %u ways (%.0f KB), %u CLOS\n", apps.size(), llcs.size(),
+	       scenario.geometry.num_sets, llc.num_ways, llc_size / 1024.0, llc.clos_count);
+
+	// whole cache shared by all applications
+	if (verbose)
+		printf("  shared:\n");
+	if (run(sim, apps, warmup, scenario.rounds, results["shared"], verbose) < 0)
+		return EXIT_FAILURE;
+
+	// profile applications as the master does
+	const catpc_mrc_sampling sampling{};
+	const std::vector<CLOS> masks = shared_masks(llc);
+	catpc_profiler profiler{sampling, 6, parallel};
+	std::unordered_map<std::string, catpc_mrc> mrc;
+	unsigned rounds = 0, concurrent = 0;
+
+	sim.set_clos_masks(llcs, masks);
+	for (const catpc_sim_workload& w : scenario.workloads)
+		profiler.add(w.cmdline);
+	while (!profiler.idle()) {
+		std::vector<CLOS> new_masks;
+		std::vector<catpc_application*> completed;
+
+		sim.poll_monitoring_data(apps);
+		rounds++;
+		if (profiler.round(llcs, apps, mrc, new_masks, completed)) {
+			sim.set_clos_masks(llcs, new_masks);
+			for (const auto& entry : apps)
+				sim.perform_allocation(entry.second);
+		}
+		for (catpc_application* app_ptr : completed)
+			app_ptr->eval_done = true;
+		concurrent = std::max(concurrent, (unsigned)profiler.active());
+	}
+	const unsigned steps = profiler.stats().steps;
+
+	printf("profiling: %u rounds, %u steps, up to %u applications at once\n", rounds, steps, concurrent);
+	if (verbose) {
+		for (const auto& entry : mrc) {
+			printf("  %s:", entry.first.c_str());
+			for (const catpc_mrc::point& p : entry.second.points())
+				printf(" %.0fKB=%.3f", p.occupancy / 1024.0, p.miss_rate);
+			printf("\n");
+		}
+	}
+
+	for (const std::string& policy : scenario.policies) {
+		std::unique_ptr<catpc_partitioner> partitioner = catpc_make_partitioner(policy);
+		std::vector<catpc_partition_app> placement;
+		std::vector<CLOS> new_masks;
+		run_result& res = results[policy];
+
+		if (partitioner == NULL) {
+			fprintf(stderr, "unknown partitioning policy: %s\n", policy.c_str());
+			return EXIT_FAILURE;
+		}
+
+		// every policy starts from the shared cache
+		sim.set_clos_masks(llcs, masks);
+		for (const auto& entry : apps) {
+			const catpc_mrc& m = mrc.at(entry.first);
+
+			placement.push_back({entry.first, &m, m.required_llc(llc_size),
+					     (double)entry.second->values.llc_references, 0, entry.second->llc_id});
+		}
+		std::sort(placement.begin(), placement.end(), [](const auto& a, const auto& b) { return a.cmdline < b.cmdline; });
+
+		auto t0 = std::chrono::steady_clock::now();
+		int ret = catpc_partition_domains(*partitioner, llcs, placement, new_masks);
+		auto t1 = std::chrono::steady_clock::now();
+
+		if (ret < 0) {
+			fprintf(stderr, "%s partitioning failed\n", policy.c_str());
+			return EXIT_FAILURE;
+		}
+		res.decision_us = std::chrono::duration<double, std::micro>(t1 - t0).count();
+		sim.set_clos_masks(llcs, new_masks);
+		for (const catpc_partition_app& p : placement) {
+			apps[p.cmdline]->CLOS_id = p.CLOS_id;
+			sim.perform_allocation(apps[p.cmdline]);
+			if (verbose) {
+				printf("  %s: %s in COS%u, mask 0x%llx\n", policy.c_str(), p.cmdline.c_str(), p.CLOS_id,
+				       (unsigned long long)llcs[std::max(p.llc_id, 0)].clos_list[p.CLOS_id].mask);
+			}
+		}
+		if (run(sim, apps, warmup, scenario.rounds, res, verbose) < 0)
+			return EXIT_FAILURE;
+	}
+
+	const run_result& shared = results["shared"];
+	int status = EXIT_SUCCESS;
+
+	printf("%10s %14s %10s %10s %10s %14s\n", "policy", "misses", "miss rate", "ipc sum", "vs shared", "decision [us]");
+	printf("%10s %14llu %10.4f %10.3f %10.3f %14s\n", "shared", (unsigned long long)shared.misses,
+	       (double)shared.misses / shared.references, shared.ipc, 1.0, "-");
+	for (const std::string& policy : scenario.policies) {
+		const run_result& res = results[policy];
+
+		printf("%10s %14llu %10.4f %10.3f %10.3f %14.1f\n", policy.c_str(), (unsigned long long)res.misses,
+		       (double)res.misses / res.references, res.ipc, (double)res.misses / shared.misses, res.decision_us);
+	}
+
+	for (const auto& [policy, ratio] : scenario.expect) {
+		auto it = results.find(policy);
+
+		if (it == results.end()) {
+			printf("FAIL: %s was not run\n", policy.c_str());
+			status = EXIT_FAILURE;
+		}
+		else if ((double)it->second.misses / shared.misses > ratio) {
+			printf("FAIL: %s misses %.3f of shared, expected at most %.3f\n", policy.c_str(),
+			       (double)it->second.misses / shared.misses, ratio);
+			status = EXIT_FAILURE;
+		}
+	}
+
+	return status;
+}
@@ -5,18 +5,23 @@
 #include <sys/socket.h>
 #include <netdb.h>
 #include <arpa/inet.h>
+#include <netinet/tcp.h>
 #include <time.h>
 #include <errno.h>
+#include <getopt.h>
 #include <vector>
 
 #include "catpc_utils.hpp"
 #include "catpc_monitor.hpp"
 #include "catpc_allocator.hpp"
+#include "catpc_proto.hpp"
+#include "catpc_backend.hpp"
 
 #define SERVER_PORT 10000
 
 FILE* log_file = NULL;
 std::unordered_map<std::string, catpc_application*> applications;
+std::unique_ptr<catpc_backend> backend;
 
 /*
 * =======================================
@@ -25,15 +30,35 @@ std::unordered_map<std::string, catpc_application*> applications;
 */
 int main(int argc, char** argv)
 {
-	pid_t pid = fork();
+	const char* backend_name = "pqos";
 	char* master_name = NULL;
+	std::string error;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "b:h")) != -1) {
+		switch (opt) {
+		case 'b':
+			backend_name = optarg;
+			break;
+		default:
+			printf("Usage : %s [-b pqos|sim:SCENARIO] [master-name]\n", argv[0]);
+			exit(opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+	}
+	if (optind >= argc) {
+		printf("Usage : %s [-b pqos|sim:SCENARIO] [master-name]\n", argv[0]);
+		exit(EXIT_FAILURE);
+	}
+	master_name = argv[optind];
 
-	if (argc < 2) {
-		printf("Usage : %s [master-name]\n", argv[0]);
+	// simulated cache runs the applications of a scenario, no RDT needed
+	backend = catpc_make_backend(backend_name, error);
+	if (backend == NULL) {
+		fprintf(stderr, "%s\n", error.c_str());
 		exit(EXIT_FAILURE);
 	}
-	
-	master_name = argv[1];
+
+	pid_t pid = fork();
 
 	if (pid < 0) {
 		fprintf(stderr, "fork failed!\n");
@@ -65,14 +90,14 @@ int main(int argc, char** argv)
 	struct hostent* host_info = NULL;
 	struct sockaddr_in server_addr;
 	int sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
-	int bytes_read = 0, bytes_sent = 0;
-	enum catpc_message msg;
+	catpc_buffer rx, tx;
+	catpc_frame frame;
 	std::string cmdline;
-	unsigned int CLOS_id;
-	uint64_t required_llc;
-	size_t sz;
+	std::vector<catpc_app_values> values;
+	std::vector<catpc_app_allocation> allocation;
+	std::vector<CLOS> masks;
+	const int one = 1;
 	int ret = 0;
-	char buf[512];
 
 	log_file = fopen("/var/log/catpc.slave.log", "w");
 	if (log_file == NULL) {
@@ -80,14 +105,14 @@ int main(int argc, char** argv)
 	}
 
 	// Start Monitoring
-	ret = init_monitoring();
+	ret = backend->init();
 	if (ret < 0) {
-		log_fprint(log_file, "ERROR: unable to init monitoring\n");
+		log_fprint(log_file, "ERROR: unable to init %s monitoring\n", backend->name());
 		exit(EXIT_FAILURE);
 	}
 
 	// get allocation configuration
-	std::vector<llc_ca> llcs = get_allocation_config();
+	std::vector<llc_ca> llcs = backend->get_allocation_config();
 	if (llcs.empty()) {
 		log_fprint(log_file, "ERROR: get_allocation_config failed\n");
 		exit(EXIT_FAILURE);
@@ -109,142 +134,130 @@ int main(int argc, char** argv)
 		exit(EXIT_FAILURE);
 	}
 
-	// read message from master
-	while ((bytes_read = recv(sock, &msg, sizeof(msg), 0)) > 0) {
-		switch (msg) {
-		case CATPC_GET_MONITORING_VALUES:
-			log_fprint(log_file, "INFO: message received: CATPC_GET_MONITORING_VALUES\n");
-			
-			// poll monitoring values
-			ret = poll_monitoring_data(applications);
-			if (ret < 0) {
-				log_fprint(log_file, "ERROR: polling monitoring data (%d)\n", ret);
-				goto exit;
-			}
+	// replies are single small frames, do not hold them back
+	setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
 
-			// send values tab
-			sz = applications.size();
-			bytes_sent = send(sock, &sz, sizeof(size_t), 0);													// send the number of applications
-			for (std::pair<std::string, catpc_application*> element : applications) {
-				catpc_application* app_ptr = element.second;
-				sz = app_ptr->cmdline.size();																				
-				bytes_sent = send(sock, &sz, sizeof(size_t), 0);												// send the length of the cmdline string
-				bytes_sent = send(sock, app_ptr->cmdline.c_str(), sz * sizeof(char), 0);					// send the cmdline string
-				bytes_sent = send(sock, &app_ptr->values, sizeof(catpc_monitoring_values), 0);		// send monitoring values
-				bytes_sent = send(sock, &app_ptr->CLOS_id, sizeof(unsigned int), 0);					// send CLOS id
-			}
+	// read messages from master
+	while ((ret = rx.read_from(sock)) > 0) {
+		while ((ret = rx.peek_frame(frame)) > 0) {
+			switch (frame.type) {
+			case CATPC_GET_MONITORING_VALUES:
+				log_fprint(log_file, "INFO: message received: CATPC_GET_MONITORING_VALUES\n");
 
-			break;
-		case CATPC_ADD_APP_TO_MONITOR:
-			log_fprint(log_file, "INFO: message received: CATPC_ADD_APP_TO_MONITOR\n");
-			
-			// receive cmd line string
-			bytes_read = recv(sock, &sz, sizeof(size_t), 0);
-			bytes_read = recv(sock, buf, sz * sizeof(char), 0);
-			cmdline.assign(buf, sz);
-
-
-			// add application to the map
-			applications.try_emplace(cmdline, new catpc_application(cmdline, catpc_monitoring_values(), 0));
-
-			// start monitoring on app launched by the command line
-			set_logfile(log_file);
-			ret = start_monitoring(cmdline);
-			if (ret < 0) {
-				log_fprint(log_file, "ERROR: unable to start monitoring on app \"%s(%d)\"\n", cmdline.c_str(), ret);
-				exit(EXIT_FAILURE);
-			}
-			
-			log_fprint(log_file, "INFO: app added : %s\n", cmdline.c_str());
-			break;
+				// poll monitoring values
+				ret = backend->poll_monitoring_data(applications);
+				if (ret < 0) {
+					log_fprint(log_file, "ERROR: polling monitoring data (%d)\n", ret);
+					goto exit;
+				}
 
-		case CATPC_REMOVE_APP_TO_MONITOR:
-			log_fprint(log_file, "INFO: message received: CATPC_REMOVE_APP_TO_MONITOR\n");
+				// values of all applications go in a single frame
+				values.clear();
+				for (std::pair<std::string, catpc_application*> element : applications) {
+					catpc_application* app_ptr = element.second;
+					values.push_back({app_ptr->cmdline, app_ptr->values, app_ptr->CLOS_id, app_ptr->llc_id});
+				}
+				catpc_put_values(tx, values);
+				break;
 
-			// receive cmd line string
-			bytes_read = recv(sock, &sz, sizeof(size_t), 0);
-			bytes_read = recv(sock, buf, sz * sizeof(char), 0);
-			cmdline.assign(buf, sz);
+			case CATPC_ADD_APP_TO_MONITOR:
+				log_fprint(log_file, "INFO: message received: CATPC_ADD_APP_TO_MONITOR\n");
+				if (!catpc_get_app(frame, cmdline))
+					goto protocol_error;
 
-			// add application to the map
-			remove_application(applications, llcs, cmdline);
-			
-			log_fprint(log_file, "INFO: app removed : %s\n", cmdline.c_str());
-			break;
+				// add application to the map
+				applications.try_emplace(cmdline, new catpc_application(cmdline, catpc_monitoring_values(), 0));
 
-		case CATPC_GET_CAPABILITIES:
-			log_fprint(log_file, "INFO: message received: CATPC_GET_CAPABILITIES\n");
-			sz = llcs.size();
-			bytes_sent = send(sock, &sz, sizeof(size_t), 0);
-			for (llc_ca llc : llcs) {
-				bytes_sent = send(sock, &llc.id, sizeof(int), 0);
-				bytes_sent = send(sock, &llc.num_ways, sizeof(unsigned), 0);
-				bytes_sent = send(sock, &llc.way_size, sizeof(unsigned), 0);
-				bytes_sent = send(sock, &llc.clos_count, sizeof(unsigned), 0);
-				for (CLOS clos : llc.clos_list) {
-					bytes_sent = send(sock, &clos, sizeof(CLOS), 0);
+				// start monitoring on app launched by the command line
+				set_logfile(log_file);
+				ret = backend->start_monitoring(cmdline);
+				if (ret < 0) {
+					log_fprint(log_file, "ERROR: unable to start monitoring on app \"%s(%d)\"\n", cmdline.c_str(), ret);
+					exit(EXIT_FAILURE);
 				}
-			}
-			break;
-		case CATPC_PERFORM_ALLOCATION:
-			log_fprint(log_file, "INFO: message received: CATPC_PERFORM_ALLOCATION\n");
-			// read as many times as there are applications
-			for (unsigned i = 0; i < applications.size(); ++i) {
-				bytes_read = recv(sock, &sz, sizeof(size_t), 0);
-				bytes_read = recv(sock, buf, sz * sizeof(char), 0);
-				bytes_read = recv(sock, &CLOS_id, sizeof(unsigned int), 0);
-				bytes_read = recv(sock, &required_llc, sizeof(uint64_t), 0);
-				log_fprint(log_file, "INFO: %s: COS%u -> COS%u\n", cmdline.c_str(), applications[cmdline]->CLOS_id, CLOS_id);
-				
-				cmdline.assign(buf, sz);
-				applications[cmdline]->CLOS_id = CLOS_id;
-				applications[cmdline]->required_llc = required_llc;
-			}
 
-			// perform allocation
-			for (std::pair<std::string, catpc_application*> element : applications) {
-				catpc_application* app_ptr = element.second;
-				if (app_ptr->required_llc > 0) {
-					if (!app_ptr->smart_alloc_done) {
-						ret = perform_smart_allocation(app_ptr, llcs);
-						if (ret < 0) {
-							log_fprint(log_file, "ERROR: perform_smart_allocation failed (%d)\n", ret);
-						}
-						app_ptr->smart_alloc_done = true;
-						log_fprint(log_file, "DEBUG: smart allocation done for %s : COS%d\n", app_ptr->cmdline.c_str(), app_ptr->CLOS_id);
+				log_fprint(log_file, "INFO: app added : %s\n", cmdline.c_str());
+				break;
+
+			case CATPC_REMOVE_APP_TO_MONITOR:
+				log_fprint(log_file, "INFO: message received: CATPC_REMOVE_APP_TO_MONITOR\n");
+				if (!catpc_get_app(frame, cmdline))
+					goto protocol_error;
+
+				// remove application from the map
+				remove_application(applications, cmdline);
+
+				log_fprint(log_file, "INFO: app removed : %s\n", cmdline.c_str());
+				break;
+
+			case CATPC_GET_CAPABILITIES:
+				log_fprint(log_file, "INFO: message received: CATPC_GET_CAPABILITIES\n");
+				catpc_put_capabilities(tx, llcs);
+				break;
+
+			case CATPC_PERFORM_ALLOCATION:
+				log_fprint(log_file, "INFO: message received: CATPC_PERFORM_ALLOCATION\n");
+				if (!catpc_get_allocation(frame, allocation, masks))
+					goto protocol_error;
+
+				// partitioning is decided by the master, masks come first
+				if (!masks.empty()) {
+					ret = backend->set_clos_masks(llcs, masks);
+					if (ret < 0) {
+						log_fprint(log_file, "ERROR: set_clos_masks failed (%d)\n", ret);
+					}
+					for (const CLOS& clos : masks) {
+						log_fprint(log_file, "INFO: COS%u mask 0x%llx\n", clos.id, (unsigned long long)clos.mask);
 					}
 				}
-				else {
-					ret = perform_allocation(app_ptr);
+
+				for (const catpc_app_allocation& app : allocation) {
+					auto it = applications.find(app.cmdline);
+
+					if (it == applications.end())
+						continue;	// removed in the meantime
+					log_fprint(log_file, "INFO: %s: COS%u -> COS%u\n", app.cmdline.c_str(), it->second->CLOS_id, app.CLOS_id);
+					it->second->CLOS_id = app.CLOS_id;
+					it->second->required_llc = app.required_llc;
+				}
+
+				// perform allocation
+				for (std::pair<std::string, catpc_application*> element : applications) {
+					ret = backend->perform_allocation(element.second);
 					if (ret < 0) {
 						log_fprint(log_file, "ERROR: perform_allocation failed (%d)\n", ret);
 					}
 				}
+				break;
+			default:
+				log_fprint(log_file, "ERROR: unknow message value: %d\n", frame.type);
 			}
-			break;
-		default:
-			log_fprint(log_file, "ERROR: unknow message value: %d\n", msg);
+			rx.consume_frame(frame);
 		}
+		if (ret < 0)
+			goto protocol_error;
 
-		// error checking
-		if (bytes_sent < 0) {
+		// replies to everything received so far leave in one send
+		if (tx.write_to(sock) < 0) {
 			log_fprint(log_file, "ERROR: send: %s (%d)\n", strerror(errno), errno);
-		}
-		if (bytes_read < 0) {
-			log_fprint(log_file, "ERROR: recv: %s (%d)\n", strerror(errno), errno);
+			goto exit;
 		}
 	}
 
-	if (bytes_read == 0) {
+	if (ret == 0) {
 		log_fprint(log_file, "INFO: recv: server closed.\n");
 	}
-	else {	// bytes_read < 0
+	else {	// ret < 0
 		log_fprint(log_file, "ERROR: recv: %s (%d)\n", strerror(errno), errno);
 	}
+	goto exit;
+
+protocol_error:
+	log_fprint(log_file, "ERROR: malformed message from master, protocol version %d\n", CATPC_PROTO_VERSION);
 
 exit:
 	// stop monitoring before exit
-	stop_monitoring(applications);
+	backend->stop_monitoring(applications);
 	
 	log_fprint(log_file, "INFO: Done.\n");
 	
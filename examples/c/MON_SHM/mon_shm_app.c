@@ -0,0 +1,141 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2022 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @brief Example consumer of monitoring samples published by pqos
+ *
+ * Start pqos with shared memory output, e.g.:
+ *     pqos -u shm -o /pqos-mon -m all:0-3
+ * and run the example to print the samples as they are published.
+ */
+
+#include "mon_shm_reader.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static volatile sig_atomic_t stop_loop = 0;
+
+/**
+ * @brief CTRL-C handler
+ *
+ * @param signo signal number
+ */
+static void
+sig_handler(int signo)
+{
+        (void)signo;
+        stop_loop = 1;
+}
+
+/**
+ * @brief Prints single sample
+ *
+ * @param [in] reader reader context
+ * @param [in] slot sample slot
+ */
+static void
+print_sample(const struct mon_shm_reader *reader,
+             const struct monitor_shm_slot *slot)
+{
+        const double interval = reader->header->interval_ms / 1000.0;
+        const double mb = 1024.0 * 1024.0;
+        unsigned i;
+
+        printf("TIME %llu.%03llu\n",
+               (unsigned long long)(slot->timestamp_ns / 1000000000ULL),
+               (unsigned long long)(slot->timestamp_ns / 1000000ULL % 1000));
+        printf("%16s %8s %10s %10s %10s\n", "GROUP", "IPC", "LLC[KB]",
+               "MBL[MB/s]", "MBT[MB/s]");
+        for (i = 0; i < reader->header->num_groups; i++) {
+                const struct pqos_event_values *v = &slot->values[i];
+
+                printf("%16.16s %8.2f %10.1f %10.1f %10.1f\n",
+                       reader->groups[i].name, v->ipc, v->llc / 1024.0,
+                       v->mbm_local_delta / mb / interval,
+                       v->mbm_total_delta / mb / interval);
+        }
+}
+
+int
+main(int argc, char **argv)
+{
+        struct mon_shm_reader reader;
+        const char *name = MONITOR_SHM_NAME;
+        useconds_t poll_us;
+
+        if (argc > 2 || (argc == 2 && argv[1][0] == '-')) {
+                printf("Usage: %s [NAME]\n"
+                       "  NAME   shared memory segment name (default: %s)\n",
+                       argv[0], MONITOR_SHM_NAME);
+                return EXIT_FAILURE;
+        }
+        if (argc == 2)
+                name = argv[1];
+
+        if (mon_shm_open(&reader, name) != 0)
+                return EXIT_FAILURE;
+
+        signal(SIGINT, sig_handler);
+        signal(SIGTERM, sig_handler);
+
+        /* check for new samples a few times per sampling interval */
+        poll_us = (useconds_t)reader.header->interval_ms * 1000 / 4;
+        if (poll_us == 0)
+                poll_us = 1000;
+
+        while (!stop_loop) {
+                const struct monitor_shm_slot *slot;
+                int ret = mon_shm_next(&reader, &slot);
+
+                if (ret < 0) {
+                        printf("Producer has stopped\n");
+                        break;
+                }
+                if (ret == 0) {
+                        usleep(poll_us);
+                        continue;
+                }
+
+                print_sample(&reader, slot);
+                if (mon_shm_release(&reader, slot) != 0)
+                        printf("Sample overwritten while printed\n");
+        }
+
+        printf("Lost samples: %llu\n", (unsigned long long)reader.lost);
+        mon_shm_close(&reader);
+
+        return EXIT_SUCCESS;
+}
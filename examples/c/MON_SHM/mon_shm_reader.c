@@ -0,0 +1,195 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2022 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "mon_shm_reader.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief Returns slot of sample \a n
+ *
+ * @param [in] reader reader context
+ * @param [in] n sample number
+ *
+ * @return slot pointer
+ */
+static const struct monitor_shm_slot *
+mon_shm_slot(const struct mon_shm_reader *reader, const uint64_t n)
+{
+        const struct monitor_shm_header *header = reader->header;
+        const uint8_t *ring = (const uint8_t *)header + header->ring_offset;
+
+        return (const struct monitor_shm_slot *)(ring +
+                                                 (n % header->num_slots) *
+                                                     header->slot_size);
+}
+
+int
+mon_shm_open(struct mon_shm_reader *reader, const char *name)
+{
+        const struct monitor_shm_header *header;
+        const uint8_t *groups;
+        struct stat st;
+        void *addr;
+        int fd;
+
+        if (reader == NULL || name == NULL)
+                return -1;
+
+        memset(reader, 0, sizeof(*reader));
+
+        fd = shm_open(name, O_RDONLY, 0);
+        if (fd < 0) {
+                printf("Failed to open shared memory '%s': %s\n", name,
+                       strerror(errno));
+                return -1;
+        }
+
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(*header)) {
+                printf("Invalid shared memory '%s'\n", name);
+                close(fd);
+                return -1;
+        }
+
+        addr = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (addr == MAP_FAILED) {
+                printf("Failed to map shared memory '%s': %s\n", name,
+                       strerror(errno));
+                return -1;
+        }
+        header = (const struct monitor_shm_header *)addr;
+
+        if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) !=
+                MONITOR_SHM_MAGIC ||
+            header->version != MONITOR_SHM_VERSION) {
+                printf("Shared memory '%s' is not ready or unsupported\n",
+                       name);
+                munmap(addr, (size_t)st.st_size);
+                return -1;
+        }
+
+        /* values have to be laid out as in this build of the library */
+        if (header->values_size != sizeof(struct pqos_event_values) ||
+            header->num_slots == 0 ||
+            header->ring_offset +
+                    (uint64_t)header->num_slots * header->slot_size >
+                (uint64_t)st.st_size) {
+                printf("Shared memory '%s' layout mismatch\n", name);
+                munmap(addr, (size_t)st.st_size);
+                return -1;
+        }
+
+        reader->header = header;
+        reader->size = (size_t)st.st_size;
+        groups = (const uint8_t *)addr + header->groups_offset;
+        reader->groups = (const struct monitor_shm_group *)groups;
+        reader->next = __atomic_load_n(&header->head, __ATOMIC_ACQUIRE);
+
+        return 0;
+}
+
+void
+mon_shm_close(struct mon_shm_reader *reader)
+{
+        if (reader == NULL || reader->header == NULL)
+                return;
+
+        munmap((void *)(uintptr_t)reader->header, reader->size);
+        memset(reader, 0, sizeof(*reader));
+}
+
+int
+mon_shm_next(struct mon_shm_reader *reader,
+             const struct monitor_shm_slot **slot)
+{
+        const struct monitor_shm_header *header = reader->header;
+        uint64_t head;
+
+        for (;;) {
+                const struct monitor_shm_slot *s;
+                uint64_t seq;
+
+                head = __atomic_load_n(&header->head, __ATOMIC_ACQUIRE);
+                if (reader->next == head) {
+                        if (__atomic_load_n(&header->state,
+                                            __ATOMIC_ACQUIRE) ==
+                            MONITOR_SHM_STATE_STOPPED)
+                                return -1;
+                        return 0;
+                }
+
+                /* slot of sample head is the one being overwritten next */
+                if (head - reader->next >= header->num_slots) {
+                        reader->lost +=
+                            head - header->num_slots + 1 - reader->next;
+                        reader->next = head - header->num_slots + 1;
+                }
+
+                s = mon_shm_slot(reader, reader->next);
+                seq = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+                if (seq == 2 * reader->next + 2) {
+                        reader->seq = seq;
+                        *slot = s;
+                        return 1;
+                }
+
+                /* producer has lapped us in the meantime */
+                reader->lost++;
+                reader->next++;
+        }
+}
+
+int
+mon_shm_release(struct mon_shm_reader *reader,
+                const struct monitor_shm_slot *slot)
+{
+        uint64_t seq;
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        seq = __atomic_load_n(&slot->seq, __ATOMIC_RELAXED);
+
+        reader->next++;
+        if (seq != reader->seq) {
+                reader->lost++;
+                return -1;
+        }
+
+        return 0;
+}
@@ -0,0 +1,119 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2022 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @brief Reader of monitoring samples published by pqos in shared memory
+ *
+ * Samples are accessed in place, without copying. A slot returned by
+ * mon_shm_next() may be overwritten by the producer at any time, so the
+ * consumer has to call mon_shm_release() once done with the slot and
+ * discard whatever it derived from the slot if the call fails.
+ */
+
+#ifndef __MON_SHM_READER_H__
+#define __MON_SHM_READER_H__
+
+#include "monitor_shm.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Reader context
+ */
+struct mon_shm_reader {
+        const struct monitor_shm_header *header; /**< mapped segment */
+        size_t size;                             /**< segment size */
+        const struct monitor_shm_group *groups;  /**< group table */
+        uint64_t next;                           /**< next sample to read */
+        uint64_t seq;                            /**< sequence of read slot */
+        uint64_t lost;                           /**< number of lost samples */
+};
+
+/**
+ * @brief Attaches to shared memory segment
+ *
+ * Reading starts from the next sample published.
+ *
+ * @param [out] reader reader context
+ * @param [in] name shared memory segment name
+ *
+ * @return Operation status
+ * @retval 0 OK
+ * @retval -1 error
+ */
+int mon_shm_open(struct mon_shm_reader *reader, const char *name);
+
+/**
+ * @brief Detaches from shared memory segment
+ *
+ * @param [in] reader reader context
+ */
+void mon_shm_close(struct mon_shm_reader *reader);
+
+/**
+ * @brief Returns next sample
+ *
+ * @param [in] reader reader context
+ * @param [out] slot sample slot, valid until mon_shm_release()
+ *
+ * @return Operation status
+ * @retval 1 sample available
+ * @retval 0 no new sample
+ * @retval -1 producer has stopped
+ */
+int mon_shm_next(struct mon_shm_reader *reader,
+                 const struct monitor_shm_slot **slot);
+
+/**
+ * @brief Finishes access to sample returned by mon_shm_next()
+ *
+ * @param [in] reader reader context
+ * @param [in] slot sample slot
+ *
+ * @return Operation status
+ * @retval 0 sample has not changed while accessed
+ * @retval -1 sample was overwritten and has to be discarded
+ */
+int mon_shm_release(struct mon_shm_reader *reader,
+                    const struct monitor_shm_slot *slot);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MON_SHM_READER_H__ */
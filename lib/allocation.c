@@ -69,6 +69,18 @@
  * ---------------------------------------
  */
 
+/**
+ * Shadow of core to COS associations, MSR interface only.
+ * It is read from hardware on first use and then kept up to date by
+ * hw_alloc_assoc_write(), so that association lookups don't read MSRs.
+ * Writes always reach the MSR.
+ * hw_alloc_assoc_resync() reads it again after another tool changed
+ * the associations.
+ */
+static unsigned *m_assoc = NULL;   /**< COS of each lcore */
+static unsigned m_assoc_num = 0;   /**< number of entries in m_assoc */
+static int m_assoc_synced = 0;     /**< m_assoc matches hardware */
+
 /**
  * ---------------------------------------
  * External data
@@ -99,6 +111,109 @@ hw_alloc_assoc_read(const unsigned lcore, unsigned *class_id)
         return PQOS_RETVAL_OK;
 }
 
+/**
+ * @brief Creates the association shadow, nothing is read from hardware
+ *
+ * @param [in] cpu CPU topology structure
+ *
+ * @return Operation status
+ */
+static int
+hw_alloc_assoc_shadow_init(const struct pqos_cpuinfo *cpu)
+{
+        unsigned i;
+
+        m_assoc_num = 0;
+        for (i = 0; i < cpu->num_cores; i++)
+                if (cpu->cores[i].lcore >= m_assoc_num)
+                        m_assoc_num = cpu->cores[i].lcore + 1;
+
+        m_assoc = calloc(m_assoc_num, sizeof(m_assoc[0]));
+        if (m_assoc == NULL) {
+                m_assoc_num = 0;
+                return PQOS_RETVAL_RESOURCE;
+        }
+        m_assoc_synced = 0;
+
+        return PQOS_RETVAL_OK;
+}
+
+/**
+ * @brief Frees the association shadow
+ */
+static void
+hw_alloc_assoc_shadow_fini(void)
+{
+        free(m_assoc);
+        m_assoc = NULL;
+        m_assoc_num = 0;
+        m_assoc_synced = 0;
+}
+
+int
+hw_alloc_assoc_resync(int *changed)
+{
+        const struct pqos_cpuinfo *cpu = _pqos_get_cpu();
+        const int synced = m_assoc_synced;
+        unsigned i;
+
+        ASSERT(changed != NULL);
+
+        *changed = 0;
+        if (m_assoc == NULL)
+                return PQOS_RETVAL_OK;
+
+        m_assoc_synced = 0;
+        for (i = 0; i < cpu->num_cores; i++) {
+                const unsigned lcore = cpu->cores[i].lcore;
+                unsigned class_id;
+                int ret;
+
+                ret = hw_alloc_assoc_read(lcore, &class_id);
+                if (ret != PQOS_RETVAL_OK)
+                        return ret;
+
+                if (synced && m_assoc[lcore] != class_id) {
+                        LOG_DEBUG("Core %u moved from COS%u to COS%u outside "
+                                  "of the library\n",
+                                  lcore, m_assoc[lcore], class_id);
+                        *changed = 1;
+                }
+                m_assoc[lcore] = class_id;
+        }
+        m_assoc_synced = 1;
+
+        return PQOS_RETVAL_OK;
+}
+
+/**
+ * @brief Reads class of service associated to \a lcore from the shadow
+ *
+ * Falls back to the MSR when there is no shadow.
+ *
+ * @param [in] lcore logical core id
+ * @param [out] class_id class of service
+ *
+ * @return Operation status
+ */
+static int
+hw_alloc_assoc_cached(const unsigned lcore, unsigned *class_id)
+{
+        if (m_assoc == NULL || lcore >= m_assoc_num)
+                return hw_alloc_assoc_read(lcore, class_id);
+
+        if (!m_assoc_synced) {
+                int changed;
+                int ret = hw_alloc_assoc_resync(&changed);
+
+                if (ret != PQOS_RETVAL_OK)
+                        return ret;
+        }
+        *class_id = m_assoc[lcore];
+
+        return PQOS_RETVAL_OK;
+}
+
 /**
  * @brief Gets unused COS on a socket or L2 cluster
  *
@@ -194,7 +309,7 @@ hw_alloc_assoc_unused(const unsigned technology,
                 if (mba_id_set && cpu->cores[i].mba_id != mba_id)
                         continue;
 
-                ret = hw_alloc_assoc_read(cpu->cores[i].lcore, &cos);
+                ret = hw_alloc_assoc_cached(cpu->cores[i].lcore, &cos);
                 if (ret != PQOS_RETVAL_OK)
                         return ret;
 
@@ -238,17 +353,16 @@ pqos_alloc_init(const struct pqos_cpuinfo *cpu,
                 const struct pqos_config *cfg)
 {
         int ret = PQOS_RETVAL_OK;
-#ifdef __linux__
         enum pqos_interface interface = _pqos_get_inter();
-#endif
 
 #ifndef __linux__
-        UNUSED_PARAM(cpu);
         UNUSED_PARAM(cap);
 #endif
 
         UNUSED_PARAM(cfg);
 
+        if (interface == PQOS_INTER_MSR)
+                ret = hw_alloc_assoc_shadow_init(cpu);
 #ifdef __linux__
         if (interface == PQOS_INTER_OS ||
             interface == PQOS_INTER_OS_RESCTRL_MON)
@@ -261,9 +375,11 @@ int
 pqos_alloc_fini(void)
 {
         int ret = PQOS_RETVAL_OK;
-#ifdef __linux__
         enum pqos_interface interface = _pqos_get_inter();
 
+        if (interface == PQOS_INTER_MSR)
+                hw_alloc_assoc_shadow_fini();
+#ifdef __linux__
         if (interface == PQOS_INTER_OS ||
             interface == PQOS_INTER_OS_RESCTRL_MON)
                 ret = os_alloc_fini();
@@ -1072,13 +1188,23 @@ int
 hw_alloc_assoc_write(const unsigned lcore, const unsigned class_id)
 {
         const uint32_t reg = PQOS_MSR_ASSOC;
+        const int shadow = (m_assoc != NULL && lcore < m_assoc_num);
         uint64_t val = 0;
         int ret;
 
+        /* always written, the shadow may be stale */
         ret = msr_read(lcore, reg, &val);
         if (ret != MACHINE_RETVAL_OK)
                 return PQOS_RETVAL_ERROR;
 
+        if (shadow && m_assoc_synced &&
+            m_assoc[lcore] != (unsigned)(val >> PQOS_MSR_ASSOC_QECOS_SHIFT)) {
+                LOG_WARN("Core %u association changed outside of the "
+                         "library, resynchronizing\n",
+                         lcore);
+                m_assoc_synced = 0;
+        }
+
         val &= (~PQOS_MSR_ASSOC_QECOS_MASK);
         val |= (((uint64_t)class_id) << PQOS_MSR_ASSOC_QECOS_SHIFT);
 
@@ -1086,6 +1212,9 @@ hw_alloc_assoc_write(const unsigned lcore, const unsigned class_id)
         if (ret != MACHINE_RETVAL_OK)
                 return PQOS_RETVAL_ERROR;
 
+        if (shadow)
+                m_assoc[lcore] = class_id;
+
         return PQOS_RETVAL_OK;
 }
 
@@ -1155,7 +1284,7 @@ hw_alloc_assoc_get(const unsigned lcore, unsigned *class_id)
                 /* no L2/L3 CAT or MBA detected */
                 return PQOS_RETVAL_RESOURCE;
 
-        ret = hw_alloc_assoc_read(lcore, class_id);
+        ret = hw_alloc_assoc_cached(lcore, class_id);
 
         return ret;
 }
@@ -1351,11 +1480,17 @@ hw_alloc_reset_assoc(void)
         unsigned i;
         const struct pqos_cpuinfo *cpu = _pqos_get_cpu();
 
+        /* write every core, whatever the shadow says */
+        m_assoc_synced = 0;
+
         for (i = 0; i < cpu->num_cores; i++)
                 if (hw_alloc_assoc_write(cpu->cores[i].lcore, 0) !=
                     PQOS_RETVAL_OK)
                         ret = PQOS_RETVAL_ERROR;
 
+        if (ret == PQOS_RETVAL_OK && m_assoc != NULL)
+                m_assoc_synced = 1;
+
         return ret;
 }
 
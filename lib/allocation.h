@@ -98,6 +98,20 @@ PQOS_LOCAL int hw_alloc_assoc_write(const unsigned lcore,
  */
 PQOS_LOCAL int hw_alloc_assoc_read(const unsigned lcore, unsigned *class_id);
 
+/**
+ * @brief Reads associations of all cores into the shadow table
+ *
+ * The shadow is used by the MSR interface in place of association MSR
+ * reads. Nothing is done when there is no shadow.
+ *
+ * @param [out] changed set to 1 if shadow was out of date and has been
+ *              updated, 0 if it matched hardware or was not read before
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+PQOS_LOCAL int hw_alloc_assoc_resync(int *changed);
+
 /**
  * @brief Gets unused COS on a socket or L2 cluster
  *
@@ -39,6 +39,7 @@
 #include "hw_monitoring.h"
 #include "log.h"
 #include "monitoring.h"
+#include "monitoring_pool.h"
 #include "os_allocation.h"
 #include "os_monitoring.h"
 
@@ -60,6 +61,8 @@ static struct pqos_api {
         int (*mon_reset)(void);
         /** Reads RMID association lcore */
         int (*mon_assoc_get)(const unsigned lcore, pqos_rmid_t *rmid);
+        /** Checks RMID associations against hardware */
+        int (*mon_assoc_verify)(int *changed);
         /** Starts resource monitoring on selected group of cores */
         int (*mon_start)(const unsigned num_cores,
                          const unsigned *cores,
@@ -88,6 +91,11 @@ static struct pqos_api {
                                 struct pqos_mon_data *group);
         /** Stops resource monitoring data for selected monitoring group */
         int (*mon_stop)(struct pqos_mon_data *group);
+        /** Reads counters of monitoring groups in one batch */
+        int (*mon_poll_prefetch)(struct pqos_mon_data **groups,
+                                 const unsigned num_groups);
+        /** Updates tasks of monitored processes */
+        int (*mon_track)(void);
 
         /** Associates lcore with given class of service */
         int (*alloc_assoc_set)(const unsigned lcore, const unsigned class_id);
@@ -95,8 +103,18 @@ static struct pqos_api {
         int (*alloc_assoc_get)(const unsigned lcore, unsigned *class_id);
         /** Associate task with given class of service */
         int (*alloc_assoc_set_pid)(const pid_t task, const unsigned class_id);
+        /** Associate tasks with given class of service */
+        int (*alloc_assoc_set_pids)(const pid_t *tasks,
+                                    const unsigned num_tasks,
+                                    const unsigned class_id,
+                                    int *status);
         /** Read association of task with class of service */
         int (*alloc_assoc_get_pid)(const pid_t task, unsigned *class_id);
+        /** Reads association of tasks with classes of service */
+        int (*alloc_assoc_get_pids)(const pid_t *tasks,
+                                    const unsigned num_tasks,
+                                    unsigned *class_ids,
+                                    int *status);
         /** Assign first available COS */
         int (*alloc_assign)(const unsigned technology,
                             const unsigned *core_array,
@@ -105,6 +123,8 @@ static struct pqos_api {
         /** Reassign cores to default COS */
         int (*alloc_release)(const unsigned *core_array,
                              const unsigned core_num);
+        /** Reads COS associations from hardware again */
+        int (*alloc_assoc_resync)(int *changed);
         /** Assign first available COS to tasks */
         int (*alloc_assign_pid)(const unsigned technology,
                                 const pid_t *task_array,
@@ -176,12 +196,15 @@ api_init(int interface, enum pqos_vendor vendor)
         if (interface == PQOS_INTER_MSR) {
                 api.mon_reset = hw_mon_reset;
                 api.mon_assoc_get = hw_mon_assoc_get;
+                api.mon_assoc_verify = hw_mon_assoc_verify;
                 api.mon_start = hw_mon_start;
                 api.mon_stop = hw_mon_stop;
+                api.mon_poll_prefetch = hw_mon_poll_prefetch;
                 api.alloc_assoc_set = hw_alloc_assoc_set;
                 api.alloc_assoc_get = hw_alloc_assoc_get;
                 api.alloc_assign = hw_alloc_assign;
                 api.alloc_release = hw_alloc_release;
+                api.alloc_assoc_resync = hw_alloc_assoc_resync;
                 api.alloc_reset = hw_alloc_reset;
                 api.l3ca_set = hw_l3ca_set;
                 api.l3ca_get = hw_l3ca_get;
@@ -207,12 +230,18 @@ api_init(int interface, enum pqos_vendor vendor)
                 api.mon_add_pids = os_mon_add_pids;
                 api.mon_remove_pids = os_mon_remove_pids;
                 api.mon_stop = os_mon_stop;
+                api.mon_assoc_verify = os_mon_assoc_verify;
+                api.mon_poll_prefetch = os_mon_poll_prefetch;
+                api.mon_track = os_mon_track_poll;
                 api.alloc_assoc_set = os_alloc_assoc_set;
                 api.alloc_assoc_get = os_alloc_assoc_get;
                 api.alloc_assoc_set_pid = os_alloc_assoc_set_pid;
+                api.alloc_assoc_set_pids = os_alloc_assoc_set_pids;
                 api.alloc_assoc_get_pid = os_alloc_assoc_get_pid;
+                api.alloc_assoc_get_pids = os_alloc_assoc_get_pids;
                 api.alloc_assign = os_alloc_assign;
                 api.alloc_release = os_alloc_release;
+                api.alloc_assoc_resync = os_alloc_assoc_resync;
                 api.alloc_assign_pid = os_alloc_assign_pid;
                 api.alloc_release_pid = os_alloc_release_pid;
                 api.alloc_reset = os_alloc_reset;
@@ -286,6 +315,19 @@ pqos_alloc_assoc_set_pid(const pid_t task, const unsigned class_id)
         return API_CALL(alloc_assoc_set_pid, task, class_id);
 }
 
+int
+pqos_alloc_assoc_set_pids(const pid_t *tasks,
+                          const unsigned num_tasks,
+                          const unsigned class_id,
+                          int *status)
+{
+        if (tasks == NULL || num_tasks == 0)
+                return PQOS_RETVAL_PARAM;
+
+        return API_CALL(alloc_assoc_set_pids, tasks, num_tasks, class_id,
+                        status);
+}
+
 int
 pqos_alloc_assoc_get_pid(const pid_t task, unsigned *class_id)
 {
@@ -295,6 +337,19 @@ pqos_alloc_assoc_get_pid(const pid_t task, unsigned *class_id)
         return API_CALL(alloc_assoc_get_pid, task, class_id);
 }
 
+int
+pqos_alloc_assoc_get_pids(const pid_t *tasks,
+                          const unsigned num_tasks,
+                          unsigned *class_ids,
+                          int *status)
+{
+        if (tasks == NULL || num_tasks == 0 || class_ids == NULL)
+                return PQOS_RETVAL_PARAM;
+
+        return API_CALL(alloc_assoc_get_pids, tasks, num_tasks, class_ids,
+                        status);
+}
+
 int
 pqos_alloc_assign(const unsigned technology,
                   const unsigned *core_array,
@@ -322,6 +377,15 @@ pqos_alloc_release(const unsigned *core_array, const unsigned core_num)
         return API_CALL(alloc_release, core_array, core_num);
 }
 
+int
+pqos_alloc_assoc_resync(int *changed)
+{
+        if (changed == NULL)
+                return PQOS_RETVAL_PARAM;
+
+        return API_CALL(alloc_assoc_resync, changed);
+}
+
 int
 pqos_alloc_assign_pid(const unsigned technology,
                       const pid_t *task_array,
@@ -639,6 +703,15 @@ pqos_mon_assoc_get(const unsigned lcore, pqos_rmid_t *rmid)
         return API_CALL(mon_assoc_get, lcore, rmid);
 }
 
+int
+pqos_mon_assoc_verify(int *changed)
+{
+        if (changed == NULL)
+                return PQOS_RETVAL_PARAM;
+
+        return API_CALL(mon_assoc_verify, changed);
+}
+
 int
 pqos_mon_start(const unsigned num_cores,
                const unsigned *cores,
@@ -773,6 +846,19 @@ pqos_mon_poll(struct pqos_mon_data **groups, const unsigned num_groups)
                 return ret;
         }
 
+        if (mon_pool_enabled()) {
+                ret = mon_pool_poll(groups, num_groups);
+                _pqos_api_unlock();
+                return ret;
+        }
+
+        if (api.mon_track != NULL && api.mon_track() != PQOS_RETVAL_OK)
+                LOG_WARN("Failed to update monitored tasks\n");
+
+        if (api.mon_poll_prefetch != NULL &&
+            api.mon_poll_prefetch(groups, num_groups) != PQOS_RETVAL_OK)
+                LOG_WARN("Failed to prefetch monitoring counters\n");
+
         for (i = 0; i < num_groups; i++) {
                 int retval = pqos_mon_poll_events(groups[i]);
 
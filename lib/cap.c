@@ -62,6 +62,7 @@
 #include "os_cap.h"
 #include "resctrl.h"
 #include "resctrl_alloc.h"
+#include "snapshot.h"
 #include "utils.h"
 
 #include <fcntl.h> /* O_CREAT */
@@ -676,6 +677,72 @@ discover_interface(enum pqos_interface requested_interface,
         return PQOS_RETVAL_OK;
 }
 
+/**
+ * @brief Initializes CPU topology
+ *
+ * Topology is restored from the snapshot when one is available, otherwise
+ * it is detected.
+ *
+ * @param interface selected interface
+ * @param topology place to store pointer to CPU topology
+ *
+ * @return Operation status
+ * @retval 0 success
+ */
+static int
+cap_cpuinfo_init(enum pqos_interface interface,
+                 const struct pqos_cpuinfo **topology)
+{
+#ifdef __linux__
+        struct pqos_cpuinfo *cpu = NULL;
+
+        if (snapshot_init() == PQOS_RETVAL_OK &&
+            snapshot_get_cpu(&cpu) == PQOS_RETVAL_OK) {
+                if (cpuinfo_init_from(cpu, topology) == 0)
+                        return 0;
+                LOG_INFO("Snapshot topology rejected\n");
+                free(cpu);
+        }
+#endif
+        return cpuinfo_init(interface, topology);
+}
+
+/**
+ * @brief Discovers capabilities
+ *
+ * Capabilities are restored from the snapshot when it is still valid.
+ * Otherwise they are discovered and the snapshot is updated.
+ *
+ * @param[out] p_cap place to store allocated capabilities structure
+ * @param[in] cpu detected cpu topology
+ * @param[in] inter selected interface
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK success
+ */
+static int
+cap_discover(struct pqos_cap **p_cap,
+             const struct pqos_cpuinfo *cpu,
+             enum pqos_interface inter)
+{
+        int ret;
+
+#ifdef __linux__
+        ret = snapshot_get_cap(inter, cpu, p_cap);
+        snapshot_fini();
+        if (ret == PQOS_RETVAL_OK) {
+                LOG_INFO("Capabilities restored from snapshot\n");
+                return ret;
+        }
+#endif
+        ret = discover_capabilities(p_cap, cpu, inter);
+#ifdef __linux__
+        if (ret == PQOS_RETVAL_OK)
+                (void)snapshot_save(inter, *p_cap, cpu);
+#endif
+        return ret;
+}
+
 /*
  * =======================================
  * =======================================
@@ -726,7 +793,7 @@ pqos_init(const struct pqos_config *config)
          * Topology not provided through config.
          * CPU discovery done through internal mechanism.
          */
-        ret = cpuinfo_init(interface, &m_cpu);
+        ret = cap_cpuinfo_init(interface, &m_cpu);
         if (ret != 0 || m_cpu == NULL) {
                 LOG_ERROR("cpuinfo_init() error %d\n", ret);
                 ret = PQOS_RETVAL_ERROR;
@@ -760,7 +827,7 @@ pqos_init(const struct pqos_config *config)
                          "and cause unexpected behaviour\n");
 #endif
 
-        ret = discover_capabilities(&m_cap, m_cpu, interface);
+        ret = cap_discover(&m_cap, m_cpu, interface);
         if (ret != PQOS_RETVAL_OK) {
                 LOG_ERROR("discover_capabilities() error %d\n", ret);
                 goto machine_init_error;
@@ -828,8 +895,12 @@ cpuinfo_init_error:
         if (ret != PQOS_RETVAL_OK)
                 (void)cpuinfo_fini();
 log_init_error:
-        if (ret != PQOS_RETVAL_OK)
+        if (ret != PQOS_RETVAL_OK) {
+#ifdef __linux__
+                snapshot_fini();
+#endif
                 (void)log_fini();
+        }
 init_error:
         if (ret != PQOS_RETVAL_OK) {
                 if (m_cap != NULL) {
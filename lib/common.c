@@ -37,9 +37,11 @@
 #include "pqos.h"
 
 #include <ctype.h>
+#include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 FILE *
 pqos_fopen(const char *name, const char *mode)
@@ -83,6 +85,42 @@ pqos_fopen_error:
         return NULL;
 }
 
+int
+pqos_open(const char *name, int flags)
+{
+        int fd;
+        struct stat lstat_val;
+        struct stat fstat_val;
+
+        /* collect any link info about the file */
+        /* coverity[fs_check_call] */
+        if (lstat(name, &lstat_val) == -1)
+                return -1;
+
+        fd = open(name, flags);
+        if (fd == -1)
+                return -1;
+
+        /* collect info about the opened file */
+        if (fstat(fd, &fstat_val) == -1)
+                goto pqos_open_error;
+
+        /* we should not have followed a symbolic link */
+        if (lstat_val.st_mode != fstat_val.st_mode ||
+            lstat_val.st_ino != fstat_val.st_ino ||
+            lstat_val.st_dev != fstat_val.st_dev) {
+                LOG_ERROR("File %s is a symlink\n", name);
+                goto pqos_open_error;
+        }
+
+        return fd;
+
+pqos_open_error:
+        close(fd);
+
+        return -1;
+}
+
 int
 pqos_fclose(FILE *stream)
 {
@@ -61,6 +61,19 @@ extern "C" {
  */
 PQOS_LOCAL FILE *pqos_fopen(const char *name, const char *mode);
 
+/**
+ * @brief Wrapper around open() that additionally checks if a given path
+ * contains any symbolic links and fails if it does.
+ *
+ * @param [in] name a path to a file
+ * @param [in] flags file access flags
+ *
+ * @return File descriptor
+ * @retval A valid file descriptor or -1 on error (e.g. when the path
+ * contains any symbolic links).
+ */
+PQOS_LOCAL int pqos_open(const char *name, int flags);
+
 /**
  * @brief Wrapper around fclose()
  *
@@ -48,6 +48,7 @@
 #include <errno.h>
 #include <limits.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h> /* sysconf() */
 #ifdef __FreeBSD__
@@ -64,6 +65,11 @@
  */
 static struct pqos_cpuinfo *m_cpu = NULL;
 
+/**
+ * Topology indexes of m_cpu, NULL if not built
+ */
+static struct cpuinfo_index *m_index = NULL;
+
 /**
  * intel/amd vendor configuration
  */
@@ -418,16 +424,13 @@ detect_cpu(const int cpu,
 }
 
 /**
- * @brief Builds CPU topology structure
+ * @brief Builds CPU topology structure with CPUID
  *
- * - saves current task CPU affinity
  * - retrieves number of processors in the system
- * - detects information on APICID structure
  * - for each processor in the system:
  *      - change affinity to run only on the processor
  *      - read APICID of current processor with CPUID
  *      - retrieve package & cluster data from the APICID
- * - restores initial task CPU affinity
  *
  * @param [in] apic information about APICID structure
  *
@@ -435,17 +438,11 @@ detect_cpu(const int cpu,
  * @retval NULL on error
  */
 static struct pqos_cpuinfo *
-cpuinfo_build_topo(struct apic_info *apic)
+cpuinfo_build_topo_cpuid(const struct apic_info *apic)
 {
         int i, max_core_count;
         unsigned core_count = 0;
         struct pqos_cpuinfo *l_cpu = NULL;
-        cpu_set_t current_mask;
-
-        if (get_affinity(&current_mask) != 0) {
-                LOG_ERROR("Error retrieving CPU affinity mask!");
-                return NULL;
-        }
 
         max_core_count = sysconf(_SC_NPROCESSORS_CONF);
         if (max_core_count <= 0) {
@@ -461,28 +458,261 @@ cpuinfo_build_topo(struct apic_info *apic)
                 LOG_ERROR("Couldn't allocate CPU topology structure!");
                 return NULL;
         }
-        l_cpu->mem_size = (unsigned)mem_sz;
         memset(l_cpu, 0, mem_sz);
+        l_cpu->mem_size = (unsigned)mem_sz;
 
         for (i = 0; i < max_core_count; ++i)
                 if (detect_cpu(i, apic, &l_cpu->cores[core_count]) == 0)
                         core_count++;
 
-        if (set_affinity_mask(&current_mask) != 0) {
-                LOG_ERROR("Couldn't restore original CPU affinity mask!");
+        l_cpu->num_cores = core_count;
+        if (core_count == 0) {
+                free(l_cpu);
+                l_cpu = NULL;
+        }
+
+        return l_cpu;
+}
+
+#ifdef __linux__
+/**
+ * @brief Checks CPU topology read from sysfs against CPUID
+ *
+ * Only a sample of processors is checked: the first core of each socket
+ * and the last core. Their APICID based topology must match \a cpu.
+ *
+ * @param [in] cpu CPU topology structure
+ * @param [in] apic information about APICID structure
+ *
+ * @return Operation status
+ * @retval 0 topology matches
+ * @retval -1 topology differs or error
+ */
+static int
+cpuinfo_check_topo(const struct pqos_cpuinfo *cpu,
+                   const struct apic_info *apic)
+{
+        unsigned i, j;
+
+        for (i = 0; i < cpu->num_cores; i++) {
+                const struct pqos_coreinfo *core = &cpu->cores[i];
+                struct pqos_coreinfo info;
+
+                for (j = 0; j < i; j++)
+                        if (cpu->cores[j].socket == core->socket)
+                                break;
+                if (j < i && i + 1 < cpu->num_cores)
+                        continue;
+
+                if (detect_cpu(core->lcore, apic, &info) != 0)
+                        return -1;
+
+                if (info.socket != core->socket || info.l2_id != core->l2_id ||
+                    info.l3_id != core->l3_id) {
+                        LOG_INFO("Core %u topology differs, sysfs: socket %u "
+                                 "L2 ID %u L3 ID %u, CPUID: socket %u "
+                                 "L2 ID %u L3 ID %u\n",
+                                 core->lcore, core->socket, core->l2_id,
+                                 core->l3_id, info.socket, info.l2_id,
+                                 info.l3_id);
+                        return -1;
+                }
+        }
+
+        return 0;
+}
+
+/**
+ * @brief Builds CPU topology structure from sysfs
+ *
+ * Package and cache ids exported by Linux are derived from APICIDs the
+ * same way as by CPUID based detection, so they are used unless
+ * RDT_TOPO=CPUID is set or a CPUID sample doesn't match them.
+ *
+ * @param [in] apic information about APICID structure
+ *
+ * @return Pointer to CPU topology structure
+ * @retval NULL on error or mismatch
+ */
+static struct pqos_cpuinfo *
+cpuinfo_build_topo_sysfs(const struct apic_info *apic)
+{
+        struct pqos_cpuinfo *l_cpu;
+        const char *environment = getenv("RDT_TOPO");
+
+        if (environment != NULL && strcasecmp(environment, "CPUID") == 0)
+                return NULL;
+
+        l_cpu = os_cpuinfo_topology();
+        if (l_cpu == NULL)
+                return NULL;
+
+        if (cpuinfo_check_topo(l_cpu, apic) != 0) {
+                LOG_INFO("Sysfs CPU topology doesn't match CPUID, "
+                         "detecting with CPUID\n");
                 free(l_cpu);
                 return NULL;
         }
 
-        l_cpu->num_cores = core_count;
-        if (core_count == 0) {
+        return l_cpu;
+}
+#endif
+
+/**
+ * @brief Builds CPU topology structure
+ *
+ * - saves current task CPU affinity
+ * - reads the topology from sysfs and checks a sample of processors
+ *   with CPUID, if available
+ * - otherwise detects each processor with CPUID
+ * - restores initial task CPU affinity
+ *
+ * @param [in] apic information about APICID structure
+ *
+ * @return Pointer to CPU topology structure
+ * @retval NULL on error
+ */
+static struct pqos_cpuinfo *
+cpuinfo_build_topo(struct apic_info *apic)
+{
+        struct pqos_cpuinfo *l_cpu = NULL;
+        cpu_set_t current_mask;
+
+        if (get_affinity(&current_mask) != 0) {
+                LOG_ERROR("Error retrieving CPU affinity mask!");
+                return NULL;
+        }
+
+#ifdef __linux__
+        l_cpu = cpuinfo_build_topo_sysfs(apic);
+#endif
+        if (l_cpu == NULL)
+                l_cpu = cpuinfo_build_topo_cpuid(apic);
+
+        if (set_affinity_mask(&current_mask) != 0) {
+                LOG_ERROR("Couldn't restore original CPU affinity mask!");
                 free(l_cpu);
-                l_cpu = NULL;
+                return NULL;
         }
 
         return l_cpu;
 }
 
+/**
+ * @brief Builds core lists of topology object \a type
+ *
+ * Arrays of \a objs must hold cpu->num_cores entries, offset one more.
+ *
+ * @param [in] cpu CPU topology structure
+ * @param [in] type topology object type
+ * @param [out] objs core lists to fill in
+ */
+static void
+cpuinfo_build_objs(const struct pqos_cpuinfo *cpu,
+                   const enum cpuinfo_obj type,
+                   struct cpuinfo_objs *objs)
+{
+        unsigned i, j;
+
+        /* object ids in order of their first core, cores counted */
+        objs->num = 0;
+        for (i = 0; i < cpu->num_cores; i++) {
+                const unsigned id = cpuinfo_obj_id(&cpu->cores[i], type);
+
+                for (j = 0; j < objs->num; j++)
+                        if (objs->ids[j] == id)
+                                break;
+                if (j == objs->num) {
+                        objs->ids[objs->num] = id;
+                        objs->offset[objs->num + 1] = 0;
+                        objs->num++;
+                }
+                objs->offset[j + 1]++;
+        }
+
+        objs->offset[0] = 0;
+        for (j = 0; j < objs->num; j++)
+                objs->offset[j + 1] += objs->offset[j];
+
+        /*
+         * cores are kept in cores[] order within an object,
+         * sorted[] holds the next free entry of each object meanwhile
+         */
+        for (j = 0; j < objs->num; j++)
+                objs->sorted[j] = objs->offset[j];
+        for (i = 0; i < cpu->num_cores; i++) {
+                const unsigned id = cpuinfo_obj_id(&cpu->cores[i], type);
+
+                for (j = 0; objs->ids[j] != id; j++)
+                        ;
+                objs->lcores[objs->sorted[j]++] = cpu->cores[i].lcore;
+        }
+
+        /* insertion sort, there are few objects */
+        for (j = 0; j < objs->num; j++) {
+                unsigned k = j;
+
+                while (k > 0 && objs->ids[objs->sorted[k - 1]] > objs->ids[j]) {
+                        objs->sorted[k] = objs->sorted[k - 1];
+                        k--;
+                }
+                objs->sorted[k] = j;
+        }
+}
+
+/**
+ * @brief Builds topology indexes of \a cpu
+ *
+ * All arrays are kept in one memory block following the index.
+ *
+ * @param [in] cpu CPU topology structure
+ *
+ * @return Topology indexes
+ * @retval NULL on error
+ */
+static struct cpuinfo_index *
+cpuinfo_build_index(const struct pqos_cpuinfo *cpu)
+{
+        const unsigned num = cpu->num_cores;
+        struct cpuinfo_index *index;
+        unsigned num_pos = 0;
+        unsigned *mem;
+        unsigned i;
+        int type;
+
+        for (i = 0; i < num; i++)
+                if (cpu->cores[i].lcore >= num_pos)
+                        num_pos = cpu->cores[i].lcore + 1;
+
+        index = malloc(sizeof(*index) +
+                       ((CPUINFO_OBJ_NUM * (4 * num + 1)) + num_pos) *
+                           sizeof(unsigned));
+        if (index == NULL)
+                return NULL;
+
+        mem = (unsigned *)(index + 1);
+        for (type = 0; type < CPUINFO_OBJ_NUM; type++) {
+                struct cpuinfo_objs *objs = &index->objs[type];
+
+                objs->ids = mem;
+                objs->sorted = objs->ids + num;
+                objs->offset = objs->sorted + num;
+                objs->lcores = objs->offset + num + 1;
+                mem = objs->lcores + num;
+
+                cpuinfo_build_objs(cpu, (enum cpuinfo_obj)type, objs);
+        }
+
+        index->num_pos = num_pos;
+        index->core_pos = mem;
+        for (i = 0; i < num_pos; i++)
+                index->core_pos[i] = UINT_MAX;
+        for (i = 0; i < num; i++)
+                index->core_pos[cpu->cores[i].lcore] = i;
+
+        return index;
+}
+
 /**
  * @brief Detects and returns the CPU vendor
  *
@@ -611,6 +841,44 @@ cpuinfo_init(enum pqos_interface interface,
                 }
         }
 
+        m_index = cpuinfo_build_index(m_cpu);
+        if (m_index == NULL) {
+                LOG_ERROR("Couldn't allocate CPU topology indexes!\n");
+                free(m_cpu);
+                m_cpu = NULL;
+                return -EFAULT;
+        }
+
+        *topology = m_cpu;
+        return 0;
+}
+
+int
+cpuinfo_init_from(struct pqos_cpuinfo *cpu,
+                  const struct pqos_cpuinfo **topology)
+{
+        int ret;
+
+        if (cpu == NULL || topology == NULL)
+                return -EINVAL;
+
+        if (m_cpu != NULL)
+                return -EPERM;
+
+        if (detect_vendor() != cpu->vendor)
+                return -EFAULT;
+
+        ret = init_config(&m_config, cpu->vendor);
+        if (ret != 0)
+                return ret;
+
+        m_index = cpuinfo_build_index(cpu);
+        if (m_index == NULL) {
+                LOG_ERROR("Couldn't allocate CPU topology indexes!\n");
+                return -EFAULT;
+        }
+
+        m_cpu = cpu;
         *topology = m_cpu;
         return 0;
 }
@@ -620,11 +888,62 @@ cpuinfo_fini(void)
 {
         if (m_cpu == NULL)
                 return -EPERM;
+        free(m_index);
+        m_index = NULL;
         free(m_cpu);
         m_cpu = NULL;
         return 0;
 }
 
+unsigned
+cpuinfo_obj_id(const struct pqos_coreinfo *info, const enum cpuinfo_obj type)
+{
+        switch (type) {
+        case CPUINFO_OBJ_SOCKET:
+                return info->socket;
+        case CPUINFO_OBJ_L3:
+                return info->l3_id;
+        case CPUINFO_OBJ_L2:
+                return info->l2_id;
+        case CPUINFO_OBJ_L3CAT:
+                return info->l3cat_id;
+        case CPUINFO_OBJ_MBA:
+                return info->mba_id;
+        default:
+                ASSERT(0);
+                return 0;
+        }
+}
+
+const struct cpuinfo_index *
+cpuinfo_get_index(const struct pqos_cpuinfo *cpu)
+{
+        if (cpu == NULL || cpu != m_cpu)
+                return NULL;
+
+        return m_index;
+}
+
+unsigned
+cpuinfo_objs_find(const struct cpuinfo_objs *objs, const unsigned id)
+{
+        unsigned lo = 0, hi = objs->num;
+
+        while (lo < hi) {
+                const unsigned mid = lo + (hi - lo) / 2;
+                const unsigned mid_id = objs->ids[objs->sorted[mid]];
+
+                if (mid_id == id)
+                        return objs->sorted[mid];
+                if (mid_id < id)
+                        lo = mid + 1;
+                else
+                        hi = mid;
+        }
+
+        return UINT_MAX;
+}
+
 void
 cpuinfo_get_config(const struct cpuinfo_config **config)
 {
@@ -57,6 +57,40 @@ struct cpuinfo_config {
         uint32_t mba_msr_reg;     /**< MBA mask base register */
 };
 
+/**
+ * Topology objects with precomputed core lists
+ */
+enum cpuinfo_obj {
+        CPUINFO_OBJ_SOCKET = 0, /**< socket id */
+        CPUINFO_OBJ_L3,         /**< L3/LLC cluster id */
+        CPUINFO_OBJ_L2,         /**< L2 cluster id */
+        CPUINFO_OBJ_L3CAT,      /**< L3 CAT classes id */
+        CPUINFO_OBJ_MBA,        /**< MBA id */
+        CPUINFO_OBJ_NUM
+};
+
+/**
+ * Cores of one topology object type in compressed sparse row form.
+ * Cores of object \a ids[i] are lcores[offset[i]] .. lcores[offset[i + 1] - 1]
+ */
+struct cpuinfo_objs {
+        unsigned num;      /**< number of objects */
+        unsigned *ids;     /**< object ids, ordered by their first core */
+        unsigned *sorted;  /**< positions in \a ids, ordered by object id */
+        unsigned *offset;  /**< start of object cores, \a num + 1 entries */
+        unsigned *lcores;  /**< cores grouped by object */
+};
+
+/**
+ * Topology indexes, built once by cpuinfo_init()
+ */
+struct cpuinfo_index {
+        struct cpuinfo_objs objs[CPUINFO_OBJ_NUM];
+        unsigned num_pos;  /**< number of entries in \a core_pos */
+        unsigned *core_pos; /**< position in cores[] of lcore, UINT_MAX if
+                                 there is no such core */
+};
+
 /**
  * @brief Initializes CPU information module
  *
@@ -74,6 +108,25 @@ struct cpuinfo_config {
 PQOS_LOCAL int cpuinfo_init(enum pqos_interface interface,
                             const struct pqos_cpuinfo **topology);
 
+/**
+ * @brief Initializes CPU information module with known topology
+ *
+ * Used when topology is restored from a snapshot instead of detected.
+ * The module takes ownership of \a cpu on success.
+ *
+ * @param [in] cpu CPU topology allocated with malloc()
+ * @param [out] topology place to store pointer to CPU topology data
+ *
+ * @return Operation status
+ * @retval 0 success
+ * @retval -EINVAL invalid argument
+ * @retval -EPERM cpuinfo already initialized
+ * @retval -EFAULT topology doesn't match the CPU vendor or error
+ *                 building topology indexes
+ */
+PQOS_LOCAL int cpuinfo_init_from(struct pqos_cpuinfo *cpu,
+                                 const struct pqos_cpuinfo **topology);
+
 /**
  * @brief Shuts down CPU information module
  *
@@ -90,6 +143,40 @@ PQOS_LOCAL int cpuinfo_fini(void);
  */
 PQOS_LOCAL void cpuinfo_get_config(const struct cpuinfo_config **config);
 
+/**
+ * @brief Retrieves id of topology object \a type the core belongs to
+ *
+ * @param [in] info core information
+ * @param [in] type topology object type
+ *
+ * @return Object id
+ */
+PQOS_LOCAL unsigned cpuinfo_obj_id(const struct pqos_coreinfo *info,
+                                   const enum cpuinfo_obj type);
+
+/**
+ * @brief Retrieves topology indexes of \a cpu
+ *
+ * @param [in] cpu CPU topology structure
+ *
+ * @return Indexes of \a cpu
+ * @retval NULL \a cpu is not the topology built by cpuinfo_init()
+ */
+PQOS_LOCAL const struct cpuinfo_index *
+cpuinfo_get_index(const struct pqos_cpuinfo *cpu);
+
+/**
+ * @brief Finds position of object \a id in \a objs
+ *
+ * @param [in] objs objects of one type
+ * @param [in] id object id
+ *
+ * @return Position of the object in objs->ids
+ * @retval UINT_MAX no such object
+ */
+PQOS_LOCAL unsigned cpuinfo_objs_find(const struct cpuinfo_objs *objs,
+                                      const unsigned id);
+
 #ifdef __cplusplus
 }
 #endif
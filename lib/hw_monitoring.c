@@ -48,6 +48,7 @@
 #include "perf_monitoring.h"
 #include "uncore_monitoring.h"
 
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -65,18 +66,64 @@
  */
 #define RMID0 (0)
 
+/**
+ * Number of RMIDs in one word of the RMID bitmaps
+ */
+#define RMID_WORD_BITS (sizeof(uint64_t) * 8)
+
 /**
  * ---------------------------------------
  * Local data types
  * ---------------------------------------
  */
 
+/**
+ * Shadow of the RMID associations of one monitoring cluster
+ *
+ * Built from hardware on first RMID allocation in the cluster and kept
+ * up to date by hw_mon_assoc_write(). RMIDs no core is associated with
+ * are set in the \a free bitmap. Released RMIDs may still hold cache
+ * occupancy of the previous group and stay in \a limbo until their
+ * occupancy is found drained.
+ */
+struct rmid_cluster {
+        unsigned id;        /**< cluster (L3) id */
+        unsigned lcore;     /**< core of the cluster to read counters on */
+        int synced;         /**< associations were read from hardware */
+        unsigned *refcnt;   /**< number of cores associated with each RMID */
+        uint64_t *free;     /**< bitmap of RMIDs not associated with cores */
+        uint64_t *limbo;    /**< bitmap of released RMIDs not drained yet */
+        uint64_t *released; /**< release sequence of each RMID, LRU order */
+};
+
+/**
+ * Released RMID waiting in limbo
+ */
+struct rmid_limbo {
+        uint64_t seq;     /**< release sequence */
+        pqos_rmid_t rmid; /**< RMID */
+};
+
+/**
+ * Shadow RMID association of a core
+ */
+struct rmid_core {
+        unsigned cluster; /**< index in m_clusters, UINT_MAX if no such core */
+        pqos_rmid_t rmid; /**< RMID the core is associated with */
+};
+
 /**
  * ---------------------------------------
  * Local data structures
  * ---------------------------------------
  */
 static unsigned m_rmid_max = 0; /**< max RMID */
+static struct rmid_cluster *m_clusters = NULL; /**< shadow RMID tables */
+static unsigned m_num_clusters = 0;
+static struct rmid_core *m_cores = NULL; /**< shadow associations by lcore */
+static unsigned m_num_lcores = 0;
+static uint64_t m_release_seq = 0; /**< RMID release counter */
+static uint64_t m_limbo_threshold = 0; /**< occupancy of a drained RMID */
 #ifdef PQOS_RMID_CUSTOM
 /* clang-format off */
 /** Custom RMID configuration */
@@ -102,6 +149,14 @@ static unsigned get_event_id(const enum pqos_mon_event event);
 static uint64_t scale_event(const enum pqos_mon_event event,
                             const uint64_t val);
 
+static int rmid_shadow_init(const struct pqos_cpuinfo *cpu);
+
+static void rmid_shadow_fini(void);
+
+static void rmid_shadow_set(const unsigned lcore, const pqos_rmid_t rmid);
+
+static void rmid_shadow_check(const unsigned lcore, const pqos_rmid_t rmid);
+
 /*
  * =======================================
  * =======================================
@@ -120,8 +175,6 @@ hw_mon_init(const struct pqos_cpuinfo *cpu,
         int ret;
         const struct pqos_capability *item = NULL;
 
-        UNUSED_PARAM(cpu);
-
         ret = pqos_cap_get_type(cap, PQOS_CAP_TYPE_MON, &item);
         if (ret != PQOS_RETVAL_OK)
                 return PQOS_RETVAL_RESOURCE;
@@ -133,6 +186,10 @@ hw_mon_init(const struct pqos_cpuinfo *cpu,
         }
         LOG_DEBUG("Max RMID per monitoring cluster is %u\n", m_rmid_max);
 
+        ret = rmid_shadow_init(cpu);
+        if (ret != PQOS_RETVAL_OK)
+                goto hw_mon_init_exit;
+
 #ifdef __linux__
         ret = perf_mon_init(cpu, cap);
         if (ret != PQOS_RETVAL_RESOURCE && ret != PQOS_RETVAL_OK)
@@ -182,6 +239,7 @@ hw_mon_init_exit:
 int
 hw_mon_fini(void)
 {
+        rmid_shadow_fini();
         m_rmid_max = 0;
 
         uncore_mon_fini();
@@ -272,7 +330,344 @@ rmid_get_event_max(const struct pqos_cap *cap,
 }
 
 /**
- * @brief Get used RMIDs on ctx->cluster
+ * @brief Allocates shadow RMID tables of all monitoring clusters
+ *
+ * Associations are not read here, each cluster is read from hardware
+ * on first RMID allocation in it.
+ *
+ * @param [in] cpu CPU topology
+ *
+ * @return Operations status
+ */
+static int
+rmid_shadow_init(const struct pqos_cpuinfo *cpu)
+{
+        const unsigned words = (m_rmid_max + RMID_WORD_BITS - 1) /
+                               RMID_WORD_BITS;
+        unsigned i, j;
+
+        if (cpu == NULL)
+                return PQOS_RETVAL_PARAM;
+
+        m_num_lcores = 0;
+        for (i = 0; i < cpu->num_cores; i++)
+                if (cpu->cores[i].lcore >= m_num_lcores)
+                        m_num_lcores = cpu->cores[i].lcore + 1;
+
+        m_cores = (struct rmid_core *)malloc(sizeof(m_cores[0]) *
+                                             m_num_lcores);
+        m_clusters = (struct rmid_cluster *)calloc(cpu->num_cores,
+                                                   sizeof(m_clusters[0]));
+        if (m_cores == NULL || m_clusters == NULL)
+                return PQOS_RETVAL_RESOURCE;
+
+        for (i = 0; i < m_num_lcores; i++) {
+                m_cores[i].cluster = UINT_MAX;
+                m_cores[i].rmid = RMID0;
+        }
+
+        for (i = 0; i < cpu->num_cores; i++) {
+                const struct pqos_coreinfo *core = &cpu->cores[i];
+                struct rmid_cluster *cluster;
+
+                for (j = 0; j < m_num_clusters; j++)
+                        if (m_clusters[j].id == core->l3_id)
+                                break;
+                m_cores[core->lcore].cluster = j;
+                if (j < m_num_clusters)
+                        continue;
+
+                cluster = &m_clusters[m_num_clusters++];
+                cluster->id = core->l3_id;
+                cluster->lcore = core->lcore;
+                cluster->refcnt = (unsigned *)calloc(m_rmid_max,
+                                                     sizeof(unsigned));
+                cluster->free = (uint64_t *)calloc(words, sizeof(uint64_t));
+                cluster->limbo = (uint64_t *)calloc(words, sizeof(uint64_t));
+                cluster->released =
+                    (uint64_t *)calloc(m_rmid_max, sizeof(uint64_t));
+                if (cluster->refcnt == NULL || cluster->free == NULL ||
+                    cluster->limbo == NULL || cluster->released == NULL)
+                        return PQOS_RETVAL_RESOURCE;
+        }
+
+        /* occupancy left by a released RMID is drained below its share */
+        m_limbo_threshold = cpu->l3.detected && cpu->l3.total_size > 0
+                                ? cpu->l3.total_size / m_rmid_max
+                                : 0;
+
+        return PQOS_RETVAL_OK;
+}
+
+/**
+ * @brief Frees shadow RMID tables
+ */
+static void
+rmid_shadow_fini(void)
+{
+        unsigned i;
+
+        if (m_clusters != NULL) {
+                for (i = 0; i < m_num_clusters; i++) {
+                        free(m_clusters[i].refcnt);
+                        free(m_clusters[i].free);
+                        free(m_clusters[i].limbo);
+                        free(m_clusters[i].released);
+                }
+                free(m_clusters);
+        }
+        if (m_cores != NULL)
+                free(m_cores);
+
+        m_clusters = NULL;
+        m_num_clusters = 0;
+        m_cores = NULL;
+        m_num_lcores = 0;
+}
+
+/**
+ * @brief Finds shadow RMID table of \a cluster
+ *
+ * @param [in] cluster cluster (L3) id
+ *
+ * @return shadow table or NULL if there is no such cluster
+ */
+static struct rmid_cluster *
+rmid_cluster_get(const unsigned cluster)
+{
+        unsigned i;
+
+        for (i = 0; i < m_num_clusters; i++)
+                if (m_clusters[i].id == cluster)
+                        return &m_clusters[i];
+
+        return NULL;
+}
+
+/**
+ * @brief Reads RMID associations of all cores of \a cluster from hardware
+ *
+ * RMIDs that became used are taken out of limbo, limbo state of other
+ * RMIDs is kept.
+ *
+ * @param [in,out] cluster shadow RMID table
+ *
+ * @return Operations status
+ */
+static int
+rmid_cluster_sync(struct rmid_cluster *cluster)
+{
+        const unsigned idx = (unsigned)(cluster - m_clusters);
+        const unsigned words = (m_rmid_max + RMID_WORD_BITS - 1) /
+                               RMID_WORD_BITS;
+        unsigned i;
+
+        memset(cluster->refcnt, 0, sizeof(unsigned) * m_rmid_max);
+
+        for (i = 0; i < m_num_lcores; i++) {
+                pqos_rmid_t rmid;
+                int ret;
+
+                if (m_cores[i].cluster != idx)
+                        continue;
+
+                ret = hw_mon_assoc_read(i, &rmid);
+                if (ret != PQOS_RETVAL_OK) {
+                        cluster->synced = 0;
+                        return ret;
+                }
+                m_cores[i].rmid = rmid;
+                if (rmid < m_rmid_max)
+                        cluster->refcnt[rmid]++;
+        }
+
+        memset(cluster->free, 0, sizeof(uint64_t) * words);
+        for (i = 0; i < m_rmid_max; i++)
+                if (cluster->refcnt[i] == 0)
+                        cluster->free[i / RMID_WORD_BITS] |=
+                            1ULL << (i % RMID_WORD_BITS);
+        for (i = 0; i < words; i++)
+                cluster->limbo[i] &= cluster->free[i];
+
+        cluster->synced = 1;
+        return PQOS_RETVAL_OK;
+}
+
+/**
+ * @brief Records \a lcore association with \a rmid in the shadow table
+ *
+ * RMID released by its last core enters limbo.
+ *
+ * @param [in] lcore logical core id
+ * @param [in] rmid RMID written to the core
+ */
+static void
+rmid_shadow_set(const unsigned lcore, const pqos_rmid_t rmid)
+{
+        struct rmid_cluster *cluster;
+        pqos_rmid_t old;
+
+        if (m_cores == NULL || lcore >= m_num_lcores ||
+            m_cores[lcore].cluster == UINT_MAX)
+                return;
+
+        cluster = &m_clusters[m_cores[lcore].cluster];
+        old = m_cores[lcore].rmid;
+        m_cores[lcore].rmid = rmid;
+        if (!cluster->synced || old == rmid)
+                return;
+
+        if (old < m_rmid_max && cluster->refcnt[old] > 0 &&
+            --cluster->refcnt[old] == 0) {
+                const uint64_t bit = 1ULL << (old % RMID_WORD_BITS);
+
+                cluster->free[old / RMID_WORD_BITS] |= bit;
+                if (old != RMID0) {
+                        cluster->limbo[old / RMID_WORD_BITS] |= bit;
+                        cluster->released[old] = ++m_release_seq;
+                }
+        }
+        if (rmid < m_rmid_max && cluster->refcnt[rmid]++ == 0) {
+                const uint64_t bit = 1ULL << (rmid % RMID_WORD_BITS);
+
+                cluster->free[rmid / RMID_WORD_BITS] &= ~bit;
+                cluster->limbo[rmid / RMID_WORD_BITS] &= ~bit;
+        }
+}
+
+/**
+ * @brief Compares \a lcore association read from hardware with the shadow
+ *
+ * On mismatch the cluster of the core is read again on next allocation.
+ *
+ * @param [in] lcore logical core id
+ * @param [in] rmid RMID read from hardware
+ */
+static void
+rmid_shadow_check(const unsigned lcore, const pqos_rmid_t rmid)
+{
+        struct rmid_cluster *cluster;
+
+        if (m_cores == NULL || lcore >= m_num_lcores ||
+            m_cores[lcore].cluster == UINT_MAX)
+                return;
+
+        cluster = &m_clusters[m_cores[lcore].cluster];
+        if (cluster->synced && m_cores[lcore].rmid != rmid) {
+                LOG_DEBUG("Core %u RMID association changed from %u to %u "
+                          "outside of the library\n",
+                          lcore, m_cores[lcore].rmid, rmid);
+                cluster->synced = 0;
+        }
+}
+
+/**
+ * @brief Checks if cache occupancy of a released RMID has drained
+ *
+ * @param [in] cluster shadow RMID table
+ * @param [in] rmid RMID in limbo
+ *
+ * @return 1 if occupancy is below the limbo threshold, 0 otherwise
+ */
+static int
+rmid_drained(const struct rmid_cluster *cluster, const pqos_rmid_t rmid)
+{
+        const struct pqos_cap *cap = _pqos_get_cap();
+        const struct pqos_monitor *pmon = NULL;
+        uint64_t value = 0;
+        int ret;
+
+        ret = pqos_cap_get_event(cap, PQOS_MON_EVENT_L3_OCCUP, &pmon);
+        if (ret != PQOS_RETVAL_OK)
+                /* without occupancy monitoring nothing is left to drain */
+                return 1;
+
+        ret = hw_mon_read(cluster->lcore, rmid,
+                          get_event_id(PQOS_MON_EVENT_L3_OCCUP), &value);
+        if (ret != PQOS_RETVAL_OK)
+                return 0;
+
+        return value * pmon->scale_factor <= m_limbo_threshold;
+}
+
+/**
+ * @brief Orders limbo RMIDs from the least recently released
+ */
+static int
+rmid_limbo_cmp(const void *a, const void *b)
+{
+        const struct rmid_limbo *la = (const struct rmid_limbo *)a;
+        const struct rmid_limbo *lb = (const struct rmid_limbo *)b;
+
+        return (la->seq > lb->seq) - (la->seq < lb->seq);
+}
+
+/**
+ * @brief Picks free RMID below \a max_rmid in \a cluster
+ *
+ * The lowest RMID not in limbo is preferred. Otherwise the least
+ * recently released RMID whose occupancy has drained is taken, and
+ * when none has drained yet, the least recently released one.
+ *
+ * @param [in,out] cluster shadow RMID table
+ * @param [in] max_rmid RMID limit of the requested events
+ *
+ * @return RMID or RMID0 if all RMIDs are used
+ */
+static pqos_rmid_t
+rmid_cluster_alloc(struct rmid_cluster *cluster, const unsigned max_rmid)
+{
+        const unsigned words = (max_rmid + RMID_WORD_BITS - 1) /
+                               RMID_WORD_BITS;
+        struct rmid_limbo lru[max_rmid];
+        unsigned num = 0;
+        pqos_rmid_t rmid;
+        unsigned i;
+
+        for (i = 0; i < words; i++) {
+                uint64_t bits = cluster->free[i] & ~cluster->limbo[i];
+
+                if (i == 0)
+                        bits &= ~1ULL; /* RMID0 */
+                if (i == words - 1 && max_rmid % RMID_WORD_BITS != 0)
+                        bits &= (1ULL << (max_rmid % RMID_WORD_BITS)) - 1;
+                if (bits != 0)
+                        return (pqos_rmid_t)(i * RMID_WORD_BITS +
+                                             __builtin_ctzll(bits));
+        }
+
+        /* All unused RMIDs are in limbo, check them from the oldest */
+        for (i = 1; i < max_rmid; i++)
+                if (cluster->limbo[i / RMID_WORD_BITS] &
+                    (1ULL << (i % RMID_WORD_BITS))) {
+                        lru[num].seq = cluster->released[i];
+                        lru[num].rmid = (pqos_rmid_t)i;
+                        num++;
+                }
+        if (num == 0)
+                return RMID0;
+
+        qsort(lru, num, sizeof(lru[0]), rmid_limbo_cmp);
+        for (i = 0; i < num; i++)
+                if (rmid_drained(cluster, lru[i].rmid))
+                        break;
+        if (i >= num) {
+                LOG_DEBUG("No drained RMID in cluster %u, reusing RMID%u\n",
+                          cluster->id, lru[0].rmid);
+                i = 0;
+        }
+        rmid = lru[i].rmid;
+
+        cluster->limbo[rmid / RMID_WORD_BITS] &=
+            ~(1ULL << (rmid % RMID_WORD_BITS));
+        return rmid;
+}
+
+/**
+ * @brief Get unused RMID on ctx->cluster
+ *
+ * RMID is taken from the shadow RMID table of the cluster, hardware
+ * associations are only read the first time the cluster is used.
  *
  * @param [in,out] ctx poll context
  * @param [in] event Monitoring event type
@@ -283,13 +678,11 @@ int
 hw_mon_assoc_unused(struct pqos_mon_poll_ctx *ctx,
                     const enum pqos_mon_event event)
 {
-        const struct pqos_cpuinfo *cpu = _pqos_get_cpu();
         const struct pqos_cap *cap = _pqos_get_cap();
+        struct rmid_cluster *cluster;
         int ret = PQOS_RETVAL_OK;
         unsigned max_rmid = 0;
-        unsigned *core_list = NULL;
-        unsigned i, core_count;
-        pqos_rmid_t *rmid_list = NULL;
+        pqos_rmid_t rmid;
 
         ASSERT(ctx != NULL);
 
@@ -298,45 +691,75 @@ hw_mon_assoc_unused(struct pqos_mon_poll_ctx *ctx,
         if (ret != PQOS_RETVAL_OK)
                 return ret;
 
-        /**
-         * Check for free RMID in the cluster by reading current associations.
-         */
-        core_list = pqos_cpu_get_cores_l3id(cpu, ctx->cluster, &core_count);
-        if (core_list == NULL)
+        cluster = rmid_cluster_get(ctx->cluster);
+        if (cluster == NULL)
                 return PQOS_RETVAL_ERROR;
-        ASSERT(core_count > 0);
-        rmid_list = (pqos_rmid_t *)malloc(sizeof(rmid_list[0]) * core_count);
-        if (rmid_list == NULL) {
-                ret = PQOS_RETVAL_RESOURCE;
-                goto rmid_alloc_error;
-        }
 
-        for (i = 0; i < core_count; i++) {
-                ret = hw_mon_assoc_read(core_list[i], &rmid_list[i]);
+        if (!cluster->synced) {
+                ret = rmid_cluster_sync(cluster);
                 if (ret != PQOS_RETVAL_OK)
-                        goto rmid_alloc_error;
+                        return ret;
         }
 
-        ret = PQOS_RETVAL_ERROR;
-        for (i = 1; i < max_rmid; i++) {
-                unsigned j = 0;
+        rmid = rmid_cluster_alloc(cluster, max_rmid);
+        if (rmid == RMID0)
+                return PQOS_RETVAL_ERROR;
 
-                for (j = 0; j < core_count; j++)
-                        if (i == rmid_list[j])
-                                break;
-                if (j >= core_count) {
-                        ret = PQOS_RETVAL_OK;
-                        ctx->rmid = i;
-                        break;
-                }
+        ctx->rmid = rmid;
+        return PQOS_RETVAL_OK;
+}
+
+int
+hw_mon_assoc_verify(int *changed)
+{
+        int stale[m_num_clusters];
+        unsigned i;
+
+        ASSERT(changed != NULL);
+
+        if (m_cores == NULL)
+                return PQOS_RETVAL_INIT;
+
+        memset(stale, 0, sizeof(stale));
+        *changed = 0;
+
+        for (i = 0; i < m_num_lcores; i++) {
+                struct rmid_cluster *cluster;
+                pqos_rmid_t rmid;
+                int retval;
+
+                if (m_cores[i].cluster == UINT_MAX)
+                        continue;
+                cluster = &m_clusters[m_cores[i].cluster];
+                if (!cluster->synced)
+                        continue;
+
+                retval = hw_mon_assoc_read(i, &rmid);
+                if (retval != PQOS_RETVAL_OK)
+                        return retval;
+                if (rmid == m_cores[i].rmid)
+                        continue;
+
+                LOG_WARN("Core %u RMID association changed from %u to %u "
+                         "outside of the library\n",
+                         i, m_cores[i].rmid, rmid);
+                cluster->synced = 0;
+                stale[m_cores[i].cluster] = 1;
+                *changed = 1;
         }
 
-rmid_alloc_error:
-        if (rmid_list != NULL)
-                free(rmid_list);
-        if (core_list != NULL)
-                free(core_list);
-        return ret;
+        /* read again clusters found out of date */
+        for (i = 0; i < m_num_clusters; i++) {
+                int retval;
+
+                if (!stale[i])
+                        continue;
+                retval = rmid_cluster_sync(&m_clusters[i]);
+                if (retval != PQOS_RETVAL_OK)
+                        return retval;
+        }
+
+        return PQOS_RETVAL_OK;
 }
 
 #ifdef PQOS_RMID_CUSTOM
@@ -432,6 +855,9 @@ hw_mon_assoc_write(const unsigned lcore, const pqos_rmid_t rmid)
         if (ret != MACHINE_RETVAL_OK)
                 return PQOS_RETVAL_ERROR;
 
+        /* association changed behind the library, shadow is out of date */
+        rmid_shadow_check(lcore, (pqos_rmid_t)(val & PQOS_MSR_ASSOC_RMID_MASK));
+
         val &= PQOS_MSR_ASSOC_QECOS_MASK;
         val |= (uint64_t)(rmid & PQOS_MSR_ASSOC_RMID_MASK);
 
@@ -439,6 +865,8 @@ hw_mon_assoc_write(const unsigned lcore, const pqos_rmid_t rmid)
         if (ret != MACHINE_RETVAL_OK)
                 return PQOS_RETVAL_ERROR;
 
+        rmid_shadow_set(lcore, rmid);
+
         return PQOS_RETVAL_OK;
 }
 
@@ -565,6 +993,223 @@ hw_mon_read(const unsigned lcore,
         return retval;
 }
 
+/**
+ * @brief Queues event selection and counter read of \a ctx in MSR batch
+ *
+ * Both operations are executed back to back on the context core.
+ *
+ * @param [in,out] batch MSR batch
+ * @param [in] ctx poll context
+ * @param [in] event MSR event id
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+hw_mon_batch_add(struct msr_batch *batch,
+                 const struct pqos_mon_poll_ctx *ctx,
+                 const unsigned event)
+{
+        uint64_t val_evtsel;
+
+        val_evtsel = ((uint64_t)ctx->rmid) & PQOS_MSR_MON_EVTSEL_RMID_MASK;
+        val_evtsel <<= PQOS_MSR_MON_EVTSEL_RMID_SHIFT;
+        val_evtsel |= ((uint64_t)event) & PQOS_MSR_MON_EVTSEL_EVTID_MASK;
+
+        if (msr_batch_add(batch, ctx->lcore, ctx->cluster, MSR_OP_WRITE,
+                          PQOS_MSR_MON_EVTSEL,
+                          val_evtsel) != MACHINE_RETVAL_OK ||
+            msr_batch_add(batch, ctx->lcore, ctx->cluster, MSR_OP_READ,
+                          PQOS_MSR_MON_QMC, 0) != MACHINE_RETVAL_OK)
+                return PQOS_RETVAL_ERROR;
+
+        return PQOS_RETVAL_OK;
+}
+
+/**
+ * @brief Gets counter value from operations queued by hw_mon_batch_add()
+ *
+ * Counter that is not ready is read again by hw_mon_read() that
+ * implements retry logic.
+ *
+ * @param [in] ops event selection and counter read operations
+ * @param [in] ctx poll context
+ * @param [in] event MSR event id
+ * @param [out] value counter value
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+hw_mon_batch_value(const struct msr_op *ops,
+                   const struct pqos_mon_poll_ctx *ctx,
+                   const unsigned event,
+                   uint64_t *value)
+{
+        const struct msr_op *wr = &ops[0];
+        const struct msr_op *rd = &ops[1];
+
+        if (wr->status == MACHINE_RETVAL_OK &&
+            rd->status == MACHINE_RETVAL_OK &&
+            (rd->value & (PQOS_MSR_MON_QMC_ERROR |
+                          PQOS_MSR_MON_QMC_UNAVAILABLE)) == 0ULL) {
+                *value = rd->value & PQOS_MSR_MON_QMC_DATA_MASK;
+                return PQOS_RETVAL_OK;
+        }
+
+        return hw_mon_read(ctx->lcore, ctx->rmid, event, value);
+}
+
+/**
+ * @brief Reads \a event counter of all poll contexts in one MSR batch
+ *
+ * @param [in] ctx table of poll contexts
+ * @param [in] num_ctx number of poll contexts
+ * @param [in] event MSR event id
+ * @param [out] values table to store counter values for each context
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+hw_mon_read_batch(const struct pqos_mon_poll_ctx *ctx,
+                  const unsigned num_ctx,
+                  const unsigned event,
+                  uint64_t *values)
+{
+        struct msr_op ops[2 * num_ctx];
+        struct msr_batch batch;
+        unsigned i;
+
+        msr_batch_init(&batch, ops, DIM(ops));
+
+        for (i = 0; i < num_ctx; i++)
+                if (hw_mon_batch_add(&batch, &ctx[i], event) !=
+                    PQOS_RETVAL_OK)
+                        return PQOS_RETVAL_ERROR;
+
+        (void)msr_batch_exec(&batch);
+
+        for (i = 0; i < num_ctx; i++)
+                if (hw_mon_batch_value(&ops[2 * i], &ctx[i], event,
+                                       &values[i]) != PQOS_RETVAL_OK)
+                        return PQOS_RETVAL_ERROR;
+
+        return PQOS_RETVAL_OK;
+}
+
+/**
+ * @brief Gets prefetched counter of \a event in poll context
+ *
+ * @param [in] ctx poll context
+ * @param [in] event PQoS event
+ *
+ * @return pointer to prefetched counter or NULL
+ */
+static uint64_t *
+hw_mon_prefetch_value(struct pqos_mon_poll_ctx *ctx,
+                      const enum pqos_mon_event event)
+{
+        switch (event) {
+        case PQOS_MON_EVENT_L3_OCCUP:
+                return &ctx->llc;
+        case PQOS_MON_EVENT_LMEM_BW:
+                return &ctx->mbm_local;
+        case PQOS_MON_EVENT_TMEM_BW:
+                return &ctx->mbm_total;
+        default:
+                return NULL;
+        }
+}
+
+/** RMID events read in one batch by hw_mon_poll_prefetch() */
+static const enum pqos_mon_event m_prefetch_events[] = {
+    PQOS_MON_EVENT_L3_OCCUP, PQOS_MON_EVENT_LMEM_BW, PQOS_MON_EVENT_TMEM_BW};
+
+int
+hw_mon_poll_prefetch(struct pqos_mon_data **groups, const unsigned num_groups)
+{
+        struct msr_op *ops;
+        struct msr_batch batch;
+        unsigned num_ops = 0;
+        unsigned i, j, k;
+        unsigned idx = 0;
+
+        ASSERT(groups != NULL);
+
+        for (i = 0; i < num_groups; i++) {
+                struct pqos_mon_data_internal *intl = groups[i]->intl;
+
+                intl->hw.prefetched = (enum pqos_mon_event)0;
+                for (j = 0; j < DIM(m_prefetch_events); j++)
+                        if (intl->hw.event & m_prefetch_events[j])
+                                num_ops += 2 * intl->hw.num_ctx;
+        }
+
+        if (num_ops == 0)
+                return PQOS_RETVAL_OK;
+
+        ops = (struct msr_op *)malloc(num_ops * sizeof(ops[0]));
+        if (ops == NULL)
+                return PQOS_RETVAL_RESOURCE;
+
+        msr_batch_init(&batch, ops, num_ops);
+
+        /* All groups, events and contexts in one batch */
+        for (i = 0; i < num_groups; i++) {
+                const struct pqos_mon_data_internal *intl = groups[i]->intl;
+
+                for (j = 0; j < DIM(m_prefetch_events); j++) {
+                        const enum pqos_mon_event event = m_prefetch_events[j];
+
+                        if (!(intl->hw.event & event))
+                                continue;
+
+                        for (k = 0; k < intl->hw.num_ctx; k++)
+                                if (hw_mon_batch_add(&batch, &intl->hw.ctx[k],
+                                                     get_event_id(event)) !=
+                                    PQOS_RETVAL_OK) {
+                                        free(ops);
+                                        return PQOS_RETVAL_ERROR;
+                                }
+                }
+        }
+
+        (void)msr_batch_exec(&batch);
+
+        /* Values of events read without error are used by hw_mon_poll() */
+        for (i = 0; i < num_groups; i++) {
+                struct pqos_mon_data_internal *intl = groups[i]->intl;
+
+                for (j = 0; j < DIM(m_prefetch_events); j++) {
+                        const enum pqos_mon_event event = m_prefetch_events[j];
+                        int valid = 1;
+
+                        if (!(intl->hw.event & event))
+                                continue;
+
+                        for (k = 0; k < intl->hw.num_ctx; k++, idx += 2) {
+                                struct pqos_mon_poll_ctx *ctx =
+                                    &intl->hw.ctx[k];
+
+                                if (valid &&
+                                    hw_mon_batch_value(
+                                        &ops[idx], ctx, get_event_id(event),
+                                        hw_mon_prefetch_value(ctx, event)) !=
+                                        PQOS_RETVAL_OK)
+                                        valid = 0;
+                        }
+
+                        if (valid)
+                                intl->hw.prefetched |= event;
+                }
+        }
+
+        free(ops);
+
+        return PQOS_RETVAL_OK;
+}
+
 /**
  * @brief Gives the difference between two values with regard to the possible
  *        overrun and counter length
@@ -1021,6 +1666,7 @@ hw_mon_start(const unsigned num_cores,
                 ret = hw_mon_assoc_read(lcore, &rmid);
                 if (ret != PQOS_RETVAL_OK)
                         return PQOS_RETVAL_PARAM;
+                rmid_shadow_check(lcore, rmid);
 
                 if (rmid != RMID0) {
                         /* If not RMID0 then it is already monitored */
@@ -1229,6 +1875,8 @@ hw_mon_read_counter(struct pqos_mon_data *group,
                     const enum pqos_mon_event event)
 {
         struct pqos_event_values *pv = &group->values;
+        const unsigned num_ctx = group->intl->hw.num_ctx;
+        uint64_t tmp[num_ctx > 0 ? num_ctx : 1];
         uint64_t value = 0;
         uint64_t max_value = 1LLU << 24;
         const struct pqos_cap *cap = _pqos_get_cap();
@@ -1244,17 +1892,32 @@ hw_mon_read_counter(struct pqos_mon_data *group,
         if (ret == PQOS_RETVAL_OK)
                 max_value = 1LLU << pmon->counter_length;
 
-        for (i = 0; i < group->intl->hw.num_ctx; i++) {
-                uint64_t tmp = 0;
-                const unsigned lcore = group->intl->hw.ctx[i].lcore;
-                const pqos_rmid_t rmid = group->intl->hw.ctx[i].rmid;
-                int retval;
-
-                retval = hw_mon_read(lcore, rmid, get_event_id(event), &tmp);
-                if (retval != MACHINE_RETVAL_OK)
+        /**
+         * Counters prefetched for this poll are used once,
+         * single context is read directly,
+         * multiple contexts (clusters) are read in one MSR batch
+         */
+        if (group->intl->hw.prefetched & event) {
+                group->intl->hw.prefetched &= ~event;
+                for (i = 0; i < num_ctx; i++)
+                        tmp[i] = *hw_mon_prefetch_value(&group->intl->hw.ctx[i],
+                                                        event);
+        } else if (num_ctx == 1) {
+                const unsigned lcore = group->intl->hw.ctx[0].lcore;
+                const pqos_rmid_t rmid = group->intl->hw.ctx[0].rmid;
+
+                if (hw_mon_read(lcore, rmid, get_event_id(event), &tmp[0]) !=
+                    PQOS_RETVAL_OK)
                         return PQOS_RETVAL_ERROR;
+        } else if (num_ctx > 1) {
+                if (hw_mon_read_batch(group->intl->hw.ctx, num_ctx,
+                                      get_event_id(event),
+                                      tmp) != PQOS_RETVAL_OK)
+                        return PQOS_RETVAL_ERROR;
+        }
 
-                value += tmp;
+        for (i = 0; i < num_ctx; i++) {
+                value += tmp[i];
 
                 if (value >= max_value)
                         value -= max_value;
@@ -101,7 +101,7 @@ PQOS_LOCAL int hw_mon_assoc_write(const unsigned lcore, const pqos_rmid_t rmid);
 PQOS_LOCAL int hw_mon_assoc_read(const unsigned lcore, pqos_rmid_t *rmid);
 
 /**
- * @brief Get used RMIDs on ctx->cluster
+ * @brief Get unused RMID on ctx->cluster
  *
  * @param [in,out] ctx poll context
  * @param [in] event Monitoring event type
@@ -111,6 +111,21 @@ PQOS_LOCAL int hw_mon_assoc_read(const unsigned lcore, pqos_rmid_t *rmid);
 PQOS_LOCAL int hw_mon_assoc_unused(struct pqos_mon_poll_ctx *ctx,
                                    const enum pqos_mon_event event);
 
+/**
+ * @brief Checks shadow RMID associations against hardware
+ *
+ * Associations of all cores in clusters used by the library are read.
+ * Clusters whose associations were changed outside of the library are
+ * read again into the shadow table.
+ *
+ * @param [out] changed set to 1 if shadow was out of date and has been
+ *              updated, 0 otherwise
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ */
+PQOS_LOCAL int hw_mon_assoc_verify(int *changed);
+
 /**
  * @brief Hardware interface to read RMID association of the \a lcore
  *
@@ -245,6 +260,22 @@ PQOS_LOCAL int hw_mon_start_uncore(const unsigned num_sockets,
 PQOS_LOCAL int hw_mon_read_counter(struct pqos_mon_data *group,
                                    const enum pqos_mon_event event);
 
+/**
+ * @brief Reads RMID counters of all \a groups in one MSR batch
+ *
+ * Counters of all poll contexts and events are read together so domains
+ * can be processed in parallel. Values are consumed by following
+ * hw_mon_poll() calls.
+ *
+ * @param [in] groups table of monitoring group pointers
+ * @param [in] num_groups number of monitoring groups in the table
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+PQOS_LOCAL int hw_mon_poll_prefetch(struct pqos_mon_data **groups,
+                                    const unsigned num_groups);
+
 /**
  * @brief Hardware interface poll monitoring data
  *
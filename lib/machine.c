@@ -44,6 +44,7 @@
 #include "log.h"
 
 #include <fcntl.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -59,6 +60,8 @@ static int *m_msr_fd = NULL;    /**< MSR driver file descriptors table */
 static unsigned m_maxcores = 0; /**< max number of cores (size of the
                                    table above too) */
 
+static void msr_batch_pool_fini(void);
+
 int
 machine_init(const unsigned max_core_id)
 {
@@ -96,6 +99,8 @@ machine_fini(void)
         if (m_msr_fd == NULL)
                 return MACHINE_RETVAL_ERROR;
 
+        msr_batch_pool_fini();
+
         /**
          * Close open file descriptors and free up table memory.
          */
@@ -153,6 +158,7 @@ lcpuid(const unsigned leaf, const unsigned subleaf, struct cpuid_out *out)
  *
  * File descriptor could be previously open and comes from
  * m_msr_fd table or is open (& cached) during the call.
+ * Function is safe to be called from multiple threads.
  *
  * @param lcore logical core id
  *
@@ -177,41 +183,46 @@ msr_file_open(const unsigned lcore)
                 snprintf(fname, sizeof(fname) - 1, "/dev/cpuctl%u", lcore);
 #endif
                 fd = open(fname, O_RDWR);
-                if (fd < 0)
+                if (fd < 0) {
                         LOG_WARN("Error opening file '%s'!\n", fname);
-                else
-                        m_msr_fd[lcore] = fd;
+                        return fd;
+                }
+
+                /**
+                 * File can be opened concurrently by monitoring poll
+                 * workers, keep the descriptor cached by the first one.
+                 */
+                if (!__sync_bool_compare_and_swap(&m_msr_fd[lcore], -1, fd)) {
+                        close(fd);
+                        fd = m_msr_fd[lcore];
+                }
         }
 
         return fd;
 }
 
-int
-msr_read(const unsigned lcore, const uint32_t reg, uint64_t *value)
+/**
+ * @brief Executes RDMSR using MSR driver file descriptor
+ *
+ * @param fd MSR driver file descriptor
+ * @param lcore logical core id
+ * @param reg MSR to read from
+ * @param value place to store MSR value at
+ *
+ * @return Operation status
+ * @retval MACHINE_RETVAL_OK on success
+ */
+static int
+msr_fd_read(const int fd,
+            const unsigned lcore,
+            const uint32_t reg,
+            uint64_t *value)
 {
-        int ret = MACHINE_RETVAL_OK;
-        int fd = -1;
         ssize_t read_ret = 0;
 #ifdef __FreeBSD__
         cpuctl_msr_args_t io;
 #endif
 
-        ASSERT(value != NULL);
-        if (value == NULL)
-                return MACHINE_RETVAL_PARAM;
-
-        ASSERT(lcore < m_maxcores);
-        if (lcore >= m_maxcores)
-                return MACHINE_RETVAL_PARAM;
-
-        ASSERT(m_msr_fd != NULL);
-        if (m_msr_fd == NULL)
-                return MACHINE_RETVAL_ERROR;
-
-        fd = msr_file_open(lcore);
-        if (fd < 0)
-                return MACHINE_RETVAL_ERROR;
-
 #ifdef __linux__
         read_ret = pread(fd, value, sizeof(value[0]), (off_t)reg);
 #endif
@@ -229,33 +240,34 @@ msr_read(const unsigned lcore, const uint32_t reg, uint64_t *value)
         if (read_ret != sizeof(value[0])) {
                 LOG_ERROR("RDMSR failed for reg[0x%x] on lcore %u\n",
                           (unsigned)reg, lcore);
-                ret = MACHINE_RETVAL_ERROR;
+                return MACHINE_RETVAL_ERROR;
         }
-        return ret;
+
+        return MACHINE_RETVAL_OK;
 }
 
-int
-msr_write(const unsigned lcore, const uint32_t reg, const uint64_t value)
+/**
+ * @brief Executes WRMSR using MSR driver file descriptor
+ *
+ * @param fd MSR driver file descriptor
+ * @param lcore logical core id
+ * @param reg MSR to write to
+ * @param value to be written into \a reg
+ *
+ * @return Operation status
+ * @retval MACHINE_RETVAL_OK on success
+ */
+static int
+msr_fd_write(const int fd,
+             const unsigned lcore,
+             const uint32_t reg,
+             const uint64_t value)
 {
-        int ret = MACHINE_RETVAL_OK;
-        int fd = -1;
         ssize_t write_ret = 0;
 #ifdef __FreeBSD__
         cpuctl_msr_args_t io;
 #endif
 
-        ASSERT(lcore < m_maxcores);
-        if (lcore >= m_maxcores)
-                return MACHINE_RETVAL_PARAM;
-
-        ASSERT(m_msr_fd != NULL);
-        if (m_msr_fd == NULL)
-                return MACHINE_RETVAL_ERROR;
-
-        fd = msr_file_open(lcore);
-        if (fd < 0)
-                return MACHINE_RETVAL_ERROR;
-
 #ifdef __linux__
         write_ret = pwrite(fd, &value, sizeof(value), (off_t)reg);
 #endif
@@ -273,8 +285,408 @@ msr_write(const unsigned lcore, const uint32_t reg, const uint64_t value)
                 LOG_ERROR("WRMSR failed for reg[0x%x] <- value[0x%llx] on "
                           "lcore %u\n",
                           (unsigned)reg, (unsigned long long)value, lcore);
-                ret = MACHINE_RETVAL_ERROR;
+                return MACHINE_RETVAL_ERROR;
+        }
+
+        return MACHINE_RETVAL_OK;
+}
+
+int
+msr_read(const unsigned lcore, const uint32_t reg, uint64_t *value)
+{
+        int fd = -1;
+
+        ASSERT(value != NULL);
+        if (value == NULL)
+                return MACHINE_RETVAL_PARAM;
+
+        ASSERT(lcore < m_maxcores);
+        if (lcore >= m_maxcores)
+                return MACHINE_RETVAL_PARAM;
+
+        ASSERT(m_msr_fd != NULL);
+        if (m_msr_fd == NULL)
+                return MACHINE_RETVAL_ERROR;
+
+        fd = msr_file_open(lcore);
+        if (fd < 0)
+                return MACHINE_RETVAL_ERROR;
+
+        return msr_fd_read(fd, lcore, reg, value);
+}
+
+int
+msr_write(const unsigned lcore, const uint32_t reg, const uint64_t value)
+{
+        int fd = -1;
+
+        ASSERT(lcore < m_maxcores);
+        if (lcore >= m_maxcores)
+                return MACHINE_RETVAL_PARAM;
+
+        ASSERT(m_msr_fd != NULL);
+        if (m_msr_fd == NULL)
+                return MACHINE_RETVAL_ERROR;
+
+        fd = msr_file_open(lcore);
+        if (fd < 0)
+                return MACHINE_RETVAL_ERROR;
+
+        return msr_fd_write(fd, lcore, reg, value);
+}
+
+/*
+ * =======================================
+ * MSR batch
+ * =======================================
+ */
+
+/**
+ * Sort key used to group batch operations per domain and lcore
+ */
+struct msr_batch_key {
+        unsigned domain; /**< dispatch domain */
+        unsigned lcore;  /**< logical core id */
+        unsigned idx;    /**< index of the operation in the batch */
+};
+
+/**
+ * Range of sorted batch operations belonging to one domain
+ */
+struct msr_batch_run {
+        struct msr_batch *batch;          /**< MSR batch */
+        const struct msr_batch_key *keys; /**< sorted keys */
+        unsigned num;                     /**< number of keys in the run */
+        int ret;                          /**< run status */
+};
+
+/**
+ * Persistent batch worker threads, runs of a batch are handed out
+ * to workers and the calling thread through a shared queue
+ */
+static pthread_t *m_workers = NULL;   /**< worker threads */
+static unsigned m_num_workers = 0;    /**< number of started workers */
+/** serializes use of the workers, concurrent batches run inline */
+static pthread_mutex_t m_batch_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t m_pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t m_pool_start = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t m_pool_done = PTHREAD_COND_INITIALIZER;
+static struct msr_batch_run *m_runs = NULL; /**< runs of current batch */
+static unsigned m_num_runs = 0;             /**< number of runs */
+static unsigned m_next_run = 0;             /**< next run to execute */
+static unsigned m_pending = 0;              /**< runs not completed yet */
+static unsigned m_generation = 0; /**< incremented on each batch */
+static int m_stop = 0;            /**< workers shall exit */
+
+void
+msr_batch_init(struct msr_batch *batch, struct msr_op *ops, unsigned size)
+{
+        ASSERT(batch != NULL);
+        ASSERT(ops != NULL || size == 0);
+
+        batch->ops = ops;
+        batch->size = size;
+        batch->num = 0;
+}
+
+int
+msr_batch_add(struct msr_batch *batch,
+              const unsigned lcore,
+              const unsigned domain,
+              const enum msr_op_type op,
+              const uint32_t reg,
+              const uint64_t value)
+{
+        struct msr_op *entry;
+
+        ASSERT(batch != NULL);
+        if (batch == NULL || batch->num >= batch->size)
+                return MACHINE_RETVAL_PARAM;
+
+        entry = &batch->ops[batch->num++];
+        entry->lcore = lcore;
+        entry->domain = domain;
+        entry->op = op;
+        entry->reg = reg;
+        entry->value = op == MSR_OP_WRITE ? value : 0;
+        entry->status = MACHINE_RETVAL_ERROR;
+
+        return MACHINE_RETVAL_OK;
+}
+
+/**
+ * @brief Compares batch keys by domain, lcore and position in the batch
+ */
+static int
+msr_batch_key_cmp(const void *a, const void *b)
+{
+        const struct msr_batch_key *ka = (const struct msr_batch_key *)a;
+        const struct msr_batch_key *kb = (const struct msr_batch_key *)b;
+
+        if (ka->domain != kb->domain)
+                return ka->domain < kb->domain ? -1 : 1;
+        if (ka->lcore != kb->lcore)
+                return ka->lcore < kb->lcore ? -1 : 1;
+        if (ka->idx != kb->idx)
+                return ka->idx < kb->idx ? -1 : 1;
+        return 0;
+}
+
+/**
+ * @brief Executes range of batch operations
+ *
+ * MSR driver files have to be open prior to this call.
+ *
+ * @param arg pointer to struct msr_batch_run
+ *
+ * @return NULL
+ */
+static void *
+msr_batch_run_exec(void *arg)
+{
+        struct msr_batch_run *run = (struct msr_batch_run *)arg;
+        unsigned i;
+
+        run->ret = MACHINE_RETVAL_OK;
+
+        for (i = 0; i < run->num; i++) {
+                struct msr_op *op = &run->batch->ops[run->keys[i].idx];
+
+                /* operation failed validation */
+                if (op->status != MACHINE_RETVAL_OK) {
+                        run->ret = op->status;
+                        continue;
+                }
+
+                if (op->op == MSR_OP_WRITE)
+                        op->status = msr_fd_write(m_msr_fd[op->lcore],
+                                                  op->lcore, op->reg,
+                                                  op->value);
+                else
+                        op->status = msr_fd_read(m_msr_fd[op->lcore],
+                                                 op->lcore, op->reg,
+                                                 &op->value);
+
+                if (op->status != MACHINE_RETVAL_OK)
+                        run->ret = op->status;
+        }
+
+        return NULL;
+}
+
+/**
+ * @brief Executes runs of current batch until the queue is empty
+ *
+ * Called by the batch workers and the calling thread.
+ * Has to be called with m_pool_lock held, returns with it held.
+ */
+static void
+msr_batch_pool_drain(void)
+{
+        while (m_next_run < m_num_runs) {
+                struct msr_batch_run *run = &m_runs[m_next_run++];
+
+                pthread_mutex_unlock(&m_pool_lock);
+                (void)msr_batch_run_exec(run);
+                pthread_mutex_lock(&m_pool_lock);
+
+                if (--m_pending == 0)
+                        pthread_cond_signal(&m_pool_done);
+        }
+}
+
+/**
+ * @brief Batch worker thread main loop
+ *
+ * @param arg unused
+ *
+ * @return NULL
+ */
+static void *
+msr_batch_worker_main(void *arg)
+{
+        unsigned generation;
+
+        UNUSED_PARAM(arg);
+
+        pthread_mutex_lock(&m_pool_lock);
+        generation = m_generation;
+        for (;;) {
+                while (!m_stop && generation == m_generation)
+                        pthread_cond_wait(&m_pool_start, &m_pool_lock);
+                if (m_stop)
+                        break;
+                generation = m_generation;
+                msr_batch_pool_drain();
+        }
+        pthread_mutex_unlock(&m_pool_lock);
+
+        return NULL;
+}
+
+/**
+ * @brief Makes sure at least \a num batch workers are running
+ *
+ * @param num number of workers
+ *
+ * @return number of running workers
+ */
+static unsigned
+msr_batch_pool_grow(const unsigned num)
+{
+        pthread_t *workers;
+
+        if (num <= m_num_workers)
+                return m_num_workers;
+
+        workers = (pthread_t *)realloc(m_workers, num * sizeof(workers[0]));
+        if (workers == NULL)
+                return m_num_workers;
+        m_workers = workers;
+
+        while (m_num_workers < num) {
+                if (pthread_create(&m_workers[m_num_workers], NULL,
+                                   msr_batch_worker_main, NULL) != 0) {
+                        LOG_WARN("Failed to start MSR batch worker\n");
+                        break;
+                }
+                m_num_workers++;
+        }
+
+        return m_num_workers;
+}
+
+/**
+ * @brief Stops batch worker threads
+ */
+static void
+msr_batch_pool_fini(void)
+{
+        unsigned i;
+
+        pthread_mutex_lock(&m_batch_lock);
+        if (m_num_workers == 0) {
+                pthread_mutex_unlock(&m_batch_lock);
+                return;
+        }
+
+        pthread_mutex_lock(&m_pool_lock);
+        m_stop = 1;
+        pthread_cond_broadcast(&m_pool_start);
+        pthread_mutex_unlock(&m_pool_lock);
+
+        for (i = 0; i < m_num_workers; i++)
+                pthread_join(m_workers[i], NULL);
+
+        free(m_workers);
+        m_workers = NULL;
+        m_num_workers = 0;
+        m_stop = 0;
+        pthread_mutex_unlock(&m_batch_lock);
+}
+
+int
+msr_batch_exec(struct msr_batch *batch)
+{
+        struct msr_batch_key *keys = NULL;
+        struct msr_batch_run *runs = NULL;
+        unsigned num_runs = 0;
+        unsigned i;
+        int dispatched = 0;
+        int ret = MACHINE_RETVAL_OK;
+
+        ASSERT(batch != NULL);
+        if (batch == NULL)
+                return MACHINE_RETVAL_PARAM;
+        if (batch->num == 0)
+                return MACHINE_RETVAL_OK;
+
+        ASSERT(m_msr_fd != NULL);
+        if (m_msr_fd == NULL)
+                return MACHINE_RETVAL_ERROR;
+
+        keys = (struct msr_batch_key *)malloc(sizeof(keys[0]) * batch->num);
+        if (keys == NULL)
+                return MACHINE_RETVAL_ERROR;
+
+        /**
+         * Validate operations and open MSR driver files up front,
+         * so worker threads only read the file descriptor table.
+         */
+        for (i = 0; i < batch->num; i++) {
+                struct msr_op *op = &batch->ops[i];
+
+                keys[i].domain = op->domain;
+                keys[i].lcore = op->lcore;
+                keys[i].idx = i;
+
+                if (op->lcore >= m_maxcores) {
+                        op->status = MACHINE_RETVAL_PARAM;
+                        ret = MACHINE_RETVAL_ERROR;
+                        continue;
+                }
+                op->status = MACHINE_RETVAL_OK;
+                if (msr_file_open(op->lcore) < 0) {
+                        op->status = MACHINE_RETVAL_ERROR;
+                        ret = MACHINE_RETVAL_ERROR;
+                }
         }
 
+        qsort(keys, batch->num, sizeof(keys[0]), msr_batch_key_cmp);
+
+        /* Split sorted operations into per domain runs */
+        runs = (struct msr_batch_run *)calloc(batch->num, sizeof(runs[0]));
+        if (runs == NULL) {
+                free(keys);
+                return MACHINE_RETVAL_ERROR;
+        }
+        for (i = 0; i < batch->num; i++) {
+                if (num_runs == 0 ||
+                    runs[num_runs - 1].keys[0].domain != keys[i].domain) {
+                        runs[num_runs].batch = batch;
+                        runs[num_runs].keys = &keys[i];
+                        num_runs++;
+                }
+                runs[num_runs - 1].num++;
+        }
+
+        /**
+         * Hand out domains to worker threads for large batches,
+         * the calling thread executes domains too.
+         */
+        if (num_runs > 1 && batch->num >= MACHINE_BATCH_PARALLEL_MIN &&
+            pthread_mutex_trylock(&m_batch_lock) == 0) {
+                if (msr_batch_pool_grow(num_runs - 1) > 0) {
+                        pthread_mutex_lock(&m_pool_lock);
+                        m_runs = runs;
+                        m_num_runs = num_runs;
+                        m_next_run = 0;
+                        m_pending = num_runs;
+                        m_generation++;
+                        pthread_cond_broadcast(&m_pool_start);
+
+                        msr_batch_pool_drain();
+                        while (m_pending > 0)
+                                pthread_cond_wait(&m_pool_done, &m_pool_lock);
+
+                        m_runs = NULL;
+                        m_num_runs = 0;
+                        m_next_run = 0;
+                        pthread_mutex_unlock(&m_pool_lock);
+                        dispatched = 1;
+                }
+                pthread_mutex_unlock(&m_batch_lock);
+        }
+
+        for (i = 0; !dispatched && i < num_runs; i++)
+                (void)msr_batch_run_exec(&runs[i]);
+
+        for (i = 0; i < num_runs; i++)
+                if (runs[i].ret != MACHINE_RETVAL_OK)
+                        ret = MACHINE_RETVAL_ERROR;
+
+        free(runs);
+        free(keys);
+
         return ret;
 }
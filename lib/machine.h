@@ -56,6 +56,13 @@ extern "C" {
 /* cpuid leaf for cache topology */
 #define CPUID_LEAF_CACHE 4
 
+/**
+ * Minimum number of operations in MSR batch for domains to be
+ * processed by parallel threads. Smaller batches are executed
+ * by the calling thread as waking up the workers outweighs the gain.
+ */
+#define MACHINE_BATCH_PARALLEL_MIN 64
+
 /**
  * Results of CPUID operation are stored in this structure.
  * It consists of 4x32bits IA registers: EAX, EBX, ECX and EDX.
@@ -67,6 +74,38 @@ struct cpuid_out {
         uint32_t edx;
 };
 
+/**
+ * MSR batch operation types
+ */
+enum msr_op_type {
+        MSR_OP_READ = 0, /**< RDMSR */
+        MSR_OP_WRITE     /**< WRMSR */
+};
+
+/**
+ * Single MSR batch operation
+ */
+struct msr_op {
+        unsigned lcore;      /**< logical core id */
+        unsigned domain;     /**< dispatch domain (e.g. socket id) */
+        enum msr_op_type op; /**< operation type */
+        uint32_t reg;        /**< MSR address */
+        uint64_t value;      /**< value to write or value read */
+        int status;          /**< operation status */
+};
+
+/**
+ * Queue of MSR operations executed in one pass by msr_batch_exec().
+ *
+ * Operations table is provided by the caller so batch can live on stack.
+ * Operations on the same lcore are executed in the order they were added.
+ */
+struct msr_batch {
+        struct msr_op *ops; /**< operations table */
+        unsigned size;      /**< size of operations table */
+        unsigned num;       /**< number of queued operations */
+};
+
 /**
  * @brief Initializes machine module
  *
@@ -123,6 +162,56 @@ msr_read(const unsigned lcore, const uint32_t reg, uint64_t *value);
 PQOS_LOCAL int
 msr_write(const unsigned lcore, const uint32_t reg, const uint64_t value);
 
+/**
+ * @brief Initializes MSR batch
+ *
+ * @param [out] batch MSR batch to initialize
+ * @param [in] ops table to store operations in
+ * @param [in] size number of entries in \a ops table
+ */
+PQOS_LOCAL void
+msr_batch_init(struct msr_batch *batch, struct msr_op *ops, unsigned size);
+
+/**
+ * @brief Adds operation to MSR batch
+ *
+ * @param [in,out] batch MSR batch
+ * @param [in] lcore logical core id
+ * @param [in] domain dispatch domain, operations from different domains
+ *             can be executed in parallel
+ * @param [in] op operation type
+ * @param [in] reg MSR address
+ * @param [in] value value to be written, ignored for MSR_OP_READ
+ *
+ * @return Operation status
+ * @retval MACHINE_RETVAL_OK on success
+ * @retval MACHINE_RETVAL_PARAM batch is full or parameter error
+ */
+PQOS_LOCAL int msr_batch_add(struct msr_batch *batch,
+                             const unsigned lcore,
+                             const unsigned domain,
+                             const enum msr_op_type op,
+                             const uint32_t reg,
+                             const uint64_t value);
+
+/**
+ * @brief Executes all operations queued in MSR batch
+ *
+ * Operations are grouped per lcore. Domains are executed in parallel
+ * by persistent worker threads when batch is large enough
+ * (MACHINE_BATCH_PARALLEL_MIN). Workers are started on first use and
+ * stopped by machine_fini().
+ * Status of each operation is stored in its status field and
+ * read values are stored in its value field.
+ *
+ * @param [in,out] batch MSR batch
+ *
+ * @return Operation status
+ * @retval MACHINE_RETVAL_OK all operations succeeded
+ * @retval MACHINE_RETVAL_ERROR at least one operation failed
+ */
+PQOS_LOCAL int msr_batch_exec(struct msr_batch *batch);
+
 #ifdef __cplusplus
 }
 #endif
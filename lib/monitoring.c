@@ -35,6 +35,7 @@
 #include "cap.h"
 #include "hw_monitoring.h"
 #include "log.h"
+#include "monitoring_pool.h"
 #include "os_monitoring.h"
 #include "perf_monitoring.h"
 #include "types.h"
@@ -107,8 +108,35 @@ pqos_mon_init(const struct pqos_cpuinfo *cpu,
         if (ret != PQOS_RETVAL_OK)
                 return ret;
 #endif
-        if (interface == PQOS_INTER_MSR)
+        if (interface == PQOS_INTER_MSR) {
                 ret = hw_mon_init(cpu, cap, cfg);
+                if (ret != PQOS_RETVAL_OK)
+                        goto pqos_mon_init_exit;
+
+                ret = mon_pool_init(cpu, cfg->mon_poll);
+                if (ret != PQOS_RETVAL_OK)
+                        hw_mon_fini();
+        } else if (cfg->mon_poll != PQOS_MON_POLL_SERIAL)
+                LOG_INFO("Parallel monitoring poll is supported "
+                         "with MSR interface only\n");
+
+#ifdef __linux__
+        if (ret == PQOS_RETVAL_OK &&
+            cfg->perf_read != PQOS_MON_PERF_READ_SYSCALL &&
+            perf_mon_set_read_mode(cfg->perf_read) != PQOS_RETVAL_OK)
+                LOG_INFO("Selected perf counter read method is not "
+                         "supported, using read()\n");
+
+        if (ret == PQOS_RETVAL_OK &&
+            cfg->pid_track != PQOS_MON_PID_TRACK_NONE) {
+                if (interface == PQOS_INTER_MSR)
+                        LOG_INFO("Process tracking is supported with OS "
+                                 "interface only\n");
+                else if (os_mon_track_init(cfg->pid_track) != PQOS_RETVAL_OK)
+                        LOG_WARN("Process events are not available, threads "
+                                 "are found when monitoring starts\n");
+        }
+#endif
 
 pqos_mon_init_exit:
         return ret;
@@ -124,9 +152,12 @@ pqos_mon_fini(void)
         if (interface == PQOS_INTER_OS ||
             interface == PQOS_INTER_OS_RESCTRL_MON)
                 ret = os_mon_fini();
-        if (interface == PQOS_INTER_MSR)
+        if (interface == PQOS_INTER_MSR) {
+                mon_pool_fini();
                 ret = hw_mon_fini();
+        }
 #else
+        mon_pool_fini();
         ret = hw_mon_fini();
 #endif
 
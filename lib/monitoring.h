@@ -43,6 +43,8 @@ extern "C" {
 #endif
 
 #include "pqos.h"
+#include "tid_hash.h"
+#include "uring.h"
 
 /**
  * Core monitoring poll context
@@ -51,8 +53,21 @@ struct pqos_mon_poll_ctx {
         unsigned lcore;
         unsigned cluster;
         pqos_rmid_t rmid;
+        uint64_t llc;       /**< prefetched LLC occupancy counter */
+        uint64_t mbm_local; /**< prefetched local memory bandwidth counter */
+        uint64_t mbm_total; /**< prefetched total memory bandwidth counter */
 };
 
+/**
+ * Maximum number of perf events read as a single group
+ */
+#define PQOS_MON_PERF_GROUP_MAX 4
+
+/**
+ * Number of entries in perf supported events table
+ */
+#define PQOS_MON_PERF_EVENT_NUM 9
+
 /**
  * Perf monitoring poll context
  */
@@ -64,6 +79,24 @@ struct pqos_mon_perf_ctx {
         int fd_cyc;
         int fd_llc_misses;
         int fd_llc_references;
+        int fd_leader;  /**< perf event group leader */
+        unsigned fresh; /**< group values not polled yet */
+        /** last values read from the perf event group */
+        uint64_t group_values[PQOS_MON_PERF_GROUP_MAX];
+        /** mapped perf_event_mmap_page of each grouped event or NULL */
+        void *mmap_page[PQOS_MON_PERF_GROUP_MAX];
+};
+
+/**
+ * Resctrl monitoring counter file cache entry
+ */
+struct pqos_mon_resctrl_fd {
+        unsigned class_id;         /**< COS id */
+        unsigned l3id;             /**< L3 id */
+        enum pqos_mon_event event; /**< monitoring event */
+        int fd;                    /**< counter file descriptor */
+        struct uring_read read;    /**< prefetched read */
+        char buf[32];              /**< prefetched file content */
 };
 
 /**
@@ -101,8 +134,21 @@ struct pqos_mon_data_internal {
                 enum pqos_mon_event event;     /**< Started perf events */
                 struct pqos_mon_perf_ctx *ctx; /**< Perf poll context for each
                                                   core/tid */
+                /** Events read as a perf group, leader first */
+                enum pqos_mon_event group[PQOS_MON_PERF_GROUP_MAX];
+                unsigned num_group; /**< Number of grouped perf events */
+                /** Final counts of exited tasks, by supported event */
+                uint64_t retired[PQOS_MON_PERF_EVENT_NUM];
         } perf;
 
+        /**
+         * Monitored tasks section
+         */
+        struct {
+                struct tid_hash tids; /**< TID to tid_map index */
+                struct tid_hash pids; /**< PID to pids index */
+        } task;
+
         /**
          * Resctrl specific section
          */
@@ -113,8 +159,11 @@ struct pqos_mon_data_internal {
                                                             of monitoring group
                                                             that was moved to
                                                             another COS */
-                unsigned *l3id;    /**< list of l3ids being monitored */
-                unsigned num_l3id; /**< Number of l3ids */
+                unsigned *l3id;                  /**< list of l3ids being
+                                                    monitored */
+                unsigned num_l3id;               /**< Number of l3ids */
+                struct pqos_mon_resctrl_fd *fds; /**< cached counter files */
+                unsigned num_fds;                /**< Number of cached files */
 
         } resctrl;
 
@@ -125,6 +174,8 @@ struct pqos_mon_data_internal {
                 enum pqos_mon_event event;     /**< Started hw events */
                 struct pqos_mon_poll_ctx *ctx; /**< core, cluster & RMID */
                 unsigned num_ctx;              /**< number of poll contexts */
+                /** Events with counters prefetched into poll contexts */
+                enum pqos_mon_event prefetched;
         } hw;
 
         /* Uncore specific section */
@@ -0,0 +1,362 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2022 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+/**
+ * @brief Monitoring poll worker pool
+ *
+ * Worker threads poll monitoring groups in parallel. There is one worker
+ * per socket, L3 cluster or core, so MSR reads are issued from a core close
+ * to the monitored cores. Per core workers also let perf counters of the
+ * core be read with rdpmc.
+ */
+
+#include "monitoring_pool.h"
+
+#include "cap.h"
+#include "log.h"
+#include "monitoring.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * ---------------------------------------
+ * Local data types
+ * ---------------------------------------
+ */
+
+/**
+ * Monitoring poll worker
+ */
+struct mon_pool_worker {
+        pthread_t thread;              /**< worker thread */
+        unsigned domain;               /**< socket, L3 cluster or core id */
+        struct pqos_mon_data **groups; /**< groups to poll */
+        unsigned num_groups;           /**< number of groups to poll */
+        int ret;                       /**< poll status */
+};
+
+/**
+ * ---------------------------------------
+ * Local data structures
+ * ---------------------------------------
+ */
+static struct mon_pool_worker *m_workers = NULL; /**< worker table */
+static unsigned m_num_workers = 0;               /**< number of workers */
+static unsigned m_max_groups = 0;                /**< group table size */
+
+/** Poll mode - selects worker domain */
+static enum pqos_mon_poll_mode m_mode = PQOS_MON_POLL_SERIAL;
+
+static pthread_mutex_t m_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t m_cond_start = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t m_cond_done = PTHREAD_COND_INITIALIZER;
+static unsigned m_generation = 0; /**< incremented on each poll request */
+static unsigned m_pending = 0;    /**< workers still polling */
+static int m_stop = 0;            /**< workers shall exit */
+
+/**
+ * @brief Gets domain id of the core
+ *
+ * @param [in] coreinfo core information
+ *
+ * @return socket, L3 cluster or core id depending on pool mode
+ */
+static unsigned
+mon_pool_core_domain(const struct pqos_coreinfo *coreinfo)
+{
+        switch (m_mode) {
+        case PQOS_MON_POLL_SOCKET:
+                return coreinfo->socket;
+        case PQOS_MON_POLL_CORE:
+                return coreinfo->lcore;
+        default:
+                return coreinfo->l3_id;
+        }
+}
+
+/**
+ * @brief Worker thread main loop
+ *
+ * @param [in] arg worker structure
+ *
+ * @return NULL
+ */
+static void *
+mon_pool_worker_main(void *arg)
+{
+        struct mon_pool_worker *worker = (struct mon_pool_worker *)arg;
+        unsigned generation = 0;
+
+        for (;;) {
+                unsigned i;
+
+                pthread_mutex_lock(&m_lock);
+                while (!m_stop && generation == m_generation)
+                        pthread_cond_wait(&m_cond_start, &m_lock);
+                if (m_stop) {
+                        pthread_mutex_unlock(&m_lock);
+                        break;
+                }
+                generation = m_generation;
+                pthread_mutex_unlock(&m_lock);
+
+                worker->ret = PQOS_RETVAL_OK;
+                for (i = 0; i < worker->num_groups; i++) {
+                        int retval = pqos_mon_poll_events(worker->groups[i]);
+
+                        if (retval != PQOS_RETVAL_OK) {
+                                LOG_WARN("Failed to poll event on group "
+                                         "%p\n",
+                                         (void *)worker->groups[i]);
+                                worker->ret = retval;
+                        }
+                }
+
+                pthread_mutex_lock(&m_lock);
+                if (--m_pending == 0)
+                        pthread_cond_signal(&m_cond_done);
+                pthread_mutex_unlock(&m_lock);
+        }
+
+        return NULL;
+}
+
+/**
+ * @brief Pins worker thread to the cores of its domain
+ *
+ * @param [in] cpu cpu topology structure
+ * @param [in] worker worker structure
+ */
+static void
+mon_pool_worker_pin(const struct pqos_cpuinfo *cpu,
+                    const struct mon_pool_worker *worker)
+{
+#ifdef __linux__
+        cpu_set_t cpuset;
+        unsigned i;
+
+        CPU_ZERO(&cpuset);
+        for (i = 0; i < cpu->num_cores; i++)
+                if (mon_pool_core_domain(&cpu->cores[i]) == worker->domain)
+                        CPU_SET(cpu->cores[i].lcore, &cpuset);
+
+        if (pthread_setaffinity_np(worker->thread, sizeof(cpuset), &cpuset) !=
+            0)
+                LOG_WARN("Failed to pin monitoring poll worker of domain "
+                         "%u\n",
+                         worker->domain);
+#else
+        UNUSED_PARAM(cpu);
+        UNUSED_PARAM(worker);
+#endif
+}
+
+int
+mon_pool_init(const struct pqos_cpuinfo *cpu,
+              const enum pqos_mon_poll_mode mode)
+{
+        unsigned i, j;
+
+        ASSERT(m_workers == NULL);
+        if (m_workers != NULL)
+                return PQOS_RETVAL_ERROR;
+
+        if (mode == PQOS_MON_POLL_SERIAL)
+                return PQOS_RETVAL_OK;
+        if (mode != PQOS_MON_POLL_SOCKET && mode != PQOS_MON_POLL_CLUSTER &&
+            mode != PQOS_MON_POLL_CORE)
+                return PQOS_RETVAL_PARAM;
+        if (cpu == NULL || cpu->num_cores == 0)
+                return PQOS_RETVAL_PARAM;
+
+        m_mode = mode;
+        m_stop = 0;
+        m_generation = 0;
+        m_pending = 0;
+
+        m_workers = (struct mon_pool_worker *)calloc(cpu->num_cores,
+                                                     sizeof(m_workers[0]));
+        if (m_workers == NULL)
+                return PQOS_RETVAL_RESOURCE;
+
+        /* one worker per domain */
+        for (i = 0; i < cpu->num_cores; i++) {
+                const unsigned domain = mon_pool_core_domain(&cpu->cores[i]);
+
+                for (j = 0; j < m_num_workers; j++)
+                        if (m_workers[j].domain == domain)
+                                break;
+                if (j < m_num_workers)
+                        continue;
+
+                m_workers[m_num_workers].domain = domain;
+                if (pthread_create(&m_workers[m_num_workers].thread, NULL,
+                                   mon_pool_worker_main,
+                                   &m_workers[m_num_workers]) != 0) {
+                        LOG_ERROR("Failed to start monitoring poll worker\n");
+                        mon_pool_fini();
+                        return PQOS_RETVAL_ERROR;
+                }
+                mon_pool_worker_pin(cpu, &m_workers[m_num_workers]);
+                m_num_workers++;
+        }
+
+        LOG_INFO("Started %u monitoring poll workers\n", m_num_workers);
+
+        return PQOS_RETVAL_OK;
+}
+
+int
+mon_pool_fini(void)
+{
+        unsigned i;
+
+        if (m_workers == NULL)
+                return PQOS_RETVAL_OK;
+
+        pthread_mutex_lock(&m_lock);
+        m_stop = 1;
+        pthread_cond_broadcast(&m_cond_start);
+        pthread_mutex_unlock(&m_lock);
+
+        for (i = 0; i < m_num_workers; i++) {
+                pthread_join(m_workers[i].thread, NULL);
+                if (m_workers[i].groups != NULL)
+                        free(m_workers[i].groups);
+        }
+
+        free(m_workers);
+        m_workers = NULL;
+        m_num_workers = 0;
+        m_max_groups = 0;
+        m_mode = PQOS_MON_POLL_SERIAL;
+
+        return PQOS_RETVAL_OK;
+}
+
+int
+mon_pool_enabled(void)
+{
+        return m_workers != NULL && m_num_workers > 0;
+}
+
+/**
+ * @brief Finds worker for monitoring group
+ *
+ * Group is assigned to the domain of its first poll context. Groups without
+ * poll context are distributed round robin.
+ *
+ * @param [in] cpu cpu topology structure
+ * @param [in] group monitoring group
+ * @param [in] idx group index
+ *
+ * @return worker
+ */
+static struct mon_pool_worker *
+mon_pool_get_worker(const struct pqos_cpuinfo *cpu,
+                    const struct pqos_mon_data *group,
+                    const unsigned idx)
+{
+        const struct pqos_coreinfo *coreinfo = NULL;
+        unsigned i;
+
+        if (group->intl->hw.num_ctx > 0)
+                coreinfo =
+                    pqos_cpu_get_core_info(cpu, group->intl->hw.ctx[0].lcore);
+
+        if (coreinfo != NULL) {
+                const unsigned domain = mon_pool_core_domain(coreinfo);
+
+                for (i = 0; i < m_num_workers; i++)
+                        if (m_workers[i].domain == domain)
+                                return &m_workers[i];
+        }
+
+        return &m_workers[idx % m_num_workers];
+}
+
+int
+mon_pool_poll(struct pqos_mon_data **groups, const unsigned num_groups)
+{
+        const struct pqos_cpuinfo *cpu = _pqos_get_cpu();
+        int ret = PQOS_RETVAL_OK;
+        unsigned i;
+
+        ASSERT(groups != NULL);
+        ASSERT(mon_pool_enabled());
+        if (!mon_pool_enabled())
+                return PQOS_RETVAL_ERROR;
+
+        /* make sure each worker can take all the groups */
+        if (num_groups > m_max_groups) {
+                for (i = 0; i < m_num_workers; i++) {
+                        struct pqos_mon_data **tab;
+
+                        tab = (struct pqos_mon_data **)realloc(
+                            m_workers[i].groups, num_groups * sizeof(tab[0]));
+                        if (tab == NULL)
+                                return PQOS_RETVAL_RESOURCE;
+                        m_workers[i].groups = tab;
+                }
+                m_max_groups = num_groups;
+        }
+
+        for (i = 0; i < m_num_workers; i++)
+                m_workers[i].num_groups = 0;
+
+        for (i = 0; i < num_groups; i++) {
+                struct mon_pool_worker *worker =
+                    mon_pool_get_worker(cpu, groups[i], i);
+
+                worker->groups[worker->num_groups++] = groups[i];
+        }
+
+        /* wake up workers and wait for them to complete */
+        pthread_mutex_lock(&m_lock);
+        m_pending = m_num_workers;
+        m_generation++;
+        pthread_cond_broadcast(&m_cond_start);
+        while (m_pending > 0)
+                pthread_cond_wait(&m_cond_done, &m_lock);
+        pthread_mutex_unlock(&m_lock);
+
+        for (i = 0; i < m_num_workers; i++)
+                if (m_workers[i].ret != PQOS_RETVAL_OK)
+                        ret = m_workers[i].ret;
+
+        return ret;
+}
@@ -0,0 +1,98 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2022 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+/**
+ * @brief Internal header file to PQoS monitoring poll worker pool
+ */
+
+#ifndef __PQOS_MON_POOL_H__
+#define __PQOS_MON_POOL_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "pqos.h"
+#include "types.h"
+
+/**
+ * @brief Starts monitoring poll worker threads
+ *
+ * One worker thread is started for each socket, L3 cluster or core,
+ * depending on \a mode. Worker is pinned to the cores of its domain.
+ *
+ * @param [in] cpu cpu topology structure
+ * @param [in] mode monitoring poll mode
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+PQOS_LOCAL int mon_pool_init(const struct pqos_cpuinfo *cpu,
+                             const enum pqos_mon_poll_mode mode);
+
+/**
+ * @brief Stops monitoring poll worker threads
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+PQOS_LOCAL int mon_pool_fini(void);
+
+/**
+ * @brief Checks if monitoring poll worker pool is running
+ *
+ * @return 1 if worker pool is running, 0 otherwise
+ */
+PQOS_LOCAL int mon_pool_enabled(void);
+
+/**
+ * @brief Polls monitoring groups using worker threads
+ *
+ * Groups are distributed to workers by the domain of their first poll
+ * context. Function returns once all workers completed.
+ *
+ * @param [in] groups table of monitoring groups
+ * @param [in] num_groups number of monitoring groups
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+PQOS_LOCAL int mon_pool_poll(struct pqos_mon_data **groups,
+                             const unsigned num_groups);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PQOS_MON_POOL_H__ */
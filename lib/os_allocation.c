@@ -432,6 +432,16 @@ os_alloc_assign(const unsigned technology,
         return ret;
 }
 
+int
+os_alloc_assoc_resync(int *changed)
+{
+        ASSERT(changed != NULL);
+
+        *changed = 0;
+
+        return PQOS_RETVAL_OK;
+}
+
 int
 os_alloc_release(const unsigned *core_array, const unsigned core_num)
 {
@@ -582,6 +592,71 @@ filter_pids(const struct dirent *dir)
         return 1;
 }
 
+/**
+ * @brief Associates task with COS and keeps its monitoring group
+ *
+ * Task association is looked up in the task to COS index, which has to be
+ * invalidated by the caller when a new operation starts.
+ *
+ * @param [in] task task ID to be associated
+ * @param [in] class_id class of service
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+os_alloc_task_set(const pid_t task, const unsigned class_id)
+{
+        int ret;
+        unsigned max_cos = 0;
+        int ret_mon;
+        char mon_group[256];
+        const struct pqos_cap *cap = _pqos_get_cap();
+
+        /* Get number of COS */
+        ret = resctrl_alloc_get_grps_num(cap, &max_cos);
+        if (ret != PQOS_RETVAL_OK)
+                return ret;
+
+        if (class_id >= max_cos) {
+                LOG_ERROR("COS out of bounds for task %d\n", (int)task);
+                return PQOS_RETVAL_PARAM;
+        }
+
+        ret = resctrl_lock_exclusive();
+        if (ret != PQOS_RETVAL_OK)
+                return ret;
+
+        /*
+         * When task is moved to different COS we need to update monitoring
+         * groups. Obtain monitoring group name
+         */
+        ret_mon = resctrl_mon_assoc_get_pid(task, mon_group, sizeof(mon_group));
+        if (ret_mon != PQOS_RETVAL_OK && ret_mon != PQOS_RETVAL_RESOURCE)
+                LOG_WARN("Failed to obtain monitoring group assignment for "
+                         "task %d\n",
+                         task);
+
+        /* Write to tasks file */
+        ret = resctrl_alloc_assoc_set_pid(task, class_id);
+        if (ret != PQOS_RETVAL_OK)
+                goto os_alloc_task_set_exit;
+
+        /* Task monitoring was started assign it back to monitoring group */
+        if (ret_mon == PQOS_RETVAL_OK) {
+                ret_mon = resctrl_mon_assoc_set_pid(task, mon_group);
+                if (ret_mon != PQOS_RETVAL_OK)
+                        LOG_WARN("Could not assign task %d back to monitoring "
+                                 "group\n",
+                                 task);
+        }
+
+os_alloc_task_set_exit:
+        resctrl_lock_release();
+
+        return ret;
+}
+
 int
 os_alloc_reset_tasks(void)
 {
@@ -596,9 +671,11 @@ os_alloc_reset_tasks(void)
 
         pid_count = scandir("/proc", &pids_list, filter_pids, NULL);
 
+        /* task index is built once for all tasks */
+        resctrl_alloc_task_index_invalidate();
         for (pid_idx = 0; pid_idx < pid_count; ++pid_idx) {
                 pid = atoi(pids_list[pid_idx]->d_name);
-                alloc_result = os_alloc_assoc_set_pid(pid, cos0);
+                alloc_result = os_alloc_task_set(pid, cos0);
                 if (alloc_result == PQOS_RETVAL_PARAM) {
                         LOG_DEBUG("Task %d no longer exists\n", pid);
                         alloc_result = PQOS_RETVAL_OK;
@@ -979,6 +1056,7 @@ os_alloc_reset(const enum pqos_cdp_config l3_cdp_cfg,
                 ret = os_alloc_reset_light(l3_cap, l2_cap, mba_cap);
 
 os_alloc_reset_exit:
+        resctrl_alloc_task_index_invalidate();
         return ret;
 }
 
@@ -1834,20 +1912,36 @@ os_mba_get_exit:
 
 int
 os_alloc_assoc_set_pid(const pid_t task, const unsigned class_id)
+{
+        resctrl_alloc_task_index_invalidate();
+
+        return os_alloc_task_set(task, class_id);
+}
+
+int
+os_alloc_assoc_set_pids(const pid_t *tasks,
+                        const unsigned num_tasks,
+                        const unsigned class_id,
+                        int *status)
 {
         int ret;
+        unsigned i;
         unsigned max_cos = 0;
-        int ret_mon;
-        char mon_group[256];
+        unsigned mon_active = 0;
+        char **mon_groups = NULL;
+        int *task_status = NULL;
         const struct pqos_cap *cap = _pqos_get_cap();
 
+        ASSERT(tasks != NULL);
+        ASSERT(num_tasks > 0);
+
         /* Get number of COS */
         ret = resctrl_alloc_get_grps_num(cap, &max_cos);
         if (ret != PQOS_RETVAL_OK)
                 return ret;
 
         if (class_id >= max_cos) {
-                LOG_ERROR("COS out of bounds for task %d\n", (int)task);
+                LOG_ERROR("COS out of bounds for tasks\n");
                 return PQOS_RETVAL_PARAM;
         }
 
@@ -1855,33 +1949,61 @@ os_alloc_assoc_set_pid(const pid_t task, const unsigned class_id)
         if (ret != PQOS_RETVAL_OK)
                 return ret;
 
+        resctrl_alloc_task_index_invalidate();
+
+        ret = resctrl_mon_active(&mon_active);
+        if (ret != PQOS_RETVAL_OK)
+                goto os_alloc_assoc_set_pids_exit;
+
         /*
-         * When task is moved to different COS we need to update monitoring
-         * groups. Obtain monitoring group name
+         * When tasks are moved to different COS we need to update monitoring
+         * groups. Obtain monitoring group names
          */
-        ret_mon = resctrl_mon_assoc_get_pid(task, mon_group, sizeof(mon_group));
-        if (ret_mon != PQOS_RETVAL_OK && ret_mon != PQOS_RETVAL_RESOURCE)
-                LOG_WARN("Failed to obtain monitoring group assignment for "
-                         "task %d\n",
-                         task);
+        if (mon_active) {
+                mon_groups = calloc(num_tasks, sizeof(mon_groups[0]));
+                if (mon_groups == NULL) {
+                        ret = PQOS_RETVAL_RESOURCE;
+                        goto os_alloc_assoc_set_pids_exit;
+                }
+
+                /* Single pass over monitoring groups for all tasks */
+                ret = resctrl_mon_assoc_get_pids(tasks, num_tasks, mon_groups);
+                if (ret != PQOS_RETVAL_OK && ret != PQOS_RETVAL_RESOURCE)
+                        LOG_WARN("Failed to obtain monitoring group "
+                                 "assignment for tasks\n");
+
+                /* Tasks not moved to the COS stay in their groups */
+                if (status == NULL) {
+                        status = task_status =
+                            calloc(num_tasks, sizeof(task_status[0]));
+                        if (status == NULL) {
+                                ret = PQOS_RETVAL_RESOURCE;
+                                goto os_alloc_assoc_set_pids_exit;
+                        }
+                }
+        }
 
         /* Write to tasks file */
-        ret = resctrl_alloc_assoc_set_pid(task, class_id);
-        if (ret != PQOS_RETVAL_OK)
-                goto os_alloc_assoc_set_pid_exit;
+        ret = resctrl_alloc_tasks_write(class_id, tasks, num_tasks, status);
+        if (ret == PQOS_RETVAL_PARAM)
+                LOG_WARN("Some tasks do not exist\n");
 
         /* Task monitoring was started assign it back to monitoring group */
-        if (ret_mon == PQOS_RETVAL_OK) {
-                ret_mon = resctrl_mon_assoc_set_pid(task, mon_group);
-                if (ret_mon != PQOS_RETVAL_OK)
-                        LOG_WARN("Could not assign task %d back to monitoring "
-                                 "group\n",
-                                 task);
-        }
+        if (mon_groups != NULL &&
+            resctrl_mon_assoc_set_pids(class_id, tasks, num_tasks, mon_groups,
+                                       status) != PQOS_RETVAL_OK)
+                LOG_WARN("Could not assign tasks back to monitoring groups\n");
 
-os_alloc_assoc_set_pid_exit:
+os_alloc_assoc_set_pids_exit:
         resctrl_lock_release();
 
+        if (mon_groups != NULL) {
+                for (i = 0; i < num_tasks; i++)
+                        free(mon_groups[i]);
+                free(mon_groups);
+        }
+        free(task_status);
+
         return ret;
 }
 
@@ -1904,13 +2026,35 @@ os_alloc_assoc_get_pid(const pid_t task, unsigned *class_id)
         return ret;
 }
 
+int
+os_alloc_assoc_get_pids(const pid_t *tasks,
+                        const unsigned num_tasks,
+                        unsigned *class_ids,
+                        int *status)
+{
+        int ret;
+
+        ASSERT(tasks != NULL);
+        ASSERT(class_ids != NULL);
+
+        ret = resctrl_lock_shared();
+        if (ret != PQOS_RETVAL_OK)
+                return ret;
+
+        ret = resctrl_alloc_assoc_get_pids(tasks, num_tasks, class_ids, status);
+
+        resctrl_lock_release();
+
+        return ret;
+}
+
 int
 os_alloc_assign_pid(const unsigned technology,
                     const pid_t *task_array,
                     const unsigned task_num,
                     unsigned *class_id)
 {
-        unsigned i, num_rctl_grps = 0;
+        unsigned num_rctl_grps = 0;
         int ret;
         const struct pqos_cap *cap = _pqos_get_cap();
 
@@ -1937,11 +2081,7 @@ os_alloc_assign_pid(const unsigned technology,
                 goto os_alloc_assign_pid_unlock;
 
         /* assign tasks to the unused class */
-        for (i = 0; i < task_num; i++) {
-                ret = resctrl_alloc_task_write(*class_id, task_array[i]);
-                if (ret != PQOS_RETVAL_OK)
-                        goto os_alloc_assign_pid_unlock;
-        }
+        ret = resctrl_alloc_tasks_write(*class_id, task_array, task_num, NULL);
 
 os_alloc_assign_pid_unlock:
         resctrl_lock_release();
@@ -1952,7 +2092,6 @@ os_alloc_assign_pid_unlock:
 int
 os_alloc_release_pid(const pid_t *task_array, const unsigned task_num)
 {
-        unsigned i;
         int ret;
 
         ASSERT(task_array != NULL);
@@ -1964,16 +2103,9 @@ os_alloc_release_pid(const pid_t *task_array, const unsigned task_num)
 
         /**
          * Write all tasks to default COS#0 tasks file
-         * - return on error
-         * - otherwise try next task in array
          */
-        for (i = 0; i < task_num; i++) {
-                ret = resctrl_alloc_task_write(0, task_array[i]);
-                if (ret != PQOS_RETVAL_OK)
-                        goto os_alloc_release_pid_unlock;
-        }
+        ret = resctrl_alloc_tasks_write(0, task_array, task_num, NULL);
 
-os_alloc_release_pid_unlock:
         resctrl_lock_release();
 
         return ret;
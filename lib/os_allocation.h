@@ -103,6 +103,18 @@ PQOS_LOCAL int os_alloc_assign(const unsigned technology,
                                const unsigned core_num,
                                unsigned *class_id);
 
+/**
+ * @brief OS interface to read COS associations again
+ *
+ * Associations are not kept by the OS interface, nothing is read.
+ *
+ * @param [out] changed always set to 0
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK
+ */
+PQOS_LOCAL int os_alloc_assoc_resync(int *changed);
+
 /**
  * @brief OS interface to reassign cores
  *        in \a core_array to default COS#0
@@ -404,6 +416,24 @@ PQOS_LOCAL unsigned *os_pid_get_pid_assoc(const unsigned class_id,
 PQOS_LOCAL int os_alloc_assoc_set_pid(const pid_t task,
                                       const unsigned class_id);
 
+/**
+ * @brief OS interface to associate multiple \a tasks
+ *        with given class of service
+ *
+ * @param [in] tasks table of task ids to be associated
+ * @param [in] num_tasks number of task ids
+ * @param [in] class_id class of service
+ * @param [out] status table to store status of each task in or NULL
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_PARAM some tasks do not exist
+ */
+PQOS_LOCAL int os_alloc_assoc_set_pids(const pid_t *tasks,
+                                       const unsigned num_tasks,
+                                       const unsigned class_id,
+                                       int *status);
+
 /**
  * @brief OS interface to read association
  *        of \a task with class of service
@@ -416,6 +446,24 @@ PQOS_LOCAL int os_alloc_assoc_set_pid(const pid_t task,
  */
 PQOS_LOCAL int os_alloc_assoc_get_pid(const pid_t task, unsigned *class_id);
 
+/**
+ * @brief OS interface to read association
+ *        of \a tasks with classes of service
+ *
+ * @param [in] tasks table of task ids
+ * @param [in] num_tasks number of task ids
+ * @param [out] class_ids table to store classes of service in
+ * @param [out] status optional table of per task statuses
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_PARAM some tasks do not exist
+ */
+PQOS_LOCAL int os_alloc_assoc_get_pids(const pid_t *tasks,
+                                       const unsigned num_tasks,
+                                       unsigned *class_ids,
+                                       int *status);
+
 #ifdef __cplusplus
 }
 #endif
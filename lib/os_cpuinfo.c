@@ -40,11 +40,20 @@
 #include <errno.h>
 #include <fnmatch.h>
 #include <limits.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h> /* sysconf() */
 
 #define SYSTEM_CPU "/sys/devices/system/cpu"
 
+/**
+ * Topology of large systems is read by up to CPU_DETECT_THREADS threads,
+ * one per CPU_DETECT_CPUS CPUs
+ */
+#define CPU_DETECT_THREADS 8
+#define CPU_DETECT_CPUS    64
+
 /**
  * @brief Filter directory filenames
  *
@@ -270,6 +279,128 @@ cpu_cache(unsigned lcore, unsigned *l3, unsigned *l2)
         return ret;
 }
 
+/**
+ * @brief Detects topology of \a lcore
+ *
+ * @param [in] lcore Logical core id
+ * @param [out] info core information to fill in
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_RESOURCE core is offline
+ */
+static int
+cpu_detect(unsigned lcore, struct pqos_coreinfo *info)
+{
+        int retval;
+
+        if (!cpu_online(lcore))
+                return PQOS_RETVAL_RESOURCE;
+
+        retval = cpu_socket(lcore, &info->socket);
+        if (retval != PQOS_RETVAL_OK)
+                return PQOS_RETVAL_ERROR;
+
+#if (PQOS_VERSION >= 50000 || defined PQOS_SNC)
+        retval = cpu_node(lcore, &info->numa);
+        if (retval != PQOS_RETVAL_OK)
+                return PQOS_RETVAL_ERROR;
+#endif
+
+        retval = cpu_cache(lcore, &info->l3_id, &info->l2_id);
+        if (retval != PQOS_RETVAL_OK)
+                return PQOS_RETVAL_ERROR;
+
+        info->lcore = lcore;
+
+        return PQOS_RETVAL_OK;
+}
+
+/**
+ * Detection of a share of CPUs
+ */
+struct cpu_detect_job {
+        pthread_t thread;
+        int started;                /**< thread was started */
+        unsigned first;             /**< first CPU of the job */
+        unsigned step;              /**< every step-th CPU is detected */
+        unsigned num_cpus;          /**< number of CPUs */
+        struct dirent **namelist;   /**< CPU directories */
+        struct pqos_coreinfo *info; /**< detected topology of each CPU */
+        int *status;                /**< detection status of each CPU */
+};
+
+/**
+ * @brief Detects topology of CPUs of a job
+ *
+ * @param [in,out] arg job
+ *
+ * @return NULL
+ */
+static void *
+cpu_detect_job(void *arg)
+{
+        struct cpu_detect_job *job = (struct cpu_detect_job *)arg;
+        unsigned i;
+
+        for (i = job->first; i < job->num_cpus; i += job->step) {
+                unsigned lcore = atoi(job->namelist[i]->d_name + 3);
+
+                job->status[i] = cpu_detect(lcore, &job->info[i]);
+        }
+
+        return NULL;
+}
+
+/**
+ * @brief Detects topology of all CPUs
+ *
+ * Sysfs files of large systems are read by several threads.
+ *
+ * @param [in] namelist CPU directories
+ * @param [in] num_cpus number of CPUs
+ * @param [out] info detected topology of each CPU
+ * @param [out] status detection status of each CPU
+ */
+static void
+cpu_detect_all(struct dirent **namelist,
+               const unsigned num_cpus,
+               struct pqos_coreinfo *info,
+               int *status)
+{
+        unsigned num_jobs = (num_cpus + CPU_DETECT_CPUS - 1) / CPU_DETECT_CPUS;
+        struct cpu_detect_job jobs[CPU_DETECT_THREADS];
+        unsigned i;
+
+        if (num_jobs > CPU_DETECT_THREADS)
+                num_jobs = CPU_DETECT_THREADS;
+        if (num_jobs == 0)
+                num_jobs = 1;
+
+        for (i = 0; i < num_jobs; i++) {
+                jobs[i].started = 0;
+                jobs[i].first = i;
+                jobs[i].step = num_jobs;
+                jobs[i].num_cpus = num_cpus;
+                jobs[i].namelist = namelist;
+                jobs[i].info = info;
+                jobs[i].status = status;
+        }
+
+        /* first job is run by the calling thread */
+        for (i = 1; i < num_jobs; i++)
+                jobs[i].started = pthread_create(&jobs[i].thread, NULL,
+                                                 cpu_detect_job, &jobs[i]) == 0;
+
+        for (i = 0; i < num_jobs; i++)
+                if (!jobs[i].started)
+                        cpu_detect_job(&jobs[i]);
+
+        for (i = 1; i < num_jobs; i++)
+                if (jobs[i].started)
+                        pthread_join(jobs[i].thread, NULL);
+}
+
 /**
  * @brief Builds CPU topology structure
  *
@@ -281,6 +412,8 @@ os_cpuinfo_topology(void)
 {
         struct pqos_cpuinfo *cpu = NULL;
         struct dirent **namelist = NULL;
+        struct pqos_coreinfo *info = NULL;
+        int *status = NULL;
         int max_core_count;
         int num_cpus;
         int i;
@@ -303,8 +436,8 @@ os_cpuinfo_topology(void)
                 LOG_ERROR("Couldn't allocate CPU topology structure!\n");
                 return NULL;
         }
-        cpu->mem_size = (unsigned)mem_sz;
         memset(cpu, 0, mem_sz);
+        cpu->mem_size = (unsigned)mem_sz;
 
         num_cpus = scandir(SYSTEM_CPU, &namelist, filter_cpu, cpu_sort);
         if (num_cpus <= 0 || max_core_count < num_cpus) {
@@ -313,46 +446,45 @@ os_cpuinfo_topology(void)
                 return NULL;
         }
 
-        for (i = 0; i < num_cpus; i++) {
-                unsigned lcore = atoi(namelist[i]->d_name + 3);
-                struct pqos_coreinfo *info = &cpu->cores[cpu->num_cores];
-
-                if (!cpu_online(lcore))
-                        continue;
-
-                retval = cpu_socket(lcore, &info->socket);
-                if (retval != PQOS_RETVAL_OK)
-                        break;
+        info = calloc(num_cpus, sizeof(*info));
+        status = calloc(num_cpus, sizeof(*status));
+        if (info == NULL || status == NULL) {
+                LOG_ERROR("Couldn't allocate CPU topology structure!\n");
+                retval = PQOS_RETVAL_RESOURCE;
+                goto os_cpuinfo_topology_exit;
+        }
 
-#if (PQOS_VERSION >= 50000 || defined PQOS_SNC)
-                retval = cpu_node(lcore, &info->numa);
-                if (retval != PQOS_RETVAL_OK)
-                        break;
-#endif
+        cpu_detect_all(namelist, num_cpus, info, status);
 
-                retval = cpu_cache(lcore, &info->l3_id, &info->l2_id);
+        for (i = 0; i < num_cpus; i++) {
+                if (status[i] == PQOS_RETVAL_RESOURCE)
+                        continue;
+                retval = status[i];
                 if (retval != PQOS_RETVAL_OK)
                         break;
 
-                info->lcore = lcore;
+                cpu->cores[cpu->num_cores] = info[i];
 
                 LOG_DEBUG("Detected core %u, socket %u, "
 #if (PQOS_VERSION >= 50000 || defined PQOS_SNC)
                           "NUMAnode %u, "
 #endif
                           "L2 ID %u, L3 ID %u\n",
-                          info->lcore, info->socket,
+                          info[i].lcore, info[i].socket,
 #if (PQOS_VERSION >= 50000 || defined PQOS_SNC)
-                          info->numa,
+                          info[i].numa,
 #endif
-                          info->l2_id, info->l3_id);
+                          info[i].l2_id, info[i].l3_id);
 
                 cpu->num_cores++;
         }
 
+os_cpuinfo_topology_exit:
         for (i = 0; i < num_cpus; i++)
                 free(namelist[i]);
         free(namelist);
+        free(info);
+        free(status);
 
         if (retval != PQOS_RETVAL_OK) {
                 free(cpu);
@@ -37,8 +37,10 @@
 #include "log.h"
 #include "monitoring.h"
 #include "perf_monitoring.h"
+#include "proc_conn.h"
 #include "resctrl.h"
 #include "resctrl_monitoring.h"
+#include "uring.h"
 
 #include <dirent.h> /**< scandir() */
 #include <stdlib.h>
@@ -60,6 +62,27 @@ static const enum pqos_mon_event os_mon_event[] = {
     (enum pqos_mon_event)PQOS_PERF_EVENT_CYCLES,
     (enum pqos_mon_event)PQOS_PERF_EVENT_INSTRUCTIONS};
 
+/** Table of counter reads prefetched in one batch */
+static struct uring_read **prefetch_reads = NULL;
+static unsigned prefetch_size = 0;
+
+/** Monitored process tracking mode */
+static enum pqos_mon_pid_track track_mode = PQOS_MON_PID_TRACK_NONE;
+/** Monitoring groups following process events */
+static struct pqos_mon_data **track_groups = NULL;
+static unsigned track_num = 0;
+static unsigned track_size = 0;
+/** Tracked processes, to index of the owning group in track_groups */
+static struct tid_hash track_owner;
+/** Process events read in one batch */
+static struct proc_conn_event *track_events = NULL;
+static unsigned track_events_num = 0;
+static unsigned track_events_size = 0;
+/** Set when process events could not be stored */
+static int track_lost = 0;
+/** TIDs exiting in the current batch, to index of the exit event */
+static struct tid_hash track_exited;
+
 /**
  * @brief Filter directory filenames
  *
@@ -353,15 +376,26 @@ os_mon_init(const struct pqos_cpuinfo *cpu, const struct pqos_cap *cap)
         if (ret != PQOS_RETVAL_OK)
                 return ret;
 
+        if (uring_init() == PQOS_RETVAL_OK)
+                LOG_INFO("Counters are read with io_uring\n");
+
         return ret;
 }
 
 int
 os_mon_fini(void)
 {
+        os_mon_track_fini();
+        uring_fini();
         perf_mon_fini();
         resctrl_mon_fini();
 
+        if (prefetch_reads != NULL) {
+                free(prefetch_reads);
+                prefetch_reads = NULL;
+        }
+        prefetch_size = 0;
+
         return PQOS_RETVAL_OK;
 }
 
@@ -390,8 +424,11 @@ os_mon_stop(struct pqos_mon_data *group)
                 group->cores = NULL;
         }
         if (group->tid_nr > 0) {
+                os_mon_track_del(group);
                 free(group->tid_map);
                 group->tid_map = NULL;
+                tid_hash_fini(&group->intl->task.tids);
+                tid_hash_fini(&group->intl->task.pids);
         }
 
         return ret;
@@ -498,18 +535,22 @@ tid_exists(const pid_t tid, const unsigned tid_nr, const pid_t *tid_map)
  * @brief Add TID to \a tid_map
  *
  * @param[in] tid TID number to add
- * @param[in] tid_nr length of \a tid_map
- * @param[in] tid_map list of TIDs
+ * @param[in,out] tid_nr length of \a tid_map
+ * @param[in,out] tid_map list of TIDs
+ * @param[in,out] tid_index TID to \a tid_map index hash
  *
  * @return Operational status
  * @retval PQOS_RETVAL_OK on success
  */
 static int
-tid_add(const pid_t tid, unsigned *tid_nr, pid_t **tid_map)
+tid_add(const pid_t tid,
+        unsigned *tid_nr,
+        pid_t **tid_map,
+        struct tid_hash *tid_index)
 {
         pid_t *tids = NULL;
 
-        if (tid_exists(tid, *tid_nr, *tid_map))
+        if (tid_hash_get(tid_index, tid, NULL))
                 return PQOS_RETVAL_OK;
 
         tids = realloc(*tid_map, sizeof(pid_t) * (*tid_nr + 1));
@@ -517,10 +558,15 @@ tid_add(const pid_t tid, unsigned *tid_nr, pid_t **tid_map)
                 LOG_ERROR("TID map allocation error!\n");
                 return PQOS_RETVAL_ERROR;
         }
+        *tid_map = tids;
+
+        if (tid_hash_put(tid_index, tid, *tid_nr) != PQOS_RETVAL_OK) {
+                LOG_ERROR("TID map allocation error!\n");
+                return PQOS_RETVAL_ERROR;
+        }
 
         tids[*tid_nr] = tid;
         (*tid_nr)++;
-        *tid_map = tids;
 
         return PQOS_RETVAL_OK;
 }
@@ -531,12 +577,16 @@ tid_add(const pid_t tid, unsigned *tid_nr, pid_t **tid_map)
  * @param[in] pid peocess id
  * @param[in,out] tid_nr number of tids
  * @param[in,out] tid_map tid mapping
+ * @param[in,out] tid_index TID to \a tid_map index hash
  *
  * @return Operations status
  * @retval PQOS_RETVAL_OK on success
  */
 static int
-tid_find(const pid_t pid, unsigned *tid_nr, pid_t **tid_map)
+tid_find(const pid_t pid,
+         unsigned *tid_nr,
+         pid_t **tid_map,
+         struct tid_hash *tid_index)
 {
         char buf[64];
         pid_t tid;
@@ -558,11 +608,11 @@ tid_find(const pid_t pid, unsigned *tid_nr, pid_t **tid_map)
          */
         tid = atoi(namelist[0]->d_name);
         if (pid != tid)
-                ret = tid_add(pid, tid_nr, tid_map);
+                ret = tid_add(pid, tid_nr, tid_map, tid_index);
         else
                 for (i = 0; i < num_tasks; i++) {
                         ret = tid_add((pid_t)atoi(namelist[i]->d_name), tid_nr,
-                                      tid_map);
+                                      tid_map, tid_index);
                         if (ret != PQOS_RETVAL_OK)
                                 break;
                 }
@@ -610,12 +660,15 @@ os_mon_start_pids(const unsigned num_pids,
         unsigned i;
         pid_t *tid_map = NULL;
         unsigned tid_nr = 0;
+        struct tid_hash tid_index;
 
         ASSERT(group != NULL);
         ASSERT(num_pids > 0);
         ASSERT(event > 0);
         ASSERT(pids != NULL);
 
+        tid_hash_init(&tid_index);
+
         /**
          * Check if all PIDs exists
          */
@@ -632,7 +685,7 @@ os_mon_start_pids(const unsigned num_pids,
          * Get TID's for selected tasks
          */
         for (i = 0; i < num_pids; i++) {
-                ret = tid_find(pids[i], &tid_nr, &tid_map);
+                ret = tid_find(pids[i], &tid_nr, &tid_map, &tid_index);
                 if (ret != PQOS_RETVAL_OK)
                         goto os_mon_start_pids_exit;
         }
@@ -643,6 +696,12 @@ os_mon_start_pids(const unsigned num_pids,
                 goto os_mon_start_pids_exit;
         }
 
+        for (i = 0; i < num_pids; i++) {
+                ret = tid_hash_put(&group->intl->task.pids, pids[i], i);
+                if (ret != PQOS_RETVAL_OK)
+                        goto os_mon_start_pids_exit;
+        }
+
         group->context = context;
         group->tid_nr = tid_nr;
         group->tid_map = tid_map;
@@ -653,10 +712,19 @@ os_mon_start_pids(const unsigned num_pids,
                 group->pids[i] = pids[i];
 
         ret = start_events(group);
+        if (ret == PQOS_RETVAL_OK) {
+                group->intl->task.tids = tid_index;
+                tid_hash_init(&tid_index);
+                os_mon_track_add(group);
+        }
 
 os_mon_start_pids_exit:
-        if (ret != PQOS_RETVAL_OK && tid_map != NULL)
-                free(tid_map);
+        if (ret != PQOS_RETVAL_OK) {
+                if (tid_map != NULL)
+                        free(tid_map);
+                tid_hash_fini(&group->intl->task.pids);
+        }
+        tid_hash_fini(&tid_index);
 
         return ret;
 }
@@ -674,12 +742,14 @@ os_mon_add_pids(const unsigned num_pids,
         struct pqos_mon_data added;
         struct pqos_mon_perf_ctx *ctx;
         unsigned num_duplicated = 0;
+        struct tid_hash tid_index;
 
         ASSERT(group != NULL);
         ASSERT(num_pids > 0);
         ASSERT(pids != NULL);
 
         memset(&added, 0, sizeof(added));
+        tid_hash_init(&tid_index);
 
         /**
          * Check if all PIDs exists
@@ -697,7 +767,7 @@ os_mon_add_pids(const unsigned num_pids,
          * Get TID's for added tasks
          */
         for (i = 0; i < num_pids; i++) {
-                ret = tid_find(pids[i], &tid_nr, &tid_map);
+                ret = tid_find(pids[i], &tid_nr, &tid_map, &tid_index);
                 if (ret != PQOS_RETVAL_OK)
                         goto os_mon_add_pids_exit;
         }
@@ -706,7 +776,7 @@ os_mon_add_pids(const unsigned num_pids,
          * Find duplicated tids
          */
         for (i = 0; i < tid_nr; i++) {
-                if (tid_exists(tid_map[i], group->tid_nr, group->tid_map)) {
+                if (tid_hash_get(&group->intl->task.tids, tid_map[i], NULL)) {
                         num_duplicated++;
                         continue;
                 }
@@ -772,15 +842,28 @@ os_mon_add_pids(const unsigned num_pids,
         }
         group->pids = ptr;
 
+        if (tid_hash_reserve(&group->intl->task.tids,
+                             group->tid_nr + added.tid_nr) != PQOS_RETVAL_OK ||
+            tid_hash_reserve(&group->intl->task.pids,
+                             group->num_pids + num_pids) != PQOS_RETVAL_OK) {
+                ret = PQOS_RETVAL_RESOURCE;
+                goto os_mon_add_pids_exit;
+        }
+
         for (i = 0; i < added.tid_nr; i++) {
                 group->tid_map[group->tid_nr] = added.tid_map[i];
                 group->intl->perf.ctx[group->tid_nr] = added.intl->perf.ctx[i];
+                (void)tid_hash_put(&group->intl->task.tids, added.tid_map[i],
+                                   group->tid_nr);
                 group->tid_nr++;
         }
         for (i = 0; i < num_pids; i++) {
                 group->pids[group->num_pids] = pids[i];
+                (void)tid_hash_put(&group->intl->task.pids, pids[i],
+                                   group->num_pids);
                 group->num_pids++;
         }
+        os_mon_track_add_pids(group, num_pids, pids);
 
 os_mon_add_pids_exit:
         if (added.intl != NULL && added.intl->resctrl.mon_group != NULL) {
@@ -798,6 +881,7 @@ os_mon_add_pids_exit:
         }
         if (tid_map != NULL)
                 free(tid_map);
+        tid_hash_fini(&tid_index);
         return ret;
 }
 
@@ -813,12 +897,14 @@ os_mon_remove_pids(const unsigned num_pids,
         unsigned keep_tid_nr = 0;
         struct pqos_mon_data remove;
         unsigned removed;
+        struct tid_hash keep_tid_index;
 
         ASSERT(num_pids > 0);
         ASSERT(pids != NULL);
         ASSERT(group != NULL);
 
         memset(&remove, 0, sizeof(remove));
+        tid_hash_init(&keep_tid_index);
 
         /**
          * Find TID's for not removed tasks
@@ -832,7 +918,8 @@ os_mon_remove_pids(const unsigned num_pids,
                 if (!tid_verify(group->pids[i]))
                         continue;
 
-                ret = tid_find(group->pids[i], &keep_tid_nr, &keep_tid_map);
+                ret = tid_find(group->pids[i], &keep_tid_nr, &keep_tid_map,
+                               &keep_tid_index);
                 if (ret != PQOS_RETVAL_OK)
                         goto os_mon_remove_pids_exit;
         }
@@ -843,6 +930,9 @@ os_mon_remove_pids(const unsigned num_pids,
                 goto os_mon_remove_pids_exit;
         memset(remove.intl, 0, sizeof(*remove.intl));
         remove.intl->perf.event = group->intl->perf.event;
+        memcpy(remove.intl->perf.group, group->intl->perf.group,
+               sizeof(remove.intl->perf.group));
+        remove.intl->perf.num_group = group->intl->perf.num_group;
         remove.intl->resctrl.event = group->intl->resctrl.event;
         remove.pids = NULL;
         remove.num_pids = num_pids;
@@ -857,7 +947,7 @@ os_mon_remove_pids(const unsigned num_pids,
         /* Add tid's for removal */
         for (i = 0; i < group->tid_nr; i++) {
                 /* TID is not removed */
-                if (tid_exists(group->tid_map[i], keep_tid_nr, keep_tid_map))
+                if (tid_hash_get(&keep_tid_index, group->tid_map[i], NULL))
                         continue;
 
                 remove.tid_map[remove.tid_nr] = group->tid_map[i];
@@ -875,7 +965,7 @@ os_mon_remove_pids(const unsigned num_pids,
         removed = 0;
         for (i = 0; i < group->tid_nr; i++) {
                 /* TID does not exists on the not keep list */
-                if (!tid_exists(group->tid_map[i], keep_tid_nr, keep_tid_map)) {
+                if (!tid_hash_get(&keep_tid_index, group->tid_map[i], NULL)) {
                         removed++;
                         continue;
                 }
@@ -902,6 +992,16 @@ os_mon_remove_pids(const unsigned num_pids,
         group->pids =
             realloc(group->pids, sizeof(group->pids[0]) * group->num_pids);
 
+        /* indexes only shrink, so no memory is allocated */
+        tid_hash_clear(&group->intl->task.tids);
+        for (i = 0; i < group->tid_nr; i++)
+                (void)tid_hash_put(&group->intl->task.tids, group->tid_map[i],
+                                   i);
+        tid_hash_clear(&group->intl->task.pids);
+        for (i = 0; i < group->num_pids; i++)
+                (void)tid_hash_put(&group->intl->task.pids, group->pids[i], i);
+        os_mon_track_remove_pids(group, num_pids, pids);
+
 os_mon_remove_pids_exit:
         if (remove.tid_map != NULL)
                 free(remove.tid_map);
@@ -912,6 +1012,50 @@ os_mon_remove_pids_exit:
         }
         if (keep_tid_map != NULL)
                 free(keep_tid_map);
+        tid_hash_fini(&keep_tid_index);
+        return ret;
+}
+
+int
+os_mon_poll_prefetch(struct pqos_mon_data **groups, const unsigned num_groups)
+{
+        unsigned num_resctrl;
+        unsigned num;
+        int ret;
+
+        ASSERT(groups != NULL);
+
+        if (!uring_enabled())
+                return PQOS_RETVAL_OK;
+
+        num_resctrl = resctrl_mon_prefetch(groups, num_groups, NULL);
+        num = num_resctrl + perf_mon_prefetch(groups, num_groups, NULL);
+        if (num == 0)
+                return PQOS_RETVAL_OK;
+
+        if (num > prefetch_size) {
+                struct uring_read **ptr =
+                    realloc(prefetch_reads, num * sizeof(ptr[0]));
+
+                if (ptr == NULL)
+                        return PQOS_RETVAL_RESOURCE;
+                prefetch_reads = ptr;
+                prefetch_size = num;
+        }
+
+        if (num_resctrl > 0) {
+                ret = resctrl_lock_shared();
+                if (ret != PQOS_RETVAL_OK)
+                        return ret;
+        }
+
+        num = resctrl_mon_prefetch(groups, num_groups, prefetch_reads);
+        num += perf_mon_prefetch(groups, num_groups, &prefetch_reads[num]);
+        ret = uring_read(prefetch_reads, num);
+
+        if (num_resctrl > 0)
+                resctrl_lock_release();
+
         return ret;
 }
 
@@ -934,3 +1078,536 @@ os_mon_poll(struct pqos_mon_data **groups, const unsigned num_groups)
 
         return PQOS_RETVAL_OK;
 }
+
+int
+os_mon_assoc_verify(int *changed)
+{
+        ASSERT(changed != NULL);
+
+        *changed = 0;
+
+        return PQOS_RETVAL_OK;
+}
+
+int
+os_mon_track_init(const enum pqos_mon_pid_track mode)
+{
+        int ret;
+
+        if (mode == PQOS_MON_PID_TRACK_NONE)
+                return PQOS_RETVAL_OK;
+
+        ret = proc_conn_init();
+        if (ret != PQOS_RETVAL_OK)
+                return ret;
+
+        track_mode = mode;
+        tid_hash_init(&track_owner);
+        tid_hash_init(&track_exited);
+
+        return PQOS_RETVAL_OK;
+}
+
+void
+os_mon_track_fini(void)
+{
+        proc_conn_fini();
+
+        if (track_groups != NULL) {
+                free(track_groups);
+                track_groups = NULL;
+        }
+        track_num = 0;
+        track_size = 0;
+
+        if (track_events != NULL) {
+                free(track_events);
+                track_events = NULL;
+        }
+        track_events_num = 0;
+        track_events_size = 0;
+        track_lost = 0;
+
+        tid_hash_fini(&track_owner);
+        tid_hash_fini(&track_exited);
+        track_mode = PQOS_MON_PID_TRACK_NONE;
+}
+
+/**
+ * @brief Removes processes of the group from the owner table
+ *
+ * @param [in] group monitoring structure
+ * @param [in] idx index of the group in track_groups
+ */
+static void
+track_owner_del(const struct pqos_mon_data *group, const unsigned idx)
+{
+        unsigned i, owner;
+
+        for (i = 0; i < group->num_pids; i++)
+                if (tid_hash_get(&track_owner, group->pids[i], &owner) &&
+                    owner == idx)
+                        (void)tid_hash_del(&track_owner, group->pids[i]);
+}
+
+/**
+ * @brief Looks up group owning the task
+ *
+ * Entry not matching a tracked group that follows the process is dropped.
+ *
+ * @param [in] tgid process id
+ * @param [out] idx index of the group in track_groups, can be NULL
+ *
+ * @return Monitoring group or NULL if process is not tracked
+ */
+static struct pqos_mon_data *
+track_owner_get(const pid_t tgid, unsigned *idx)
+{
+        struct pqos_mon_data *group;
+        unsigned owner;
+
+        if (!tid_hash_get(&track_owner, tgid, &owner))
+                return NULL;
+
+        if (owner >= track_num) {
+                (void)tid_hash_del(&track_owner, tgid);
+                return NULL;
+        }
+
+        group = track_groups[owner];
+        if (!tid_hash_get(&group->intl->task.pids, tgid, NULL)) {
+                (void)tid_hash_del(&track_owner, tgid);
+                return NULL;
+        }
+
+        if (idx != NULL)
+                *idx = owner;
+
+        return group;
+}
+
+/**
+ * @brief Finds slot of the group in track_groups
+ *
+ * @param [in] group monitoring structure
+ *
+ * @return Index of the group, track_num if group is not tracked
+ */
+static unsigned
+track_slot(const struct pqos_mon_data *group)
+{
+        unsigned i;
+
+        for (i = 0; i < track_num; i++)
+                if (track_groups[i] == group)
+                        break;
+
+        return i;
+}
+
+void
+os_mon_track_add(struct pqos_mon_data *group)
+{
+        unsigned i;
+
+        ASSERT(group != NULL);
+
+        if (!proc_conn_enabled())
+                return;
+
+        if (track_num == track_size) {
+                const unsigned size = track_size > 0 ? track_size * 2 : 8;
+                struct pqos_mon_data **ptr =
+                    realloc(track_groups, size * sizeof(ptr[0]));
+
+                if (ptr == NULL) {
+                        LOG_WARN("Tasks of monitoring group will not be "
+                                 "tracked\n");
+                        return;
+                }
+                track_groups = ptr;
+                track_size = size;
+        }
+
+        for (i = 0; i < group->num_pids; i++)
+                if (tid_hash_put(&track_owner, group->pids[i], track_num) !=
+                    PQOS_RETVAL_OK) {
+                        LOG_WARN("Tasks of monitoring group will not be "
+                                 "tracked\n");
+                        track_owner_del(group, track_num);
+                        return;
+                }
+
+        track_groups[track_num++] = group;
+}
+
+void
+os_mon_track_del(struct pqos_mon_data *group)
+{
+        unsigned i, j, owner;
+
+        ASSERT(group != NULL);
+
+        i = track_slot(group);
+        if (i == track_num)
+                return;
+
+        track_owner_del(group, i);
+        if (--track_num == i)
+                return;
+
+        /* last group takes the released slot */
+        group = track_groups[track_num];
+        track_groups[i] = group;
+        for (j = 0; j < group->num_pids; j++)
+                if (tid_hash_get(&track_owner, group->pids[j], &owner) &&
+                    owner == track_num)
+                        (void)tid_hash_put(&track_owner, group->pids[j], i);
+}
+
+void
+os_mon_track_add_pids(const struct pqos_mon_data *group,
+                      const unsigned num_pids,
+                      const pid_t *pids)
+{
+        const unsigned idx = track_slot(group);
+        unsigned i;
+
+        if (idx == track_num)
+                return;
+
+        for (i = 0; i < num_pids; i++)
+                if (tid_hash_put(&track_owner, pids[i], idx) != PQOS_RETVAL_OK)
+                        LOG_WARN("Task %d will not be tracked\n",
+                                 (int)pids[i]);
+}
+
+void
+os_mon_track_remove_pids(const struct pqos_mon_data *group,
+                         const unsigned num_pids,
+                         const pid_t *pids)
+{
+        const unsigned idx = track_slot(group);
+        unsigned i, owner;
+
+        if (idx == track_num)
+                return;
+
+        for (i = 0; i < num_pids; i++)
+                if (tid_hash_get(&track_owner, pids[i], &owner) &&
+                    owner == idx)
+                        (void)tid_hash_del(&track_owner, pids[i]);
+}
+
+/**
+ * @brief Stores process event for processing after the batch is read
+ *
+ * @param [in] event process event
+ * @param [in] arg not used
+ */
+static void
+track_event_store(const struct proc_conn_event *event, void *arg)
+{
+        UNUSED_PARAM(arg);
+
+        if (track_events_num == track_events_size) {
+                const unsigned size =
+                    track_events_size > 0 ? track_events_size * 2 : 64;
+                struct proc_conn_event *ptr =
+                    realloc(track_events, size * sizeof(ptr[0]));
+
+                if (ptr == NULL) {
+                        track_lost = 1;
+                        return;
+                }
+                track_events = ptr;
+                track_events_size = size;
+        }
+
+        track_events[track_events_num++] = *event;
+}
+
+/**
+ * @brief Starts monitoring of a task joining the group
+ *
+ * @param [in,out] group monitoring structure
+ * @param [in] tid task id
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+track_task_attach(struct pqos_mon_data *group, const pid_t tid)
+{
+        struct pqos_mon_perf_ctx *ctx;
+        pid_t *tid_map;
+        int ret;
+
+        if (tid_hash_get(&group->intl->task.tids, tid, NULL))
+                return PQOS_RETVAL_OK;
+
+        tid_map =
+            realloc(group->tid_map, sizeof(tid_map[0]) * (group->tid_nr + 1));
+        if (tid_map == NULL)
+                return PQOS_RETVAL_RESOURCE;
+        group->tid_map = tid_map;
+
+        ctx = realloc(group->intl->perf.ctx,
+                      sizeof(ctx[0]) * (group->tid_nr + 1));
+        if (ctx == NULL)
+                return PQOS_RETVAL_RESOURCE;
+        group->intl->perf.ctx = ctx;
+
+        ret = tid_hash_put(&group->intl->task.tids, tid, group->tid_nr);
+        if (ret != PQOS_RETVAL_OK)
+                return ret;
+
+        /* resctrl monitoring group is inherited from the parent task */
+        ret = perf_mon_start_task(group, tid, &ctx[group->tid_nr]);
+        if (ret != PQOS_RETVAL_OK) {
+                (void)tid_hash_del(&group->intl->task.tids, tid);
+                return ret;
+        }
+
+        tid_map[group->tid_nr] = tid;
+        group->tid_nr++;
+
+        return PQOS_RETVAL_OK;
+}
+
+/**
+ * @brief Stops monitoring of a task leaving the group
+ *
+ * Last task of the group is kept, so the group stays valid.
+ *
+ * @param [in,out] group monitoring structure
+ * @param [in] idx index of the task in tid_map
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+track_task_detach(struct pqos_mon_data *group, const unsigned idx)
+{
+        struct tid_hash *tids = &group->intl->task.tids;
+        const unsigned last = group->tid_nr - 1;
+        int ret;
+
+        ASSERT(idx < group->tid_nr);
+
+        if (group->tid_nr <= 1)
+                return PQOS_RETVAL_OK;
+
+        ret = perf_mon_stop_task(group, &group->intl->perf.ctx[idx]);
+
+        (void)tid_hash_del(tids, group->tid_map[idx]);
+        if (idx != last) {
+                group->tid_map[idx] = group->tid_map[last];
+                group->intl->perf.ctx[idx] = group->intl->perf.ctx[last];
+                (void)tid_hash_put(tids, group->tid_map[idx], idx);
+        }
+        group->tid_nr--;
+
+        return ret;
+}
+
+/**
+ * @brief Adds process to the group process list
+ *
+ * @param [in,out] group monitoring structure
+ * @param [in] owner index of the group in track_groups
+ * @param [in] pid process id
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+track_pid_add(struct pqos_mon_data *group,
+              const unsigned owner,
+              const pid_t pid)
+{
+        pid_t *pids;
+        int ret;
+
+        if (tid_hash_get(&group->intl->task.pids, pid, NULL))
+                return PQOS_RETVAL_OK;
+
+        ret = tid_hash_put(&track_owner, pid, owner);
+        if (ret != PQOS_RETVAL_OK)
+                return ret;
+
+        pids = realloc(group->pids, sizeof(pids[0]) * (group->num_pids + 1));
+        if (pids == NULL)
+                return PQOS_RETVAL_RESOURCE;
+        group->pids = pids;
+
+        ret = tid_hash_put(&group->intl->task.pids, pid, group->num_pids);
+        if (ret != PQOS_RETVAL_OK) {
+                (void)tid_hash_del(&track_owner, pid);
+                return ret;
+        }
+
+        pids[group->num_pids] = pid;
+        group->num_pids++;
+
+        return PQOS_RETVAL_OK;
+}
+
+/**
+ * @brief Removes exited process from the group process list
+ *
+ * Prevents a new process reusing the PID from being followed.
+ * Last process of the group is kept.
+ *
+ * @param [in,out] group monitoring structure
+ * @param [in] pid process id
+ */
+static void
+track_pid_del(struct pqos_mon_data *group, const pid_t pid)
+{
+        struct tid_hash *pids = &group->intl->task.pids;
+        unsigned idx, last;
+
+        if (group->num_pids <= 1 || !tid_hash_get(pids, pid, &idx))
+                return;
+
+        last = group->num_pids - 1;
+        (void)tid_hash_del(pids, pid);
+        (void)tid_hash_del(&track_owner, pid);
+        if (idx != last) {
+                group->pids[idx] = group->pids[last];
+                (void)tid_hash_put(pids, group->pids[idx], idx);
+        }
+        group->num_pids--;
+}
+
+/**
+ * @brief Applies process event to the monitoring group owning the task
+ *
+ * Owning group is looked up by process id of the task, or of the parent
+ * process for a new child process.
+ *
+ * @param [in] event process event
+ */
+static void
+track_event_apply(const struct proc_conn_event *event)
+{
+        struct pqos_mon_data *group;
+        unsigned idx;
+        int ret = PQOS_RETVAL_OK;
+
+        if (event->type == PROC_CONN_EVENT_EXIT) {
+                group = track_owner_get(event->tgid, NULL);
+                /* task monitored by its own id */
+                if (group == NULL)
+                        group = track_owner_get(event->pid, NULL);
+                if (group == NULL)
+                        return;
+                if (tid_hash_get(&group->intl->task.tids, event->pid, &idx))
+                        ret = track_task_detach(group, idx);
+                if (event->pid == event->tgid)
+                        track_pid_del(group, event->pid);
+        } else if (event->pid != event->tgid) {
+                /* new thread of monitored process */
+                group = track_owner_get(event->tgid, NULL);
+                if (group != NULL)
+                        ret = track_task_attach(group, event->pid);
+        } else if (track_mode == PQOS_MON_PID_TRACK_CHILDREN) {
+                /* new child of monitored process */
+                group = track_owner_get(event->parent_tgid, &idx);
+                if (group == NULL)
+                        return;
+                ret = track_pid_add(group, idx, event->pid);
+                if (ret == PQOS_RETVAL_OK)
+                        ret = track_task_attach(group, event->pid);
+        }
+
+        if (ret != PQOS_RETVAL_OK)
+                LOG_DEBUG("Failed to update monitoring of task %d\n",
+                          (int)event->pid);
+}
+
+/**
+ * @brief Rescans tasks of monitored processes after events were lost
+ *
+ * Child processes created while events were lost are not found.
+ *
+ * @param [in,out] group monitoring structure
+ */
+static void
+track_resync(struct pqos_mon_data *group)
+{
+        struct tid_hash tid_index;
+        pid_t *tid_map = NULL;
+        unsigned tid_nr = 0;
+        unsigned i;
+
+        tid_hash_init(&tid_index);
+
+        for (i = 0; i < group->num_pids; i++)
+                if (tid_verify(group->pids[i]))
+                        (void)tid_find(group->pids[i], &tid_nr, &tid_map,
+                                       &tid_index);
+
+        for (i = 0; i < group->tid_nr && group->tid_nr > 1;)
+                if (!tid_hash_get(&tid_index, group->tid_map[i], NULL))
+                        (void)track_task_detach(group, i);
+                else
+                        i++;
+
+        for (i = 0; i < tid_nr; i++)
+                (void)track_task_attach(group, tid_map[i]);
+
+        if (tid_map != NULL)
+                free(tid_map);
+        tid_hash_fini(&tid_index);
+}
+
+int
+os_mon_track_poll(void)
+{
+        unsigned i;
+        int ret;
+
+        if (!proc_conn_enabled())
+                return PQOS_RETVAL_OK;
+
+        track_events_num = 0;
+        ret = proc_conn_read(track_event_store, NULL);
+        if (ret != PQOS_RETVAL_OK && ret != PQOS_RETVAL_OVERFLOW)
+                return ret;
+
+        if (track_num == 0) {
+                track_lost = 0;
+                return PQOS_RETVAL_OK;
+        }
+
+        if (ret == PQOS_RETVAL_OVERFLOW || track_lost) {
+                LOG_INFO("Process events lost, rescanning monitored tasks\n");
+                track_lost = 0;
+                for (i = 0; i < track_num; i++)
+                        track_resync(track_groups[i]);
+                return PQOS_RETVAL_OK;
+        }
+
+        /* tasks exiting later in the same batch are not started */
+        tid_hash_clear(&track_exited);
+        for (i = 0; i < track_events_num; i++)
+                if (track_events[i].type == PROC_CONN_EVENT_EXIT)
+                        (void)tid_hash_put(&track_exited, track_events[i].pid,
+                                           i);
+
+        for (i = 0; i < track_events_num; i++) {
+                const struct proc_conn_event *event = &track_events[i];
+                unsigned exit_idx;
+
+                if (event->type == PROC_CONN_EVENT_FORK &&
+                    tid_hash_get(&track_exited, event->pid, &exit_idx) &&
+                    exit_idx > i)
+                        continue;
+
+                track_event_apply(event);
+        }
+
+        return PQOS_RETVAL_OK;
+}
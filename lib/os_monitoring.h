@@ -123,6 +123,21 @@ PQOS_LOCAL int os_mon_start(const unsigned num_cores,
 PQOS_LOCAL int os_mon_poll(struct pqos_mon_data **groups,
                            const unsigned num_groups);
 
+/**
+ * @brief OS interface to read counters of requested groups in one batch
+ *
+ * Counter values are stored and used by the following poll of each group.
+ * Function does nothing when io_uring is not available.
+ *
+ * @param [in] groups table of monitoring group pointers to be updated
+ * @param [in] num_groups number of monitoring groups in the table
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ */
+PQOS_LOCAL int os_mon_poll_prefetch(struct pqos_mon_data **groups,
+                                    const unsigned num_groups);
+
 /**
  * @brief OS interface to start monitoring of selected group of \a pids
  *
@@ -170,6 +185,82 @@ PQOS_LOCAL int os_mon_remove_pids(const unsigned num_pids,
                                   const pid_t *pids,
                                   struct pqos_mon_data *group);
 
+/**
+ * @brief Starts following process events of monitored processes
+ *
+ * @param [in] mode process tracking mode
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_RESOURCE process events are not available
+ */
+PQOS_LOCAL int os_mon_track_init(const enum pqos_mon_pid_track mode);
+
+/**
+ * @brief Stops following process events
+ */
+PQOS_LOCAL void os_mon_track_fini(void);
+
+/**
+ * @brief Registers process monitoring group for task tracking
+ *
+ * @param [in] group monitoring structure
+ */
+PQOS_LOCAL void os_mon_track_add(struct pqos_mon_data *group);
+
+/**
+ * @brief Unregisters process monitoring group from task tracking
+ *
+ * @param [in] group monitoring structure
+ */
+PQOS_LOCAL void os_mon_track_del(struct pqos_mon_data *group);
+
+/**
+ * @brief Follows processes added to tracked monitoring group
+ *
+ * @param [in] group monitoring structure
+ * @param [in] num_pids number of processes
+ * @param [in] pids added process ids
+ */
+PQOS_LOCAL void os_mon_track_add_pids(const struct pqos_mon_data *group,
+                                      const unsigned num_pids,
+                                      const pid_t *pids);
+
+/**
+ * @brief Stops following processes removed from tracked monitoring group
+ *
+ * @param [in] group monitoring structure
+ * @param [in] num_pids number of processes
+ * @param [in] pids removed process ids
+ */
+PQOS_LOCAL void os_mon_track_remove_pids(const struct pqos_mon_data *group,
+                                         const unsigned num_pids,
+                                         const pid_t *pids);
+
+/**
+ * @brief OS interface to check RMID associations against hardware
+ *
+ * Associations are not kept by the OS interface, nothing is checked.
+ *
+ * @param [out] changed always set to 0
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK
+ */
+PQOS_LOCAL int os_mon_assoc_verify(int *changed);
+
+/**
+ * @brief Applies pending process events to monitoring groups
+ *
+ * Threads (and child processes) created since the last call are added
+ * to the groups of their processes, exited tasks are removed. Tasks are
+ * rescanned from /proc if events were lost.
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+PQOS_LOCAL int os_mon_track_poll(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -37,6 +37,7 @@
 #include "types.h"
 
 #include <sys/ioctl.h>
+#include <sys/mman.h>
 #include <sys/syscall.h>
 
 /**
@@ -150,3 +151,122 @@ perf_read_counter(int counter_fd, uint64_t *value)
         LOG_ERROR("Failed to read perf counter!\n");
         return PQOS_RETVAL_ERROR;
 }
+
+int
+perf_read_group(int counter_fd, void *buf, const size_t size, size_t *len)
+{
+        ssize_t ret;
+
+        if (counter_fd <= 0 || buf == NULL || len == NULL)
+                return PQOS_RETVAL_PARAM;
+
+        ret = read(counter_fd, buf, size);
+        if (ret <= 0) {
+                LOG_ERROR("Failed to read perf counter group!\n");
+                return PQOS_RETVAL_ERROR;
+        }
+        *len = (size_t)ret;
+
+        return PQOS_RETVAL_OK;
+}
+
+int
+perf_mmap_counter(int counter_fd, void **page)
+{
+        void *addr;
+
+        if (counter_fd <= 0 || page == NULL)
+                return PQOS_RETVAL_PARAM;
+
+        addr = mmap(NULL, (size_t)sysconf(_SC_PAGESIZE), PROT_READ, MAP_SHARED,
+                    counter_fd, 0);
+        if (addr == MAP_FAILED) {
+                LOG_DEBUG("Failed to map perf counter\n");
+                return PQOS_RETVAL_ERROR;
+        }
+        *page = addr;
+
+        return PQOS_RETVAL_OK;
+}
+
+int
+perf_munmap_counter(void *page)
+{
+        if (page == NULL)
+                return PQOS_RETVAL_PARAM;
+
+        if (munmap(page, (size_t)sysconf(_SC_PAGESIZE)) != 0) {
+                LOG_ERROR("Failed to unmap perf counter\n");
+                return PQOS_RETVAL_ERROR;
+        }
+
+        return PQOS_RETVAL_OK;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+/**
+ * @brief Reads performance monitoring counter of the current core
+ *
+ * @param idx counter index
+ *
+ * @return counter value
+ */
+static inline uint64_t
+perf_rdpmc(const uint32_t idx)
+{
+        uint32_t lo, hi;
+
+        __asm__ volatile("rdpmc" : "=a"(lo), "=d"(hi) : "c"(idx));
+        return (uint64_t)hi << 32 | lo;
+}
+#endif
+
+int
+perf_rdpmc_read(const void *page, uint64_t *value)
+{
+#if defined(__x86_64__) || defined(__i386__)
+        const volatile struct perf_event_mmap_page *pc =
+            (const volatile struct perf_event_mmap_page *)page;
+        uint64_t count;
+        uint32_t seq;
+
+        if (page == NULL || value == NULL)
+                return PQOS_RETVAL_PARAM;
+
+        /* see perf_event_mmap_page description in linux/perf_event.h */
+        do {
+                uint32_t idx;
+                uint16_t width;
+                int64_t pmc;
+
+                seq = pc->lock;
+                __asm__ volatile("" ::: "memory");
+
+                idx = pc->index;
+                if (!pc->cap_user_rdpmc || idx == 0)
+                        return PQOS_RETVAL_RESOURCE;
+                /* multiplexed counter needs to be scaled */
+                if (pc->time_enabled != pc->time_running)
+                        return PQOS_RETVAL_RESOURCE;
+
+                width = pc->pmc_width;
+                if (width == 0 || width > 64)
+                        return PQOS_RETVAL_RESOURCE;
+
+                pmc = (int64_t)(perf_rdpmc(idx - 1) << (64 - width));
+                pmc >>= 64 - width;
+                count = (uint64_t)((int64_t)pc->offset + pmc);
+
+                __asm__ volatile("" ::: "memory");
+        } while (pc->lock != seq);
+
+        *value = count;
+
+        return PQOS_RETVAL_OK;
+#else
+        UNUSED_PARAM(page);
+        UNUSED_PARAM(value);
+
+        return PQOS_RETVAL_RESOURCE;
+#endif
+}
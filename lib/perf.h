@@ -105,6 +105,60 @@ PQOS_LOCAL int perf_stop_counter(int counter_fd);
  */
 PQOS_LOCAL int perf_read_counter(int counter_fd, uint64_t *value);
 
+/**
+ * @brief Function to read all counters of a perf event group
+ *
+ * Group leader has to be opened with PERF_FORMAT_GROUP read format.
+ *
+ * @param [in] counter_fd fd of the group leader
+ * @param [out] buf buffer to store group read format data
+ * @param [in] size size of the buffer
+ * @param [out] len number of bytes read
+ *
+ * @return Operational status
+ * @retval PQOS_RETVAL_OK on success
+ */
+PQOS_LOCAL int
+perf_read_group(int counter_fd, void *buf, const size_t size, size_t *len);
+
+/**
+ * @brief Function to map perf counter metadata page to user space
+ *
+ * @param [in] counter_fd fd used to access the perf counter
+ * @param [out] page mapped struct perf_event_mmap_page
+ *
+ * @return Operational status
+ * @retval PQOS_RETVAL_OK on success
+ */
+PQOS_LOCAL int perf_mmap_counter(int counter_fd, void **page);
+
+/**
+ * @brief Function to unmap perf counter metadata page
+ *
+ * @param [in] page page mapped with perf_mmap_counter
+ *
+ * @return Operational status
+ * @retval PQOS_RETVAL_OK on success
+ */
+PQOS_LOCAL int perf_munmap_counter(void *page);
+
+/**
+ * @brief Function to read a perf counter with rdpmc instruction
+ *
+ * Counter can be read only from the core it is counting on, i.e.
+ * by a thread running on the monitored core or by the monitored task
+ * itself. Caller is responsible for that check.
+ *
+ * @param [in] page page mapped with perf_mmap_counter
+ * @param [out] value counter value
+ *
+ * @return Operational status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_RESOURCE counter can't be read from user space,
+ *         read() has to be used
+ */
+PQOS_LOCAL int perf_rdpmc_read(const void *page, uint64_t *value);
+
 #ifdef __cplusplus
 }
 #endif
@@ -39,10 +39,15 @@
 #include "perf.h"
 
 #include <dirent.h> /**< scandir() */
+#include <errno.h>
 #include <linux/perf_event.h>
+#include <stddef.h>
 #include <stdlib.h>
+#include <sched.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
 /**
  * Event indexes in table of supported events
@@ -76,6 +81,59 @@ static int os_mon_type = 0;
  */
 static enum pqos_mon_event all_evt_mask = (enum pqos_mon_event)0;
 
+/**
+ * Perf counter read method
+ */
+static enum pqos_mon_perf_read read_mode = PQOS_MON_PERF_READ_SYSCALL;
+
+/**
+ * Perf event group read format
+ * (PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+ *  PERF_FORMAT_TOTAL_TIME_RUNNING)
+ */
+struct perf_mon_group_read {
+        uint64_t nr;                              /**< number of counters */
+        uint64_t time_enabled;                    /**< group enabled time */
+        uint64_t time_running;                    /**< group running time */
+        uint64_t values[PQOS_MON_PERF_GROUP_MAX]; /**< counter values */
+};
+
+#define PERF_MON_GROUP_READ_FORMAT                                             \
+        (PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |                  \
+         PERF_FORMAT_TOTAL_TIME_RUNNING)
+
+/**
+ * Prefetched counter value
+ */
+struct perf_mon_prefetch {
+        int fd;      /**< counter file descriptor */
+        int grouped; /**< fd is a group leader */
+        union {
+                uint64_t value;                   /**< counter value */
+                struct perf_mon_group_read group; /**< group values */
+        } data;
+        struct uring_read read; /**< prefetch read request */
+};
+
+/**
+ * Table of prefetched counters sorted by fd
+ */
+static struct perf_mon_prefetch *prefetch_tab = NULL;
+static unsigned prefetch_num = 0;
+static unsigned prefetch_size = 0;
+
+/**
+ * @brief Drops prefetched counters
+ *
+ * Has to be called when counters are closed, as the table is keyed by
+ * file descriptor and a new counter may reuse the number.
+ */
+static void
+perf_mon_prefetch_invalidate(void)
+{
+        prefetch_num = 0;
+}
+
 /**
  * Table of structures used to store data about
  * supported monitoring events and their
@@ -472,6 +530,34 @@ perf_mon_init_exit:
 int
 perf_mon_fini(void)
 {
+        perf_mon_prefetch_invalidate();
+        if (prefetch_tab != NULL) {
+                free(prefetch_tab);
+                prefetch_tab = NULL;
+        }
+        prefetch_size = 0;
+        read_mode = PQOS_MON_PERF_READ_SYSCALL;
+
+        return PQOS_RETVAL_OK;
+}
+
+int
+perf_mon_set_read_mode(const enum pqos_mon_perf_read mode)
+{
+        switch (mode) {
+        case PQOS_MON_PERF_READ_SYSCALL:
+                break;
+        case PQOS_MON_PERF_READ_RDPMC:
+#if !defined(__x86_64__) && !defined(__i386__)
+                return PQOS_RETVAL_RESOURCE;
+#endif
+                break;
+        default:
+                return PQOS_RETVAL_PARAM;
+        }
+
+        read_mode = mode;
+
         return PQOS_RETVAL_OK;
 }
 
@@ -498,11 +584,51 @@ perf_mon_get_fd(struct pqos_mon_perf_ctx *ctx, const enum pqos_mon_event event)
         }
 }
 
+/**
+ * @brief Checks if event can be read as a part of perf event group
+ *
+ * Only generic hardware events are grouped. RDT events belong to a
+ * different PMU and are read individually.
+ *
+ * @param [in] se supported event
+ *
+ * @return 1 if event can be grouped, 0 otherwise
+ */
+static int
+perf_mon_is_group_event(const struct perf_mon_supported_event *se)
+{
+        return se->attrs.type == PERF_TYPE_HARDWARE;
+}
+
+/**
+ * @brief Gets position of the event in the perf event group
+ *
+ * @param [in] intl internal monitoring group data
+ * @param [in] event monitoring event
+ *
+ * @return Position of the event in the group
+ * @retval -1 if event is not grouped
+ */
+static int
+perf_mon_group_idx(const struct pqos_mon_data_internal *intl,
+                   const enum pqos_mon_event event)
+{
+        unsigned i;
+
+        for (i = 0; i < intl->perf.num_group; i++)
+                if (intl->perf.group[i] == event)
+                        return (int)i;
+
+        return -1;
+}
+
 int
 perf_mon_start(struct pqos_mon_data *group, enum pqos_mon_event event)
 {
         int i, num_ctrs;
+        int group_idx = -1;
         struct perf_mon_supported_event *se;
+        struct perf_event_attr attrs;
 
         ASSERT(group != NULL);
         ASSERT(group->intl != NULL);
@@ -522,6 +648,17 @@ perf_mon_start(struct pqos_mon_data *group, enum pqos_mon_event event)
         if (se == NULL)
                 return PQOS_RETVAL_ERROR;
 
+        /**
+         * Hardware events of the same core/task are opened as one group so
+         * that they are scheduled together and read with a single read()
+         */
+        attrs = se->attrs;
+        if (perf_mon_is_group_event(se) &&
+            group->intl->perf.num_group < PQOS_MON_PERF_GROUP_MAX) {
+                group_idx = (int)group->intl->perf.num_group;
+                attrs.read_format = PERF_MON_GROUP_READ_FORMAT;
+        }
+
         /**
          * For each core/task assign fd to read counter
          */
@@ -544,22 +681,41 @@ perf_mon_start(struct pqos_mon_data *group, enum pqos_mon_event event)
                  * If monitoring cores, pass core list
                  * Otherwise, pass list of TID's
                  */
-                ret = perf_setup_counter(&se->attrs, tid, core, -1, 0, fd);
+                ret = perf_setup_counter(&attrs, tid, core,
+                                         group_idx > 0 ? ctx->fd_leader : -1,
+                                         0, fd);
                 if (ret != PQOS_RETVAL_OK) {
                         LOG_ERROR("Failed to start perf "
                                   "counters for %s\n",
                                   se->desc);
                         return PQOS_RETVAL_ERROR;
                 }
+                if (group_idx < 0)
+                        continue;
+                if (group_idx == 0) {
+                        ctx->fd_leader = *fd;
+                        ctx->fresh = 0;
+                        memset(ctx->group_values, 0,
+                               sizeof(ctx->group_values));
+                }
+
+                /* rdpmc falls back to read() if counter is not mapped */
+                ctx->mmap_page[group_idx] = NULL;
+                if (read_mode == PQOS_MON_PERF_READ_RDPMC)
+                        (void)perf_mmap_counter(*fd,
+                                                &ctx->mmap_page[group_idx]);
         }
 
+        if (group_idx >= 0)
+                group->intl->perf.group[group->intl->perf.num_group++] = event;
+
         return PQOS_RETVAL_OK;
 }
 
 int
 perf_mon_stop(struct pqos_mon_data *group, enum pqos_mon_event event)
 {
-        int i, num_ctrs;
+        int i, num_ctrs, idx;
 
         ASSERT(group != NULL);
         ASSERT(group->intl != NULL);
@@ -575,17 +731,46 @@ perf_mon_stop(struct pqos_mon_data *group, enum pqos_mon_event event)
         else
                 return PQOS_RETVAL_ERROR;
 
+        idx = perf_mon_group_idx(group->intl, event);
+
+        perf_mon_prefetch_invalidate();
+
         /**
          * For each counter, close associated file descriptor
          */
         for (i = 0; i < num_ctrs; i++) {
                 struct pqos_mon_perf_ctx *ctx = &group->intl->perf.ctx[i];
                 int *fd = perf_mon_get_fd(ctx, event);
+                unsigned j;
 
                 if (fd == NULL)
                         return PQOS_RETVAL_ERROR;
 
+                if (idx >= 0 && ctx->mmap_page[idx] != NULL)
+                        perf_munmap_counter(ctx->mmap_page[idx]);
                 perf_shutdown_counter(*fd);
+
+                if (idx < 0)
+                        continue;
+                for (j = (unsigned)idx + 1; j < group->intl->perf.num_group;
+                     j++) {
+                        ctx->group_values[j - 1] = ctx->group_values[j];
+                        ctx->mmap_page[j - 1] = ctx->mmap_page[j];
+                }
+                ctx->fresh = 0;
+        }
+
+        /**
+         * Remove event from the perf group
+         */
+        if (idx >= 0) {
+                unsigned j;
+
+                for (j = (unsigned)idx + 1; j < group->intl->perf.num_group;
+                     j++)
+                        group->intl->perf.group[j - 1] =
+                            group->intl->perf.group[j];
+                group->intl->perf.num_group--;
         }
 
         return PQOS_RETVAL_OK;
@@ -608,13 +793,323 @@ get_delta(const uint64_t old_value, const uint64_t new_value)
                 return new_value - old_value;
 }
 
+/**
+ * @brief Compares prefetched counters by fd
+ *
+ * @param a pointer to first counter
+ * @param b pointer to second counter
+ *
+ * @return Comparison result
+ */
+static int
+perf_mon_prefetch_cmp(const void *a, const void *b)
+{
+        const struct perf_mon_prefetch *pa =
+            (const struct perf_mon_prefetch *)a;
+        const struct perf_mon_prefetch *pb =
+            (const struct perf_mon_prefetch *)b;
+
+        return (pa->fd > pb->fd) - (pa->fd < pb->fd);
+}
+
+/**
+ * @brief Lists perf counters of monitoring groups
+ *
+ * @param [in] groups table of monitoring groups
+ * @param [in] num_groups number of monitoring groups
+ * @param [out] tab table to store counters in or NULL
+ *
+ * @return Number of counters
+ */
+static unsigned
+perf_mon_prefetch_list(struct pqos_mon_data **groups,
+                       const unsigned num_groups,
+                       struct perf_mon_prefetch *tab)
+{
+        unsigned num = 0;
+        unsigned i;
+
+        for (i = 0; i < num_groups; i++) {
+                struct pqos_mon_data *group = groups[i];
+                int j, num_ctrs;
+                unsigned k;
+
+                if (group->intl->perf.event == 0)
+                        continue;
+
+                if (group->num_cores > 0)
+                        num_ctrs = group->num_cores;
+                else
+                        num_ctrs = group->tid_nr;
+
+                /* in rdpmc mode group is read only if rdpmc fails */
+                for (j = 0; read_mode == PQOS_MON_PERF_READ_SYSCALL &&
+                            group->intl->perf.num_group > 0 && j < num_ctrs;
+                     j++) {
+                        const struct pqos_mon_perf_ctx *ctx =
+                            &group->intl->perf.ctx[j];
+
+                        if (tab != NULL) {
+                                tab[num].fd = ctx->fd_leader;
+                                tab[num].grouped = 1;
+                        }
+                        num++;
+                }
+
+                for (k = 0; k < DIM(events_tab); k++) {
+                        const enum pqos_mon_event event = events_tab[k].event;
+
+                        if (!(group->intl->perf.event & event))
+                                continue;
+                        if (perf_mon_group_idx(group->intl, event) >= 0)
+                                continue;
+
+                        for (j = 0; j < num_ctrs; j++) {
+                                const int *fd = perf_mon_get_fd(
+                                    &group->intl->perf.ctx[j], event);
+
+                                if (fd == NULL || *fd <= 0)
+                                        continue;
+                                if (tab != NULL) {
+                                        tab[num].fd = *fd;
+                                        tab[num].grouped = 0;
+                                }
+                                num++;
+                        }
+                }
+        }
+
+        return num;
+}
+
+unsigned
+perf_mon_prefetch(struct pqos_mon_data **groups,
+                  const unsigned num_groups,
+                  struct uring_read **reads)
+{
+        unsigned num;
+        unsigned i;
+
+        ASSERT(groups != NULL);
+
+        num = perf_mon_prefetch_list(groups, num_groups, NULL);
+        if (reads == NULL)
+                return num;
+
+        prefetch_num = 0;
+        if (num > prefetch_size) {
+                struct perf_mon_prefetch *tab =
+                    realloc(prefetch_tab, num * sizeof(tab[0]));
+
+                if (tab == NULL)
+                        return 0;
+                prefetch_tab = tab;
+                prefetch_size = num;
+        }
+
+        prefetch_num = perf_mon_prefetch_list(groups, num_groups, prefetch_tab);
+        qsort(prefetch_tab, prefetch_num, sizeof(prefetch_tab[0]),
+              perf_mon_prefetch_cmp);
+
+        for (i = 0; i < prefetch_num; i++) {
+                struct perf_mon_prefetch *p = &prefetch_tab[i];
+
+                p->read.fd = p->fd;
+                p->read.buf = &p->data;
+                if (p->grouped)
+                        p->read.size = sizeof(p->data.group);
+                else
+                        p->read.size = sizeof(p->data.value);
+                p->read.offset = 0;
+                p->read.res = -ENODATA;
+                reads[i] = &p->read;
+        }
+
+        return prefetch_num;
+}
+
+/**
+ * @brief Reads perf counter, using prefetched value when available
+ *
+ * @param [in] fd counter file descriptor
+ * @param [out] value counter value
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+perf_mon_read_counter(const int fd, uint64_t *value)
+{
+        struct perf_mon_prefetch key;
+        struct perf_mon_prefetch *p;
+
+        key.fd = fd;
+        p = (struct perf_mon_prefetch *)bsearch(&key, prefetch_tab,
+                                                prefetch_num, sizeof(key),
+                                                perf_mon_prefetch_cmp);
+        if (p != NULL && !p->grouped &&
+            p->read.res == (int)sizeof(p->data.value)) {
+                *value = p->data.value;
+                p->read.res = -ENODATA;
+                return PQOS_RETVAL_OK;
+        }
+
+        return perf_read_counter(fd, value);
+}
+
+/**
+ * @brief Reads perf event group, using prefetched values when available
+ *
+ * Counter values are scaled by time enabled/running of the group to
+ * account for counter multiplexing. Scaled values never decrease so that
+ * deltas stay valid.
+ *
+ * @param [in] intl internal monitoring group data
+ * @param [in,out] ctx perf poll context
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+perf_mon_read_group(const struct pqos_mon_data_internal *intl,
+                    struct pqos_mon_perf_ctx *ctx)
+{
+        struct perf_mon_prefetch key;
+        struct perf_mon_prefetch *p;
+        struct perf_mon_group_read data;
+        const struct perf_mon_group_read *grp = &data;
+        size_t len;
+        unsigned i;
+
+        key.fd = ctx->fd_leader;
+        p = (struct perf_mon_prefetch *)bsearch(&key, prefetch_tab,
+                                                prefetch_num, sizeof(key),
+                                                perf_mon_prefetch_cmp);
+        if (p != NULL && p->grouped && p->read.res > 0) {
+                grp = &p->data.group;
+                len = (size_t)p->read.res;
+                p->read.res = -ENODATA;
+        } else {
+                int ret = perf_read_group(ctx->fd_leader, &data, sizeof(data),
+                                          &len);
+
+                if (ret != PQOS_RETVAL_OK)
+                        return ret;
+        }
+
+        if (len < offsetof(struct perf_mon_group_read, values) ||
+            grp->nr != intl->perf.num_group ||
+            len < offsetof(struct perf_mon_group_read, values) +
+                      grp->nr * sizeof(grp->values[0])) {
+                LOG_ERROR("Invalid perf counter group data!\n");
+                return PQOS_RETVAL_ERROR;
+        }
+
+        for (i = 0; i < grp->nr; i++) {
+                uint64_t value = grp->values[i];
+
+                if (grp->time_running > 0 &&
+                    grp->time_running < grp->time_enabled)
+                        value = (uint64_t)((double)value *
+                                           ((double)grp->time_enabled /
+                                            (double)grp->time_running));
+                if (value > ctx->group_values[i])
+                        ctx->group_values[i] = value;
+        }
+        ctx->fresh = (1U << grp->nr) - 1;
+
+        return PQOS_RETVAL_OK;
+}
+
+/**
+ * @brief Gets the only CPU the calling thread is allowed to run on
+ *
+ * @return CPU id or -1 if the thread can migrate between CPUs
+ */
+static int
+perf_mon_pinned_cpu(void)
+{
+        cpu_set_t mask;
+        int cpu;
+
+        if (sched_getaffinity(0, sizeof(mask), &mask) != 0 ||
+            CPU_COUNT(&mask) != 1)
+                return -1;
+
+        for (cpu = 0; cpu < CPU_SETSIZE; cpu++)
+                if (CPU_ISSET(cpu, &mask))
+                        return cpu;
+
+        return -1;
+}
+
+/**
+ * @brief Reads grouped perf counter with rdpmc
+ *
+ * Counter of a core is read only if the calling thread is pinned to the
+ * monitored core, so it cannot migrate between the CPU check and rdpmc.
+ * Counter of a task is read only by the monitored task.
+ *
+ * @param [in] group monitoring group
+ * @param [in] i poll context index
+ * @param [in] idx position of the event in the perf group
+ * @param [in] cpu CPU the calling thread is pinned to or -1
+ * @param [out] value counter value
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_RESOURCE if counter has to be read with read()
+ */
+static int
+perf_mon_rdpmc_read(const struct pqos_mon_data *group,
+                    const int i,
+                    const int idx,
+                    const int cpu,
+                    uint64_t *value)
+{
+        static __thread pid_t tid = 0;
+        struct pqos_mon_perf_ctx *ctx = &group->intl->perf.ctx[i];
+        int ret;
+
+        if (ctx->mmap_page[idx] == NULL)
+                return PQOS_RETVAL_RESOURCE;
+
+        if (group->num_cores > 0) {
+                if (cpu < 0 || cpu != (int)group->cores[i])
+                        return PQOS_RETVAL_RESOURCE;
+        } else {
+                if (tid == 0)
+                        tid = (pid_t)syscall(SYS_gettid);
+                if (group->tid_map[i] != tid)
+                        return PQOS_RETVAL_RESOURCE;
+        }
+
+        ret = perf_rdpmc_read(ctx->mmap_page[idx], value);
+        if (ret != PQOS_RETVAL_OK)
+                return ret;
+
+        /* affinity changed by another thread while reading */
+        if (group->num_cores > 0 && sched_getcpu() != cpu)
+                return PQOS_RETVAL_RESOURCE;
+
+        /* keep value consistent with the group read */
+        if (*value < ctx->group_values[idx])
+                *value = ctx->group_values[idx];
+        else
+                ctx->group_values[idx] = *value;
+
+        return PQOS_RETVAL_OK;
+}
+
 int
 perf_mon_poll(struct pqos_mon_data *group, enum pqos_mon_event event)
 {
         int ret;
-        int i, num_ctrs;
-        uint64_t value = 0;
+        int i, num_ctrs, idx;
+        int cpu = -1;
+        uint64_t value;
         uint64_t old_value;
+        const struct perf_mon_supported_event *se;
 
         ASSERT(group != NULL);
         ASSERT(group->intl != NULL);
@@ -630,18 +1125,61 @@ perf_mon_poll(struct pqos_mon_data *group, enum pqos_mon_event event)
         else
                 return PQOS_RETVAL_ERROR;
 
+        se = get_supported_event(event);
+        if (se == NULL)
+                return PQOS_RETVAL_ERROR;
+
+        idx = perf_mon_group_idx(group->intl, event);
+
+        /* include counts of tasks that already exited */
+        value = group->intl->perf.retired[se - events_tab];
+
+        /* core counters are read with rdpmc only by thread pinned to core */
+        if (idx >= 0 && read_mode == PQOS_MON_PERF_READ_RDPMC &&
+            group->num_cores > 0)
+                cpu = perf_mon_pinned_cpu();
+
         /**
          * For each task read counter and sum of all counter values
          */
         for (i = 0; i < num_ctrs; i++) {
                 struct pqos_mon_perf_ctx *ctx = &group->intl->perf.ctx[i];
                 uint64_t counter_value;
-                int *fd = perf_mon_get_fd(ctx, event);
+                int *fd;
 
+                /**
+                 * Grouped events are read once per poll cycle,
+                 * the first event polled refreshes the whole group
+                 */
+                if (idx >= 0) {
+                        if (read_mode == PQOS_MON_PERF_READ_RDPMC)
+                                ret = perf_mon_rdpmc_read(group, i, idx, cpu,
+                                                          &counter_value);
+                        else
+                                ret = PQOS_RETVAL_RESOURCE;
+                        if (ret == PQOS_RETVAL_OK) {
+                                ctx->fresh &= ~(1U << idx);
+                                value += counter_value;
+                                continue;
+                        }
+                        if (!(ctx->fresh & (1U << idx))) {
+                                ret = perf_mon_read_group(group->intl, ctx);
+                                if (ret != PQOS_RETVAL_OK)
+                                        return ret;
+                        }
+                        ctx->fresh &= ~(1U << idx);
+                        value += ctx->group_values[idx];
+                        continue;
+                }
+
+                fd = perf_mon_get_fd(ctx, event);
                 if (fd == NULL)
                         return PQOS_RETVAL_ERROR;
+                /* task counted by counter of its parent */
+                if (*fd < 0)
+                        continue;
 
-                ret = perf_read_counter(*fd, &counter_value);
+                ret = perf_mon_read_counter(*fd, &counter_value);
                 if (ret != PQOS_RETVAL_OK)
                         return ret;
                 value += counter_value;
@@ -704,6 +1242,157 @@ perf_mon_poll(struct pqos_mon_data *group, enum pqos_mon_event event)
         return PQOS_RETVAL_OK;
 }
 
+/**
+ * @brief Closes all perf counters of the poll context
+ *
+ * @param [in] intl internal monitoring group data
+ * @param [in,out] ctx perf poll context
+ */
+static void
+perf_mon_ctx_close(const struct pqos_mon_data_internal *intl,
+                   struct pqos_mon_perf_ctx *ctx)
+{
+        unsigned k;
+
+        perf_mon_prefetch_invalidate();
+
+        for (k = 0; k < intl->perf.num_group; k++)
+                if (ctx->mmap_page[k] != NULL) {
+                        perf_munmap_counter(ctx->mmap_page[k]);
+                        ctx->mmap_page[k] = NULL;
+                }
+
+        for (k = 0; k < DIM(events_tab); k++) {
+                int *fd = perf_mon_get_fd(ctx, events_tab[k].event);
+
+                if (fd == NULL || *fd < 0)
+                        continue;
+                perf_shutdown_counter(*fd);
+                *fd = -1;
+        }
+}
+
+int
+perf_mon_start_task(struct pqos_mon_data *group,
+                    const pid_t tid,
+                    struct pqos_mon_perf_ctx *ctx)
+{
+        const struct pqos_mon_data_internal *intl;
+        unsigned k;
+
+        ASSERT(group != NULL);
+        ASSERT(group->intl != NULL);
+        ASSERT(ctx != NULL);
+        intl = group->intl;
+
+        memset(ctx, 0, sizeof(*ctx));
+        for (k = 0; k < DIM(events_tab); k++) {
+                int *fd = perf_mon_get_fd(ctx, events_tab[k].event);
+
+                if (fd != NULL)
+                        *fd = -1;
+        }
+        ctx->fd_leader = -1;
+
+        /* grouped events have to be opened in the order of the group */
+        for (k = 0; k < intl->perf.num_group; k++) {
+                struct perf_mon_supported_event *se =
+                    get_supported_event(intl->perf.group[k]);
+                struct perf_event_attr attrs;
+                int *fd = perf_mon_get_fd(ctx, intl->perf.group[k]);
+                int ret;
+
+                if (se == NULL || fd == NULL)
+                        goto perf_mon_start_task_error;
+
+                attrs = se->attrs;
+                attrs.read_format = PERF_MON_GROUP_READ_FORMAT;
+                ret = perf_setup_counter(&attrs, tid, -1, ctx->fd_leader, 0,
+                                         fd);
+                if (ret != PQOS_RETVAL_OK)
+                        goto perf_mon_start_task_error;
+                if (k == 0)
+                        ctx->fd_leader = *fd;
+                if (read_mode == PQOS_MON_PERF_READ_RDPMC)
+                        (void)perf_mmap_counter(*fd, &ctx->mmap_page[k]);
+        }
+
+        /**
+         * Events inherited by child tasks already count the task
+         * through the counter of its parent
+         */
+        for (k = 0; k < DIM(events_tab); k++) {
+                const enum pqos_mon_event event = events_tab[k].event;
+                int *fd;
+
+                if (!(intl->perf.event & event) || events_tab[k].attrs.inherit)
+                        continue;
+                if (perf_mon_group_idx(intl, event) >= 0)
+                        continue;
+
+                fd = perf_mon_get_fd(ctx, event);
+                if (fd == NULL)
+                        continue;
+                if (perf_setup_counter(&events_tab[k].attrs, tid, -1, -1, 0,
+                                       fd) != PQOS_RETVAL_OK)
+                        goto perf_mon_start_task_error;
+        }
+
+        return PQOS_RETVAL_OK;
+
+perf_mon_start_task_error:
+        LOG_DEBUG("Failed to start perf counters for task %d\n", (int)tid);
+        perf_mon_ctx_close(intl, ctx);
+        return PQOS_RETVAL_ERROR;
+}
+
+int
+perf_mon_stop_task(struct pqos_mon_data *group, struct pqos_mon_perf_ctx *ctx)
+{
+        struct pqos_mon_data_internal *intl;
+        int ret = PQOS_RETVAL_OK;
+        unsigned k;
+
+        ASSERT(group != NULL);
+        ASSERT(group->intl != NULL);
+        ASSERT(ctx != NULL);
+        intl = group->intl;
+
+        if (intl->perf.num_group > 0)
+                ret = perf_mon_read_group(intl, ctx);
+
+        /**
+         * Keep final counts of the task so that the group values
+         * do not go backwards. Occupancy is not accumulated.
+         */
+        for (k = 0; k < DIM(events_tab); k++) {
+                const enum pqos_mon_event event = events_tab[k].event;
+                const int idx = perf_mon_group_idx(intl, event);
+                uint64_t value;
+                int *fd;
+
+                if (!(intl->perf.event & event) ||
+                    event == PQOS_MON_EVENT_L3_OCCUP)
+                        continue;
+
+                if (idx >= 0) {
+                        if (ret == PQOS_RETVAL_OK)
+                                intl->perf.retired[k] += ctx->group_values[idx];
+                        continue;
+                }
+
+                fd = perf_mon_get_fd(ctx, event);
+                if (fd == NULL || *fd < 0)
+                        continue;
+                if (perf_read_counter(*fd, &value) == PQOS_RETVAL_OK)
+                        intl->perf.retired[k] += value;
+        }
+
+        perf_mon_ctx_close(intl, ctx);
+
+        return ret;
+}
+
 int
 perf_mon_is_event_supported(const enum pqos_mon_event event)
 {
@@ -44,9 +44,12 @@ extern "C" {
 
 #include "pqos.h"
 #include "types.h"
+#include "uring.h"
 
 #define PERF_MON_PATH "/sys/devices/intel_cqm"
 
+struct pqos_mon_perf_ctx;
+
 /**
  * Local monitor event types
  */
@@ -75,6 +78,19 @@ PQOS_LOCAL int perf_mon_init(const struct pqos_cpuinfo *cpu,
  */
 PQOS_LOCAL int perf_mon_fini(void);
 
+/**
+ * @brief Selects method used to read perf counters
+ *
+ * Has to be called before monitoring is started.
+ *
+ * @param [in] mode perf counter read method
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_RESOURCE if method is not supported on the platform
+ */
+PQOS_LOCAL int perf_mon_set_read_mode(const enum pqos_mon_perf_read mode);
+
 /**
  * @brief This function starts Perf pqos event counters
  *
@@ -102,6 +118,38 @@ PQOS_LOCAL int perf_mon_start(struct pqos_mon_data *group,
 PQOS_LOCAL int perf_mon_stop(struct pqos_mon_data *group,
                              const enum pqos_mon_event event);
 
+/**
+ * @brief Starts perf counters of a task joining running monitoring group
+ *
+ * Events inherited by child tasks are not started as the task is counted
+ * by the counter of its parent.
+ *
+ * @param [in] group monitoring structure
+ * @param [in] tid task id
+ * @param [out] ctx perf poll context of the task
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+PQOS_LOCAL int perf_mon_start_task(struct pqos_mon_data *group,
+                                   const pid_t tid,
+                                   struct pqos_mon_perf_ctx *ctx);
+
+/**
+ * @brief Stops perf counters of a task leaving running monitoring group
+ *
+ * Final counts of the task are kept by the group, so the group values
+ * do not decrease.
+ *
+ * @param [in] group monitoring structure
+ * @param [in] ctx perf poll context of the task
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+PQOS_LOCAL int perf_mon_stop_task(struct pqos_mon_data *group,
+                                  struct pqos_mon_perf_ctx *ctx);
+
 /**
  * @brief This function polls all perf counters
  *
@@ -117,6 +165,21 @@ PQOS_LOCAL int perf_mon_stop(struct pqos_mon_data *group,
 PQOS_LOCAL int perf_mon_poll(struct pqos_mon_data *group,
                              const enum pqos_mon_event event);
 
+/**
+ * @brief Lists counter reads of monitoring groups for batched prefetch
+ *
+ * Prefetched value is used by the next perf_mon_poll of the group.
+ *
+ * @param [in] groups table of monitoring groups
+ * @param [in] num_groups number of monitoring groups
+ * @param [out] reads table to store read requests in or NULL
+ *
+ * @return Number of read requests
+ */
+PQOS_LOCAL unsigned perf_mon_prefetch(struct pqos_mon_data **groups,
+                                      const unsigned num_groups,
+                                      struct uring_read **reads);
+
 /**
  * @brief Check if event is supported by perf
  *
@@ -56,7 +56,7 @@ extern "C" {
  * =======================================
  */
 
-#define PQOS_VERSION      40401 /**< version 4.4.1 */
+#define PQOS_VERSION      40500 /**< version 4.5.0 */
 #define PQOS_MAX_COS      16    /**< 16 x COS */
 #define PQOS_MAX_L3CA_COS PQOS_MAX_COS
 #define PQOS_MAX_L2CA_COS PQOS_MAX_COS
@@ -102,6 +102,33 @@ enum pqos_cdp_config {
                                      setting */
 };
 
+/**
+ * Monitoring poll modes
+ */
+enum pqos_mon_poll_mode {
+        PQOS_MON_POLL_SERIAL = 0, /**< poll groups in calling thread */
+        PQOS_MON_POLL_SOCKET,     /**< worker thread per socket */
+        PQOS_MON_POLL_CLUSTER,    /**< worker thread per L3 cluster */
+        PQOS_MON_POLL_CORE        /**< worker thread per core */
+};
+
+/**
+ * Perf counter read methods
+ */
+enum pqos_mon_perf_read {
+        PQOS_MON_PERF_READ_SYSCALL = 0, /**< read() system call */
+        PQOS_MON_PERF_READ_RDPMC        /**< rdpmc instruction when possible */
+};
+
+/**
+ * Monitored process tracking modes
+ */
+enum pqos_mon_pid_track {
+        PQOS_MON_PID_TRACK_NONE = 0, /**< tasks resolved at start only */
+        PQOS_MON_PID_TRACK_THREADS,  /**< follow new and exiting threads */
+        PQOS_MON_PID_TRACK_CHILDREN  /**< follow threads and child processes */
+};
+
 /**
  * Resource Monitoring ID (RMID) definition
  */
@@ -153,6 +180,31 @@ struct pqos_rmid_config {
  *         PQOS_INTER_OS             - OS interface or nothing
  *         PQOS_INTER_OS_RESCTRL_MON - OS interface with resctrl monitoring
  *                                     or nothing
+ *
+ * @param mon_poll monitoring poll mode (MSR interface only)
+ *         PQOS_MON_POLL_SERIAL  - groups polled by the calling thread
+ *         PQOS_MON_POLL_SOCKET  - groups polled by worker thread per socket
+ *         PQOS_MON_POLL_CLUSTER - groups polled by worker thread per
+ *                                 L3 cluster
+ *         PQOS_MON_POLL_CORE    - groups polled by worker thread pinned
+ *                                 to the first core of the group
+ *
+ * @param perf_read perf counter read method
+ *         PQOS_MON_PERF_READ_SYSCALL - counters read with read()
+ *         PQOS_MON_PERF_READ_RDPMC   - hardware counters mapped to user space
+ *                                      and read with rdpmc when the polling
+ *                                      thread is pinned to the monitored core
+ *                                      or is the monitored task, read()
+ *                                      otherwise
+ *
+ * @param pid_track monitored process tracking (OS interface only)
+ *         PQOS_MON_PID_TRACK_NONE     - threads of monitored processes are
+ *                                       found when monitoring starts
+ *         PQOS_MON_PID_TRACK_THREADS  - threads created and exiting later are
+ *                                       followed using kernel process events,
+ *                                       requires CAP_NET_ADMIN
+ *         PQOS_MON_PID_TRACK_CHILDREN - as above, child processes are
+ *                                       monitored as well
  */
 struct pqos_config {
         int fd_log;
@@ -165,6 +217,9 @@ struct pqos_config {
 #ifdef PQOS_RMID_CUSTOM
         struct pqos_rmid_config rmid_cfg;
 #endif
+        enum pqos_mon_poll_mode mon_poll;
+        enum pqos_mon_perf_read perf_read;
+        enum pqos_mon_pid_track pid_track;
 };
 
 /**
@@ -178,6 +233,9 @@ struct pqos_config {
  * @retval PQOS_RETVAL_OK on success
  * @note   If you require system wide interface enforcement you can do so by
  *         setting the "RDT_IFACE" environment variable.
+ * @note   Setting the "RDT_SNAPSHOT" environment variable to a file path
+ *         keeps capabilities and CPU topology in that file, so that next
+ *         initializations on the same boot skip their discovery.
  */
 int pqos_init(const struct pqos_config *config);
 
@@ -496,6 +554,23 @@ int pqos_mon_reset(void);
  */
 int pqos_mon_assoc_get(const unsigned lcore, pqos_rmid_t *rmid);
 
+/**
+ * @brief Checks RMID associations known to the library against hardware
+ *
+ * The library keeps RMID associations of cores it allocates RMIDs for
+ * instead of reading them from hardware on every monitoring start.
+ * This call detects associations changed by other tools and updates
+ * the library view. The OS interface does not keep associations and
+ * never reports a change.
+ *
+ * @param [out] changed set to 1 if associations were changed outside of
+ *              the library and have been read again, 0 otherwise
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ */
+int pqos_mon_assoc_verify(int *changed);
+
 /**
  * @brief Starts resource monitoring on selected group of cores
  *
@@ -668,6 +743,30 @@ int pqos_alloc_assoc_get(const unsigned lcore, unsigned *class_id);
  */
 int pqos_alloc_assoc_set_pid(const pid_t task, const unsigned class_id);
 
+/**
+ * @brief OS interface to associate multiple \a tasks
+ *        with given class of service
+ *
+ * Resctrl tasks file is opened once for all tasks. Tasks that could not be
+ * associated (e.g. already exited) do not stop association of the
+ * remaining tasks.
+ *
+ * @param [in] tasks table of task IDs to be associated
+ * @param [in] num_tasks number of task IDs in \a tasks
+ * @param [in] class_id class of service
+ * @param [out] status optional table of \a num_tasks statuses, one for
+ *              each task
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_PARAM some tasks do not exist, other tasks have been
+ *         associated
+ */
+int pqos_alloc_assoc_set_pids(const pid_t *tasks,
+                              const unsigned num_tasks,
+                              const unsigned class_id,
+                              int *status);
+
 /**
  * @brief OS interface to read association
  *        of \a task with class of service
@@ -680,6 +779,31 @@ int pqos_alloc_assoc_set_pid(const pid_t task, const unsigned class_id);
  */
 int pqos_alloc_assoc_get_pid(const pid_t task, unsigned *class_id);
 
+/**
+ * @brief OS interface to read association
+ *        of multiple \a tasks with classes of service
+ *
+ * Resctrl tasks files are read once for all tasks, which is much faster
+ * than calling pqos_alloc_assoc_get_pid() for each task. Tasks that could
+ * not be found (e.g. already exited) do not stop lookup of the remaining
+ * tasks.
+ *
+ * @param [in] tasks table of task IDs to find association
+ * @param [in] num_tasks number of task IDs in \a tasks
+ * @param [out] class_ids table of \a num_tasks classes of service
+ * @param [out] status optional table of \a num_tasks statuses, one for
+ *              each task
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_PARAM some tasks do not exist, classes of service of
+ *         other tasks have been read
+ */
+int pqos_alloc_assoc_get_pids(const pid_t *tasks,
+                              const unsigned num_tasks,
+                              unsigned *class_ids,
+                              int *status);
+
 /**
  * @brief Assign first available COS to cores in \a core_array
  *
@@ -714,6 +838,22 @@ int pqos_alloc_assign(const unsigned technology,
  */
 int pqos_alloc_release(const unsigned *core_array, const unsigned core_num);
 
+/**
+ * @brief Reads COS associations of all cores from hardware again
+ *
+ * The library keeps COS associations of cores in memory and reads them
+ * from hardware only once. This call is needed after other tools changed
+ * the associations. The OS interface does not keep associations and
+ * never reports a change.
+ *
+ * @param [out] changed set to 1 if associations were changed outside of
+ *              the library and have been read again, 0 otherwise
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ */
+int pqos_alloc_assoc_resync(int *changed);
+
 /**
  * @brief Assign first available COS to tasks in \a task_array
  *        Searches all COS directories from highest to lowest
@@ -1046,6 +1186,103 @@ unsigned *pqos_cpu_get_cores_l3cat_id(const struct pqos_cpuinfo *cpu,
                                       const unsigned l3cat_id,
                                       unsigned *count);
 
+/**
+ * @brief Retrieves socket id's without allocating memory
+ *
+ * The view* functions return arrays precomputed by the library. They
+ * remain valid until pqos_fini() and must not be freed. Only the CPU
+ * information structure returned by \a pqos_cap_get is supported.
+ *
+ * @param [in] cpu CPU information structure from \a pqos_cap_get
+ * @param [out] count place to store number of sockets
+ *
+ * @return Array of socket id's
+ * @retval NULL on error or if \a cpu was not returned by \a pqos_cap_get
+ */
+const unsigned *pqos_cpu_view_sockets(const struct pqos_cpuinfo *cpu,
+                                      unsigned *count);
+
+/**
+ * @brief Retrieves l3cat id's without allocating memory
+ *
+ * @param [in] cpu CPU information structure from \a pqos_cap_get
+ * @param [out] count place to store number of l3cat id's
+ *
+ * @return Array of l3cat id's
+ * @retval NULL on error or if \a cpu was not returned by \a pqos_cap_get
+ */
+const unsigned *pqos_cpu_view_l3cat_ids(const struct pqos_cpuinfo *cpu,
+                                        unsigned *count);
+
+/**
+ * @brief Retrieves mba id's without allocating memory
+ *
+ * @param [in] cpu CPU information structure from \a pqos_cap_get
+ * @param [out] count place to store number of mba id's
+ *
+ * @return Array of mba id's
+ * @retval NULL on error or if \a cpu was not returned by \a pqos_cap_get
+ */
+const unsigned *pqos_cpu_view_mba_ids(const struct pqos_cpuinfo *cpu,
+                                      unsigned *count);
+
+/**
+ * @brief Retrieves L2 id's without allocating memory
+ *
+ * @param [in] cpu CPU information structure from \a pqos_cap_get
+ * @param [out] count place to store number of L2 id's
+ *
+ * @return Array of L2 id's
+ * @retval NULL on error or if \a cpu was not returned by \a pqos_cap_get
+ */
+const unsigned *pqos_cpu_view_l2ids(const struct pqos_cpuinfo *cpu,
+                                    unsigned *count);
+
+/**
+ * @brief Retrieves core id's of \a socket without allocating memory
+ *
+ * @param [in] cpu CPU information structure from \a pqos_cap_get
+ * @param [in] socket CPU socket id to enumerate
+ * @param [out] count place to store number of core id's
+ *
+ * @return Array of core id's
+ * @retval NULL on error, if no core found or if \a cpu was not returned
+ *         by \a pqos_cap_get
+ */
+const unsigned *pqos_cpu_view_cores(const struct pqos_cpuinfo *cpu,
+                                    const unsigned socket,
+                                    unsigned *count);
+
+/**
+ * @brief Retrieves core id's of L3 cluster without allocating memory
+ *
+ * @param [in] cpu CPU information structure from \a pqos_cap_get
+ * @param [in] l3_id L3 cluster ID
+ * @param [out] count place to store number of core id's
+ *
+ * @return Array of core id's
+ * @retval NULL on error, if no core found or if \a cpu was not returned
+ *         by \a pqos_cap_get
+ */
+const unsigned *pqos_cpu_view_cores_l3id(const struct pqos_cpuinfo *cpu,
+                                         const unsigned l3_id,
+                                         unsigned *count);
+
+/**
+ * @brief Retrieves core id's of \a l3cat_id without allocating memory
+ *
+ * @param [in] cpu CPU information structure from \a pqos_cap_get
+ * @param [in] l3cat_id to enumerate
+ * @param [out] count place to store number of core id's
+ *
+ * @return Array of core id's
+ * @retval NULL on error, if no core found or if \a cpu was not returned
+ *         by \a pqos_cap_get
+ */
+const unsigned *pqos_cpu_view_cores_l3cat_id(const struct pqos_cpuinfo *cpu,
+                                             const unsigned l3cat_id,
+                                             unsigned *count);
+
 /**
  * @brief Retrieves task id's from resctrl task file for a given COS
  *
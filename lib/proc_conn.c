@@ -0,0 +1,256 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2022 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+/**
+ * @brief Process event connector
+ *
+ * Socket is non-blocking and is drained by the caller, so no thread
+ * is needed to receive events.
+ */
+
+#include "proc_conn.h"
+
+#include "log.h"
+#include "pqos.h"
+
+#include <errno.h>
+#include <linux/cn_proc.h>
+#include <linux/connector.h>
+#include <linux/netlink.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/**
+ * Requested socket receive buffer size
+ */
+#define PROC_CONN_RCVBUF (4 * 1024 * 1024)
+
+/**
+ * Netlink socket subscribed to process events
+ */
+static int m_sock = -1;
+
+/**
+ * @brief Sends multicast listen/ignore request to proc connector
+ *
+ * @param [in] op PROC_CN_MCAST_LISTEN or PROC_CN_MCAST_IGNORE
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+proc_conn_mcast(const enum proc_cn_mcast_op op)
+{
+        union {
+                struct nlmsghdr hdr;
+                char buf[NLMSG_SPACE(sizeof(struct cn_msg) + sizeof(op))];
+        } req;
+        struct cn_msg *msg;
+
+        memset(&req, 0, sizeof(req));
+        req.hdr.nlmsg_len = NLMSG_LENGTH(sizeof(struct cn_msg) + sizeof(op));
+        req.hdr.nlmsg_type = NLMSG_DONE;
+        req.hdr.nlmsg_pid = (__u32)getpid();
+
+        msg = (struct cn_msg *)NLMSG_DATA(&req.hdr);
+        msg->id.idx = CN_IDX_PROC;
+        msg->id.val = CN_VAL_PROC;
+        msg->len = sizeof(op);
+        memcpy(msg->data, &op, sizeof(op));
+
+        if (send(m_sock, &req, req.hdr.nlmsg_len, 0) < 0)
+                return PQOS_RETVAL_ERROR;
+
+        return PQOS_RETVAL_OK;
+}
+
+int
+proc_conn_init(void)
+{
+        struct sockaddr_nl addr;
+        int size = PROC_CONN_RCVBUF;
+
+        if (m_sock >= 0)
+                return PQOS_RETVAL_OK;
+
+        m_sock = socket(PF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                        NETLINK_CONNECTOR);
+        if (m_sock < 0) {
+                LOG_DEBUG("Failed to open proc connector socket\n");
+                return PQOS_RETVAL_RESOURCE;
+        }
+
+        memset(&addr, 0, sizeof(addr));
+        addr.nl_family = AF_NETLINK;
+        addr.nl_groups = CN_IDX_PROC;
+        if (bind(m_sock, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+                LOG_DEBUG("Failed to bind proc connector socket\n");
+                goto proc_conn_init_error;
+        }
+
+        /* bursts of thread creation should not overflow the socket */
+        if (setsockopt(m_sock, SOL_SOCKET, SO_RCVBUFFORCE, &size,
+                       sizeof(size)) != 0)
+                (void)setsockopt(m_sock, SOL_SOCKET, SO_RCVBUF, &size,
+                                 sizeof(size));
+
+        if (proc_conn_mcast(PROC_CN_MCAST_LISTEN) != PQOS_RETVAL_OK) {
+                LOG_DEBUG("Failed to subscribe to process events\n");
+                goto proc_conn_init_error;
+        }
+
+        return PQOS_RETVAL_OK;
+
+proc_conn_init_error:
+        close(m_sock);
+        m_sock = -1;
+        return PQOS_RETVAL_RESOURCE;
+}
+
+void
+proc_conn_fini(void)
+{
+        if (m_sock < 0)
+                return;
+
+        (void)proc_conn_mcast(PROC_CN_MCAST_IGNORE);
+        close(m_sock);
+        m_sock = -1;
+}
+
+int
+proc_conn_enabled(void)
+{
+        return m_sock >= 0;
+}
+
+/**
+ * @brief Converts proc connector message to process event
+ *
+ * @param [in] msg connector message
+ * @param [out] event process event
+ *
+ * @return 1 if message is fork or exit event, 0 otherwise
+ */
+static int
+proc_conn_parse(const struct cn_msg *msg, struct proc_conn_event *event)
+{
+        const struct proc_event *ev = (const struct proc_event *)msg->data;
+
+        if (msg->id.idx != CN_IDX_PROC || msg->id.val != CN_VAL_PROC ||
+            msg->len < sizeof(*ev))
+                return 0;
+
+        switch (ev->what) {
+        case PROC_EVENT_FORK:
+                event->type = PROC_CONN_EVENT_FORK;
+                event->pid = ev->event_data.fork.child_pid;
+                event->tgid = ev->event_data.fork.child_tgid;
+                event->parent_pid = ev->event_data.fork.parent_pid;
+                event->parent_tgid = ev->event_data.fork.parent_tgid;
+                return 1;
+        case PROC_EVENT_EXIT:
+                event->type = PROC_CONN_EVENT_EXIT;
+                event->pid = ev->event_data.exit.process_pid;
+                event->tgid = ev->event_data.exit.process_tgid;
+                event->parent_pid = 0;
+                event->parent_tgid = 0;
+                return 1;
+        default:
+                return 0;
+        }
+}
+
+int
+proc_conn_read(proc_conn_cb_t cb, void *arg)
+{
+        int ret = PQOS_RETVAL_OK;
+
+        ASSERT(cb != NULL);
+
+        if (m_sock < 0)
+                return PQOS_RETVAL_RESOURCE;
+
+        for (;;) {
+                union {
+                        struct nlmsghdr hdr;
+                        char buf[8192];
+                } rsp;
+                const struct nlmsghdr *hdr;
+                struct sockaddr_nl addr;
+                socklen_t addr_len = sizeof(addr);
+                ssize_t len;
+
+                len = recvfrom(m_sock, &rsp, sizeof(rsp), 0,
+                               (struct sockaddr *)&addr, &addr_len);
+                if (len < 0) {
+                        if (errno == EINTR)
+                                continue;
+                        if (errno == ENOBUFS) {
+                                LOG_WARN("Process events lost\n");
+                                ret = PQOS_RETVAL_OVERFLOW;
+                                continue;
+                        }
+                        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                                LOG_ERROR("Failed to read process events\n");
+                                ret = PQOS_RETVAL_ERROR;
+                        }
+                        break;
+                }
+
+                /* accept messages from the kernel only */
+                if (addr.nl_pid != 0)
+                        continue;
+
+                for (hdr = &rsp.hdr; NLMSG_OK(hdr, len);
+                     hdr = NLMSG_NEXT(hdr, len)) {
+                        struct proc_conn_event event;
+
+                        if (hdr->nlmsg_type == NLMSG_NOOP)
+                                continue;
+                        if (hdr->nlmsg_type == NLMSG_ERROR ||
+                            hdr->nlmsg_type == NLMSG_OVERRUN) {
+                                ret = PQOS_RETVAL_OVERFLOW;
+                                continue;
+                        }
+                        if (proc_conn_parse(
+                                (const struct cn_msg *)NLMSG_DATA(hdr),
+                                &event))
+                                cb(&event, arg);
+                }
+        }
+
+        return ret;
+}
@@ -0,0 +1,121 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2022 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+/**
+ * @brief Internal header file to process event connector
+ *
+ * Process fork and exit notifications are received from the kernel
+ * proc connector over a netlink socket. Requires CAP_NET_ADMIN.
+ */
+
+#ifndef __PQOS_PROC_CONN_H__
+#define __PQOS_PROC_CONN_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "types.h"
+
+#include <sys/types.h>
+
+/**
+ * Process event types
+ */
+enum proc_conn_event_type {
+        PROC_CONN_EVENT_FORK = 0, /**< new task created */
+        PROC_CONN_EVENT_EXIT      /**< task exited */
+};
+
+/**
+ * Process event
+ */
+struct proc_conn_event {
+        enum proc_conn_event_type type; /**< event type */
+        pid_t pid;                      /**< task id */
+        pid_t tgid;                     /**< thread group id of the task */
+        pid_t parent_pid;               /**< parent task id (fork only) */
+        pid_t parent_tgid; /**< parent thread group id (fork only) */
+};
+
+/**
+ * @brief Process event callback
+ *
+ * @param [in] event process event
+ * @param [in] arg callback argument
+ */
+typedef void (*proc_conn_cb_t)(const struct proc_conn_event *event,
+                               void *arg);
+
+/**
+ * @brief Subscribes to process events
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_RESOURCE proc connector is not available
+ */
+PQOS_LOCAL int proc_conn_init(void);
+
+/**
+ * @brief Unsubscribes from process events
+ */
+PQOS_LOCAL void proc_conn_fini(void);
+
+/**
+ * @brief Checks if subscribed to process events
+ *
+ * @return 1 if subscribed, 0 otherwise
+ */
+PQOS_LOCAL int proc_conn_enabled(void);
+
+/**
+ * @brief Reads all pending process events
+ *
+ * Function does not block. \a cb is called for each event in the order
+ * of arrival.
+ *
+ * @param [in] cb event callback
+ * @param [in] arg callback argument
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_OVERFLOW some events were lost
+ */
+PQOS_LOCAL int proc_conn_read(proc_conn_cb_t cb, void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PQOS_PROC_CONN_H__ */
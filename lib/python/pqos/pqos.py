@@ -67,6 +67,8 @@ class CPqosConfig(ctypes.Structure):
         ('verbose', ctypes.c_int),
         ('interface', ctypes.c_int),
         ('reserved', ctypes.c_int),
+        ('perf_read', ctypes.c_int),
+        ('pid_track', ctypes.c_int),
     ]
 
 
@@ -112,7 +114,7 @@ class Pqos(object):
     def __init__(self):
         "Finds PQoS library and constructs a new object."
 
-        self.lib = ctypes.cdll.LoadLibrary('libpqos.so.4')
+        self.lib = ctypes.cdll.LoadLibrary('libpqos.so.5')
 
     def init(self, interface, log_file=None, log_callback=None,
              log_context=None, verbose='default'):
@@ -39,12 +39,14 @@
 #include "log.h"
 #include "resctrl_monitoring.h"
 #include "resctrl_utils.h"
+#include "tid_hash.h"
 
 #include <dirent.h>
 #include <errno.h>
 #include <signal.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 /*
  * COS file names on resctrl file system
@@ -53,18 +55,29 @@ static const char *rctl_cpus = "cpus";
 static const char *rctl_schemata = "schemata";
 static const char *rctl_tasks = "tasks";
 
+/**
+ * Task to COS index built from all COS tasks files
+ */
+static struct tid_hash task_index;
+static int task_index_valid = 0;
+
 int
 resctrl_alloc_init(const struct pqos_cpuinfo *cpu, const struct pqos_cap *cap)
 {
         if (cpu == NULL || cap == NULL)
                 return PQOS_RETVAL_PARAM;
 
+        resctrl_alloc_task_index_invalidate();
+
         return PQOS_RETVAL_OK;
 }
 
 int
 resctrl_alloc_fini(void)
 {
+        tid_hash_fini(&task_index);
+        task_index_valid = 0;
+
         return PQOS_RETVAL_OK;
 }
 
@@ -413,6 +426,74 @@ resctrl_alloc_task_write(const unsigned class_id, const pid_t task)
                 ret = PQOS_RETVAL_PARAM;
         }
 
+        /* keep task index in sync with our own writes */
+        if (ret != PQOS_RETVAL_OK ||
+            (task_index_valid &&
+             tid_hash_put(&task_index, task, class_id) != PQOS_RETVAL_OK))
+                resctrl_alloc_task_index_invalidate();
+
+        return ret;
+}
+
+int
+resctrl_alloc_tasks_write(const unsigned class_id,
+                          const pid_t *tasks,
+                          const unsigned num_tasks,
+                          int *status)
+{
+        FILE *fd;
+        unsigned i;
+        int ret = PQOS_RETVAL_OK;
+
+        ASSERT(tasks != NULL);
+
+        /* Open resctrl tasks file once for all tasks */
+        fd = resctrl_alloc_fopen(class_id, rctl_tasks, "w");
+        if (fd == NULL)
+                return PQOS_RETVAL_ERROR;
+
+        /*
+         * Kernel accepts one task per write, failure of one task does not
+         * affect the others
+         */
+        for (i = 0; i < num_tasks; i++) {
+                const pid_t task = tasks[i];
+                int task_ret = PQOS_RETVAL_OK;
+                char buf[16];
+                int len;
+
+                len = snprintf(buf, sizeof(buf), "%d\n", (int)task);
+                if (task <= 0)
+                        task_ret = PQOS_RETVAL_PARAM;
+                else if (write(fileno(fd), buf, (size_t)len) != len) {
+                        if (errno == ESRCH) {
+                                LOG_DEBUG("Task %d does not exist!\n",
+                                          (int)task);
+                                task_ret = PQOS_RETVAL_PARAM;
+                        } else {
+                                LOG_ERROR("Failed to write task %d to "
+                                          "file!\n",
+                                          (int)task);
+                                task_ret = PQOS_RETVAL_ERROR;
+                        }
+                }
+
+                /* keep task index in sync with our own writes */
+                if (task_ret == PQOS_RETVAL_ERROR ||
+                    (task_ret == PQOS_RETVAL_OK && task_index_valid &&
+                     tid_hash_put(&task_index, task, class_id) !=
+                         PQOS_RETVAL_OK))
+                        resctrl_alloc_task_index_invalidate();
+
+                if (status != NULL)
+                        status[i] = task_ret;
+                if (task_ret != PQOS_RETVAL_OK && ret != PQOS_RETVAL_ERROR)
+                        ret = task_ret;
+        }
+
+        if (resctrl_alloc_fclose(fd) != PQOS_RETVAL_OK)
+                ret = PQOS_RETVAL_ERROR;
+
         return ret;
 }
 
@@ -481,21 +562,20 @@ resctrl_alloc_task_read_exit_clean:
         return tasks;
 }
 
+void
+resctrl_alloc_task_index_invalidate(void)
+{
+        tid_hash_clear(&task_index);
+        task_index_valid = 0;
+}
+
 int
-resctrl_alloc_task_search(unsigned *class_id,
-                          const struct pqos_cap *cap,
-                          const pid_t task)
+resctrl_alloc_task_index_refresh(const struct pqos_cap *cap)
 {
-        FILE *fd;
         unsigned i, max_cos = 0;
         int ret;
 
-        /* Check if task exists */
-        ret = resctrl_alloc_task_validate(task);
-        if (ret != PQOS_RETVAL_OK) {
-                LOG_ERROR("Task %d does not exist!\n", (int)task);
-                return PQOS_RETVAL_PARAM;
-        }
+        resctrl_alloc_task_index_invalidate();
 
         /* Get number of COS */
         ret = resctrl_alloc_get_grps_num(cap, &max_cos);
@@ -503,40 +583,97 @@ resctrl_alloc_task_search(unsigned *class_id,
                 return ret;
 
         /**
-         * Starting at highest COS - search all COS tasks files for task ID
+         * Single pass over all COS tasks files
          */
-        for (i = (max_cos - 1); (int)i >= 0; i--) {
+        for (i = 0; i < max_cos; i++) {
+                FILE *fd;
                 uint64_t tid = 0;
                 char buf[128];
 
                 /* Open resctrl tasks file */
                 fd = resctrl_alloc_fopen(i, rctl_tasks, "r");
                 if (fd == NULL)
-                        return PQOS_RETVAL_ERROR;
+                        goto resctrl_alloc_task_index_refresh_error;
 
-                /* Search tasks file for specified task ID */
                 memset(buf, 0, sizeof(buf));
                 while (fgets(buf, sizeof(buf), fd) != NULL) {
                         ret = resctrl_utils_strtouint64(buf, 10, &tid);
-                        if (ret != PQOS_RETVAL_OK)
+                        if (ret != PQOS_RETVAL_OK || tid == 0)
                                 continue;
 
-                        if (task == (pid_t)tid) {
-                                *class_id = i;
-                                if (resctrl_alloc_fclose(fd) != PQOS_RETVAL_OK)
-                                        return PQOS_RETVAL_ERROR;
-
-                                return PQOS_RETVAL_OK;
-                        }
+                        ret = tid_hash_put(&task_index, (pid_t)tid, i);
+                        if (ret != PQOS_RETVAL_OK)
+                                break;
                 }
-                if (resctrl_alloc_fclose(fd) != PQOS_RETVAL_OK)
-                        return PQOS_RETVAL_ERROR;
+                if (resctrl_alloc_fclose(fd) != PQOS_RETVAL_OK ||
+                    ret != PQOS_RETVAL_OK)
+                        goto resctrl_alloc_task_index_refresh_error;
+        }
+
+        task_index_valid = 1;
+        return PQOS_RETVAL_OK;
+
+resctrl_alloc_task_index_refresh_error:
+        resctrl_alloc_task_index_invalidate();
+        return PQOS_RETVAL_ERROR;
+}
+
+/**
+ * @brief Looks up task in the index, refreshing the index once if needed
+ *
+ * @param [in] cap platform QoS capabilities structure
+ * @param [in] task task ID to search for
+ * @param [out] class_id COS containing task ID
+ * @param [in,out] refreshed set once the index was refreshed by the caller
+ *
+ * @return Operational status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_PARAM task does not exist
+ */
+static int
+resctrl_alloc_task_lookup(const struct pqos_cap *cap,
+                          const pid_t task,
+                          unsigned *class_id,
+                          int *refreshed)
+{
+        int ret;
+
+        if (task_index_valid && tid_hash_get(&task_index, task, class_id))
+                return PQOS_RETVAL_OK;
+
+        /* Check if task exists */
+        ret = resctrl_alloc_task_validate(task);
+        if (ret != PQOS_RETVAL_OK) {
+                LOG_ERROR("Task %d does not exist!\n", (int)task);
+                return PQOS_RETVAL_PARAM;
+        }
+
+        /* task could be created after the index was built */
+        if (!*refreshed) {
+                ret = resctrl_alloc_task_index_refresh(cap);
+                if (ret != PQOS_RETVAL_OK)
+                        return ret;
+                *refreshed = 1;
+
+                if (tid_hash_get(&task_index, task, class_id))
+                        return PQOS_RETVAL_OK;
         }
+
         /* If not found in any COS group - return error */
         LOG_ERROR("Failed to get association for task %d!\n", (int)task);
         return PQOS_RETVAL_ERROR;
 }
 
+int
+resctrl_alloc_task_search(unsigned *class_id,
+                          const struct pqos_cap *cap,
+                          const pid_t task)
+{
+        int refreshed = 0;
+
+        return resctrl_alloc_task_lookup(cap, task, class_id, &refreshed);
+}
+
 int
 resctrl_alloc_task_file_check(const unsigned class_id, unsigned *found)
 {
@@ -622,9 +759,99 @@ int
 resctrl_alloc_assoc_get_pid(const pid_t task, unsigned *class_id)
 {
         const struct pqos_cap *cap = _pqos_get_cap();
+        unsigned i, max_cos = 0;
+        int ret;
+
+        /* Check if task exists */
+        ret = resctrl_alloc_task_validate(task);
+        if (ret != PQOS_RETVAL_OK) {
+                LOG_ERROR("Task %d does not exist!\n", (int)task);
+                return PQOS_RETVAL_PARAM;
+        }
+
+        /* Get number of COS */
+        ret = resctrl_alloc_get_grps_num(cap, &max_cos);
+        if (ret != PQOS_RETVAL_OK)
+                return ret;
+
+        /**
+         * Single task - read tasks files directly, starting at highest COS,
+         * and stop at the first match instead of indexing all tasks
+         */
+        for (i = (max_cos - 1); (int)i >= 0; i--) {
+                FILE *fd;
+                uint64_t tid = 0;
+                char buf[128];
+                int found = 0;
+
+                /* Open resctrl tasks file */
+                fd = resctrl_alloc_fopen(i, rctl_tasks, "r");
+                if (fd == NULL)
+                        return PQOS_RETVAL_ERROR;
 
-        /* Search tasks files */
-        return resctrl_alloc_task_search(class_id, cap, task);
+                /* Search tasks file for specified task ID */
+                memset(buf, 0, sizeof(buf));
+                while (fgets(buf, sizeof(buf), fd) != NULL) {
+                        ret = resctrl_utils_strtouint64(buf, 10, &tid);
+                        if (ret != PQOS_RETVAL_OK)
+                                continue;
+
+                        if (task == (pid_t)tid) {
+                                found = 1;
+                                break;
+                        }
+                }
+                if (resctrl_alloc_fclose(fd) != PQOS_RETVAL_OK)
+                        return PQOS_RETVAL_ERROR;
+
+                if (found) {
+                        *class_id = i;
+                        /* keep a valid index in line with what was read */
+                        if (task_index_valid &&
+                            tid_hash_put(&task_index, task, i) !=
+                                PQOS_RETVAL_OK)
+                                resctrl_alloc_task_index_invalidate();
+                        return PQOS_RETVAL_OK;
+                }
+        }
+
+        /* If not found in any COS group - return error */
+        LOG_ERROR("Failed to get association for task %d!\n", (int)task);
+        return PQOS_RETVAL_ERROR;
+}
+
+int
+resctrl_alloc_assoc_get_pids(const pid_t *tasks,
+                             const unsigned num_tasks,
+                             unsigned *class_ids,
+                             int *status)
+{
+        const struct pqos_cap *cap = _pqos_get_cap();
+        int refreshed;
+        unsigned i;
+        int ret;
+
+        ASSERT(tasks != NULL);
+        ASSERT(class_ids != NULL);
+
+        /* one snapshot of all tasks files serves the whole table */
+        ret = resctrl_alloc_task_index_refresh(cap);
+        if (ret != PQOS_RETVAL_OK)
+                return ret;
+        refreshed = 1;
+
+        /* failure of one task does not affect the others */
+        for (i = 0; i < num_tasks; i++) {
+                int task_ret = resctrl_alloc_task_lookup(
+                    cap, tasks[i], &class_ids[i], &refreshed);
+
+                if (status != NULL)
+                        status[i] = task_ret;
+                if (task_ret != PQOS_RETVAL_OK && ret != PQOS_RETVAL_ERROR)
+                        ret = task_ret;
+        }
+
+        return ret;
 }
 
 int
@@ -189,6 +189,27 @@ PQOS_LOCAL int resctrl_alloc_task_validate(const pid_t task);
 PQOS_LOCAL int resctrl_alloc_task_write(const unsigned class_id,
                                         const pid_t task);
 
+/**
+ * @brief Function to write multiple task IDs to resctrl COS tasks file
+ *
+ * Tasks file is opened once. Tasks that failed to be written do not stop
+ * the remaining ones.
+ *
+ * @param [in] class_id COS tasks file to write to
+ * @param [in] tasks task IDs to write to tasks file
+ * @param [in] num_tasks number of task IDs
+ * @param [out] status table to store status of each task in or NULL
+ *
+ * @return Operational status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_PARAM some tasks do not exist
+ * @retval PQOS_RETVAL_ERROR some tasks could not be written
+ */
+PQOS_LOCAL int resctrl_alloc_tasks_write(const unsigned class_id,
+                                         const pid_t *tasks,
+                                         const unsigned num_tasks,
+                                         int *status);
+
 /**
  * @brief Reads task id's from resctrl task file for a given COS
  *
@@ -201,9 +222,30 @@ PQOS_LOCAL int resctrl_alloc_task_write(const unsigned class_id,
 PQOS_LOCAL unsigned *resctrl_alloc_task_read(unsigned class_id,
                                              unsigned *count);
 
+/**
+ * @brief Drops task to COS index
+ *
+ * Index is rebuilt from COS tasks files on the next lookup.
+ */
+PQOS_LOCAL void resctrl_alloc_task_index_invalidate(void);
+
+/**
+ * @brief Builds task to COS index reading all COS tasks files once
+ *
+ * @param [in] cap platform QoS capabilities structure
+ *                 returned by \a pqos_cap_get
+ *
+ * @return Operational status
+ * @retval PQOS_RETVAL_OK on success
+ */
+PQOS_LOCAL int resctrl_alloc_task_index_refresh(const struct pqos_cap *cap);
+
 /**
  * @brief Function to search a COS tasks file for a task ID
  *
+ * Task is looked up in the task to COS index. Index is built on first use
+ * and rebuilt when the task is not found in it.
+ *
  * @param [out] class_id COS containing task ID
  * @param [in] cap platform QoS capabilities structure
  *                 returned by \a pqos_cap_get
@@ -280,6 +322,26 @@ PQOS_LOCAL int resctrl_alloc_assoc_set_pid(const pid_t task,
 PQOS_LOCAL int resctrl_alloc_assoc_get_pid(const pid_t task,
                                            unsigned *class_id);
 
+/**
+ * @brief Resctrl interface to read association
+ *        of \a tasks with classes of service
+ *
+ * Task to COS index is refreshed once for all tasks.
+ *
+ * @param [in] tasks table of task ids
+ * @param [in] num_tasks number of task ids
+ * @param [out] class_ids table to store classes of service in
+ * @param [out] status optional table of per task statuses
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_PARAM some tasks do not exist
+ */
+PQOS_LOCAL int resctrl_alloc_assoc_get_pids(const pid_t *tasks,
+                                            const unsigned num_tasks,
+                                            unsigned *class_ids,
+                                            int *status);
+
 /**
  * @brief Gets unused resctrl group
  *
@@ -39,9 +39,11 @@
 #include "monitoring.h"
 #include "resctrl.h"
 #include "resctrl_alloc.h"
+#include "tid_hash.h"
 
 #include <dirent.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
@@ -222,7 +224,8 @@ alloc_assoc_get_pid(const pid_t tid, unsigned *class_id)
                 return PQOS_RETVAL_OK;
         }
 
-        ret = resctrl_alloc_assoc_get_pid(tid, class_id);
+        /* callers invalidate task index when a new operation starts */
+        ret = resctrl_alloc_task_search(class_id, cap, tid);
         if (ret != PQOS_RETVAL_OK)
                 LOG_ERROR("Failed to retrieve task %d association\n", tid);
 
@@ -338,6 +341,126 @@ resctrl_mon_cpumask_read(const unsigned class_id,
         return ret;
 }
 
+/**
+ * @brief Get name of the counter file for resctrl mon event
+ *
+ * @param [in] event resctrl mon event
+ *
+ * @return Counter file name or NULL for unknown event
+ */
+static const char *
+resctrl_mon_counter_name(const enum pqos_mon_event event)
+{
+        switch (event) {
+        case PQOS_MON_EVENT_L3_OCCUP:
+                return "llc_occupancy";
+        case PQOS_MON_EVENT_LMEM_BW:
+                return "mbm_local_bytes";
+        case PQOS_MON_EVENT_TMEM_BW:
+                return "mbm_total_bytes";
+        default:
+                return NULL;
+        }
+}
+
+/**
+ * @brief Open counter file
+ *
+ * @param [in] class_id COS id
+ * @param [in] resctrl_group mon group name
+ * @param [in] l3id l3id to read from
+ * @param [in] event resctrl mon event
+ *
+ * @return File descriptor
+ * @retval -1 on error
+ */
+static int
+resctrl_mon_counter_open(const unsigned class_id,
+                         const char *resctrl_group,
+                         const unsigned l3id,
+                         const enum pqos_mon_event event)
+{
+        char buf[128];
+        char path[PATH_MAX];
+        const char *name = resctrl_mon_counter_name(event);
+
+        ASSERT(resctrl_group != NULL);
+        ASSERT(name != NULL);
+
+        resctrl_mon_group_path(class_id, resctrl_group, NULL, buf, sizeof(buf));
+        snprintf(path, sizeof(path), "%s/mon_data/mon_L3_%02u/%s", buf, l3id,
+                 name);
+
+        /* descriptors may be cached, don't leak them to executed programs */
+        return pqos_open(path, O_RDONLY | O_CLOEXEC);
+}
+
+/**
+ * @brief Parse counter file content
+ *
+ * Value is set to 0 if the counter is not available.
+ *
+ * @param [in] buf file content
+ * @param [in] len length of the content
+ * @param [out] value counter value
+ */
+static void
+resctrl_mon_counter_parse(const char *buf, const ssize_t len, uint64_t *value)
+{
+        ssize_t i;
+        uint64_t counter = 0;
+
+        *value = 0;
+
+        /* "Unavailable" or "Error" is reported when counter is not ready */
+        if (len <= 0 || buf[0] < '0' || buf[0] > '9')
+                return;
+
+        for (i = 0; i < len && buf[i] >= '0' && buf[i] <= '9'; i++) {
+                const unsigned digit = buf[i] - '0';
+
+                /* counter overflow */
+                if (counter > (UINT64_MAX - digit) / 10)
+                        return;
+
+                counter = counter * 10 + digit;
+        }
+
+        if (counter < UINT64_MAX)
+                *value = counter;
+}
+
+/**
+ * @brief Read counter value from open counter file
+ *
+ * File is re-read from the beginning so the same descriptor can be used
+ * for subsequent reads. Value is set to 0 if the counter is not available.
+ *
+ * @param [in] fd counter file descriptor
+ * @param [out] value counter value
+ *
+ * @return Operational status
+ * @retval PQOS_RETVAL_OK on success
+ */
+PQOS_STATIC int
+resctrl_mon_counter_pread(const int fd, uint64_t *value)
+{
+        char buf[32];
+        ssize_t len;
+
+        ASSERT(value != NULL);
+
+        *value = 0;
+
+        len = pread(fd, buf, sizeof(buf), 0);
+        if (len < 0)
+                return PQOS_RETVAL_ERROR;
+
+        resctrl_mon_counter_parse(buf, len, value);
+
+        return PQOS_RETVAL_OK;
+}
+
 /**
  * @brief Read counter value
  *
@@ -357,54 +480,197 @@ resctrl_mon_read_counter(const unsigned class_id,
                          const enum pqos_mon_event event,
                          uint64_t *value)
 {
-        char buf[128];
-        const char *name;
-        char path[PATH_MAX];
-        FILE *fd;
-        unsigned long long counter;
+        int fd;
+        int ret;
 
         ASSERT(resctrl_group != NULL);
         ASSERT(value != NULL);
 
-        switch (event) {
-        case PQOS_MON_EVENT_L3_OCCUP:
-                name = "llc_occupancy";
-                break;
-        case PQOS_MON_EVENT_LMEM_BW:
-                name = "mbm_local_bytes";
-                break;
-        case PQOS_MON_EVENT_TMEM_BW:
-                name = "mbm_total_bytes";
-                break;
-        default:
+        if (resctrl_mon_counter_name(event) == NULL) {
                 LOG_ERROR("Unknown resctrl event\n");
                 return PQOS_RETVAL_PARAM;
-                break;
         }
 
         *value = 0;
 
-        resctrl_mon_group_path(class_id, resctrl_group, NULL, buf, sizeof(buf));
-        snprintf(path, sizeof(path), "%s/mon_data/mon_L3_%02u/%s", buf, l3id,
-                 name);
-        fd = pqos_fopen(path, "r");
-        if (fd == NULL)
+        fd = resctrl_mon_counter_open(class_id, resctrl_group, l3id, event);
+        if (fd < 0)
                 return PQOS_RETVAL_ERROR;
-        if (fscanf(fd, "%llu", &counter) == 1 && counter < UINT64_MAX)
-                *value = counter;
-        pqos_fclose(fd);
 
-        return PQOS_RETVAL_OK;
+        ret = resctrl_mon_counter_pread(fd, value);
+
+        close(fd);
+
+        return ret;
 }
 
 /**
- * @brief Read counter value from requested \a l3ids
+ * @brief Close cached counter files of monitoring group
  *
+ * @param [in] group monitoring structure
+ * @param [in] class_id COS id to close files for
+ * @param [in] all close files for all COS ids and release the cache
+ */
+static void
+resctrl_mon_counter_invalidate(struct pqos_mon_data *group,
+                               const unsigned class_id,
+                               const int all)
+{
+        struct pqos_mon_data_internal *intl = group->intl;
+        unsigned i;
+        unsigned num_fds = 0;
+
+        for (i = 0; i < intl->resctrl.num_fds; i++) {
+                struct pqos_mon_resctrl_fd *entry = &intl->resctrl.fds[i];
+
+                if (!all && entry->class_id != class_id) {
+                        intl->resctrl.fds[num_fds++] = *entry;
+                        continue;
+                }
+
+                close(entry->fd);
+        }
+        intl->resctrl.num_fds = num_fds;
+
+        if (num_fds == 0 && intl->resctrl.fds != NULL) {
+                free(intl->resctrl.fds);
+                intl->resctrl.fds = NULL;
+        }
+}
+
+/**
+ * @brief Read counter value using file cached in the monitoring group
+ *
+ * Counter file is opened on the first read and kept open for the lifetime
+ * of the monitoring group. Stale file is reopened once, i.e. when the mon
+ * group directory was recreated.
+ *
+ * @param [in] group monitoring structure
  * @param [in] class_id COS id
- * @param [in] resctrl_group mon group name
+ * @param [in] l3id l3id to read from
  * @param [in] event resctrl mon event
- * @param [in] l3ids l3ids to read from
- * @param [in] l3ids_num number of l3ids
+ * @param [out] value counter value
+ *
+ * @return Operational status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+resctrl_mon_read_counter_cached(struct pqos_mon_data *group,
+                                const unsigned class_id,
+                                const unsigned l3id,
+                                const enum pqos_mon_event event,
+                                uint64_t *value)
+{
+        struct pqos_mon_data_internal *intl = group->intl;
+        const char *resctrl_group = intl->resctrl.mon_group;
+        struct pqos_mon_resctrl_fd *entry = NULL;
+        unsigned i;
+        int ret;
+
+        ASSERT(resctrl_group != NULL);
+        ASSERT(value != NULL);
+
+        if (resctrl_mon_counter_name(event) == NULL) {
+                LOG_ERROR("Unknown resctrl event\n");
+                return PQOS_RETVAL_PARAM;
+        }
+
+        *value = 0;
+
+        for (i = 0; i < intl->resctrl.num_fds; i++)
+                if (intl->resctrl.fds[i].class_id == class_id &&
+                    intl->resctrl.fds[i].l3id == l3id &&
+                    intl->resctrl.fds[i].event == event) {
+                        entry = &intl->resctrl.fds[i];
+                        break;
+                }
+
+        /* value read by resctrl_mon_prefetch */
+        if (entry != NULL && entry->read.res >= 0) {
+                resctrl_mon_counter_parse(entry->buf, entry->read.res, value);
+                entry->read.res = -ENODATA;
+                return PQOS_RETVAL_OK;
+        }
+
+        if (entry != NULL) {
+                ret = resctrl_mon_counter_pread(entry->fd, value);
+                if (ret == PQOS_RETVAL_OK)
+                        return ret;
+
+                close(entry->fd);
+                entry->fd =
+                    resctrl_mon_counter_open(class_id, resctrl_group, l3id,
+                                             event);
+                if (entry->fd < 0) {
+                        /* drop stale entry */
+                        *entry = intl->resctrl.fds[--intl->resctrl.num_fds];
+                        return PQOS_RETVAL_ERROR;
+                }
+
+                return resctrl_mon_counter_pread(entry->fd, value);
+        }
+
+        entry = realloc(intl->resctrl.fds,
+                        sizeof(*entry) * (intl->resctrl.num_fds + 1));
+        if (entry == NULL)
+                return PQOS_RETVAL_RESOURCE;
+        intl->resctrl.fds = entry;
+
+        entry = &intl->resctrl.fds[intl->resctrl.num_fds];
+        entry->class_id = class_id;
+        entry->l3id = l3id;
+        entry->event = event;
+        entry->read.res = -ENODATA;
+        entry->fd = resctrl_mon_counter_open(class_id, resctrl_group, l3id,
+                                             event);
+        if (entry->fd < 0)
+                return PQOS_RETVAL_ERROR;
+        intl->resctrl.num_fds++;
+
+        return resctrl_mon_counter_pread(entry->fd, value);
+}
+
+unsigned
+resctrl_mon_prefetch(struct pqos_mon_data **groups,
+                     const unsigned num_groups,
+                     struct uring_read **reads)
+{
+        unsigned num = 0;
+        unsigned i;
+
+        ASSERT(groups != NULL);
+
+        for (i = 0; i < num_groups; i++) {
+                struct pqos_mon_data_internal *intl = groups[i]->intl;
+                unsigned j;
+
+                if (intl->resctrl.event == 0)
+                        continue;
+
+                for (j = 0; j < intl->resctrl.num_fds; j++) {
+                        struct pqos_mon_resctrl_fd *entry =
+                            &intl->resctrl.fds[j];
+
+                        if (reads != NULL) {
+                                entry->read.fd = entry->fd;
+                                entry->read.buf = entry->buf;
+                                entry->read.size = sizeof(entry->buf);
+                                entry->read.offset = 0;
+                                entry->read.res = -ENODATA;
+                                reads[num] = &entry->read;
+                        }
+                        num++;
+                }
+        }
+
+        return num;
+}
+
+/**
+ * @brief Read counter value from l3ids monitored by \a group
+ *
+ * @param [in] group monitoring structure
+ * @param [in] class_id COS id
  * @param [in] event monitoring event
  * @param [out] value counter value
  *
@@ -412,50 +678,48 @@ resctrl_mon_read_counter(const unsigned class_id,
  * @retval PQOS_RETVAL_OK on success
  */
 static int
-resctrl_mon_read_counters(const unsigned class_id,
-                          const char *resctrl_group,
-                          unsigned *l3ids,
-                          unsigned l3ids_num,
+resctrl_mon_read_counters(struct pqos_mon_data *group,
+                          const unsigned class_id,
                           const enum pqos_mon_event event,
                           uint64_t *value)
 {
         int ret = PQOS_RETVAL_OK;
-        unsigned *l3cat_ids = NULL;
-        unsigned l3cat_id_num;
+        const unsigned *l3cat_ids = group->intl->resctrl.l3id;
+        unsigned *l3cat_ids_alloc = NULL;
+        unsigned l3cat_id_num = group->intl->resctrl.num_l3id;
         unsigned l3cat_id;
-        const struct pqos_cpuinfo *cpu = _pqos_get_cpu();
 
-        ASSERT(resctrl_group != NULL);
+        ASSERT(group->intl->resctrl.mon_group != NULL);
         ASSERT(value != NULL);
 
         *value = 0;
 
-        if (l3ids == NULL) {
-                l3cat_ids = pqos_cpu_get_l3cat_ids(cpu, &l3cat_id_num);
+        if (l3cat_ids == NULL) {
+                const struct pqos_cpuinfo *cpu = _pqos_get_cpu();
+
+                l3cat_ids = pqos_cpu_view_l3cat_ids(cpu, &l3cat_id_num);
                 if (l3cat_ids == NULL) {
-                        ret = PQOS_RETVAL_ERROR;
-                        goto resctrl_mon_read_exit;
+                        l3cat_ids_alloc =
+                            pqos_cpu_get_l3cat_ids(cpu, &l3cat_id_num);
+                        if (l3cat_ids_alloc == NULL)
+                                return PQOS_RETVAL_ERROR;
+                        l3cat_ids = l3cat_ids_alloc;
                 }
-        } else {
-                l3cat_ids = l3ids;
-                l3cat_id_num = l3ids_num;
         }
 
         for (l3cat_id = 0; l3cat_id < l3cat_id_num; l3cat_id++) {
                 const unsigned l3id = l3cat_ids[l3cat_id];
                 uint64_t counter;
 
-                ret = resctrl_mon_read_counter(class_id, resctrl_group, l3id,
-                                               event, &counter);
+                ret = resctrl_mon_read_counter_cached(group, class_id, l3id,
+                                                      event, &counter);
                 if (ret != PQOS_RETVAL_OK)
-                        goto resctrl_mon_read_exit;
+                        break;
 
                 *value += counter;
         }
 
-resctrl_mon_read_exit:
-        if (l3ids == NULL && l3cat_ids != NULL)
-                free(l3cat_ids);
+        free(l3cat_ids_alloc);
 
         return ret;
 }
@@ -518,20 +782,16 @@ resctrl_mon_file_empty(const char *path)
 /**
  * @brief Check if monitored group is junk (no cores/tasks assigned/low llc)
  *
+ * @param [in] group monitoring structure
  * @param [in] class_id COS id
- * @param [in] resctrl_group mon group name
- * @param [in] l3id  l3ids to read from
- * @param [in] l3id_num number of l3ids
  * @param [out] empty 1 when group is empty
  *
  * @return Operational status
  * @retval PQOS_RETVAL_OK on success
  */
 static int
-resctrl_mon_empty(const unsigned class_id,
-                  const char *resctrl_group,
-                  unsigned *l3id,
-                  unsigned l3id_num,
+resctrl_mon_empty(struct pqos_mon_data *group,
+                  const unsigned class_id,
                   int *empty)
 {
         int ret;
@@ -539,6 +799,7 @@ resctrl_mon_empty(const unsigned class_id,
         char path[128];
         unsigned max_threshold_occupancy;
         uint64_t value;
+        const char *resctrl_group = group->intl->resctrl.mon_group;
 
         ASSERT(resctrl_group != NULL);
         ASSERT(empty != NULL);
@@ -577,7 +838,7 @@ resctrl_mon_empty(const unsigned class_id,
         if (!resctrl_mon_is_event_supported(PQOS_MON_EVENT_L3_OCCUP))
                 return PQOS_RETVAL_OK;
 
-        ret = resctrl_mon_read_counters(class_id, resctrl_group, l3id, l3id_num,
+        ret = resctrl_mon_read_counters(group, class_id,
                                         PQOS_MON_EVENT_L3_OCCUP, &value);
         if (ret != PQOS_RETVAL_OK)
                 return ret;
@@ -883,6 +1144,180 @@ resctrl_mon_assoc_set_pid(const pid_t task, const char *name)
         return PQOS_RETVAL_OK;
 }
 
+int
+resctrl_mon_assoc_get_pids(const pid_t *tasks,
+                           const unsigned num_tasks,
+                           char **names)
+{
+        int ret;
+        unsigned max_cos;
+        unsigned cos;
+        unsigned i;
+        struct tid_hash index;
+
+        ASSERT(tasks != NULL);
+        ASSERT(names != NULL);
+
+        if (!resctrl_mon_is_supported())
+                return PQOS_RETVAL_RESOURCE;
+
+        ret = resctrl_alloc_get_grps_num(_pqos_get_cap(), &max_cos);
+        if (ret != PQOS_RETVAL_OK)
+                return ret;
+
+        /* Map task id to its position in tasks table */
+        tid_hash_init(&index);
+        ret = tid_hash_reserve(&index, num_tasks);
+        for (i = 0; ret == PQOS_RETVAL_OK && i < num_tasks; i++)
+                if (tasks[i] > 0 && !tid_hash_get(&index, tasks[i], NULL))
+                        ret = tid_hash_put(&index, tasks[i], i);
+        if (ret != PQOS_RETVAL_OK)
+                goto resctrl_mon_assoc_get_pids_exit;
+
+        /* Read each monitoring group tasks file once */
+        for (cos = 0; cos < max_cos; cos++) {
+                struct dirent **namelist = NULL;
+                char dir[256];
+                int num_groups;
+                int j;
+
+                resctrl_mon_group_path(cos, "", NULL, dir, sizeof(dir));
+                num_groups = scandir(dir, &namelist, filter, NULL);
+                if (num_groups < 0) {
+                        LOG_ERROR(
+                            "Failed to read monitoring groups for COS %u\n",
+                            cos);
+                        ret = PQOS_RETVAL_ERROR;
+                        goto resctrl_mon_assoc_get_pids_exit;
+                }
+
+                for (j = 0; ret == PQOS_RETVAL_OK && j < num_groups; j++) {
+                        char path[256];
+                        char buf[128];
+                        FILE *fd;
+                        const char *d_name = namelist[j]->d_name;
+
+                        resctrl_mon_group_path(cos, d_name, "/tasks", path,
+                                               sizeof(path));
+
+                        fd = pqos_fopen(path, "r");
+                        if (fd == NULL) {
+                                ret = PQOS_RETVAL_ERROR;
+                                break;
+                        }
+
+                        while (fgets(buf, sizeof(buf), fd) != NULL) {
+                                char *endptr = NULL;
+                                pid_t value = strtol(buf, &endptr, 10);
+                                unsigned idx;
+
+                                if (!(*buf != '\0' &&
+                                      (*endptr == '\0' || *endptr == '\n'))) {
+                                        ret = PQOS_RETVAL_ERROR;
+                                        break;
+                                }
+
+                                if (!tid_hash_get(&index, value, &idx) ||
+                                    names[idx] != NULL)
+                                        continue;
+
+                                names[idx] = strdup(d_name);
+                                if (names[idx] == NULL) {
+                                        ret = PQOS_RETVAL_RESOURCE;
+                                        break;
+                                }
+                        }
+
+                        fclose(fd);
+                }
+
+                free_scandir(namelist, num_groups);
+                if (ret != PQOS_RETVAL_OK)
+                        break;
+        }
+
+resctrl_mon_assoc_get_pids_exit:
+        tid_hash_fini(&index);
+
+        return ret;
+}
+
+int
+resctrl_mon_assoc_set_pids(const unsigned class_id,
+                           const pid_t *tasks,
+                           const unsigned num_tasks,
+                           char *const *names,
+                           const int *status)
+{
+        int ret = PQOS_RETVAL_OK;
+        unsigned i;
+        char *done;
+
+        ASSERT(tasks != NULL);
+        ASSERT(names != NULL);
+
+        if (!resctrl_mon_is_supported())
+                return PQOS_RETVAL_RESOURCE;
+
+        done = calloc(num_tasks, sizeof(done[0]));
+        if (done == NULL)
+                return PQOS_RETVAL_RESOURCE;
+
+        for (i = 0; i < num_tasks; i++) {
+                char path[256];
+                FILE *fd;
+                unsigned j;
+
+                if (done[i] || names[i] == NULL)
+                        continue;
+
+                if (resctrl_mon_mkdir(class_id, names[i]) != PQOS_RETVAL_OK) {
+                        LOG_ERROR(
+                            "Failed to create resctrl monitoring group!\n");
+                        ret = PQOS_RETVAL_ERROR;
+                        continue;
+                }
+
+                resctrl_mon_group_path(class_id, names[i], "/tasks", path,
+                                       sizeof(path));
+                fd = pqos_fopen(path, "w");
+                if (fd == NULL) {
+                        ret = PQOS_RETVAL_ERROR;
+                        continue;
+                }
+
+                /* All tasks of the group, kernel accepts one task per write */
+                for (j = i; j < num_tasks; j++) {
+                        char buf[16];
+                        int len;
+
+                        if (done[j] || names[j] == NULL ||
+                            strcmp(names[i], names[j]) != 0)
+                                continue;
+                        done[j] = 1;
+
+                        /* task was not moved to the new class */
+                        if (status != NULL && status[j] != PQOS_RETVAL_OK)
+                                continue;
+
+                        len = snprintf(buf, sizeof(buf), "%d\n", (int)tasks[j]);
+                        if (write(fileno(fd), buf, (size_t)len) != len) {
+                                LOG_ERROR("Could not assign TID %d to resctrl "
+                                          "monitoring group\n",
+                                          (int)tasks[j]);
+                                ret = PQOS_RETVAL_ERROR;
+                        }
+                }
+
+                if (pqos_fclose(fd) != 0)
+                        ret = PQOS_RETVAL_ERROR;
+        }
+
+        free(done);
+
+        return ret;
+}
+
 #define RESCTRL_CORE_MAX_L3ID 63
 struct resctrl_core_group {
         char name[32];
@@ -1213,6 +1648,7 @@ resctrl_mon_start(struct pqos_mon_data *group)
         /**
          * Add pids to the resctrl group
          */
+        resctrl_alloc_task_index_invalidate();
         for (i = 0; i < group->tid_nr; i++) {
                 ret =
                     resctrl_mon_assoc_set_pid(group->tid_map[i], resctrl_group);
@@ -1360,6 +1796,8 @@ resctrl_mon_stop(struct pqos_mon_data *group)
 
         ASSERT(group != NULL);
 
+        resctrl_mon_counter_invalidate(group, 0, 1);
+
         ret = resctrl_alloc_get_grps_num(cap, &max_cos);
         if (ret != PQOS_RETVAL_OK)
                 return ret;
@@ -1367,6 +1805,7 @@ resctrl_mon_stop(struct pqos_mon_data *group)
         /*
          * Add pids back to the default group
          */
+        resctrl_alloc_task_index_invalidate();
         if (group->num_pids > 0)
                 for (i = 0; i < group->tid_nr; i++) {
                         const pid_t tid = group->tid_map[i];
@@ -1501,9 +1940,7 @@ resctrl_mon_purge(struct pqos_mon_data *group)
                 if (!pqos_dir_exists(buf))
                         continue;
 
-                ret = resctrl_mon_empty(cos, group->intl->resctrl.mon_group,
-                                        group->intl->resctrl.l3id,
-                                        group->intl->resctrl.num_l3id, &empty);
+                ret = resctrl_mon_empty(group, cos, &empty);
                 if (ret != PQOS_RETVAL_OK)
                         return ret;
 
@@ -1513,26 +1950,22 @@ resctrl_mon_purge(struct pqos_mon_data *group)
                 /* store counter values */
                 if (resctrl_mon_is_event_supported(PQOS_MON_EVENT_LMEM_BW)) {
                         ret = resctrl_mon_read_counters(
-                            cos, group->intl->resctrl.mon_group,
-                            group->intl->resctrl.l3id,
-                            group->intl->resctrl.num_l3id,
-                            PQOS_MON_EVENT_LMEM_BW, &value);
+                            group, cos, PQOS_MON_EVENT_LMEM_BW, &value);
                         if (ret != PQOS_RETVAL_OK)
                                 return ret;
                         group->intl->resctrl.values_storage.mbm_local += value;
                 }
                 if (resctrl_mon_is_event_supported(PQOS_MON_EVENT_TMEM_BW)) {
                         ret = resctrl_mon_read_counters(
-                            cos, group->intl->resctrl.mon_group,
-                            group->intl->resctrl.l3id,
-                            group->intl->resctrl.num_l3id,
-                            PQOS_MON_EVENT_TMEM_BW, &value);
+                            group, cos, PQOS_MON_EVENT_TMEM_BW, &value);
                         if (ret != PQOS_RETVAL_OK)
                                 return ret;
 
                         group->intl->resctrl.values_storage.mbm_total += value;
                 }
 
+                resctrl_mon_counter_invalidate(group, cos, 0);
+
                 ret = resctrl_mon_rmdir(cos, name);
                 if (ret != PQOS_RETVAL_OK) {
                         LOG_WARN("Failed to remove empty mon group %s: %m\n",
@@ -1597,10 +2030,7 @@ resctrl_mon_poll(struct pqos_mon_data *group, const enum pqos_mon_event event)
                 if (!pqos_dir_exists(buf))
                         continue;
 
-                ret = resctrl_mon_read_counters(
-                    cos, group->intl->resctrl.mon_group,
-                    group->intl->resctrl.l3id, group->intl->resctrl.num_l3id,
-                    event, &val);
+                ret = resctrl_mon_read_counters(group, cos, event, &val);
                 if (ret != PQOS_RETVAL_OK)
                         goto resctrl_mon_poll_exit;
 
@@ -45,6 +45,7 @@ extern "C" {
 #include "pqos.h"
 #include "resctrl.h"
 #include "types.h"
+#include "uring.h"
 
 /**
  * @brief Initializes resctrl structures used for OS monitoring interface
@@ -100,6 +101,22 @@ PQOS_LOCAL int resctrl_mon_stop(struct pqos_mon_data *group);
 PQOS_LOCAL int resctrl_mon_poll(struct pqos_mon_data *group,
                                 const enum pqos_mon_event event);
 
+/**
+ * @brief Lists counter reads of monitoring groups for batched prefetch
+ *
+ * Only counter files already cached by previous polls are listed.
+ * Prefetched value is used by the next resctrl_mon_poll of the group.
+ *
+ * @param [in] groups table of monitoring groups
+ * @param [in] num_groups number of monitoring groups
+ * @param [out] reads table to store read requests in or NULL
+ *
+ * @return Number of read requests
+ */
+PQOS_LOCAL unsigned resctrl_mon_prefetch(struct pqos_mon_data **groups,
+                                         const unsigned num_groups,
+                                         struct uring_read **reads);
+
 /**
  * @brief Reset of resctrl monitoring
  *
@@ -179,6 +196,47 @@ PQOS_LOCAL int resctrl_mon_assoc_get_pid(const pid_t task,
  */
 PQOS_LOCAL int resctrl_mon_assoc_set_pid(const pid_t task, const char *name);
 
+/**
+ * @brief Read association of \a tasks with monitoring groups
+ *
+ * Tasks file of each monitoring group is read once.
+ *
+ * @param [in] tasks table of task ids
+ * @param [in] num_tasks number of tasks in the table
+ * @param [in,out] names table of \a num_tasks monitoring group names,
+ *                 NULL entries are set for tasks assigned to a monitoring
+ *                 group and have to be freed by the caller
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_RESOURCE when monitoring is not supported
+ * @retval PQOS_RETVAL_OK on success
+ */
+PQOS_LOCAL int resctrl_mon_assoc_get_pids(const pid_t *tasks,
+                                          const unsigned num_tasks,
+                                          char **names);
+
+/**
+ * @brief Set association of \a tasks to monitoring groups of \a class_id
+ *
+ * Tasks file of each monitoring group is opened once.
+ *
+ * @param [in] class_id COS the tasks are assigned to
+ * @param [in] tasks table of task ids
+ * @param [in] num_tasks number of tasks in the table
+ * @param [in] names monitoring group name of each task, tasks with NULL
+ *             name are skipped
+ * @param [in] status per task status of COS assignment, tasks that were not
+ *             assigned are skipped, can be NULL
+ *
+ * @return Operations status
+ * @retval PQOS_RETVAL_OK on success
+ */
+PQOS_LOCAL int resctrl_mon_assoc_set_pids(const unsigned class_id,
+                                          const pid_t *tasks,
+                                          const unsigned num_tasks,
+                                          char *const *names,
+                                          const int *status);
+
 /**
  * @brief Check if resctrl monitoring is active
  *
@@ -0,0 +1,704 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2022 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @brief Snapshot of capabilities and CPU topology
+ *
+ * File layout, in host byte order:
+ * - struct snapshot_header
+ * - struct pqos_cpuinfo, header.cpu_size bytes
+ * - header.num_cap times struct snapshot_cap followed by the capability
+ *
+ * The file is replaced atomically with rename(), so it is either the old
+ * or the new snapshot. It is not synced to disk, a snapshot that did not
+ * survive a crash is stale after reboot anyway.
+ */
+
+#include "snapshot.h"
+
+#include "common.h"
+#include "hw_cap.h"
+#include "log.h"
+#include "os_common.h"
+#include "resctrl.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+
+/**
+ * ---------------------------------------
+ * Local macros
+ * ---------------------------------------
+ */
+
+#define SNAPSHOT_ENV       "RDT_SNAPSHOT"
+#define SNAPSHOT_MAGIC     0x534f5150 /**< "PQOS" */
+#define SNAPSHOT_VERSION   1
+#define SNAPSHOT_STR_LEN   256
+#define SNAPSHOT_BOOT_ID   "/proc/sys/kernel/random/boot_id"
+#define SNAPSHOT_MICROCODE "/sys/devices/system/cpu/cpu0/microcode/version"
+#define SNAPSHOT_ONLINE    "/sys/devices/system/cpu/online"
+
+/**
+ * ---------------------------------------
+ * Local data types
+ * ---------------------------------------
+ */
+
+/**
+ * System the snapshot was taken on
+ */
+struct snapshot_key {
+        char boot_id[64];              /**< boot id */
+        char kernel[SNAPSHOT_STR_LEN]; /**< kernel release and version */
+        char microcode[64];            /**< microcode revision of CPU 0 */
+        char online[SNAPSHOT_STR_LEN]; /**< online CPUs */
+        uint32_t lib_version;          /**< PQOS_VERSION */
+};
+
+/**
+ * Snapshot file header
+ */
+struct snapshot_header {
+        uint32_t magic;           /**< SNAPSHOT_MAGIC */
+        uint32_t version;         /**< file format version */
+        uint64_t size;            /**< file size */
+        uint64_t checksum;        /**< FNV-1a hash of data after the header */
+        struct snapshot_key key;  /**< system the snapshot was taken on */
+        uint32_t interface;       /**< interface used for discovery */
+        char resctrl[SNAPSHOT_STR_LEN]; /**< resctrl mount options */
+        uint32_t cpu_size;        /**< size of CPU topology */
+        uint32_t num_cap;         /**< number of capabilities */
+};
+
+/**
+ * Capability entry header, followed by the capability structure
+ */
+struct snapshot_cap {
+        uint32_t type; /**< capability type */
+        uint32_t size; /**< capability structure size */
+};
+
+/**
+ * ---------------------------------------
+ * Local data structures
+ * ---------------------------------------
+ */
+
+/**
+ * Mapped snapshot file, NULL if not mapped
+ */
+static uint8_t *m_map = NULL;
+static size_t m_map_size = 0;
+
+/**
+ * @brief Retrieves snapshot file path
+ *
+ * @return Path set by RDT_SNAPSHOT environment variable
+ * @retval NULL snapshot not configured
+ */
+static const char *
+snapshot_path(void)
+{
+        const char *path = getenv(SNAPSHOT_ENV);
+
+        if (path == NULL || path[0] == '\0')
+                return NULL;
+
+        return path;
+}
+
+/**
+ * @brief Reads first line of a file
+ *
+ * @param [in] fname file name
+ * @param [out] buf place to store the line without newline
+ * @param [in] len size of \a buf
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_ERROR file not readable or line too long
+ */
+static int
+snapshot_read_line(const char *fname, char *buf, const size_t len)
+{
+        FILE *fd;
+        char *p;
+
+        /* procfs files may be symlinks */
+        if (strncmp(fname, "/proc/", 6) == 0)
+                fd = fopen(fname, "r");
+        else
+                fd = pqos_fopen(fname, "r");
+        if (fd == NULL)
+                return PQOS_RETVAL_ERROR;
+
+        p = fgets(buf, len, fd);
+        fclose(fd);
+        if (p == NULL)
+                return PQOS_RETVAL_ERROR;
+
+        p = strchr(buf, '\n');
+        if (p == NULL && strlen(buf) == len - 1)
+                return PQOS_RETVAL_ERROR;
+        if (p != NULL)
+                *p = '\0';
+
+        return PQOS_RETVAL_OK;
+}
+
+/**
+ * @brief Identifies the running system
+ *
+ * @param [out] key place to store system identification
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+snapshot_get_key(struct snapshot_key *key)
+{
+        struct utsname name;
+        int ret;
+
+        memset(key, 0, sizeof(*key));
+        key->lib_version = PQOS_VERSION;
+
+        ret = snapshot_read_line(SNAPSHOT_BOOT_ID, key->boot_id,
+                                 sizeof(key->boot_id));
+        if (ret != PQOS_RETVAL_OK)
+                return ret;
+
+        ret = snapshot_read_line(SNAPSHOT_ONLINE, key->online,
+                                 sizeof(key->online));
+        if (ret != PQOS_RETVAL_OK)
+                return ret;
+
+        /* not exported by some hypervisors, boot id still covers updates */
+        if (snapshot_read_line(SNAPSHOT_MICROCODE, key->microcode,
+                               sizeof(key->microcode)) != PQOS_RETVAL_OK)
+                memset(key->microcode, 0, sizeof(key->microcode));
+
+        if (uname(&name) != 0)
+                return PQOS_RETVAL_ERROR;
+        if (snprintf(key->kernel, sizeof(key->kernel), "%s %s", name.release,
+                     name.version) >= (int)sizeof(key->kernel))
+                return PQOS_RETVAL_ERROR;
+
+        return PQOS_RETVAL_OK;
+}
+
+/**
+ * @brief Retrieves resctrl mount options
+ *
+ * @param [out] opts place to store options, empty if resctrl is not mounted
+ * @param [in] len size of \a opts
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+snapshot_get_resctrl(char *opts, const size_t len)
+{
+        FILE *fd;
+        char *line = NULL;
+        size_t line_len = 0;
+        int ret = PQOS_RETVAL_OK;
+
+        memset(opts, 0, len);
+
+        fd = fopen(PROC_MOUNTS, "r");
+        if (fd == NULL)
+                return PQOS_RETVAL_ERROR;
+
+        while (getline(&line, &line_len, fd) != -1) {
+                char *saveptr = NULL;
+                char *dir, *type, *options;
+
+                if (strtok_r(line, " \n", &saveptr) == NULL)
+                        continue;
+                dir = strtok_r(NULL, " \n", &saveptr);
+                type = strtok_r(NULL, " \n", &saveptr);
+                options = strtok_r(NULL, " \n", &saveptr);
+                if (dir == NULL || type == NULL || options == NULL ||
+                    strcmp(type, "resctrl") != 0 ||
+                    strcmp(dir, RESCTRL_PATH) != 0)
+                        continue;
+
+                if (strlen(options) >= len)
+                        ret = PQOS_RETVAL_ERROR;
+                else
+                        strcpy(opts, options);
+                break;
+        }
+
+        free(line);
+        fclose(fd);
+
+        return ret;
+}
+
+/**
+ * @brief Calculates FNV-1a hash
+ *
+ * @param [in] data data to hash
+ * @param [in] size size of \a data
+ *
+ * @return Hash value
+ */
+static uint64_t
+snapshot_checksum(const uint8_t *data, const size_t size)
+{
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        size_t i;
+
+        for (i = 0; i < size; i++) {
+                hash ^= data[i];
+                hash *= 0x100000001b3ULL;
+        }
+
+        return hash;
+}
+
+/**
+ * @brief Validates capability structure stored in the snapshot
+ *
+ * @param [in] entry capability entry header
+ * @param [in] data capability structure, \a entry->size bytes
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK structure is consistent
+ * @retval PQOS_RETVAL_ERROR structure is malformed
+ */
+static int
+snapshot_check_cap(const struct snapshot_cap *entry, const uint8_t *data)
+{
+        unsigned mem_size;
+        struct pqos_cap_mon mon;
+
+        /* every capability structure starts with its size */
+        if (entry->size < sizeof(mem_size))
+                return PQOS_RETVAL_ERROR;
+        memcpy(&mem_size, data, sizeof(mem_size));
+        if (mem_size != entry->size)
+                return PQOS_RETVAL_ERROR;
+
+        switch (entry->type) {
+        case PQOS_CAP_TYPE_MON:
+                if (entry->size < sizeof(mon))
+                        return PQOS_RETVAL_ERROR;
+                memcpy(&mon, data, sizeof(mon));
+                if (mon.num_events >
+                    (entry->size - sizeof(mon)) / sizeof(mon.events[0]))
+                        return PQOS_RETVAL_ERROR;
+                return PQOS_RETVAL_OK;
+        case PQOS_CAP_TYPE_L3CA:
+                return entry->size == sizeof(struct pqos_cap_l3ca)
+                           ? PQOS_RETVAL_OK
+                           : PQOS_RETVAL_ERROR;
+        case PQOS_CAP_TYPE_L2CA:
+                return entry->size == sizeof(struct pqos_cap_l2ca)
+                           ? PQOS_RETVAL_OK
+                           : PQOS_RETVAL_ERROR;
+        case PQOS_CAP_TYPE_MBA:
+                return entry->size == sizeof(struct pqos_cap_mba)
+                           ? PQOS_RETVAL_OK
+                           : PQOS_RETVAL_ERROR;
+        default:
+                return PQOS_RETVAL_ERROR;
+        }
+}
+
+/**
+ * @brief Checks CDP state of the snapshot against the hardware
+ *
+ * @param [in] cap capabilities from the snapshot
+ * @param [in] cpu CPU topology
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK CDP state matches
+ * @retval PQOS_RETVAL_RESOURCE CDP state changed
+ */
+static int
+snapshot_check_cdp(const struct pqos_cap *cap, const struct pqos_cpuinfo *cpu)
+{
+        unsigned i;
+
+        for (i = 0; i < cap->num_cap; i++) {
+                const struct pqos_capability *c = &cap->capabilities[i];
+                int enabled = 0;
+                int ret;
+
+                if (c->type == PQOS_CAP_TYPE_L3CA && c->u.l3ca->cdp) {
+                        ret = hw_cap_l3ca_cdp(cpu, &enabled);
+                        if (ret != PQOS_RETVAL_OK ||
+                            enabled != c->u.l3ca->cdp_on)
+                                return PQOS_RETVAL_RESOURCE;
+                }
+                if (c->type == PQOS_CAP_TYPE_L2CA && c->u.l2ca->cdp) {
+                        ret = hw_cap_l2ca_cdp(cpu, &enabled);
+                        if (ret != PQOS_RETVAL_OK ||
+                            enabled != c->u.l2ca->cdp_on)
+                                return PQOS_RETVAL_RESOURCE;
+                }
+        }
+
+        return PQOS_RETVAL_OK;
+}
+
+/**
+ * @brief Frees capabilities structure
+ *
+ * @param [in] cap capabilities
+ */
+static void
+snapshot_free_cap(struct pqos_cap *cap)
+{
+        unsigned i;
+
+        if (cap == NULL)
+                return;
+
+        for (i = 0; i < cap->num_cap; i++)
+                free(cap->capabilities[i].u.generic_ptr);
+        free(cap);
+}
+
+int
+snapshot_init(void)
+{
+        const char *path = snapshot_path();
+        struct snapshot_header hdr;
+        struct snapshot_key key;
+        struct stat st;
+        void *addr;
+        int fd;
+
+        if (path == NULL)
+                return PQOS_RETVAL_RESOURCE;
+        if (m_map != NULL)
+                return PQOS_RETVAL_OK;
+
+        fd = pqos_open(path, O_RDONLY);
+        if (fd < 0) {
+                LOG_INFO("Snapshot %s not available\n", path);
+                return PQOS_RETVAL_RESOURCE;
+        }
+
+        /* snapshot is trusted as much as its owner */
+        if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) ||
+            (st.st_uid != 0 && st.st_uid != geteuid()) ||
+            (st.st_mode & (S_IWGRP | S_IWOTH))) {
+                LOG_WARN("Snapshot %s ignored, it must be a regular file "
+                         "writable only by its owner\n",
+                         path);
+                close(fd);
+                return PQOS_RETVAL_RESOURCE;
+        }
+        if ((size_t)st.st_size < sizeof(hdr)) {
+                LOG_INFO("Snapshot %s is invalid\n", path);
+                close(fd);
+                return PQOS_RETVAL_RESOURCE;
+        }
+
+        addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (addr == MAP_FAILED)
+                return PQOS_RETVAL_RESOURCE;
+
+        m_map = (uint8_t *)addr;
+        m_map_size = st.st_size;
+
+        memcpy(&hdr, m_map, sizeof(hdr));
+        if (hdr.magic != SNAPSHOT_MAGIC || hdr.version != SNAPSHOT_VERSION ||
+            hdr.size != m_map_size ||
+            hdr.checksum != snapshot_checksum(m_map + sizeof(hdr),
+                                              m_map_size - sizeof(hdr))) {
+                LOG_INFO("Snapshot %s is invalid\n", path);
+                goto snapshot_init_error;
+        }
+
+        if (snapshot_get_key(&key) != PQOS_RETVAL_OK ||
+            memcmp(&key, &hdr.key, sizeof(key)) != 0) {
+                LOG_INFO("Snapshot %s is stale\n", path);
+                goto snapshot_init_error;
+        }
+
+        LOG_INFO("Using snapshot %s\n", path);
+        return PQOS_RETVAL_OK;
+
+snapshot_init_error:
+        snapshot_fini();
+        return PQOS_RETVAL_RESOURCE;
+}
+
+void
+snapshot_fini(void)
+{
+        if (m_map == NULL)
+                return;
+
+        munmap(m_map, m_map_size);
+        m_map = NULL;
+        m_map_size = 0;
+}
+
+int
+snapshot_get_cpu(struct pqos_cpuinfo **cpu)
+{
+        struct snapshot_header hdr;
+        struct pqos_cpuinfo info;
+        struct pqos_cpuinfo *c;
+
+        ASSERT(cpu != NULL);
+
+        if (m_map == NULL)
+                return PQOS_RETVAL_RESOURCE;
+
+        memcpy(&hdr, m_map, sizeof(hdr));
+        if (hdr.cpu_size < sizeof(info) ||
+            hdr.cpu_size > m_map_size - sizeof(hdr))
+                return PQOS_RETVAL_RESOURCE;
+
+        memcpy(&info, m_map + sizeof(hdr), sizeof(info));
+        if (info.mem_size != hdr.cpu_size || info.num_cores == 0 ||
+            hdr.cpu_size - sizeof(info) !=
+                info.num_cores * sizeof(info.cores[0]))
+                return PQOS_RETVAL_RESOURCE;
+
+        c = malloc(hdr.cpu_size);
+        if (c == NULL)
+                return PQOS_RETVAL_RESOURCE;
+
+        memcpy(c, m_map + sizeof(hdr), hdr.cpu_size);
+        *cpu = c;
+
+        return PQOS_RETVAL_OK;
+}
+
+int
+snapshot_get_cap(const enum pqos_interface inter,
+                 const struct pqos_cpuinfo *cpu,
+                 struct pqos_cap **cap)
+{
+        struct snapshot_header hdr;
+        struct pqos_cap *c = NULL;
+        unsigned seen = 0;
+        size_t offset;
+        size_t sz;
+        unsigned i;
+
+        ASSERT(cpu != NULL);
+        ASSERT(cap != NULL);
+
+        if (m_map == NULL)
+                return PQOS_RETVAL_RESOURCE;
+
+        memcpy(&hdr, m_map, sizeof(hdr));
+        if (hdr.interface != (uint32_t)inter) {
+                LOG_INFO("Snapshot taken with other interface\n");
+                return PQOS_RETVAL_RESOURCE;
+        }
+
+        /* capabilities were discovered on this topology */
+        if (hdr.cpu_size != cpu->mem_size ||
+            hdr.cpu_size > m_map_size - sizeof(hdr) ||
+            memcmp(m_map + sizeof(hdr), cpu, cpu->mem_size) != 0)
+                return PQOS_RETVAL_RESOURCE;
+
+        if (hdr.num_cap == 0 || hdr.num_cap > PQOS_CAP_TYPE_NUMOF)
+                return PQOS_RETVAL_RESOURCE;
+
+        if (inter == PQOS_INTER_OS || inter == PQOS_INTER_OS_RESCTRL_MON) {
+                char resctrl[SNAPSHOT_STR_LEN];
+
+                if (snapshot_get_resctrl(resctrl, sizeof(resctrl)) !=
+                        PQOS_RETVAL_OK ||
+                    memcmp(resctrl, hdr.resctrl, sizeof(resctrl)) != 0) {
+                        LOG_INFO("resctrl remounted since snapshot\n");
+                        return PQOS_RETVAL_RESOURCE;
+                }
+        }
+
+        sz = sizeof(*c) + hdr.num_cap * sizeof(c->capabilities[0]);
+        c = calloc(1, sz);
+        if (c == NULL)
+                return PQOS_RETVAL_RESOURCE;
+        c->mem_size = sz;
+        c->version = PQOS_VERSION;
+
+        offset = sizeof(hdr) + hdr.cpu_size;
+        for (i = 0; i < hdr.num_cap; i++) {
+                struct snapshot_cap entry;
+                void *ptr;
+
+                if (m_map_size - offset < sizeof(entry))
+                        goto snapshot_get_cap_error;
+                memcpy(&entry, m_map + offset, sizeof(entry));
+                offset += sizeof(entry);
+
+                if (entry.size > m_map_size - offset ||
+                    snapshot_check_cap(&entry, m_map + offset) !=
+                        PQOS_RETVAL_OK ||
+                    (seen & (1 << entry.type)))
+                        goto snapshot_get_cap_error;
+                seen |= 1 << entry.type;
+
+                ptr = malloc(entry.size);
+                if (ptr == NULL)
+                        goto snapshot_get_cap_error;
+                memcpy(ptr, m_map + offset, entry.size);
+                offset += entry.size;
+
+                c->capabilities[i].type = (enum pqos_cap_type)entry.type;
+                c->capabilities[i].u.generic_ptr = ptr;
+                c->num_cap++;
+        }
+        if (offset != m_map_size)
+                goto snapshot_get_cap_error;
+
+        if (inter == PQOS_INTER_MSR &&
+            snapshot_check_cdp(c, cpu) != PQOS_RETVAL_OK) {
+                LOG_INFO("CDP reconfigured since snapshot\n");
+                snapshot_free_cap(c);
+                return PQOS_RETVAL_RESOURCE;
+        }
+
+        *cap = c;
+        return PQOS_RETVAL_OK;
+
+snapshot_get_cap_error:
+        LOG_INFO("Snapshot capabilities are invalid\n");
+        snapshot_free_cap(c);
+        return PQOS_RETVAL_RESOURCE;
+}
+
+int
+snapshot_save(const enum pqos_interface inter,
+              const struct pqos_cap *cap,
+              const struct pqos_cpuinfo *cpu)
+{
+        const char *path = snapshot_path();
+        struct snapshot_header hdr;
+        char tmp[PATH_MAX];
+        uint8_t *buf = NULL;
+        size_t size, offset, done;
+        unsigned i;
+        int fd = -1;
+        int ret = PQOS_RETVAL_ERROR;
+
+        ASSERT(cap != NULL);
+        ASSERT(cpu != NULL);
+
+        if (path == NULL)
+                return PQOS_RETVAL_OK;
+
+        memset(&hdr, 0, sizeof(hdr));
+        hdr.magic = SNAPSHOT_MAGIC;
+        hdr.version = SNAPSHOT_VERSION;
+        hdr.interface = inter;
+        hdr.cpu_size = cpu->mem_size;
+        hdr.num_cap = cap->num_cap;
+
+        if (snapshot_get_key(&hdr.key) != PQOS_RETVAL_OK)
+                goto snapshot_save_exit;
+        if ((inter == PQOS_INTER_OS || inter == PQOS_INTER_OS_RESCTRL_MON) &&
+            snapshot_get_resctrl(hdr.resctrl, sizeof(hdr.resctrl)) !=
+                PQOS_RETVAL_OK)
+                goto snapshot_save_exit;
+
+        size = sizeof(hdr) + cpu->mem_size;
+        for (i = 0; i < cap->num_cap; i++)
+                size += sizeof(struct snapshot_cap) +
+                        *(const unsigned *)cap->capabilities[i].u.generic_ptr;
+
+        buf = calloc(1, size);
+        if (buf == NULL)
+                goto snapshot_save_exit;
+
+        offset = sizeof(hdr);
+        memcpy(buf + offset, cpu, cpu->mem_size);
+        offset += cpu->mem_size;
+        for (i = 0; i < cap->num_cap; i++) {
+                const void *ptr = cap->capabilities[i].u.generic_ptr;
+                struct snapshot_cap entry;
+
+                entry.type = cap->capabilities[i].type;
+                entry.size = *(const unsigned *)ptr;
+                memcpy(buf + offset, &entry, sizeof(entry));
+                offset += sizeof(entry);
+                memcpy(buf + offset, ptr, entry.size);
+                offset += entry.size;
+        }
+
+        hdr.size = size;
+        hdr.checksum = snapshot_checksum(buf + sizeof(hdr), size - sizeof(hdr));
+        memcpy(buf, &hdr, sizeof(hdr));
+
+        if (snprintf(tmp, sizeof(tmp), "%s.XXXXXX", path) >= (int)sizeof(tmp))
+                goto snapshot_save_exit;
+
+        fd = mkstemp(tmp);
+        if (fd < 0)
+                goto snapshot_save_exit;
+
+        for (done = 0; done < size;) {
+                ssize_t len = write(fd, buf + done, size - done);
+
+                if (len <= 0)
+                        break;
+                done += len;
+        }
+
+        if (close(fd) == 0 && done == size && rename(tmp, path) == 0)
+                ret = PQOS_RETVAL_OK;
+        else
+                unlink(tmp);
+
+snapshot_save_exit:
+        if (ret == PQOS_RETVAL_OK)
+                LOG_INFO("Snapshot saved to %s\n", path);
+        else
+                LOG_WARN("Unable to save snapshot to %s\n", path);
+
+        free(buf);
+
+        return ret;
+}
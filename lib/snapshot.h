@@ -0,0 +1,116 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2022 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @brief Snapshot of capabilities and CPU topology
+ *
+ * Discovery results are kept in a file selected by the RDT_SNAPSHOT
+ * environment variable. The snapshot is used only when it was taken on the
+ * same boot, kernel, microcode, set of online CPUs and library version.
+ * Capabilities are also bound to the interface and to CDP/resctrl state.
+ */
+
+#ifndef __PQOS_SNAPSHOT_H__
+#define __PQOS_SNAPSHOT_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "pqos.h"
+#include "types.h"
+
+/**
+ * @brief Maps snapshot file and validates it against the running system
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK snapshot is valid
+ * @retval PQOS_RETVAL_RESOURCE snapshot not configured, missing or stale
+ */
+PQOS_LOCAL int snapshot_init(void);
+
+/**
+ * @brief Unmaps snapshot file
+ */
+PQOS_LOCAL void snapshot_fini(void);
+
+/**
+ * @brief Retrieves CPU topology from the snapshot
+ *
+ * @param [out] cpu place to store topology, allocated by the function
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_RESOURCE snapshot not available
+ */
+PQOS_LOCAL int snapshot_get_cpu(struct pqos_cpuinfo **cpu);
+
+/**
+ * @brief Retrieves capabilities from the snapshot
+ *
+ * Requires machine module to be initialized, CDP state of MSR interface
+ * is read from the hardware.
+ *
+ * @param [in] inter selected interface
+ * @param [in] cpu CPU topology in use
+ * @param [out] cap place to store capabilities, allocated by the function
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_RESOURCE snapshot not available or stale
+ */
+PQOS_LOCAL int snapshot_get_cap(const enum pqos_interface inter,
+                                const struct pqos_cpuinfo *cpu,
+                                struct pqos_cap **cap);
+
+/**
+ * @brief Saves capabilities and CPU topology to the snapshot file
+ *
+ * Does nothing when RDT_SNAPSHOT is not set.
+ *
+ * @param [in] inter selected interface
+ * @param [in] cap discovered capabilities
+ * @param [in] cpu CPU topology
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+PQOS_LOCAL int snapshot_save(const enum pqos_interface inter,
+                             const struct pqos_cap *cap,
+                             const struct pqos_cpuinfo *cpu);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PQOS_SNAPSHOT_H__ */
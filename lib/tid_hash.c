@@ -0,0 +1,255 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2022 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+/**
+ * @brief TID hash table
+ *
+ * Linear probing with backward shift deletion, so lookups never have
+ * to skip deleted slots.
+ */
+
+#include "tid_hash.h"
+
+#include "pqos.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Initial number of slots
+ */
+#define TID_HASH_MIN_SIZE 16
+
+/**
+ * @brief Gets home slot of the task id
+ *
+ * @param [in] hash hash table
+ * @param [in] tid task id
+ *
+ * @return slot index
+ */
+static unsigned
+tid_hash_slot(const struct tid_hash *hash, const pid_t tid)
+{
+        /* multiplicative hashing spreads sequential TIDs */
+        uint32_t h = (uint32_t)tid * 2654435769U;
+
+        return (unsigned)(h ^ (h >> 16)) & (hash->size - 1);
+}
+
+void
+tid_hash_init(struct tid_hash *hash)
+{
+        ASSERT(hash != NULL);
+
+        memset(hash, 0, sizeof(*hash));
+}
+
+void
+tid_hash_fini(struct tid_hash *hash)
+{
+        ASSERT(hash != NULL);
+
+        free(hash->keys);
+        free(hash->values);
+        memset(hash, 0, sizeof(*hash));
+}
+
+void
+tid_hash_clear(struct tid_hash *hash)
+{
+        ASSERT(hash != NULL);
+
+        if (hash->keys != NULL)
+                memset(hash->keys, 0, sizeof(hash->keys[0]) * hash->size);
+        hash->num = 0;
+}
+
+/**
+ * @brief Resizes hash table
+ *
+ * @param [in,out] hash hash table
+ * @param [in] size new number of slots, power of 2
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+tid_hash_resize(struct tid_hash *hash, const unsigned size)
+{
+        struct tid_hash resized;
+        unsigned i;
+
+        resized.size = size;
+        resized.num = 0;
+        resized.keys = (pid_t *)calloc(size, sizeof(resized.keys[0]));
+        resized.values = (unsigned *)malloc(size * sizeof(resized.values[0]));
+        if (resized.keys == NULL || resized.values == NULL) {
+                free(resized.keys);
+                free(resized.values);
+                return PQOS_RETVAL_RESOURCE;
+        }
+
+        for (i = 0; i < hash->size; i++)
+                if (hash->keys[i] != 0)
+                        (void)tid_hash_put(&resized, hash->keys[i],
+                                           hash->values[i]);
+
+        free(hash->keys);
+        free(hash->values);
+        *hash = resized;
+
+        return PQOS_RETVAL_OK;
+}
+
+int
+tid_hash_reserve(struct tid_hash *hash, const unsigned num)
+{
+        unsigned size;
+
+        ASSERT(hash != NULL);
+
+        size = hash->size > 0 ? hash->size : TID_HASH_MIN_SIZE;
+        /* keep load factor below 3/4 */
+        while (num * 4 > size * 3)
+                size *= 2;
+
+        if (size == hash->size)
+                return PQOS_RETVAL_OK;
+
+        return tid_hash_resize(hash, size);
+}
+
+int
+tid_hash_put(struct tid_hash *hash, const pid_t tid, const unsigned value)
+{
+        unsigned slot;
+        int ret;
+
+        ASSERT(hash != NULL);
+        ASSERT(tid > 0);
+
+        ret = tid_hash_reserve(hash, hash->num + 1);
+        if (ret != PQOS_RETVAL_OK)
+                return ret;
+
+        for (slot = tid_hash_slot(hash, tid); hash->keys[slot] != 0;
+             slot = (slot + 1) & (hash->size - 1))
+                if (hash->keys[slot] == tid) {
+                        hash->values[slot] = value;
+                        return PQOS_RETVAL_OK;
+                }
+
+        hash->keys[slot] = tid;
+        hash->values[slot] = value;
+        hash->num++;
+
+        return PQOS_RETVAL_OK;
+}
+
+/**
+ * @brief Finds slot of the task id
+ *
+ * @param [in] hash hash table
+ * @param [in] tid task id
+ *
+ * @return slot index
+ * @retval -1 if not found
+ */
+static int
+tid_hash_find(const struct tid_hash *hash, const pid_t tid)
+{
+        unsigned slot;
+
+        if (hash->num == 0 || tid <= 0)
+                return -1;
+
+        for (slot = tid_hash_slot(hash, tid); hash->keys[slot] != 0;
+             slot = (slot + 1) & (hash->size - 1))
+                if (hash->keys[slot] == tid)
+                        return (int)slot;
+
+        return -1;
+}
+
+int
+tid_hash_get(const struct tid_hash *hash, const pid_t tid, unsigned *value)
+{
+        int slot;
+
+        ASSERT(hash != NULL);
+
+        slot = tid_hash_find(hash, tid);
+        if (slot < 0)
+                return 0;
+
+        if (value != NULL)
+                *value = hash->values[slot];
+
+        return 1;
+}
+
+int
+tid_hash_del(struct tid_hash *hash, const pid_t tid)
+{
+        unsigned hole, slot;
+        int found;
+
+        ASSERT(hash != NULL);
+
+        found = tid_hash_find(hash, tid);
+        if (found < 0)
+                return 0;
+
+        /* shift following entries of the cluster back into the hole */
+        hole = (unsigned)found;
+        for (slot = (hole + 1) & (hash->size - 1); hash->keys[slot] != 0;
+             slot = (slot + 1) & (hash->size - 1)) {
+                const unsigned home = tid_hash_slot(hash, hash->keys[slot]);
+
+                /* entry can't move before its home slot */
+                if (((slot - home) & (hash->size - 1)) <
+                    ((slot - hole) & (hash->size - 1)))
+                        continue;
+
+                hash->keys[hole] = hash->keys[slot];
+                hash->values[hole] = hash->values[slot];
+                hole = slot;
+        }
+        hash->keys[hole] = 0;
+        hash->num--;
+
+        return 1;
+}
@@ -0,0 +1,139 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2022 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+/**
+ * @brief Internal header file to TID hash table
+ *
+ * Open addressing hash table mapping task ids onto unsigned values,
+ * e.g. position of the task in the monitoring group TID map.
+ */
+
+#ifndef __PQOS_TID_HASH_H__
+#define __PQOS_TID_HASH_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "types.h"
+
+#include <sys/types.h>
+
+/**
+ * TID hash table
+ */
+struct tid_hash {
+        pid_t *keys;      /**< slot keys, 0 marks empty slot */
+        unsigned *values; /**< slot values */
+        unsigned size;    /**< number of slots, power of 2 */
+        unsigned num;     /**< number of stored entries */
+};
+
+/**
+ * @brief Initializes empty hash table
+ *
+ * @param [out] hash hash table
+ */
+PQOS_LOCAL void tid_hash_init(struct tid_hash *hash);
+
+/**
+ * @brief Releases hash table memory
+ *
+ * @param [in,out] hash hash table
+ */
+PQOS_LOCAL void tid_hash_fini(struct tid_hash *hash);
+
+/**
+ * @brief Removes all entries from hash table
+ *
+ * @param [in,out] hash hash table
+ */
+PQOS_LOCAL void tid_hash_clear(struct tid_hash *hash);
+
+/**
+ * @brief Makes room for entries
+ *
+ * Following insertions up to \a num entries in total do not allocate
+ * memory.
+ *
+ * @param [in,out] hash hash table
+ * @param [in] num number of entries
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_RESOURCE on memory allocation error
+ */
+PQOS_LOCAL int tid_hash_reserve(struct tid_hash *hash, const unsigned num);
+
+/**
+ * @brief Inserts or updates entry
+ *
+ * @param [in,out] hash hash table
+ * @param [in] tid task id, has to be positive
+ * @param [in] value value to store
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_RESOURCE on memory allocation error
+ */
+PQOS_LOCAL int
+tid_hash_put(struct tid_hash *hash, const pid_t tid, const unsigned value);
+
+/**
+ * @brief Looks up entry
+ *
+ * @param [in] hash hash table
+ * @param [in] tid task id
+ * @param [out] value stored value, can be NULL
+ *
+ * @return 1 if found, 0 otherwise
+ */
+PQOS_LOCAL int
+tid_hash_get(const struct tid_hash *hash, const pid_t tid, unsigned *value);
+
+/**
+ * @brief Removes entry
+ *
+ * @param [in,out] hash hash table
+ * @param [in] tid task id
+ *
+ * @return 1 if entry was removed, 0 if not found
+ */
+PQOS_LOCAL int tid_hash_del(struct tid_hash *hash, const pid_t tid);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PQOS_TID_HASH_H__ */
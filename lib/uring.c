@@ -0,0 +1,354 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2022 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @brief Batched file read engine
+ *
+ * io_uring is driven with raw system calls, so no additional library is
+ * required. Only one submission thread is supported.
+ */
+
+#include "uring.h"
+
+#include "pqos.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef PQOS_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+/**
+ * Number of submission queue entries
+ */
+#define URING_ENTRIES 256
+
+/**
+ * ---------------------------------------
+ * Local data types
+ * ---------------------------------------
+ */
+
+/**
+ * Submission queue ring
+ */
+struct uring_sq {
+        unsigned *head;            /**< consumer index */
+        unsigned *tail;            /**< producer index */
+        unsigned *ring_mask;       /**< index mask */
+        unsigned *array;           /**< sqe indexes */
+        struct io_uring_sqe *sqes; /**< submission queue entries */
+        size_t sqes_size;          /**< size of sqes mapping */
+};
+
+/**
+ * Completion queue ring
+ */
+struct uring_cq {
+        unsigned *head;            /**< consumer index */
+        unsigned *tail;            /**< producer index */
+        unsigned *ring_mask;       /**< index mask */
+        struct io_uring_cqe *cqes; /**< completion queue entries */
+};
+
+/**
+ * ---------------------------------------
+ * Local data structures
+ * ---------------------------------------
+ */
+static int m_ring_fd = -1;     /**< io_uring file descriptor */
+static unsigned m_entries = 0; /**< number of sq entries */
+static void *m_ring = NULL;    /**< sq & cq rings mapping */
+static size_t m_ring_size = 0; /**< size of rings mapping */
+static struct uring_sq m_sq;
+static struct uring_cq m_cq;
+static uint64_t m_seq = 0; /**< user_data of the next read */
+
+/**
+ * @brief Checks if kernel supports read operation
+ *
+ * @param [in] fd io_uring file descriptor
+ *
+ * @return 1 if read operation is supported, 0 otherwise
+ */
+static int
+uring_probe_read(const int fd)
+{
+        struct io_uring_probe *probe;
+        const size_t size =
+            sizeof(*probe) + IORING_OP_LAST * sizeof(probe->ops[0]);
+        int supported = 0;
+
+        probe = (struct io_uring_probe *)calloc(1, size);
+        if (probe == NULL)
+                return 0;
+
+        if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe,
+                    IORING_OP_LAST) == 0 &&
+            probe->last_op >= IORING_OP_READ)
+                supported = (probe->ops[IORING_OP_READ].flags &
+                             IO_URING_OP_SUPPORTED) != 0;
+
+        free(probe);
+
+        return supported;
+}
+
+int
+uring_init(void)
+{
+        struct io_uring_params p;
+        size_t sq_size;
+        size_t cq_size;
+        char *ring;
+        void *sqes;
+        int fd;
+
+        if (m_ring_fd >= 0)
+                return PQOS_RETVAL_OK;
+
+        memset(&p, 0, sizeof(p));
+        fd = (int)syscall(__NR_io_uring_setup, URING_ENTRIES, &p);
+        if (fd < 0)
+                return PQOS_RETVAL_RESOURCE;
+
+        /* sq and cq rings are mapped together */
+        if (!(p.features & IORING_FEAT_SINGLE_MMAP))
+                goto uring_init_error;
+
+        if (!uring_probe_read(fd))
+                goto uring_init_error;
+
+        sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cq_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+        m_ring_size = sq_size > cq_size ? sq_size : cq_size;
+
+        m_ring = mmap(NULL, m_ring_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (m_ring == MAP_FAILED) {
+                m_ring = NULL;
+                goto uring_init_error;
+        }
+
+        m_sq.sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+        sqes = mmap(NULL, m_sq.sqes_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) {
+                munmap(m_ring, m_ring_size);
+                m_ring = NULL;
+                goto uring_init_error;
+        }
+
+        ring = (char *)m_ring;
+        m_sq.head = (unsigned *)(ring + p.sq_off.head);
+        m_sq.tail = (unsigned *)(ring + p.sq_off.tail);
+        m_sq.ring_mask = (unsigned *)(ring + p.sq_off.ring_mask);
+        m_sq.array = (unsigned *)(ring + p.sq_off.array);
+        m_sq.sqes = (struct io_uring_sqe *)sqes;
+        m_cq.head = (unsigned *)(ring + p.cq_off.head);
+        m_cq.tail = (unsigned *)(ring + p.cq_off.tail);
+        m_cq.ring_mask = (unsigned *)(ring + p.cq_off.ring_mask);
+        m_cq.cqes = (struct io_uring_cqe *)(ring + p.cq_off.cqes);
+
+        m_entries = p.sq_entries;
+        m_ring_fd = fd;
+
+        return PQOS_RETVAL_OK;
+
+uring_init_error:
+        close(fd);
+
+        return PQOS_RETVAL_RESOURCE;
+}
+
+void
+uring_fini(void)
+{
+        if (m_ring_fd < 0)
+                return;
+
+        munmap(m_sq.sqes, m_sq.sqes_size);
+        munmap(m_ring, m_ring_size);
+        close(m_ring_fd);
+
+        m_ring = NULL;
+        m_ring_fd = -1;
+        m_entries = 0;
+}
+
+int
+uring_enabled(void)
+{
+        return m_ring_fd >= 0;
+}
+
+/**
+ * @brief Submits up to URING_ENTRIES reads and waits for completion
+ *
+ * Reads are tagged with increasing ids so completions left over from
+ * an earlier failed call are not credited to \a reads. On error, reads
+ * not consumed by the kernel are dropped and completion of the submitted
+ * ones is awaited, as the kernel writes into their buffers.
+ *
+ * @param [in,out] reads table of read requests
+ * @param [in] num number of read requests, not greater than sq size
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+uring_submit(struct uring_read **reads, const unsigned num)
+{
+        const uint64_t seq = m_seq;
+        const unsigned tail = *m_sq.tail;
+        const unsigned mask = *m_sq.ring_mask;
+        unsigned submitted = 0;
+        unsigned target = num;
+        unsigned done = 0;
+        int ret = PQOS_RETVAL_OK;
+        unsigned i;
+
+        m_seq += num;
+
+        for (i = 0; i < num; i++) {
+                const unsigned idx = (tail + i) & mask;
+                struct io_uring_sqe *sqe = &m_sq.sqes[idx];
+
+                memset(sqe, 0, sizeof(*sqe));
+                sqe->opcode = IORING_OP_READ;
+                sqe->fd = reads[i]->fd;
+                sqe->addr = (uint64_t)(uintptr_t)reads[i]->buf;
+                sqe->len = reads[i]->size;
+                sqe->off = reads[i]->offset;
+                sqe->user_data = seq + i;
+                m_sq.array[idx] = idx;
+        }
+        __atomic_store_n(m_sq.tail, tail + num, __ATOMIC_RELEASE);
+
+        while (done < target) {
+                unsigned head = *m_cq.head;
+                unsigned cq_tail;
+                int n;
+
+                n = (int)syscall(__NR_io_uring_enter, m_ring_fd,
+                                 target - submitted, target - done,
+                                 IORING_ENTER_GETEVENTS, NULL, 0);
+                if (n < 0 && errno != EINTR) {
+                        /* reads still in flight, stop using the ring */
+                        if (ret != PQOS_RETVAL_OK) {
+                                uring_fini();
+                                return ret;
+                        }
+                        ret = PQOS_RETVAL_ERROR;
+
+                        /* drop reads not consumed by the kernel */
+                        submitted =
+                            __atomic_load_n(m_sq.head, __ATOMIC_ACQUIRE) - tail;
+                        __atomic_store_n(m_sq.tail, tail + submitted,
+                                         __ATOMIC_RELEASE);
+                        target = submitted;
+                } else if (n > 0)
+                        submitted += n;
+
+                cq_tail = __atomic_load_n(m_cq.tail, __ATOMIC_ACQUIRE);
+                for (; head != cq_tail; head++) {
+                        const struct io_uring_cqe *cqe =
+                            &m_cq.cqes[head & *m_cq.ring_mask];
+                        const uint64_t id = cqe->user_data - seq;
+
+                        if (id < num) {
+                                reads[id]->res = cqe->res;
+                                done++;
+                        }
+                }
+                __atomic_store_n(m_cq.head, head, __ATOMIC_RELEASE);
+        }
+
+        return ret;
+}
+#else
+int
+uring_init(void)
+{
+        return PQOS_RETVAL_RESOURCE;
+}
+
+void
+uring_fini(void)
+{
+}
+
+int
+uring_enabled(void)
+{
+        return 0;
+}
+#endif /* PQOS_IO_URING */
+
+int
+uring_read(struct uring_read **reads, const unsigned num)
+{
+        unsigned i;
+
+        if (reads == NULL)
+                return PQOS_RETVAL_PARAM;
+
+#ifdef PQOS_IO_URING
+        if (m_ring_fd >= 0) {
+                for (i = 0; i < num; i += m_entries) {
+                        const unsigned n =
+                            num - i < m_entries ? num - i : m_entries;
+                        int ret = uring_submit(&reads[i], n);
+
+                        if (ret != PQOS_RETVAL_OK)
+                                return ret;
+                }
+
+                return PQOS_RETVAL_OK;
+        }
+#endif
+
+        for (i = 0; i < num; i++) {
+                struct uring_read *rd = reads[i];
+                ssize_t len =
+                    pread(rd->fd, rd->buf, rd->size, (off_t)rd->offset);
+
+                rd->res = len < 0 ? -errno : (int)len;
+        }
+
+        return PQOS_RETVAL_OK;
+}
@@ -0,0 +1,103 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2022 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @brief Internal header file to batched file read engine
+ *
+ * Reads are submitted to io_uring in a single batch when the library is
+ * built with io_uring support and the kernel provides it. Otherwise
+ * reads are issued one by one with pread().
+ */
+
+#ifndef __PQOS_URING_H__
+#define __PQOS_URING_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "types.h"
+
+#include <stdint.h>
+
+/**
+ * Single read request
+ */
+struct uring_read {
+        int fd;          /**< file descriptor */
+        void *buf;       /**< destination buffer */
+        unsigned size;   /**< buffer size */
+        uint64_t offset; /**< file offset */
+        int res;         /**< bytes read or negative errno */
+};
+
+/**
+ * @brief Sets up io_uring instance
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ * @retval PQOS_RETVAL_RESOURCE io_uring is not available
+ */
+PQOS_LOCAL int uring_init(void);
+
+/**
+ * @brief Releases io_uring instance
+ */
+PQOS_LOCAL void uring_fini(void);
+
+/**
+ * @brief Checks if io_uring instance is set up
+ *
+ * @return 1 if reads are submitted with io_uring, 0 otherwise
+ */
+PQOS_LOCAL int uring_enabled(void);
+
+/**
+ * @brief Reads files in a single batch
+ *
+ * Result of each read is stored in its \a res field. Function is not
+ * thread safe.
+ *
+ * @param [in,out] reads table of pointers to read requests
+ * @param [in] num number of read requests
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK when all requests were processed
+ */
+PQOS_LOCAL int uring_read(struct uring_read **reads, const unsigned num);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PQOS_URING_H__ */
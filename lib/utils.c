@@ -43,13 +43,10 @@
 #include "cpuinfo.h"
 #include "pqos.h"
 
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 
-#define TOPO_OBJ_SOCKET     0
-#define TOPO_OBJ_L2_CLUSTER 2
-#define TOPO_OBJ_L3_CLUSTER 3
-
 int
 _pqos_utils_init(int interface)
 {
@@ -58,152 +55,103 @@ _pqos_utils_init(int interface)
         return PQOS_RETVAL_OK;
 }
 
-unsigned *
-pqos_cpu_get_mba_ids(const struct pqos_cpuinfo *cpu, unsigned *count)
+/**
+ * @brief Copies \a num entries of \a list into newly allocated array
+ *
+ * @param [in] list entries to copy
+ * @param [in] num number of entries
+ *
+ * @return Allocated array
+ * @retval NULL on error
+ */
+static unsigned *
+__copy_list(const unsigned *list, const unsigned num)
 {
-        unsigned mba_id_count = 0, i = 0;
-        unsigned *mba_ids = NULL;
-
-        ASSERT(cpu != NULL);
-        ASSERT(count != NULL);
-        if (cpu == NULL || count == NULL)
-                return NULL;
-
-        mba_ids = (unsigned *)malloc(sizeof(mba_ids[0]) * cpu->num_cores);
-        if (mba_ids == NULL)
-                return NULL;
-
-        for (i = 0; i < cpu->num_cores; i++) {
-                unsigned j = 0;
-
-                /**
-                 * Check if this mba id is already on the \a mbas list
-                 */
-                for (j = 0; j < mba_id_count && mba_id_count > 0; j++)
-                        if (cpu->cores[i].mba_id == mba_ids[j])
-                                break;
+        unsigned *copy = (unsigned *)malloc(sizeof(copy[0]) * num);
 
-                if (j >= mba_id_count || mba_id_count == 0) {
-                        /**
-                         * This mba_id wasn't reported before
-                         */
-                        mba_ids[mba_id_count++] = cpu->cores[i].mba_id;
-                }
-        }
+        if (copy != NULL)
+                memcpy(copy, list, sizeof(copy[0]) * num);
 
-        *count = mba_id_count;
-        return mba_ids;
+        return copy;
 }
 
-unsigned *
-pqos_cpu_get_l3cat_ids(const struct pqos_cpuinfo *cpu, unsigned *count)
+/**
+ * @brief Retrieves core lists of topology object \a type
+ *
+ * @param [in] cpu CPU topology
+ * @param [in] type CPU topology object type
+ *
+ * @return Precomputed core lists
+ * @retval NULL \a cpu was not obtained from the library
+ */
+static const struct cpuinfo_objs *
+__get_objs(const struct pqos_cpuinfo *cpu, const enum cpuinfo_obj type)
 {
-        unsigned l3cat_count = 0, i = 0;
-        unsigned *l3cat_ids = NULL;
-
-        ASSERT(cpu != NULL);
-        ASSERT(count != NULL);
-        if (cpu == NULL || count == NULL)
-                return NULL;
+        const struct cpuinfo_index *index = cpuinfo_get_index(cpu);
 
-        l3cat_ids = (unsigned *)malloc(sizeof(l3cat_ids[0]) * cpu->num_cores);
-        if (l3cat_ids == NULL)
+        if (index == NULL)
                 return NULL;
 
-        for (i = 0; i < cpu->num_cores; i++) {
-                unsigned j = 0;
-
-                /**
-                 * Check if this l3cat id is already on the \a l3cat_ids list
-                 */
-                for (j = 0; j < l3cat_count && l3cat_count > 0; j++)
-                        if (cpu->cores[i].l3cat_id == l3cat_ids[j])
-                                break;
-
-                if (j >= l3cat_count || l3cat_count == 0) {
-                        /**
-                         * This l3cat_id wasn't reported before
-                         */
-                        l3cat_ids[l3cat_count++] = cpu->cores[i].l3cat_id;
-                }
-        }
-
-        *count = l3cat_count;
-        return l3cat_ids;
+        return &index->objs[type];
 }
 
-unsigned *
-pqos_cpu_get_sockets(const struct pqos_cpuinfo *cpu, unsigned *count)
+/**
+ * @brief Creates list of ids of given topology object type
+ *
+ * @param [in] cpu CPU topology
+ * @param [in] type CPU topology object type
+ * @param [out] count place to put number of ids found
+ *
+ * @return Allocated array of ids in order of their first core
+ * @retval NULL on error
+ */
+static unsigned *
+__get_topology_obj_ids(const struct pqos_cpuinfo *cpu,
+                       const enum cpuinfo_obj type,
+                       unsigned *count)
 {
-        unsigned scount = 0, i = 0;
-        unsigned *sockets = NULL;
+        const struct cpuinfo_objs *objs;
+        unsigned id_count = 0, i = 0;
+        unsigned *ids = NULL;
 
         ASSERT(cpu != NULL);
         ASSERT(count != NULL);
         if (cpu == NULL || count == NULL)
                 return NULL;
 
-        sockets = (unsigned *)malloc(sizeof(sockets[0]) * cpu->num_cores);
-        if (sockets == NULL)
-                return NULL;
-
-        for (i = 0; i < cpu->num_cores; i++) {
-                unsigned j = 0;
-
-                /**
-                 * Check if this socket id is already on the \a sockets list
-                 */
-                for (j = 0; j < scount && scount > 0; j++)
-                        if (cpu->cores[i].socket == sockets[j])
-                                break;
-
-                if (j >= scount || scount == 0) {
-                        /**
-                         * This socket wasn't reported before
-                         */
-                        sockets[scount++] = cpu->cores[i].socket;
-                }
+        objs = __get_objs(cpu, type);
+        if (objs != NULL) {
+                ids = __copy_list(objs->ids, objs->num);
+                if (ids != NULL)
+                        *count = objs->num;
+                return ids;
         }
 
-        *count = scount;
-        return sockets;
-}
-
-unsigned *
-pqos_cpu_get_l2ids(const struct pqos_cpuinfo *cpu, unsigned *count)
-{
-        unsigned l2count = 0, i = 0;
-        unsigned *l2ids = NULL;
-
-        ASSERT(cpu != NULL);
-        ASSERT(count != NULL);
-        if (cpu == NULL || count == NULL)
-                return NULL;
-
-        l2ids = (unsigned *)malloc(sizeof(l2ids[0]) * cpu->num_cores);
-        if (l2ids == NULL)
+        ids = (unsigned *)malloc(sizeof(ids[0]) * cpu->num_cores);
+        if (ids == NULL)
                 return NULL;
 
         for (i = 0; i < cpu->num_cores; i++) {
+                const unsigned id = cpuinfo_obj_id(&cpu->cores[i], type);
                 unsigned j = 0;
 
                 /**
-                 * Check if this L2 id is already on the list
+                 * Check if this id is already on the \a ids list
                  */
-                for (j = 0; j < l2count && l2count > 0; j++)
-                        if (cpu->cores[i].l2_id == l2ids[j])
+                for (j = 0; j < id_count; j++)
+                        if (id == ids[j])
                                 break;
 
-                if (j >= l2count || l2count == 0) {
+                if (j >= id_count) {
                         /**
-                         * This l2id wasn't reported before
+                         * This id wasn't reported before
                          */
-                        l2ids[l2count++] = cpu->cores[i].l2_id;
+                        ids[id_count++] = id;
                 }
         }
 
-        *count = l2count;
-        return l2ids;
+        *count = id_count;
+        return ids;
 }
 
 /**
@@ -211,9 +159,6 @@ pqos_cpu_get_l2ids(const struct pqos_cpuinfo *cpu, unsigned *count)
  *
  * @param [in] cpu CPU topology
  * @param [in] type CPU topology object type to search cores for
- *             TOPO_OBJ_SOCKET - sockets
- *             TOPO_OBJ_L2_CLUSTER - L2 cache clusters
- *             TOPO_OBJ_L3_CLUSTER - L3 cache clusters
  * @param [in] id CPU topology object ID to search cores for
  * @param [out] count place to put number of objects found
  *
@@ -222,10 +167,11 @@ pqos_cpu_get_l2ids(const struct pqos_cpuinfo *cpu, unsigned *count)
  */
 static unsigned *
 __get_cores_per_topology_obj(const struct pqos_cpuinfo *cpu,
-                             const int type,
+                             const enum cpuinfo_obj type,
                              const unsigned id,
                              unsigned *count)
 {
+        const struct cpuinfo_objs *objs;
         unsigned num = 0, i = 0;
         unsigned *core_list = NULL;
 
@@ -234,16 +180,26 @@ __get_cores_per_topology_obj(const struct pqos_cpuinfo *cpu,
         if (cpu == NULL || count == NULL)
                 return NULL;
 
+        objs = __get_objs(cpu, type);
+        if (objs != NULL) {
+                const unsigned pos = cpuinfo_objs_find(objs, id);
+
+                if (pos == UINT_MAX)
+                        return NULL;
+
+                num = objs->offset[pos + 1] - objs->offset[pos];
+                core_list = __copy_list(&objs->lcores[objs->offset[pos]], num);
+                if (core_list != NULL)
+                        *count = num;
+                return core_list;
+        }
+
         core_list = (unsigned *)malloc(cpu->num_cores * sizeof(core_list[0]));
         if (core_list == NULL)
                 return NULL;
 
         for (i = 0; i < cpu->num_cores; i++)
-                if ((type == TOPO_OBJ_L3_CLUSTER &&
-                     id == cpu->cores[i].l3_id) ||
-                    (type == TOPO_OBJ_L2_CLUSTER &&
-                     id == cpu->cores[i].l2_id) ||
-                    (type == TOPO_OBJ_SOCKET && id == cpu->cores[i].socket))
+                if (cpuinfo_obj_id(&cpu->cores[i], type) == id)
                         core_list[num++] = cpu->cores[i].lcore;
 
         if (num == 0) {
@@ -255,12 +211,146 @@ __get_cores_per_topology_obj(const struct pqos_cpuinfo *cpu,
         return core_list;
 }
 
+/**
+ * @brief Retrieves first core belonging to given topology object
+ *
+ * @param [in] cpu CPU topology
+ * @param [in] type CPU topology object type to search core for
+ * @param [in] id CPU topology object ID to search core for
+ * @param [out] lcore place to store core id
+ *
+ * @return Operation status
+ * @retval PQOS_RETVAL_OK on success
+ */
+static int
+__get_one_core_per_topology_obj(const struct pqos_cpuinfo *cpu,
+                                const enum cpuinfo_obj type,
+                                const unsigned id,
+                                unsigned *lcore)
+{
+        const struct cpuinfo_objs *objs;
+        unsigned i = 0;
+
+        ASSERT(cpu != NULL);
+        ASSERT(lcore != NULL);
+
+        if (cpu == NULL || lcore == NULL)
+                return PQOS_RETVAL_PARAM;
+
+        objs = __get_objs(cpu, type);
+        if (objs != NULL) {
+                const unsigned pos = cpuinfo_objs_find(objs, id);
+
+                if (pos == UINT_MAX)
+                        return PQOS_RETVAL_ERROR;
+
+                *lcore = objs->lcores[objs->offset[pos]];
+                return PQOS_RETVAL_OK;
+        }
+
+        for (i = 0; i < cpu->num_cores; i++)
+                if (cpuinfo_obj_id(&cpu->cores[i], type) == id) {
+                        *lcore = cpu->cores[i].lcore;
+                        return PQOS_RETVAL_OK;
+                }
+
+        return PQOS_RETVAL_ERROR;
+}
+
+/**
+ * @brief Retrieves precomputed ids of given topology object type
+ *
+ * @param [in] cpu CPU topology
+ * @param [in] type CPU topology object type
+ * @param [out] count place to put number of ids
+ *
+ * @return Pointer to ids owned by the library
+ * @retval NULL on error or if \a cpu was not obtained from the library
+ */
+static const unsigned *
+__view_topology_obj_ids(const struct pqos_cpuinfo *cpu,
+                        const enum cpuinfo_obj type,
+                        unsigned *count)
+{
+        const struct cpuinfo_objs *objs;
+
+        if (count == NULL)
+                return NULL;
+
+        objs = __get_objs(cpu, type);
+        if (objs == NULL)
+                return NULL;
+
+        *count = objs->num;
+        return objs->ids;
+}
+
+/**
+ * @brief Retrieves precomputed cores of given topology object
+ *
+ * @param [in] cpu CPU topology
+ * @param [in] type CPU topology object type
+ * @param [in] id CPU topology object ID
+ * @param [out] count place to put number of cores
+ *
+ * @return Pointer to cores owned by the library
+ * @retval NULL on error, if no core found or if \a cpu was not obtained
+ *         from the library
+ */
+static const unsigned *
+__view_cores_per_topology_obj(const struct pqos_cpuinfo *cpu,
+                              const enum cpuinfo_obj type,
+                              const unsigned id,
+                              unsigned *count)
+{
+        const struct cpuinfo_objs *objs;
+        unsigned pos;
+
+        if (count == NULL)
+                return NULL;
+
+        objs = __get_objs(cpu, type);
+        if (objs == NULL)
+                return NULL;
+
+        pos = cpuinfo_objs_find(objs, id);
+        if (pos == UINT_MAX)
+                return NULL;
+
+        *count = objs->offset[pos + 1] - objs->offset[pos];
+        return &objs->lcores[objs->offset[pos]];
+}
+
+unsigned *
+pqos_cpu_get_mba_ids(const struct pqos_cpuinfo *cpu, unsigned *count)
+{
+        return __get_topology_obj_ids(cpu, CPUINFO_OBJ_MBA, count);
+}
+
+unsigned *
+pqos_cpu_get_l3cat_ids(const struct pqos_cpuinfo *cpu, unsigned *count)
+{
+        return __get_topology_obj_ids(cpu, CPUINFO_OBJ_L3CAT, count);
+}
+
+unsigned *
+pqos_cpu_get_sockets(const struct pqos_cpuinfo *cpu, unsigned *count)
+{
+        return __get_topology_obj_ids(cpu, CPUINFO_OBJ_SOCKET, count);
+}
+
+unsigned *
+pqos_cpu_get_l2ids(const struct pqos_cpuinfo *cpu, unsigned *count)
+{
+        return __get_topology_obj_ids(cpu, CPUINFO_OBJ_L2, count);
+}
+
 unsigned *
 pqos_cpu_get_cores_l3id(const struct pqos_cpuinfo *cpu,
                         const unsigned l3_id,
                         unsigned *count)
 {
-        return __get_cores_per_topology_obj(cpu, TOPO_OBJ_L3_CLUSTER, l3_id,
+        return __get_cores_per_topology_obj(cpu, CPUINFO_OBJ_L3, l3_id,
                                             count);
 }
 
@@ -269,35 +359,74 @@ pqos_cpu_get_cores(const struct pqos_cpuinfo *cpu,
                    const unsigned socket,
                    unsigned *count)
 {
-        unsigned i = 0, cnt = 0;
-        unsigned *cores = NULL;
+        return __get_cores_per_topology_obj(cpu, CPUINFO_OBJ_SOCKET, socket,
+                                            count);
+}
 
-        ASSERT(cpu != NULL);
-        ASSERT(count != NULL);
+unsigned *
+pqos_cpu_get_cores_l3cat_id(const struct pqos_cpuinfo *cpu,
+                            const unsigned l3cat_id,
+                            unsigned *count)
+{
+        return __get_cores_per_topology_obj(cpu, CPUINFO_OBJ_L3CAT, l3cat_id,
+                                            count);
+}
 
-        if (cpu == NULL || count == NULL)
-                return NULL;
+const unsigned *
+pqos_cpu_view_sockets(const struct pqos_cpuinfo *cpu, unsigned *count)
+{
+        return __view_topology_obj_ids(cpu, CPUINFO_OBJ_SOCKET, count);
+}
 
-        cores = (unsigned *)malloc(cpu->num_cores * sizeof(cores[0]));
-        if (cores == NULL)
-                return NULL;
+const unsigned *
+pqos_cpu_view_l3cat_ids(const struct pqos_cpuinfo *cpu, unsigned *count)
+{
+        return __view_topology_obj_ids(cpu, CPUINFO_OBJ_L3CAT, count);
+}
 
-        for (i = 0; i < cpu->num_cores; i++)
-                if (cpu->cores[i].socket == socket)
-                        cores[cnt++] = cpu->cores[i].lcore;
+const unsigned *
+pqos_cpu_view_mba_ids(const struct pqos_cpuinfo *cpu, unsigned *count)
+{
+        return __view_topology_obj_ids(cpu, CPUINFO_OBJ_MBA, count);
+}
 
-        if (!cnt) {
-                free(cores);
-                return NULL;
-        }
+const unsigned *
+pqos_cpu_view_l2ids(const struct pqos_cpuinfo *cpu, unsigned *count)
+{
+        return __view_topology_obj_ids(cpu, CPUINFO_OBJ_L2, count);
+}
 
-        *count = cnt;
-        return cores;
+const unsigned *
+pqos_cpu_view_cores(const struct pqos_cpuinfo *cpu,
+                    const unsigned socket,
+                    unsigned *count)
+{
+        return __view_cores_per_topology_obj(cpu, CPUINFO_OBJ_SOCKET, socket,
+                                             count);
+}
+
+const unsigned *
+pqos_cpu_view_cores_l3id(const struct pqos_cpuinfo *cpu,
+                         const unsigned l3_id,
+                         unsigned *count)
+{
+        return __view_cores_per_topology_obj(cpu, CPUINFO_OBJ_L3, l3_id,
+                                             count);
+}
+
+const unsigned *
+pqos_cpu_view_cores_l3cat_id(const struct pqos_cpuinfo *cpu,
+                             const unsigned l3cat_id,
+                             unsigned *count)
+{
+        return __view_cores_per_topology_obj(cpu, CPUINFO_OBJ_L3CAT, l3cat_id,
+                                             count);
 }
 
 const struct pqos_coreinfo *
 pqos_cpu_get_core_info(const struct pqos_cpuinfo *cpu, unsigned lcore)
 {
+        const struct cpuinfo_index *index;
         unsigned i;
 
         ASSERT(cpu != NULL);
@@ -305,6 +434,15 @@ pqos_cpu_get_core_info(const struct pqos_cpuinfo *cpu, unsigned lcore)
         if (cpu == NULL)
                 return NULL;
 
+        index = cpuinfo_get_index(cpu);
+        if (index != NULL) {
+                if (lcore >= index->num_pos ||
+                    index->core_pos[lcore] == UINT_MAX)
+                        return NULL;
+
+                return &cpu->cores[index->core_pos[lcore]];
+        }
+
         for (i = 0; i < cpu->num_cores; i++)
                 if (cpu->cores[i].lcore == lcore)
                         return &cpu->cores[i];
@@ -317,21 +455,8 @@ pqos_cpu_get_one_core(const struct pqos_cpuinfo *cpu,
                       const unsigned socket,
                       unsigned *lcore)
 {
-        unsigned i = 0;
-
-        ASSERT(cpu != NULL);
-        ASSERT(lcore != NULL);
-
-        if (cpu == NULL || lcore == NULL)
-                return PQOS_RETVAL_PARAM;
-
-        for (i = 0; i < cpu->num_cores; i++)
-                if (cpu->cores[i].socket == socket) {
-                        *lcore = cpu->cores[i].lcore;
-                        return PQOS_RETVAL_OK;
-                }
-
-        return PQOS_RETVAL_ERROR;
+        return __get_one_core_per_topology_obj(cpu, CPUINFO_OBJ_SOCKET, socket,
+                                               lcore);
 }
 
 int
@@ -339,21 +464,8 @@ pqos_cpu_get_one_by_l3cat_id(const struct pqos_cpuinfo *cpu,
                              const unsigned l3cat_id,
                              unsigned *lcore)
 {
-        unsigned i = 0;
-
-        ASSERT(cpu != NULL);
-        ASSERT(lcore != NULL);
-
-        if (cpu == NULL || lcore == NULL)
-                return PQOS_RETVAL_PARAM;
-
-        for (i = 0; i < cpu->num_cores; i++)
-                if (cpu->cores[i].l3cat_id == l3cat_id) {
-                        *lcore = cpu->cores[i].lcore;
-                        return PQOS_RETVAL_OK;
-                }
-
-        return PQOS_RETVAL_ERROR;
+        return __get_one_core_per_topology_obj(cpu, CPUINFO_OBJ_L3CAT,
+                                               l3cat_id, lcore);
 }
 
 int
@@ -361,21 +473,8 @@ pqos_cpu_get_one_by_mba_id(const struct pqos_cpuinfo *cpu,
                            const unsigned mba_id,
                            unsigned *lcore)
 {
-        unsigned i = 0;
-
-        ASSERT(cpu != NULL);
-        ASSERT(lcore != NULL);
-
-        if (cpu == NULL || lcore == NULL)
-                return PQOS_RETVAL_PARAM;
-
-        for (i = 0; i < cpu->num_cores; i++)
-                if (cpu->cores[i].mba_id == mba_id) {
-                        *lcore = cpu->cores[i].lcore;
-                        return PQOS_RETVAL_OK;
-                }
-
-        return PQOS_RETVAL_ERROR;
+        return __get_one_core_per_topology_obj(cpu, CPUINFO_OBJ_MBA, mba_id,
+                                               lcore);
 }
 
 int
@@ -383,37 +482,21 @@ pqos_cpu_get_one_by_l2id(const struct pqos_cpuinfo *cpu,
                          const unsigned l2id,
                          unsigned *lcore)
 {
-        unsigned i = 0;
-
-        ASSERT(cpu != NULL);
-        ASSERT(lcore != NULL);
-
-        if (cpu == NULL || lcore == NULL)
-                return PQOS_RETVAL_PARAM;
-
-        for (i = 0; i < cpu->num_cores; i++)
-                if (cpu->cores[i].l2_id == l2id) {
-                        *lcore = cpu->cores[i].lcore;
-                        return PQOS_RETVAL_OK;
-                }
-
-        return PQOS_RETVAL_ERROR;
+        return __get_one_core_per_topology_obj(cpu, CPUINFO_OBJ_L2, l2id,
+                                               lcore);
 }
 
 int
 pqos_cpu_check_core(const struct pqos_cpuinfo *cpu, const unsigned lcore)
 {
-        unsigned i = 0;
-
         ASSERT(cpu != NULL);
         if (cpu == NULL)
                 return PQOS_RETVAL_PARAM;
 
-        for (i = 0; i < cpu->num_cores; i++)
-                if (cpu->cores[i].lcore == lcore)
-                        return PQOS_RETVAL_OK;
+        if (pqos_cpu_get_core_info(cpu, lcore) == NULL)
+                return PQOS_RETVAL_ERROR;
 
-        return PQOS_RETVAL_ERROR;
+        return PQOS_RETVAL_OK;
 }
 
 int
@@ -421,18 +504,17 @@ pqos_cpu_get_socketid(const struct pqos_cpuinfo *cpu,
                       const unsigned lcore,
                       unsigned *socket)
 {
-        unsigned i = 0;
+        const struct pqos_coreinfo *info;
 
         if (cpu == NULL || socket == NULL)
                 return PQOS_RETVAL_PARAM;
 
-        for (i = 0; i < cpu->num_cores; i++)
-                if (cpu->cores[i].lcore == lcore) {
-                        *socket = cpu->cores[i].socket;
-                        return PQOS_RETVAL_OK;
-                }
+        info = pqos_cpu_get_core_info(cpu, lcore);
+        if (info == NULL)
+                return PQOS_RETVAL_ERROR;
 
-        return PQOS_RETVAL_ERROR;
+        *socket = info->socket;
+        return PQOS_RETVAL_OK;
 }
 
 int
@@ -440,18 +522,17 @@ pqos_cpu_get_clusterid(const struct pqos_cpuinfo *cpu,
                        const unsigned lcore,
                        unsigned *cluster)
 {
-        unsigned i = 0;
+        const struct pqos_coreinfo *info;
 
         if (cpu == NULL || cluster == NULL)
                 return PQOS_RETVAL_PARAM;
 
-        for (i = 0; i < cpu->num_cores; i++)
-                if (cpu->cores[i].lcore == lcore) {
-                        *cluster = cpu->cores[i].l3_id;
-                        return PQOS_RETVAL_OK;
-                }
+        info = pqos_cpu_get_core_info(cpu, lcore);
+        if (info == NULL)
+                return PQOS_RETVAL_ERROR;
 
-        return PQOS_RETVAL_ERROR;
+        *cluster = info->l3_id;
+        return PQOS_RETVAL_OK;
 }
 
 int
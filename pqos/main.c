@@ -953,7 +953,9 @@ static const char help_printf_long[] =
     "  -o FILE, --mon-file=FILE    output monitored data in a FILE\n"
     "  -u TYPE, --mon-file-type=TYPE\n"
     "          select output file format type for monitored data.\n"
-    "          TYPE is one of: text (default), xml or csv.\n"
+    "          TYPE is one of: text (default), xml, csv or shm.\n"
+    "          shm publishes binary samples into POSIX shared memory,\n"
+    "          FILE selects the segment name (default /pqos-mon).\n"
     "  -i N, --mon-interval=N      set sampling interval to Nx100ms,\n"
     "                              default 10 = 10 x 100ms = 1s.\n"
     "  -T, --mon-top               top like monitoring output\n"
@@ -39,6 +39,7 @@
 #include "common.h"
 #include "main.h"
 #include "monitor_csv.h"
+#include "monitor_shm.h"
 #include "monitor_text.h"
 #include "monitor_utils.h"
 #include "monitor_xml.h"
@@ -970,7 +971,8 @@ monitor_setup(const struct pqos_cpuinfo *cpu_info,
 
         if (strcasecmp(sel_output_type, "text") != 0 &&
             strcasecmp(sel_output_type, "xml") != 0 &&
-            strcasecmp(sel_output_type, "csv") != 0) {
+            strcasecmp(sel_output_type, "csv") != 0 &&
+            strcasecmp(sel_output_type, "shm") != 0) {
                 printf("Invalid selection of file output type '%s'!\n",
                        sel_output_type);
                 return -1;
@@ -979,7 +981,9 @@ monitor_setup(const struct pqos_cpuinfo *cpu_info,
         /**
          * Set up file descriptor for monitored data
          */
-        if (sel_output_file == NULL) {
+        if (sel_output_file == NULL ||
+            strcasecmp(sel_output_type, "shm") == 0) {
+                /* for shared memory output file is the segment name */
                 fp_monitor = stdout;
         } else {
                 if (strcasecmp(sel_output_type, "xml") == 0 ||
@@ -1948,6 +1952,12 @@ monitor_loop(void)
                 output.row = monitor_xml_row;
                 output.footer = monitor_xml_footer;
                 output.end = monitor_xml_end;
+        } else if (strcasecmp(sel_output_type, "shm") == 0) {
+                output.begin = monitor_shm_begin;
+                output.header = monitor_shm_header;
+                output.row = monitor_shm_row;
+                output.footer = monitor_shm_footer;
+                output.end = monitor_shm_end;
         } else {
                 printf("Invalid selection of output file type '%s'!\n",
                        sel_output_type);
@@ -1979,6 +1989,16 @@ monitor_loop(void)
         mon_number = get_mon_arrays(&mon_grps, &mon_data);
         display_num = mon_number;
 
+        if (strcasecmp(sel_output_type, "shm") == 0 &&
+            monitor_shm_init(sel_output_file != NULL ? sel_output_file
+                                                     : MONITOR_SHM_NAME,
+                             mon_grps, mon_number,
+                             (unsigned)sel_mon_interval * 100) != 0) {
+                free(mon_grps);
+                free(mon_data);
+                return;
+        }
+
         /**
          * Capture ctrl-c to gracefully stop the loop
          */
@@ -0,0 +1,248 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2022 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "monitor_shm.h"
+
+#include "common.h"
+#include "monitor.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define CACHE_LINE_SIZE 64
+
+static char *shm_name = NULL;
+static size_t shm_size = 0;
+static struct monitor_shm_header *shm_header = NULL;
+static struct pqos_mon_data **shm_groups = NULL;
+static unsigned shm_num_groups = 0;
+
+/**
+ * @brief Returns slot of sample \a n
+ *
+ * @param n sample number
+ *
+ * @return slot pointer
+ */
+static struct monitor_shm_slot *
+shm_slot(const uint64_t n)
+{
+        uint8_t *ring = (uint8_t *)shm_header + shm_header->ring_offset;
+
+        return (struct monitor_shm_slot *)(ring + (n % shm_header->num_slots) *
+                                                      shm_header->slot_size);
+}
+
+int
+monitor_shm_init(const char *name,
+                 struct pqos_mon_data **groups,
+                 const unsigned num_groups,
+                 const unsigned interval_ms)
+{
+        struct monitor_shm_group *table;
+        size_t groups_offset, ring_offset, slot_size;
+        unsigned i;
+        void *addr;
+        int fd;
+
+        ASSERT(name != NULL);
+        ASSERT(groups != NULL || num_groups == 0);
+
+        groups_offset = sizeof(*shm_header);
+        groups_offset = (groups_offset + CACHE_LINE_SIZE - 1) &
+                        ~(size_t)(CACHE_LINE_SIZE - 1);
+        ring_offset = groups_offset + num_groups * sizeof(table[0]);
+        ring_offset = (ring_offset + CACHE_LINE_SIZE - 1) &
+                      ~(size_t)(CACHE_LINE_SIZE - 1);
+        slot_size = sizeof(struct monitor_shm_slot) +
+                    num_groups * sizeof(struct pqos_event_values);
+        slot_size = (slot_size + CACHE_LINE_SIZE - 1) &
+                    ~(size_t)(CACHE_LINE_SIZE - 1);
+
+        shm_name = strdup(name);
+        if (shm_name == NULL) {
+                printf("Memory allocation error!\n");
+                return -1;
+        }
+
+        /* segment left by previous run stays with its consumers */
+        shm_unlink(name);
+        fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0) {
+                printf("Failed to create shared memory '%s': %s\n", name,
+                       strerror(errno));
+                goto error_exit;
+        }
+
+        shm_size = ring_offset + MONITOR_SHM_SLOTS * slot_size;
+        if (ftruncate(fd, (off_t)shm_size) != 0) {
+                printf("Failed to resize shared memory '%s': %s\n", name,
+                       strerror(errno));
+                close(fd);
+                goto error_unlink;
+        }
+
+        addr = mmap(NULL, shm_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (addr == MAP_FAILED) {
+                printf("Failed to map shared memory '%s': %s\n", name,
+                       strerror(errno));
+                goto error_unlink;
+        }
+        shm_header = (struct monitor_shm_header *)addr;
+
+        shm_header->version = MONITOR_SHM_VERSION;
+        shm_header->state = MONITOR_SHM_STATE_RUNNING;
+        shm_header->interval_ms = interval_ms;
+        shm_header->num_groups = num_groups;
+        shm_header->num_slots = MONITOR_SHM_SLOTS;
+        shm_header->slot_size = (uint32_t)slot_size;
+        shm_header->values_size = sizeof(struct pqos_event_values);
+        shm_header->events = monitor_get_events();
+        shm_header->groups_offset = groups_offset;
+        shm_header->ring_offset = ring_offset;
+        shm_header->head = 0;
+
+        table = (struct monitor_shm_group *)((uint8_t *)addr + groups_offset);
+        for (i = 0; i < num_groups; i++) {
+                if (groups[i]->context != NULL)
+                        strncpy(table[i].name, (char *)groups[i]->context,
+                                sizeof(table[i].name) - 1);
+                table[i].events = groups[i]->event;
+        }
+
+        shm_groups = groups;
+        shm_num_groups = num_groups;
+
+        /* layout is complete, let consumers in */
+        __atomic_store_n(&shm_header->magic, MONITOR_SHM_MAGIC,
+                         __ATOMIC_RELEASE);
+
+        return 0;
+
+error_unlink:
+        shm_unlink(name);
+error_exit:
+        free(shm_name);
+        shm_name = NULL;
+        return -1;
+}
+
+void
+monitor_shm_begin(FILE *fp)
+{
+        UNUSED_ARG(fp);
+
+        if (shm_header == NULL)
+                return;
+
+        printf("Publishing %u monitoring groups to shared memory '%s'\n",
+               shm_num_groups, shm_name);
+}
+
+void
+monitor_shm_header(FILE *fp, const char *timestamp)
+{
+        UNUSED_ARG(fp);
+        UNUSED_ARG(timestamp);
+}
+
+void
+monitor_shm_row(FILE *fp,
+                const char *timestamp,
+                const struct pqos_mon_data *data)
+{
+        UNUSED_ARG(fp);
+        UNUSED_ARG(timestamp);
+        UNUSED_ARG(data);
+}
+
+void
+monitor_shm_footer(FILE *fp)
+{
+        struct monitor_shm_slot *slot;
+        struct timespec ts;
+        uint64_t n;
+        unsigned i;
+
+        UNUSED_ARG(fp);
+
+        if (shm_header == NULL)
+                return;
+
+        n = shm_header->head;
+        slot = shm_slot(n);
+
+        /* mark slot as being written before touching the values */
+        __atomic_store_n(&slot->seq, 2 * n + 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+
+        if (clock_gettime(CLOCK_REALTIME, &ts) == 0)
+                slot->timestamp_ns =
+                    (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+        else
+                slot->timestamp_ns = 0;
+        for (i = 0; i < shm_num_groups; i++)
+                slot->values[i] = shm_groups[i]->values;
+
+        __atomic_store_n(&slot->seq, 2 * n + 2, __ATOMIC_RELEASE);
+        __atomic_store_n(&shm_header->head, n + 1, __ATOMIC_RELEASE);
+}
+
+void
+monitor_shm_end(FILE *fp)
+{
+        UNUSED_ARG(fp);
+
+        if (shm_header == NULL)
+                return;
+
+        /* consumers already attached keep their mapping */
+        __atomic_store_n(&shm_header->state, MONITOR_SHM_STATE_STOPPED,
+                         __ATOMIC_RELEASE);
+        munmap(shm_header, shm_size);
+        shm_unlink(shm_name);
+
+        shm_header = NULL;
+        shm_size = 0;
+        shm_groups = NULL;
+        shm_num_groups = 0;
+        free(shm_name);
+        shm_name = NULL;
+}
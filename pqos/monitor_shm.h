@@ -0,0 +1,177 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2022 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @brief Shared memory output of monitoring data
+ *
+ * Monitoring samples are published into POSIX shared memory segment as
+ * binary data. Segment starts with header, followed by table of monitoring
+ * groups and ring of samples. Each sample (slot) holds timestamp and
+ * pqos_event_values of all groups, in order of the group table.
+ *
+ * There is single producer and any number of consumers. Slots are protected
+ * by sequence numbers: while sample N is written its slot sequence is
+ * 2 * N + 1 and it becomes 2 * N + 2 once the sample is complete. Consumer
+ * reads sequence before and after accessing the slot and discards the slot
+ * if the values differ. Consumers that fall behind by more than the ring
+ * size lose the oldest samples, producer never waits for consumers.
+ */
+
+#ifndef __MONITOR_SHM_H__
+#define __MONITOR_SHM_H__
+
+#include "pqos.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MONITOR_SHM_MAGIC     0x4d534f51 /**< "QOSM" */
+#define MONITOR_SHM_VERSION   1
+#define MONITOR_SHM_NAME      "/pqos-mon" /**< default segment name */
+#define MONITOR_SHM_SLOTS     64          /**< number of ring slots */
+#define MONITOR_SHM_GROUP_LEN 64          /**< max group name length */
+
+/**
+ * Producer state
+ */
+enum monitor_shm_state {
+        MONITOR_SHM_STATE_RUNNING = 1, /**< samples are being published */
+        MONITOR_SHM_STATE_STOPPED = 2, /**< monitoring has finished */
+};
+
+/**
+ * Shared memory segment header
+ */
+struct monitor_shm_header {
+        uint32_t magic;         /**< MONITOR_SHM_MAGIC */
+        uint32_t version;       /**< MONITOR_SHM_VERSION */
+        uint32_t state;         /**< producer state */
+        uint32_t interval_ms;   /**< sampling interval */
+        uint32_t num_groups;    /**< number of monitoring groups */
+        uint32_t num_slots;     /**< number of ring slots */
+        uint32_t slot_size;     /**< size of single slot in bytes */
+        uint32_t values_size;   /**< size of struct pqos_event_values */
+        uint64_t events;        /**< monitored events */
+        uint64_t groups_offset; /**< offset of group table */
+        uint64_t ring_offset;   /**< offset of first slot */
+        uint64_t head;          /**< number of published samples */
+};
+
+/**
+ * Monitoring group description
+ */
+struct monitor_shm_group {
+        char name[MONITOR_SHM_GROUP_LEN]; /**< cores or pids of the group */
+        uint64_t events;                  /**< events monitored by group */
+};
+
+/**
+ * Ring slot holding single sample of all groups
+ */
+struct monitor_shm_slot {
+        uint64_t seq;                      /**< slot sequence number */
+        uint64_t timestamp_ns;             /**< sample time (CLOCK_REALTIME) */
+        struct pqos_event_values values[]; /**< values of each group */
+};
+
+/**
+ * @brief Creates shared memory segment for monitoring groups
+ *
+ * @param [in] name shared memory segment name
+ * @param [in] groups monitoring groups
+ * @param [in] num_groups number of monitoring groups
+ * @param [in] interval_ms sampling interval
+ *
+ * @return Operation status
+ * @retval 0 OK
+ * @retval -1 error
+ */
+int monitor_shm_init(const char *name,
+                     struct pqos_mon_data **groups,
+                     const unsigned num_groups,
+                     const unsigned interval_ms);
+
+/**
+ * @brief Start shared memory output
+ *
+ * @param fp file descriptor, not used
+ */
+/* clang-format off */
+void monitor_shm_begin(FILE * fp);
+/* clang-format on */
+
+/**
+ * @brief Start new sample
+ *
+ * @param fp file descriptor, not used
+ * @param [in] timestamp data timestamp, not used
+ */
+void monitor_shm_header(FILE *fp, const char *timestamp);
+
+/**
+ * @brief Monitoring data row, not used
+ *
+ * Values of all groups are published in group table order by
+ * monitor_shm_footer().
+ *
+ * @param fp file descriptor, not used
+ * @param [in] timestamp data timestamp
+ * @param [in] data monitoring data
+ */
+void monitor_shm_row(FILE *fp,
+                     const char *timestamp,
+                     const struct pqos_mon_data *data);
+
+/**
+ * @brief Publish sample of all groups
+ *
+ * @param fp file descriptor, not used
+ */
+void monitor_shm_footer(FILE *fp);
+
+/**
+ * @brief Finalize shared memory output and remove the segment
+ *
+ * @param fp file descriptor, not used
+ */
+void monitor_shm_end(FILE *fp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MONITOR_SHM_H__ */
@@ -0,0 +1,141 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2022 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+/**
+ * @brief Common benchmark helpers
+ */
+
+#include "bench.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+uint64_t
+bench_time_ns(void)
+{
+        struct timespec ts;
+
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+
+        return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+int
+bench_syscalls(uint64_t *syscr, uint64_t *syscw)
+{
+        FILE *fd;
+        char line[64];
+        unsigned long long val;
+        int found = 0;
+
+        *syscr = 0;
+        *syscw = 0;
+
+        fd = fopen("/proc/self/io", "r");
+        if (fd == NULL)
+                return -1;
+
+        while (fgets(line, sizeof(line), fd) != NULL) {
+                if (sscanf(line, "syscr: %llu", &val) == 1) {
+                        *syscr = val;
+                        found++;
+                } else if (sscanf(line, "syscw: %llu", &val) == 1) {
+                        *syscw = val;
+                        found++;
+                }
+        }
+
+        fclose(fd);
+
+        return found == 2 ? 0 : -1;
+}
+
+void
+bench_stats_init(struct bench_stats *stats)
+{
+        uint64_t r0, w0, r1, w1;
+
+        memset(stats, 0, sizeof(*stats));
+        stats->min_ns = UINT64_MAX;
+
+        if (bench_syscalls(&r0, &w0) == 0 && bench_syscalls(&r1, &w1) == 0) {
+                stats->syscr_self = r1 - r0;
+                stats->syscw_self = w1 - w0;
+        }
+}
+
+void
+bench_sample_start(struct bench_sample *sample)
+{
+        (void)bench_syscalls(&sample->syscr, &sample->syscw);
+        sample->start_ns = bench_time_ns();
+}
+
+void
+bench_sample_stop(const struct bench_sample *sample, struct bench_stats *stats)
+{
+        const uint64_t duration = bench_time_ns() - sample->start_ns;
+        uint64_t syscr, syscw;
+
+        if (bench_syscalls(&syscr, &syscw) == 0) {
+                stats->syscr += syscr - sample->syscr - stats->syscr_self;
+                stats->syscw += syscw - sample->syscw - stats->syscw_self;
+        }
+
+        if (duration < stats->min_ns)
+                stats->min_ns = duration;
+        if (duration > stats->max_ns)
+                stats->max_ns = duration;
+        stats->total_ns += duration;
+        stats->count++;
+}
+
+void
+bench_stats_print(const struct bench_stats *stats, const char *name)
+{
+        if (stats->count == 0) {
+                printf("%s: no samples\n", name);
+                return;
+        }
+
+        printf("%s: %u samples\n", name, stats->count);
+        printf("  latency [us]    min %.1f avg %.1f max %.1f\n",
+               (double)stats->min_ns / 1000.0,
+               (double)stats->total_ns / stats->count / 1000.0,
+               (double)stats->max_ns / 1000.0);
+        printf("  syscalls/sample read %.1f write %.1f\n",
+               (double)stats->syscr / stats->count,
+               (double)stats->syscw / stats->count);
+}
@@ -0,0 +1,125 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2022 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+/**
+ * @brief Common benchmark helpers
+ */
+
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Benchmark statistics
+ */
+struct bench_stats {
+        unsigned count;      /**< number of samples */
+        uint64_t min_ns;     /**< min sample duration */
+        uint64_t max_ns;     /**< max sample duration */
+        uint64_t total_ns;   /**< sum of sample durations */
+        uint64_t syscr;      /**< read system calls */
+        uint64_t syscw;      /**< write system calls */
+        uint64_t syscr_self; /**< read calls made by bench_syscalls() */
+        uint64_t syscw_self; /**< write calls made by bench_syscalls() */
+};
+
+/**
+ * Single benchmark sample
+ */
+struct bench_sample {
+        uint64_t start_ns; /**< timestamp at sample start */
+        uint64_t syscr;    /**< read system calls at sample start */
+        uint64_t syscw;    /**< write system calls at sample start */
+};
+
+/**
+ * @brief Returns monotonic time in nanoseconds
+ */
+uint64_t bench_time_ns(void);
+
+/**
+ * @brief Reads number of read and write system calls issued by the process
+ *
+ * Values come from /proc/self/io and include pread/pwrite calls.
+ *
+ * @param [out] syscr number of read system calls
+ * @param [out] syscw number of write system calls
+ *
+ * @return 0 on success
+ */
+int bench_syscalls(uint64_t *syscr, uint64_t *syscw);
+
+/**
+ * @brief Initializes benchmark statistics
+ *
+ * Calibrates number of system calls made by the measurement itself.
+ *
+ * @param [out] stats statistics
+ */
+void bench_stats_init(struct bench_stats *stats);
+
+/**
+ * @brief Starts benchmark sample
+ *
+ * @param [out] sample sample
+ */
+void bench_sample_start(struct bench_sample *sample);
+
+/**
+ * @brief Stops benchmark sample and accounts it in \a stats
+ *
+ * @param [in] sample sample
+ * @param [in,out] stats statistics
+ */
+void bench_sample_stop(const struct bench_sample *sample,
+                       struct bench_stats *stats);
+
+/**
+ * @brief Prints benchmark statistics
+ *
+ * @param [in] stats statistics
+ * @param [in] name name of measured operation
+ */
+void bench_stats_print(const struct bench_stats *stats, const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BENCH_H__ */
@@ -0,0 +1,138 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2022 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+
+/**
+ * @brief Library initialization benchmark
+ *
+ * Measures latency and number of read/write system calls of
+ * pqos_init() followed by pqos_fini().
+ */
+
+#include "bench.h"
+#include "pqos.h"
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_ITER 10
+
+/**
+ * @brief Prints usage
+ *
+ * @param app application name
+ */
+static void
+usage(const char *app)
+{
+        printf("Usage: %s [-I msr|os] [-T sysfs|cpuid] [-t ITER]\n"
+               "  -I   select library interface (default: auto)\n"
+               "  -T   detect CPU topology from sysfs or with CPUID on\n"
+               "       each core (default: sysfs)\n"
+               "  -t   number of initializations to measure "
+               "(default: %u)\n",
+               app, DEFAULT_ITER);
+}
+
+int
+main(int argc, char **argv)
+{
+        struct pqos_config cfg;
+        struct bench_stats stats;
+        unsigned iter = DEFAULT_ITER;
+        unsigned i;
+        int ret, opt;
+        int exit_val = EXIT_SUCCESS;
+
+        memset(&cfg, 0, sizeof(cfg));
+        cfg.fd_log = STDOUT_FILENO;
+        cfg.verbose = 0;
+        cfg.interface = PQOS_INTER_AUTO;
+
+        while ((opt = getopt(argc, argv, "I:T:t:h")) != -1) {
+                switch (opt) {
+                case 'I':
+                        if (strcasecmp(optarg, "msr") == 0)
+                                cfg.interface = PQOS_INTER_MSR;
+                        else if (strcasecmp(optarg, "os") == 0)
+                                cfg.interface = PQOS_INTER_OS;
+                        else {
+                                usage(argv[0]);
+                                return EXIT_FAILURE;
+                        }
+                        break;
+                case 'T':
+                        /* same switch as used by the library */
+                        if (strcasecmp(optarg, "cpuid") == 0 ||
+                            strcasecmp(optarg, "sysfs") == 0)
+                                setenv("RDT_TOPO", optarg, 1);
+                        else {
+                                usage(argv[0]);
+                                return EXIT_FAILURE;
+                        }
+                        break;
+                case 't':
+                        iter = (unsigned)strtoul(optarg, NULL, 0);
+                        break;
+                case 'h':
+                default:
+                        usage(argv[0]);
+                        return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+                }
+        }
+
+        bench_stats_init(&stats);
+        for (i = 0; i < iter; i++) {
+                struct bench_sample sample;
+
+                bench_sample_start(&sample);
+                ret = pqos_init(&cfg);
+                if (ret == PQOS_RETVAL_OK)
+                        ret = pqos_fini();
+                bench_sample_stop(&sample, &stats);
+
+                if (ret != PQOS_RETVAL_OK) {
+                        printf("PQoS library initialization failed!\n");
+                        exit_val = EXIT_FAILURE;
+                        break;
+                }
+        }
+
+        if (exit_val == EXIT_SUCCESS)
+                bench_stats_print(&stats, "pqos_init/pqos_fini");
+
+        return exit_val;
+}
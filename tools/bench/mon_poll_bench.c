@@ -0,0 +1,343 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2022 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+/**
+ * @brief Monitoring poll benchmark
+ *
+ * Starts monitoring groups and measures latency and number of read/write
+ * system calls of each pqos_mon_poll() call (tick).
+ */
+
+#include "bench.h"
+#include "pqos.h"
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_TICKS 100
+
+static struct pqos_mon_data **m_groups = NULL;
+static unsigned m_num_groups = 0;
+
+/**
+ * @brief Prints usage
+ *
+ * @param app application name
+ */
+static void
+usage(const char *app)
+{
+        printf("Usage: %s [-I msr|os] [-P socket|cluster|core] [-R] "
+               "[-g GROUPS] [-t TICKS] [-e llc,mbl,mbt,ipc,llcmiss]\n"
+               "  -I   select library interface (default: auto)\n"
+               "  -P   poll groups by worker thread per socket, L3 "
+               "cluster or core\n"
+               "       (default: serial poll)\n"
+               "  -R   read perf counters with rdpmc when possible\n"
+               "  -g   number of monitoring groups (default: max)\n"
+               "  -t   number of polls to measure (default: %u)\n"
+               "  -e   monitoring events (default: all supported)\n",
+               app, DEFAULT_TICKS);
+}
+
+/**
+ * @brief Parses comma separated list of monitoring events
+ *
+ * @param str event list
+ *
+ * @return event mask
+ */
+static enum pqos_mon_event
+parse_events(char *str)
+{
+        unsigned event = 0;
+        char *saveptr = NULL;
+        char *tok;
+
+        for (tok = strtok_r(str, ",", &saveptr); tok != NULL;
+             tok = strtok_r(NULL, ",", &saveptr)) {
+                if (strcmp(tok, "llc") == 0)
+                        event |= PQOS_MON_EVENT_L3_OCCUP;
+                else if (strcmp(tok, "mbl") == 0)
+                        event |= PQOS_MON_EVENT_LMEM_BW;
+                else if (strcmp(tok, "mbt") == 0)
+                        event |= PQOS_MON_EVENT_TMEM_BW;
+                else if (strcmp(tok, "ipc") == 0)
+                        event |= PQOS_PERF_EVENT_IPC;
+                else if (strcmp(tok, "llcmiss") == 0)
+                        event |= PQOS_PERF_EVENT_LLC_MISS;
+                else
+                        printf("Unknown event '%s' ignored\n", tok);
+        }
+
+        return (enum pqos_mon_event)event;
+}
+
+/**
+ * @brief Starts monitoring groups
+ *
+ * Cores are assigned to groups round robin across sockets, so each group
+ * spans all sockets and is polled on every monitoring cluster.
+ *
+ * @param cpu cpu topology
+ * @param event events to monitor
+ * @param max_groups max number of groups to start
+ *
+ * @return Operation status
+ */
+static int
+start_groups(const struct pqos_cpuinfo *cpu,
+             const enum pqos_mon_event event,
+             unsigned max_groups)
+{
+        unsigned *sockets;
+        unsigned num_sockets = 0;
+        unsigned **cores;
+        unsigned *num_cores;
+        unsigned min_cores = UINT32_MAX;
+        unsigned i, s;
+        int ret = PQOS_RETVAL_OK;
+
+        sockets = pqos_cpu_get_sockets(cpu, &num_sockets);
+        if (sockets == NULL)
+                return PQOS_RETVAL_ERROR;
+
+        cores = calloc(num_sockets, sizeof(cores[0]));
+        num_cores = calloc(num_sockets, sizeof(num_cores[0]));
+        if (cores == NULL || num_cores == NULL) {
+                ret = PQOS_RETVAL_RESOURCE;
+                goto start_groups_exit;
+        }
+
+        for (s = 0; s < num_sockets; s++) {
+                cores[s] = pqos_cpu_get_cores(cpu, sockets[s], &num_cores[s]);
+                if (cores[s] == NULL) {
+                        ret = PQOS_RETVAL_ERROR;
+                        goto start_groups_exit;
+                }
+                if (num_cores[s] < min_cores)
+                        min_cores = num_cores[s];
+        }
+
+        if (max_groups == 0 || max_groups > min_cores)
+                max_groups = min_cores;
+
+        m_groups = calloc(max_groups, sizeof(m_groups[0]));
+        if (m_groups == NULL) {
+                ret = PQOS_RETVAL_RESOURCE;
+                goto start_groups_exit;
+        }
+
+        for (i = 0; i < max_groups; i++) {
+                unsigned group_cores[num_sockets];
+
+                for (s = 0; s < num_sockets; s++)
+                        group_cores[s] = cores[s][i];
+
+                m_groups[i] = calloc(1, sizeof(*m_groups[i]));
+                if (m_groups[i] == NULL) {
+                        ret = PQOS_RETVAL_RESOURCE;
+                        break;
+                }
+
+                ret = pqos_mon_start(num_sockets, group_cores, event, NULL,
+                                     m_groups[i]);
+                if (ret != PQOS_RETVAL_OK) {
+                        printf("Failed to start group %u\n", i);
+                        free(m_groups[i]);
+                        m_groups[i] = NULL;
+                        break;
+                }
+                m_num_groups++;
+        }
+
+        /* benchmark what was started */
+        if (m_num_groups > 0)
+                ret = PQOS_RETVAL_OK;
+
+start_groups_exit:
+        if (cores != NULL)
+                for (s = 0; s < num_sockets; s++)
+                        free(cores[s]);
+        free(cores);
+        free(num_cores);
+        free(sockets);
+
+        return ret;
+}
+
+/**
+ * @brief Stops monitoring groups
+ */
+static void
+stop_groups(void)
+{
+        unsigned i;
+
+        for (i = 0; i < m_num_groups; i++) {
+                pqos_mon_stop(m_groups[i]);
+                free(m_groups[i]);
+        }
+        free(m_groups);
+        m_groups = NULL;
+        m_num_groups = 0;
+}
+
+int
+main(int argc, char **argv)
+{
+        struct pqos_config cfg;
+        const struct pqos_cpuinfo *p_cpu = NULL;
+        const struct pqos_cap *p_cap = NULL;
+        const struct pqos_capability *cap_mon = NULL;
+        enum pqos_mon_event event = (enum pqos_mon_event)0;
+        struct bench_stats stats;
+        unsigned max_groups = 0;
+        unsigned ticks = DEFAULT_TICKS;
+        unsigned i;
+        int ret, opt;
+        int exit_val = EXIT_SUCCESS;
+
+        memset(&cfg, 0, sizeof(cfg));
+        cfg.fd_log = STDOUT_FILENO;
+        cfg.verbose = 0;
+        cfg.interface = PQOS_INTER_AUTO;
+
+        while ((opt = getopt(argc, argv, "I:P:Rg:t:e:h")) != -1) {
+                switch (opt) {
+                case 'I':
+                        if (strcasecmp(optarg, "msr") == 0)
+                                cfg.interface = PQOS_INTER_MSR;
+                        else if (strcasecmp(optarg, "os") == 0)
+                                cfg.interface = PQOS_INTER_OS;
+                        else {
+                                usage(argv[0]);
+                                return EXIT_FAILURE;
+                        }
+                        break;
+                case 'P':
+                        if (strcasecmp(optarg, "socket") == 0)
+                                cfg.mon_poll = PQOS_MON_POLL_SOCKET;
+                        else if (strcasecmp(optarg, "cluster") == 0)
+                                cfg.mon_poll = PQOS_MON_POLL_CLUSTER;
+                        else if (strcasecmp(optarg, "core") == 0)
+                                cfg.mon_poll = PQOS_MON_POLL_CORE;
+                        else {
+                                usage(argv[0]);
+                                return EXIT_FAILURE;
+                        }
+                        break;
+                case 'R':
+                        cfg.perf_read = PQOS_MON_PERF_READ_RDPMC;
+                        break;
+                case 'g':
+                        max_groups = (unsigned)strtoul(optarg, NULL, 0);
+                        break;
+                case 't':
+                        ticks = (unsigned)strtoul(optarg, NULL, 0);
+                        break;
+                case 'e':
+                        event = parse_events(optarg);
+                        break;
+                case 'h':
+                default:
+                        usage(argv[0]);
+                        return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+                }
+        }
+
+        ret = pqos_init(&cfg);
+        if (ret != PQOS_RETVAL_OK) {
+                printf("Error initializing PQoS library!\n");
+                return EXIT_FAILURE;
+        }
+
+        ret = pqos_cap_get(&p_cap, &p_cpu);
+        if (ret == PQOS_RETVAL_OK)
+                ret = pqos_cap_get_type(p_cap, PQOS_CAP_TYPE_MON, &cap_mon);
+        if (ret != PQOS_RETVAL_OK) {
+                printf("Monitoring capability not detected!\n");
+                exit_val = EXIT_FAILURE;
+                goto error_exit;
+        }
+
+        if (event == 0)
+                for (i = 0; i < cap_mon->u.mon->num_events; i++) {
+                        const enum pqos_mon_event type =
+                            cap_mon->u.mon->events[i].type;
+
+                        if (type & (PQOS_MON_EVENT_L3_OCCUP |
+                                    PQOS_MON_EVENT_LMEM_BW |
+                                    PQOS_MON_EVENT_TMEM_BW))
+                                event |= type;
+                }
+
+        ret = start_groups(p_cpu, event, max_groups);
+        if (ret != PQOS_RETVAL_OK) {
+                printf("Failed to start monitoring groups!\n");
+                exit_val = EXIT_FAILURE;
+                goto error_exit;
+        }
+
+        /* first poll initializes counters */
+        (void)pqos_mon_poll(m_groups, m_num_groups);
+
+        bench_stats_init(&stats);
+        for (i = 0; i < ticks; i++) {
+                struct bench_sample sample;
+
+                bench_sample_start(&sample);
+                ret = pqos_mon_poll(m_groups, m_num_groups);
+                bench_sample_stop(&sample, &stats);
+                if (ret != PQOS_RETVAL_OK) {
+                        printf("Poll failed!\n");
+                        exit_val = EXIT_FAILURE;
+                        break;
+                }
+        }
+
+        printf("Groups: %u, events: 0x%x\n", m_num_groups, (unsigned)event);
+        bench_stats_print(&stats, "pqos_mon_poll");
+
+        stop_groups();
+
+error_exit:
+        ret = pqos_fini();
+        if (ret != PQOS_RETVAL_OK)
+                printf("Error shutting down PQoS library!\n");
+
+        return exit_val;
+}
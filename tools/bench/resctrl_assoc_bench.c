@@ -0,0 +1,297 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2022 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @brief Resctrl task association benchmark
+ *
+ * Creates mocked resctrl COS directory (tmpfs by default) and measures
+ * cost of writing a set of tasks into its tasks file (tick) using:
+ * - single: task validation and fopen()/fprintf()/fclose() for each task,
+ *           as done by repeated pqos_alloc_assoc_set_pid() calls
+ * - bulk: tasks file opened once and one write() for each task,
+ *         as done by pqos_alloc_assoc_set_pids()
+ */
+
+#include "bench.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#define DEFAULT_PIDS  1000
+#define DEFAULT_TICKS 100
+#define DEFAULT_ROOT  "/dev/shm"
+
+static char m_root[128];
+static char m_cos[160];
+static char m_tasks[192];
+static pid_t *m_pids = NULL;
+static unsigned m_num_pids = 0;
+
+/**
+ * @brief Prints usage
+ *
+ * @param app application name
+ */
+static void
+usage(const char *app)
+{
+        printf("Usage: %s [-d DIR] [-p PIDS] [-t TICKS]\n"
+               "  -d   directory to create mocked tree in (default: %s)\n"
+               "  -p   number of tasks to associate (default: %u)\n"
+               "  -t   number of ticks to measure (default: %u)\n",
+               app, DEFAULT_ROOT, DEFAULT_PIDS, DEFAULT_TICKS);
+}
+
+/**
+ * @brief Creates mocked resctrl COS directory
+ *
+ * @param dir parent directory
+ * @param num_pids number of tasks
+ *
+ * @return 0 on success
+ */
+static int
+tree_create(const char *dir, unsigned num_pids)
+{
+        unsigned i;
+        int fd;
+
+        snprintf(m_root, sizeof(m_root), "%s/pqos-bench-XXXXXX", dir);
+        if (mkdtemp(m_root) == NULL) {
+                printf("Failed to create %s: %s\n", m_root, strerror(errno));
+                return -1;
+        }
+
+        snprintf(m_cos, sizeof(m_cos), "%s/COS1", m_root);
+        if (mkdir(m_cos, 0755) != 0) {
+                printf("Failed to create %s: %s\n", m_cos, strerror(errno));
+                return -1;
+        }
+
+        snprintf(m_tasks, sizeof(m_tasks), "%s/tasks", m_cos);
+        fd = open(m_tasks, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+                printf("Failed to create %s: %s\n", m_tasks, strerror(errno));
+                return -1;
+        }
+        close(fd);
+
+        /* tasks have to pass validation, use own PID */
+        m_pids = calloc(num_pids, sizeof(m_pids[0]));
+        if (m_pids == NULL)
+                return -1;
+        m_num_pids = num_pids;
+        for (i = 0; i < num_pids; i++)
+                m_pids[i] = getpid();
+
+        return 0;
+}
+
+/**
+ * @brief Removes mocked resctrl COS directory
+ */
+static void
+tree_remove(void)
+{
+        if (m_tasks[0] != '\0')
+                unlink(m_tasks);
+        if (m_cos[0] != '\0')
+                rmdir(m_cos);
+        rmdir(m_root);
+
+        free(m_pids);
+}
+
+/**
+ * @brief Associates all tasks opening tasks file for each of them
+ *
+ * @return 0 on success
+ */
+static int
+tick_single(void)
+{
+        unsigned i;
+
+        for (i = 0; i < m_num_pids; i++) {
+                FILE *fd;
+
+                if (kill(m_pids[i], 0) != 0)
+                        return -1;
+
+                fd = fopen(m_tasks, "w");
+                if (fd == NULL)
+                        return -1;
+                if (fprintf(fd, "%d\n", (int)m_pids[i]) < 0) {
+                        fclose(fd);
+                        return -1;
+                }
+                if (fclose(fd) != 0)
+                        return -1;
+        }
+
+        return 0;
+}
+
+/**
+ * @brief Associates all tasks with tasks file opened once
+ *
+ * @return 0 on success
+ */
+static int
+tick_bulk(void)
+{
+        unsigned i;
+        int ret = 0;
+        int fd;
+
+        fd = open(m_tasks, O_WRONLY | O_TRUNC);
+        if (fd < 0)
+                return -1;
+
+        for (i = 0; i < m_num_pids; i++) {
+                char buf[16];
+                int len;
+
+                len = snprintf(buf, sizeof(buf), "%d\n", (int)m_pids[i]);
+                if (write(fd, buf, (size_t)len) != len)
+                        ret = -1;
+        }
+
+        if (close(fd) != 0)
+                ret = -1;
+
+        return ret;
+}
+
+/**
+ * @brief Measures task association method
+ *
+ * @param name method name
+ * @param tick function associating all tasks
+ * @param ticks number of ticks
+ *
+ * @return 0 on success
+ */
+static int
+measure(const char *name, int (*tick)(void), unsigned ticks)
+{
+        struct bench_stats stats;
+        unsigned i;
+
+        /* warm up */
+        if (tick() != 0) {
+                printf("%s: write failed\n", name);
+                return -1;
+        }
+
+        bench_stats_init(&stats);
+        for (i = 0; i < ticks; i++) {
+                struct bench_sample sample;
+                int ret;
+
+                bench_sample_start(&sample);
+                ret = tick();
+                bench_sample_stop(&sample, &stats);
+                if (ret != 0) {
+                        printf("%s: write failed\n", name);
+                        return -1;
+                }
+        }
+
+        bench_stats_print(&stats, name);
+        if (ticks > 0)
+                printf("  time per task: %llu ns\n",
+                       (unsigned long long)(stats.total_ns /
+                                            ((uint64_t)ticks * m_num_pids)));
+
+        return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+        const char *dir = DEFAULT_ROOT;
+        unsigned num_pids = DEFAULT_PIDS;
+        unsigned ticks = DEFAULT_TICKS;
+        int exit_val = EXIT_SUCCESS;
+        int opt;
+
+        while ((opt = getopt(argc, argv, "d:p:t:h")) != -1) {
+                switch (opt) {
+                case 'd':
+                        dir = optarg;
+                        break;
+                case 'p':
+                        num_pids = (unsigned)strtoul(optarg, NULL, 0);
+                        break;
+                case 't':
+                        ticks = (unsigned)strtoul(optarg, NULL, 0);
+                        break;
+                case 'h':
+                default:
+                        usage(argv[0]);
+                        return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+                }
+        }
+
+        if (num_pids == 0) {
+                usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+
+        if (tree_create(dir, num_pids) != 0) {
+                exit_val = EXIT_FAILURE;
+                goto error_exit;
+        }
+
+        printf("Tasks: %u\n", num_pids);
+
+        if (measure("single", tick_single, ticks) != 0)
+                exit_val = EXIT_FAILURE;
+
+        if (measure("bulk", tick_bulk, ticks) != 0)
+                exit_val = EXIT_FAILURE;
+
+error_exit:
+        tree_remove();
+
+        return exit_val;
+}
@@ -0,0 +1,453 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2022 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/**
+ * @brief Resctrl counter read benchmark
+ *
+ * Creates mocked resctrl monitoring tree (tmpfs by default) and measures
+ * cost of reading all counter files of all groups (tick) using:
+ * - open: fopen()/fscanf()/fclose() of each counter file
+ * - pread: pread() of cached file descriptors
+ * - uring: single io_uring batch of cached file descriptors
+ */
+
+#include "bench.h"
+#include "pqos.h"
+#include "uring.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define DEFAULT_GROUPS 100
+#define DEFAULT_L3IDS  2
+#define DEFAULT_TICKS  100
+#define DEFAULT_ROOT   "/dev/shm"
+
+/**
+ * Counter files of each L3 domain
+ */
+static const char *const m_events[] = {"llc_occupancy", "mbm_local_bytes",
+                                       "mbm_total_bytes"};
+
+/**
+ * Single counter file
+ */
+struct counter {
+        char path[288];         /**< counter file path */
+        int fd;                 /**< cached file descriptor */
+        char buf[32];           /**< read buffer */
+        uint64_t value;         /**< counter value */
+        struct uring_read read; /**< read request */
+};
+
+static char m_root[128];
+static struct counter *m_counters = NULL;
+static unsigned m_num_counters = 0;
+static struct uring_read **m_reads = NULL;
+
+/**
+ * @brief Prints usage
+ *
+ * @param app application name
+ */
+static void
+usage(const char *app)
+{
+        printf("Usage: %s [-d DIR] [-g GROUPS] [-l L3IDS] [-t TICKS]\n"
+               "  -d   directory to create mocked tree in (default: %s)\n"
+               "  -g   number of monitoring groups (default: %u)\n"
+               "  -l   number of L3 domains (default: %u)\n"
+               "  -t   number of ticks to measure (default: %u)\n",
+               app, DEFAULT_ROOT, DEFAULT_GROUPS, DEFAULT_L3IDS,
+               DEFAULT_TICKS);
+}
+
+/**
+ * @brief Returns CPU time used by the process in nanoseconds
+ *
+ * Includes kernel threads servicing io_uring requests of the process.
+ */
+static uint64_t
+cpu_time_ns(void)
+{
+        struct rusage ru;
+
+        if (getrusage(RUSAGE_SELF, &ru) != 0)
+                return 0;
+
+        return (uint64_t)(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) *
+                   1000000000ULL +
+               (uint64_t)(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) * 1000ULL;
+}
+
+/**
+ * @brief Creates directory path
+ *
+ * @param path directory path
+ *
+ * @return 0 on success
+ */
+static int
+make_dir(const char *path)
+{
+        if (mkdir(path, 0755) != 0 && errno != EEXIST) {
+                printf("Failed to create %s: %s\n", path, strerror(errno));
+                return -1;
+        }
+
+        return 0;
+}
+
+/**
+ * @brief Creates mocked resctrl tree
+ *
+ * @param dir parent directory
+ * @param num_groups number of monitoring groups
+ * @param num_l3ids number of L3 domains
+ *
+ * @return 0 on success
+ */
+static int
+tree_create(const char *dir, unsigned num_groups, unsigned num_l3ids)
+{
+        char path[256];
+        unsigned g, l, e, i;
+
+        snprintf(m_root, sizeof(m_root), "%s/pqos-bench-XXXXXX", dir);
+        if (mkdtemp(m_root) == NULL) {
+                printf("Failed to create %s: %s\n", m_root, strerror(errno));
+                return -1;
+        }
+
+        m_counters = calloc(num_groups * num_l3ids * DIM(m_events),
+                            sizeof(m_counters[0]));
+        m_reads = calloc(num_groups * num_l3ids * DIM(m_events),
+                         sizeof(m_reads[0]));
+        if (m_counters == NULL || m_reads == NULL)
+                return -1;
+        m_num_counters = num_groups * num_l3ids * DIM(m_events);
+        for (i = 0; i < m_num_counters; i++)
+                m_counters[i].fd = -1;
+
+        snprintf(path, sizeof(path), "%s/mon_groups", m_root);
+        if (make_dir(path) != 0)
+                return -1;
+
+        for (g = 0; g < num_groups; g++) {
+                snprintf(path, sizeof(path), "%s/mon_groups/pqos-%u", m_root,
+                         g);
+                if (make_dir(path) != 0)
+                        return -1;
+                snprintf(path, sizeof(path), "%s/mon_groups/pqos-%u/mon_data",
+                         m_root, g);
+                if (make_dir(path) != 0)
+                        return -1;
+
+                for (l = 0; l < num_l3ids; l++) {
+                        snprintf(path, sizeof(path),
+                                 "%s/mon_groups/pqos-%u/mon_data/mon_L3_%02u",
+                                 m_root, g, l);
+                        if (make_dir(path) != 0)
+                                return -1;
+
+                        for (e = 0; e < DIM(m_events); e++) {
+                                const unsigned idx =
+                                    (g * num_l3ids + l) * DIM(m_events) + e;
+                                struct counter *c = &m_counters[idx];
+                                FILE *fd;
+
+                                snprintf(c->path, sizeof(c->path), "%s/%s",
+                                         path, m_events[e]);
+                                fd = fopen(c->path, "w");
+                                if (fd == NULL) {
+                                        printf("Failed to create %s\n",
+                                               c->path);
+                                        return -1;
+                                }
+                                fprintf(fd, "%u\n", idx * 4096);
+                                fclose(fd);
+                        }
+                }
+        }
+
+        return 0;
+}
+
+/**
+ * @brief Removes mocked resctrl tree
+ *
+ * @param num_groups number of monitoring groups
+ * @param num_l3ids number of L3 domains
+ */
+static void
+tree_remove(unsigned num_groups, unsigned num_l3ids)
+{
+        char path[256];
+        unsigned g, l, i;
+
+        for (i = 0; i < m_num_counters; i++) {
+                if (m_counters[i].fd >= 0)
+                        close(m_counters[i].fd);
+                if (m_counters[i].path[0] != '\0')
+                        unlink(m_counters[i].path);
+        }
+
+        for (g = 0; g < num_groups; g++) {
+                for (l = 0; l < num_l3ids; l++) {
+                        snprintf(path, sizeof(path),
+                                 "%s/mon_groups/pqos-%u/mon_data/mon_L3_%02u",
+                                 m_root, g, l);
+                        rmdir(path);
+                }
+                snprintf(path, sizeof(path), "%s/mon_groups/pqos-%u/mon_data",
+                         m_root, g);
+                rmdir(path);
+                snprintf(path, sizeof(path), "%s/mon_groups/pqos-%u", m_root,
+                         g);
+                rmdir(path);
+        }
+        snprintf(path, sizeof(path), "%s/mon_groups", m_root);
+        rmdir(path);
+        rmdir(m_root);
+
+        free(m_counters);
+        free(m_reads);
+}
+
+/**
+ * @brief Reads all counters with fopen()/fscanf()/fclose()
+ *
+ * @return 0 on success
+ */
+static int
+tick_open(void)
+{
+        unsigned i;
+
+        for (i = 0; i < m_num_counters; i++) {
+                unsigned long long value;
+                FILE *fd = fopen(m_counters[i].path, "r");
+
+                if (fd == NULL)
+                        return -1;
+                if (fscanf(fd, "%llu", &value) == 1)
+                        m_counters[i].value = value;
+                fclose(fd);
+        }
+
+        return 0;
+}
+
+/**
+ * @brief Reads all counters with pread() of cached descriptors
+ *
+ * @return 0 on success
+ */
+static int
+tick_pread(void)
+{
+        unsigned i;
+
+        for (i = 0; i < m_num_counters; i++) {
+                struct counter *c = &m_counters[i];
+                ssize_t len = pread(c->fd, c->buf, sizeof(c->buf) - 1, 0);
+
+                if (len < 0)
+                        return -1;
+                c->buf[len] = '\0';
+                c->value = strtoull(c->buf, NULL, 10);
+        }
+
+        return 0;
+}
+
+/**
+ * @brief Reads all counters in a single batch of cached descriptors
+ *
+ * @return 0 on success
+ */
+static int
+tick_uring(void)
+{
+        unsigned i;
+
+        for (i = 0; i < m_num_counters; i++) {
+                struct counter *c = &m_counters[i];
+
+                c->read.fd = c->fd;
+                c->read.buf = c->buf;
+                c->read.size = sizeof(c->buf) - 1;
+                c->read.offset = 0;
+                m_reads[i] = &c->read;
+        }
+
+        if (uring_read(m_reads, m_num_counters) != PQOS_RETVAL_OK)
+                return -1;
+
+        for (i = 0; i < m_num_counters; i++) {
+                struct counter *c = &m_counters[i];
+
+                if (c->read.res < 0)
+                        return -1;
+                c->buf[c->read.res] = '\0';
+                c->value = strtoull(c->buf, NULL, 10);
+        }
+
+        return 0;
+}
+
+/**
+ * @brief Measures counter read method
+ *
+ * @param name method name
+ * @param tick function reading all counters
+ * @param ticks number of ticks
+ *
+ * @return 0 on success
+ */
+static int
+measure(const char *name, int (*tick)(void), unsigned ticks)
+{
+        struct bench_stats stats;
+        uint64_t cpu_ns;
+        unsigned i;
+
+        /* warm up */
+        if (tick() != 0) {
+                printf("%s: read failed\n", name);
+                return -1;
+        }
+
+        bench_stats_init(&stats);
+        cpu_ns = cpu_time_ns();
+        for (i = 0; i < ticks; i++) {
+                struct bench_sample sample;
+                int ret;
+
+                bench_sample_start(&sample);
+                ret = tick();
+                bench_sample_stop(&sample, &stats);
+                if (ret != 0) {
+                        printf("%s: read failed\n", name);
+                        return -1;
+                }
+        }
+        cpu_ns = cpu_time_ns() - cpu_ns;
+
+        bench_stats_print(&stats, name);
+        if (ticks > 0)
+                printf("  cpu per tick: %llu ns\n",
+                       (unsigned long long)(cpu_ns / ticks));
+
+        return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+        const char *dir = DEFAULT_ROOT;
+        unsigned num_groups = DEFAULT_GROUPS;
+        unsigned num_l3ids = DEFAULT_L3IDS;
+        unsigned ticks = DEFAULT_TICKS;
+        unsigned i;
+        int exit_val = EXIT_SUCCESS;
+        int opt;
+
+        while ((opt = getopt(argc, argv, "d:g:l:t:h")) != -1) {
+                switch (opt) {
+                case 'd':
+                        dir = optarg;
+                        break;
+                case 'g':
+                        num_groups = (unsigned)strtoul(optarg, NULL, 0);
+                        break;
+                case 'l':
+                        num_l3ids = (unsigned)strtoul(optarg, NULL, 0);
+                        break;
+                case 't':
+                        ticks = (unsigned)strtoul(optarg, NULL, 0);
+                        break;
+                case 'h':
+                default:
+                        usage(argv[0]);
+                        return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+                }
+        }
+
+        if (num_groups == 0 || num_l3ids == 0) {
+                usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+
+        if (tree_create(dir, num_groups, num_l3ids) != 0) {
+                exit_val = EXIT_FAILURE;
+                goto error_exit;
+        }
+
+        printf("Groups: %u, L3 domains: %u, counter files: %u\n", num_groups,
+               num_l3ids, m_num_counters);
+
+        if (measure("open", tick_open, ticks) != 0)
+                exit_val = EXIT_FAILURE;
+
+        for (i = 0; i < m_num_counters; i++) {
+                m_counters[i].fd = open(m_counters[i].path, O_RDONLY);
+                if (m_counters[i].fd < 0) {
+                        printf("Failed to open %s\n", m_counters[i].path);
+                        exit_val = EXIT_FAILURE;
+                        goto error_exit;
+                }
+        }
+
+        if (measure("pread", tick_pread, ticks) != 0)
+                exit_val = EXIT_FAILURE;
+
+        if (uring_init() == PQOS_RETVAL_OK) {
+                if (measure("uring", tick_uring, ticks) != 0)
+                        exit_val = EXIT_FAILURE;
+                uring_fini();
+        } else
+                printf("uring: io_uring not available\n");
+
+error_exit:
+        tree_remove(num_groups, num_l3ids);
+
+        return exit_val;
+}
@@ -1898,6 +1898,31 @@ test_pqos_mon_poll(void **state __attribute__((unused)))
         assert_int_equal(ret, PQOS_RETVAL_OK);
 }
 
+static void
+test_pqos_mon_poll_hw(void **state __attribute__((unused)))
+{
+        int ret;
+        struct pqos_mon_data group;
+        unsigned num_groups = 1;
+        struct pqos_mon_data *groups[] = {&group};
+
+        memset(&group, 0, sizeof(group));
+        group.valid = 0x00DEAD00;
+        group.event = PQOS_MON_EVENT_LMEM_BW;
+
+        wrap_check_init(1, PQOS_RETVAL_OK);
+
+        /* counters of all groups are read up front */
+        expect_value(__wrap_hw_mon_poll_prefetch, num_groups, num_groups);
+        will_return(__wrap_hw_mon_poll_prefetch, PQOS_RETVAL_OK);
+
+        expect_value(__wrap_pqos_mon_poll_events, group, &group);
+        will_return(__wrap_pqos_mon_poll_events, PQOS_RETVAL_OK);
+
+        ret = pqos_mon_poll(groups, num_groups);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+}
+
 static void
 test_pqos_mon_poll_param(void **state __attribute__((unused)))
 {
@@ -2688,7 +2713,7 @@ main(void)
             cmocka_unit_test(test_pqos_mon_assoc_get_hw),
             cmocka_unit_test(test_pqos_mon_start_hw),
             cmocka_unit_test(test_pqos_mon_stop_hw),
-            cmocka_unit_test(test_pqos_mon_poll),
+            cmocka_unit_test(test_pqos_mon_poll_hw),
             cmocka_unit_test(test_pqos_mon_start_pids_hw),
             cmocka_unit_test(test_pqos_mon_start_pid_hw),
             cmocka_unit_test(test_pqos_mon_add_pids_hw),
@@ -0,0 +1,408 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2022 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "cpuinfo.h"
+#include "machine.h"
+#include "test.h"
+
+#include <limits.h>
+
+/**
+ * Topology built by cpuinfo_init_from(), queries on it use the indexes.
+ * Queries on test_data cpu, which is not known to cpuinfo, take the
+ * linear path.
+ */
+static const struct pqos_cpuinfo *m_indexed;
+
+/* ======== mock ======== */
+
+void
+__wrap_lcpuid(const unsigned leaf,
+              const unsigned subleaf,
+              struct cpuid_out *out)
+{
+        assert_int_equal(leaf, 0x0);
+        assert_int_equal(subleaf, 0x0);
+
+        /* GenuineIntel */
+        out->eax = 0;
+        out->ebx = 0x756e6547;
+        out->edx = 0x49656e69;
+        out->ecx = 0x6c65746e;
+}
+
+/* ======== setup ======== */
+
+/**
+ * @brief Registers a copy of the test topology with cpuinfo
+ */
+static int
+index_init(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        struct pqos_cpuinfo *cpu;
+        size_t size;
+
+        size = sizeof(*cpu) + data->cpu->num_cores * sizeof(cpu->cores[0]);
+        cpu = malloc(size);
+        if (cpu == NULL)
+                return -1;
+        memcpy(cpu, data->cpu, size);
+
+        if (cpuinfo_init_from(cpu, &m_indexed) != 0) {
+                free(cpu);
+                return -1;
+        }
+
+        return 0;
+}
+
+static int
+test_init_index(void **state)
+{
+        int ret;
+
+        ret = test_init_unsupported(state);
+        if (ret != 0)
+                return ret;
+
+        return index_init(state);
+}
+
+/**
+ * Cores out of lcore order, object ids not contiguous and not in order of
+ * their first core
+ */
+static int
+test_init_index_sparse(void **state)
+{
+        static const unsigned lcore[] = {6, 1, 12, 3, 0, 9, 2, 7};
+        static const unsigned socket[] = {3, 0, 3, 0, 0, 3, 0, 3};
+        static const unsigned l2_id[] = {10, 4, 21, 4, 8, 10, 8, 21};
+        struct pqos_cpuinfo *cpu;
+        unsigned i;
+        int ret;
+
+        ret = test_init_unsupported(state);
+        if (ret != 0)
+                return ret;
+
+        cpu = ((struct test_data *)*state)->cpu;
+        if (cpu->num_cores != DIM(lcore))
+                return -1;
+
+        for (i = 0; i < cpu->num_cores; i++) {
+                struct pqos_coreinfo *info = &cpu->cores[i];
+
+                info->lcore = lcore[i];
+                info->socket = socket[i];
+                info->l3_id = socket[i] + 1;
+                info->l2_id = l2_id[i];
+                info->l3cat_id = socket[i];
+                info->mba_id = socket[i] * 2;
+        }
+
+        return index_init(state);
+}
+
+static int
+test_fini_index(void **state)
+{
+        cpuinfo_fini();
+        m_indexed = NULL;
+
+        return test_fini(state);
+}
+
+/* ======== helpers ======== */
+
+static void
+assert_lists_equal(const unsigned *list,
+                   const unsigned num,
+                   const unsigned *expected,
+                   const unsigned num_expected)
+{
+        unsigned i;
+
+        assert_int_equal(num, num_expected);
+        if (num_expected == 0)
+                return;
+
+        assert_non_null(list);
+        assert_non_null(expected);
+        for (i = 0; i < num; i++)
+                assert_int_equal(list[i], expected[i]);
+}
+
+typedef unsigned *(*get_ids_fn)(const struct pqos_cpuinfo *, unsigned *);
+typedef const unsigned *(*view_ids_fn)(const struct pqos_cpuinfo *,
+                                       unsigned *);
+typedef unsigned *(*get_cores_fn)(const struct pqos_cpuinfo *,
+                                  const unsigned,
+                                  unsigned *);
+typedef const unsigned *(*view_cores_fn)(const struct pqos_cpuinfo *,
+                                         const unsigned,
+                                         unsigned *);
+
+/**
+ * @brief Compares object ids and cores of each object found by indexed and
+ *        linear lookups
+ */
+static void
+check_objs(const struct pqos_cpuinfo *linear,
+           get_ids_fn get_ids,
+           view_ids_fn view_ids,
+           get_cores_fn get_cores,
+           view_cores_fn view_cores)
+{
+        unsigned *expected;
+        unsigned *ids;
+        const unsigned *view;
+        unsigned num_expected = 0;
+        unsigned num = 0;
+        unsigned i;
+
+        expected = get_ids(linear, &num_expected);
+        assert_non_null(expected);
+
+        ids = get_ids(m_indexed, &num);
+        assert_lists_equal(ids, num, expected, num_expected);
+        free(ids);
+
+        /* views are available for the indexed topology only */
+        num = 0;
+        view = view_ids(m_indexed, &num);
+        assert_lists_equal(view, num, expected, num_expected);
+        assert_null(view_ids(linear, &num));
+
+        for (i = 0; get_cores != NULL && i < num_expected; i++) {
+                unsigned *expected_cores;
+                unsigned *cores;
+                unsigned num_expected_cores = 0;
+                unsigned num_cores = 0;
+
+                expected_cores =
+                    get_cores(linear, expected[i], &num_expected_cores);
+                assert_non_null(expected_cores);
+
+                cores = get_cores(m_indexed, expected[i], &num_cores);
+                assert_lists_equal(cores, num_cores, expected_cores,
+                                   num_expected_cores);
+                free(cores);
+
+                num_cores = 0;
+                view = view_cores(m_indexed, expected[i], &num_cores);
+                assert_lists_equal(view, num_cores, expected_cores,
+                                   num_expected_cores);
+
+                free(expected_cores);
+        }
+
+        free(expected);
+}
+
+/* ======== cpuinfo_get_index ======== */
+
+static void
+test_cpuinfo_get_index(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+
+        assert_non_null(cpuinfo_get_index(m_indexed));
+        assert_null(cpuinfo_get_index(data->cpu));
+        assert_null(cpuinfo_get_index(NULL));
+}
+
+/* ======== pqos_cpu_get_* ======== */
+
+static void
+test_cpuinfo_index_sockets(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+
+        check_objs(data->cpu, pqos_cpu_get_sockets, pqos_cpu_view_sockets,
+                   pqos_cpu_get_cores, pqos_cpu_view_cores);
+}
+
+static void
+test_cpuinfo_index_l3cat_ids(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+
+        check_objs(data->cpu, pqos_cpu_get_l3cat_ids, pqos_cpu_view_l3cat_ids,
+                   pqos_cpu_get_cores_l3cat_id, pqos_cpu_view_cores_l3cat_id);
+}
+
+static void
+test_cpuinfo_index_mba_ids(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+
+        check_objs(data->cpu, pqos_cpu_get_mba_ids, pqos_cpu_view_mba_ids,
+                   NULL, NULL);
+}
+
+static void
+test_cpuinfo_index_l2ids(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+
+        check_objs(data->cpu, pqos_cpu_get_l2ids, pqos_cpu_view_l2ids, NULL,
+                   NULL);
+}
+
+static void
+test_cpuinfo_index_l3ids(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        unsigned i;
+
+        for (i = 0; i < data->cpu->num_cores; i++) {
+                const unsigned l3_id = data->cpu->cores[i].l3_id;
+                unsigned *expected;
+                unsigned *cores;
+                const unsigned *view;
+                unsigned num_expected = 0;
+                unsigned num = 0;
+
+                expected =
+                    pqos_cpu_get_cores_l3id(data->cpu, l3_id, &num_expected);
+                assert_non_null(expected);
+
+                cores = pqos_cpu_get_cores_l3id(m_indexed, l3_id, &num);
+                assert_lists_equal(cores, num, expected, num_expected);
+                free(cores);
+
+                num = 0;
+                view = pqos_cpu_view_cores_l3id(m_indexed, l3_id, &num);
+                assert_lists_equal(view, num, expected, num_expected);
+
+                free(expected);
+        }
+}
+
+static void
+test_cpuinfo_index_one_core(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        unsigned i;
+
+        for (i = 0; i < data->cpu->num_cores; i++) {
+                const struct pqos_coreinfo *info = &data->cpu->cores[i];
+                unsigned expected = UINT_MAX;
+                unsigned lcore = UINT_MAX;
+                int ret;
+
+                ret = pqos_cpu_get_one_core(data->cpu, info->socket,
+                                            &expected);
+                assert_int_equal(ret, PQOS_RETVAL_OK);
+                ret = pqos_cpu_get_one_core(m_indexed, info->socket, &lcore);
+                assert_int_equal(ret, PQOS_RETVAL_OK);
+                assert_int_equal(lcore, expected);
+
+                ret = pqos_cpu_get_one_by_l3cat_id(data->cpu, info->l3cat_id,
+                                                   &expected);
+                assert_int_equal(ret, PQOS_RETVAL_OK);
+                ret = pqos_cpu_get_one_by_l3cat_id(m_indexed, info->l3cat_id,
+                                                   &lcore);
+                assert_int_equal(ret, PQOS_RETVAL_OK);
+                assert_int_equal(lcore, expected);
+        }
+}
+
+static void
+test_cpuinfo_index_core_info(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        unsigned lcore;
+
+        for (lcore = 0; lcore < 2 * data->cpu->num_cores + 2; lcore++) {
+                const struct pqos_coreinfo *expected =
+                    pqos_cpu_get_core_info(data->cpu, lcore);
+                const struct pqos_coreinfo *info =
+                    pqos_cpu_get_core_info(m_indexed, lcore);
+
+                if (expected == NULL) {
+                        assert_null(info);
+                        continue;
+                }
+                assert_non_null(info);
+                assert_int_equal(info - m_indexed->cores,
+                                 expected - data->cpu->cores);
+        }
+}
+
+static void
+test_cpuinfo_index_unknown(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        unsigned count = 0;
+        unsigned lcore;
+        int ret;
+
+        assert_null(pqos_cpu_get_cores(data->cpu, 100, &count));
+        assert_null(pqos_cpu_get_cores(m_indexed, 100, &count));
+        assert_null(pqos_cpu_view_cores(m_indexed, 100, &count));
+        assert_null(pqos_cpu_get_cores_l3id(data->cpu, 100, &count));
+        assert_null(pqos_cpu_get_cores_l3id(m_indexed, 100, &count));
+
+        ret = pqos_cpu_get_one_core(data->cpu, 100, &lcore);
+        assert_int_equal(ret, PQOS_RETVAL_ERROR);
+        ret = pqos_cpu_get_one_core(m_indexed, 100, &lcore);
+        assert_int_equal(ret, PQOS_RETVAL_ERROR);
+}
+
+int
+main(void)
+{
+        int result = 0;
+
+        const struct CMUnitTest tests[] = {
+            cmocka_unit_test(test_cpuinfo_get_index),
+            cmocka_unit_test(test_cpuinfo_index_sockets),
+            cmocka_unit_test(test_cpuinfo_index_l3cat_ids),
+            cmocka_unit_test(test_cpuinfo_index_mba_ids),
+            cmocka_unit_test(test_cpuinfo_index_l2ids),
+            cmocka_unit_test(test_cpuinfo_index_l3ids),
+            cmocka_unit_test(test_cpuinfo_index_one_core),
+            cmocka_unit_test(test_cpuinfo_index_core_info),
+            cmocka_unit_test(test_cpuinfo_index_unknown),
+        };
+
+        result += cmocka_run_group_tests(tests, test_init_index,
+                                         test_fini_index);
+        result += cmocka_run_group_tests(tests, test_init_index_sparse,
+                                         test_fini_index);
+
+        return result;
+}
@@ -0,0 +1,283 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2020-2022 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "allocation.h"
+#include "cpu_registers.h"
+#include "mock_cap.h"
+#include "test.h"
+
+/* ======== mock ======== */
+
+enum pqos_interface
+__wrap__pqos_get_inter(void)
+{
+        return mock_type(enum pqos_interface);
+}
+
+/* ======== helpers ======== */
+
+static void
+expect_assoc_read(const unsigned lcore, const unsigned class_id)
+{
+        expect_value(__wrap_msr_read, lcore, lcore);
+        expect_value(__wrap_msr_read, reg, PQOS_MSR_ASSOC);
+        will_return(__wrap_msr_read,
+                    ((uint64_t)class_id) << PQOS_MSR_ASSOC_QECOS_SHIFT);
+        will_return(__wrap_msr_read, PQOS_RETVAL_OK);
+}
+
+static void
+expect_resync(const struct pqos_cpuinfo *cpu, const unsigned *class_id)
+{
+        unsigned i;
+
+        for (i = 0; i < cpu->num_cores; i++)
+                expect_assoc_read(cpu->cores[i].lcore, class_id[i]);
+}
+
+static int
+test_shadow_init(void **state)
+{
+        struct test_data *data;
+        int ret;
+
+        ret = test_init_l3ca(state);
+        if (ret != 0)
+                return ret;
+
+        data = (struct test_data *)*state;
+        will_return(__wrap__pqos_get_inter, PQOS_INTER_MSR);
+
+        return pqos_alloc_init(data->cpu, data->cap, NULL);
+}
+
+static int
+test_shadow_fini(void **state)
+{
+        will_return(__wrap__pqos_get_inter, PQOS_INTER_MSR);
+        pqos_alloc_fini();
+
+        return test_fini(state);
+}
+
+/* ======== hw_alloc_assoc_resync ======== */
+
+static void
+test_hw_alloc_assoc_resync(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        const unsigned cos[] = {0, 1, 2, 3, 2, 0, 0, 0};
+        unsigned class_id;
+        unsigned i;
+        int changed = -1;
+        int ret;
+
+        will_return_maybe(__wrap__pqos_get_cap, data->cap);
+        will_return_maybe(__wrap__pqos_get_cpu, data->cpu);
+
+        expect_resync(data->cpu, cos);
+        ret = hw_alloc_assoc_resync(&changed);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(changed, 0);
+
+        /* associations are read from the shadow */
+        for (i = 0; i < data->cpu->num_cores; i++) {
+                ret = hw_alloc_assoc_get(data->cpu->cores[i].lcore, &class_id);
+                assert_int_equal(ret, PQOS_RETVAL_OK);
+                assert_int_equal(class_id, cos[i]);
+        }
+}
+
+static void
+test_hw_alloc_assoc_resync_lazy(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        const unsigned cos[] = {0, 1, 2, 3, 2, 0, 0, 0};
+        unsigned class_id;
+        int ret;
+
+        will_return_maybe(__wrap__pqos_get_cap, data->cap);
+        will_return_maybe(__wrap__pqos_get_cpu, data->cpu);
+
+        /* shadow is read on first use only */
+        expect_resync(data->cpu, cos);
+        ret = hw_alloc_assoc_unused(1 << PQOS_CAP_TYPE_L3CA, 1, 0, 0,
+                                    &class_id);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(class_id, data->cap_l3ca.num_classes - 1);
+
+        ret = hw_alloc_assoc_get(3, &class_id);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(class_id, 3);
+}
+
+static void
+test_hw_alloc_assoc_resync_changed(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        const unsigned cos[] = {0, 0, 0, 0, 0, 0, 0, 0};
+        const unsigned moved[] = {0, 0, 0, 1, 0, 0, 0, 0};
+        unsigned class_id;
+        int changed = -1;
+        int ret;
+
+        will_return_maybe(__wrap__pqos_get_cap, data->cap);
+        will_return_maybe(__wrap__pqos_get_cpu, data->cpu);
+
+        expect_resync(data->cpu, cos);
+        ret = hw_alloc_assoc_resync(&changed);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(changed, 0);
+
+        expect_resync(data->cpu, moved);
+        ret = hw_alloc_assoc_resync(&changed);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(changed, 1);
+
+        ret = hw_alloc_assoc_get(3, &class_id);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(class_id, 1);
+}
+
+static void
+test_hw_alloc_assoc_resync_write(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        const unsigned cos[] = {0, 0, 0, 0, 0, 0, 0, 0};
+        unsigned class_id;
+        int changed = -1;
+        int ret;
+
+        will_return_maybe(__wrap__pqos_get_cap, data->cap);
+        will_return_maybe(__wrap__pqos_get_cpu, data->cpu);
+
+        expect_resync(data->cpu, cos);
+        ret = hw_alloc_assoc_resync(&changed);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(changed, 0);
+
+        /* written even though the core is already in COS0 */
+        expect_assoc_read(2, 0);
+        expect_value(__wrap_msr_write, lcore, 2);
+        expect_value(__wrap_msr_write, reg, PQOS_MSR_ASSOC);
+        expect_value(__wrap_msr_write, value, 0);
+        will_return(__wrap_msr_write, PQOS_RETVAL_OK);
+        ret = hw_alloc_assoc_write(2, 0);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        expect_assoc_read(2, 0);
+        expect_value(__wrap_msr_write, lcore, 2);
+        expect_value(__wrap_msr_write, reg, PQOS_MSR_ASSOC);
+        expect_value(__wrap_msr_write, value,
+                     ((uint64_t)1) << PQOS_MSR_ASSOC_QECOS_SHIFT);
+        will_return(__wrap_msr_write, PQOS_RETVAL_OK);
+        ret = hw_alloc_assoc_write(2, 1);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        ret = hw_alloc_assoc_get(2, &class_id);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(class_id, 1);
+}
+
+static void
+test_hw_alloc_assoc_resync_write_drift(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        const unsigned cos[] = {0, 0, 0, 0, 0, 0, 0, 0};
+        unsigned class_id;
+        int changed = -1;
+        int ret;
+
+        will_return_maybe(__wrap__pqos_get_cap, data->cap);
+        will_return_maybe(__wrap__pqos_get_cpu, data->cpu);
+
+        expect_resync(data->cpu, cos);
+        ret = hw_alloc_assoc_resync(&changed);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(changed, 0);
+
+        /* core 3 moved to COS2 by another tool, shadow still says COS0 */
+        expect_assoc_read(3, 2);
+        expect_value(__wrap_msr_write, lcore, 3);
+        expect_value(__wrap_msr_write, reg, PQOS_MSR_ASSOC);
+        expect_value(__wrap_msr_write, value, 0);
+        will_return(__wrap_msr_write, PQOS_RETVAL_OK);
+        ret = hw_alloc_assoc_write(3, 0);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        /* drift detected, shadow is read again on next lookup */
+        expect_resync(data->cpu, cos);
+        ret = hw_alloc_assoc_get(3, &class_id);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(class_id, 0);
+}
+
+static void
+test_hw_alloc_assoc_resync_no_shadow(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        int changed = -1;
+        int ret;
+
+        will_return_maybe(__wrap__pqos_get_cap, data->cap);
+        will_return_maybe(__wrap__pqos_get_cpu, data->cpu);
+
+        ret = hw_alloc_assoc_resync(&changed);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(changed, 0);
+}
+
+int
+main(void)
+{
+        int result = 0;
+
+        const struct CMUnitTest tests[] = {
+            cmocka_unit_test_setup_teardown(test_hw_alloc_assoc_resync,
+                                            test_shadow_init, test_shadow_fini),
+            cmocka_unit_test_setup_teardown(test_hw_alloc_assoc_resync_lazy,
+                                            test_shadow_init, test_shadow_fini),
+            cmocka_unit_test_setup_teardown(test_hw_alloc_assoc_resync_changed,
+                                            test_shadow_init, test_shadow_fini),
+            cmocka_unit_test_setup_teardown(test_hw_alloc_assoc_resync_write,
+                                            test_shadow_init, test_shadow_fini),
+            cmocka_unit_test_setup_teardown(
+                test_hw_alloc_assoc_resync_write_drift, test_shadow_init,
+                test_shadow_fini),
+            cmocka_unit_test_setup_teardown(
+                test_hw_alloc_assoc_resync_no_shadow, test_init_l3ca,
+                test_fini)};
+
+        result += cmocka_run_group_tests(tests, NULL, NULL);
+
+        return result;
+}
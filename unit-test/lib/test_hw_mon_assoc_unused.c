@@ -30,6 +30,7 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include "cpu_registers.h"
 #include "hw_monitoring.h"
 #include "mock_cap.h"
 #include "mock_perf_monitoring.h"
@@ -144,6 +145,117 @@ test_hw_alloc_assoc_unused_invalid_cluster(void **state)
         assert_int_equal(ret, PQOS_RETVAL_ERROR);
 }
 
+static void
+test_hw_mon_assoc_unused_shadow(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        int ret;
+        struct pqos_mon_poll_ctx ctx;
+
+        will_return_maybe(__wrap__pqos_get_cap, data->cap);
+        will_return_maybe(__wrap__pqos_get_cpu, data->cpu);
+
+        /* associations of both clusters are already known */
+        ctx.lcore = 1;
+        ctx.cluster = 0;
+
+        ret = hw_mon_assoc_unused(&ctx, PQOS_MON_EVENT_TMEM_BW);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(ctx.rmid, 4);
+}
+
+static void
+assoc_write(const unsigned lcore, const pqos_rmid_t old, const pqos_rmid_t rmid)
+{
+        int ret;
+
+        expect_value(__wrap_msr_read, lcore, lcore);
+        expect_value(__wrap_msr_read, reg, PQOS_MSR_ASSOC);
+        will_return(__wrap_msr_read, old);
+        will_return(__wrap_msr_read, PQOS_RETVAL_OK);
+
+        expect_value(__wrap_msr_write, lcore, lcore);
+        expect_value(__wrap_msr_write, reg, PQOS_MSR_ASSOC);
+        expect_value(__wrap_msr_write, value, rmid);
+        will_return(__wrap_msr_write, PQOS_RETVAL_OK);
+
+        ret = hw_mon_assoc_write(lcore, rmid);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+}
+
+static void
+test_hw_mon_assoc_unused_limbo(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        int ret;
+        struct pqos_mon_poll_ctx ctx;
+
+        will_return_maybe(__wrap__pqos_get_cap, data->cap);
+        will_return_maybe(__wrap__pqos_get_cpu, data->cpu);
+
+        ctx.lcore = 5;
+        ctx.cluster = 1;
+
+        ret = hw_mon_assoc_unused(&ctx, PQOS_MON_EVENT_TMEM_BW);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(ctx.rmid, 1);
+
+        /* RMID1 is used and released by core 5 */
+        assoc_write(5, 0, 1);
+        ret = hw_mon_assoc_unused(&ctx, PQOS_MON_EVENT_TMEM_BW);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(ctx.rmid, 3);
+
+        assoc_write(5, 1, 0);
+
+        /* released RMID is not handed out while other RMIDs are free */
+        ret = hw_mon_assoc_unused(&ctx, PQOS_MON_EVENT_TMEM_BW);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(ctx.rmid, 3);
+}
+
+static void
+test_hw_mon_assoc_unused_changed(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        int ret;
+        struct pqos_mon_poll_ctx ctx;
+
+        will_return_maybe(__wrap__pqos_get_cap, data->cap);
+        will_return_maybe(__wrap__pqos_get_cpu, data->cpu);
+
+        /* core 2 association changed from RMID2 to RMID4 by another tool */
+        assoc_write(2, 4, 2);
+
+        /* cluster is read again on next allocation */
+        will_return_count(hw_mon_assoc_read, PQOS_RETVAL_OK,
+                          data->cpu->num_cores / 2);
+
+        ctx.lcore = 1;
+        ctx.cluster = 0;
+
+        ret = hw_mon_assoc_unused(&ctx, PQOS_MON_EVENT_TMEM_BW);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(ctx.rmid, 4);
+}
+
+/* ======== hw_mon_assoc_verify ======== */
+
+static void
+test_hw_mon_assoc_verify(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        int changed = -1;
+        int ret;
+
+        will_return_count(hw_mon_assoc_read, PQOS_RETVAL_OK,
+                          data->cpu->num_cores);
+
+        ret = hw_mon_assoc_verify(&changed);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(changed, 0);
+}
+
 int
 main(void)
 {
@@ -151,7 +263,11 @@ main(void)
 
         const struct CMUnitTest tests[] = {
             cmocka_unit_test(test_hw_alloc_assoc_unused),
-            cmocka_unit_test(test_hw_alloc_assoc_unused_invalid_cluster)};
+            cmocka_unit_test(test_hw_alloc_assoc_unused_invalid_cluster),
+            cmocka_unit_test(test_hw_mon_assoc_unused_shadow),
+            cmocka_unit_test(test_hw_mon_assoc_unused_limbo),
+            cmocka_unit_test(test_hw_mon_assoc_unused_changed),
+            cmocka_unit_test(test_hw_mon_assoc_verify)};
 
         result += cmocka_run_group_tests(tests, test_init_mon, test_fini_mon);
 
@@ -32,6 +32,7 @@
 
 #include "hw_monitoring.h"
 #include "mock_cap.h"
+#include "mock_machine.h"
 #include "mock_perf_monitoring.h"
 #include "test.h"
 
@@ -238,6 +239,179 @@ test_hw_mon_read_counter_llc(void **state)
         assert_int_equal(group.values.llc, 5 * pmon->scale_factor);
 }
 
+static void
+test_hw_mon_read_counter_batch(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        unsigned num_cores = 2;
+        unsigned cores[] = {1, 2};
+        struct pqos_mon_data group;
+        struct pqos_mon_data_internal intl;
+        struct pqos_mon_poll_ctx ctx[2];
+        enum pqos_mon_event event = PQOS_MON_EVENT_LMEM_BW;
+        unsigned i;
+        int ret;
+
+        memset(&group, 0, sizeof(struct pqos_mon_data));
+        group.intl = &intl;
+        group.num_cores = num_cores;
+        group.cores = cores;
+        memset(&intl, 0, sizeof(struct pqos_mon_data_internal));
+        intl.hw.ctx = ctx;
+        intl.hw.num_ctx = 2;
+        memset(ctx, 0, sizeof(ctx));
+        for (i = 0; i < 2; i++) {
+                ctx[i].lcore = cores[i];
+                ctx[i].cluster = i;
+                ctx[i].rmid = 2 + i;
+        }
+
+        will_return_maybe(__wrap__pqos_get_cap, data->cap);
+        will_return_maybe(__wrap__pqos_get_cpu, data->cpu);
+
+        for (i = 0; i < 2; i++) {
+                expect_value(__wrap_msr_batch_exec, lcore, cores[i]);
+                expect_value(__wrap_msr_batch_exec, reg, PQOS_MSR_MON_EVTSEL);
+                expect_value(__wrap_msr_batch_exec, value,
+                             ((uint64_t)ctx[i].rmid << 32) | 3);
+                will_return(__wrap_msr_batch_exec, MACHINE_RETVAL_OK);
+
+                expect_value(__wrap_msr_batch_exec, lcore, cores[i]);
+                expect_value(__wrap_msr_batch_exec, reg, PQOS_MSR_MON_QMC);
+                will_return(__wrap_msr_batch_exec, 5 + i);
+                will_return(__wrap_msr_batch_exec, MACHINE_RETVAL_OK);
+        }
+
+        ret = hw_mon_read_counter(&group, event);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(group.values.mbm_local, 11);
+        assert_int_equal(group.values.mbm_local_delta, 0);
+}
+
+/* ======== hw_mon_poll_prefetch ======== */
+
+static void
+test_hw_mon_poll_prefetch(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        unsigned cores[] = {1, 2};
+        struct pqos_mon_data group[2];
+        struct pqos_mon_data_internal intl[2];
+        struct pqos_mon_data *groups[] = {&group[0], &group[1]};
+        struct pqos_mon_poll_ctx ctx[2];
+        unsigned i;
+        int ret;
+
+        memset(group, 0, sizeof(group));
+        memset(intl, 0, sizeof(intl));
+        memset(ctx, 0, sizeof(ctx));
+        for (i = 0; i < 2; i++) {
+                group[i].intl = &intl[i];
+                group[i].num_cores = 1;
+                group[i].cores = &cores[i];
+                intl[i].hw.ctx = &ctx[i];
+                intl[i].hw.num_ctx = 1;
+                ctx[i].lcore = cores[i];
+                ctx[i].cluster = i;
+                ctx[i].rmid = 2 + i;
+        }
+        intl[0].hw.event = PQOS_MON_EVENT_L3_OCCUP | PQOS_MON_EVENT_LMEM_BW;
+        intl[1].hw.event = PQOS_MON_EVENT_TMEM_BW;
+
+        will_return_maybe(__wrap__pqos_get_cap, data->cap);
+        will_return_maybe(__wrap__pqos_get_cpu, data->cpu);
+
+        /* all groups and events in one batch */
+        expect_value(__wrap_msr_batch_exec, lcore, cores[0]);
+        expect_value(__wrap_msr_batch_exec, reg, PQOS_MSR_MON_EVTSEL);
+        expect_value(__wrap_msr_batch_exec, value, ((uint64_t)2 << 32) | 1);
+        will_return(__wrap_msr_batch_exec, MACHINE_RETVAL_OK);
+        expect_value(__wrap_msr_batch_exec, lcore, cores[0]);
+        expect_value(__wrap_msr_batch_exec, reg, PQOS_MSR_MON_QMC);
+        will_return(__wrap_msr_batch_exec, 4);
+        will_return(__wrap_msr_batch_exec, MACHINE_RETVAL_OK);
+
+        expect_value(__wrap_msr_batch_exec, lcore, cores[0]);
+        expect_value(__wrap_msr_batch_exec, reg, PQOS_MSR_MON_EVTSEL);
+        expect_value(__wrap_msr_batch_exec, value, ((uint64_t)2 << 32) | 3);
+        will_return(__wrap_msr_batch_exec, MACHINE_RETVAL_OK);
+        expect_value(__wrap_msr_batch_exec, lcore, cores[0]);
+        expect_value(__wrap_msr_batch_exec, reg, PQOS_MSR_MON_QMC);
+        will_return(__wrap_msr_batch_exec, 5);
+        will_return(__wrap_msr_batch_exec, MACHINE_RETVAL_OK);
+
+        expect_value(__wrap_msr_batch_exec, lcore, cores[1]);
+        expect_value(__wrap_msr_batch_exec, reg, PQOS_MSR_MON_EVTSEL);
+        expect_value(__wrap_msr_batch_exec, value, ((uint64_t)3 << 32) | 2);
+        will_return(__wrap_msr_batch_exec, MACHINE_RETVAL_OK);
+        expect_value(__wrap_msr_batch_exec, lcore, cores[1]);
+        expect_value(__wrap_msr_batch_exec, reg, PQOS_MSR_MON_QMC);
+        will_return(__wrap_msr_batch_exec, 6);
+        will_return(__wrap_msr_batch_exec, MACHINE_RETVAL_OK);
+
+        ret = hw_mon_poll_prefetch(groups, DIM(groups));
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        /* prefetched values are read without MSR access */
+        ret = hw_mon_read_counter(&group[0], PQOS_MON_EVENT_LMEM_BW);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(group[0].values.mbm_local, 5);
+        ret = hw_mon_read_counter(&group[1], PQOS_MON_EVENT_TMEM_BW);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(group[1].values.mbm_total, 6);
+
+        /* prefetched value is used once */
+        assert_int_equal(intl[0].hw.prefetched, PQOS_MON_EVENT_L3_OCCUP);
+        assert_int_equal(intl[1].hw.prefetched, 0);
+}
+
+static void
+test_hw_mon_poll_prefetch_retry(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        unsigned cores[] = {1};
+        struct pqos_mon_data group;
+        struct pqos_mon_data_internal intl;
+        struct pqos_mon_data *groups[] = {&group};
+        struct pqos_mon_poll_ctx ctx;
+        int ret;
+
+        memset(&group, 0, sizeof(group));
+        memset(&intl, 0, sizeof(intl));
+        memset(&ctx, 0, sizeof(ctx));
+        group.intl = &intl;
+        group.num_cores = 1;
+        group.cores = cores;
+        intl.hw.ctx = &ctx;
+        intl.hw.num_ctx = 1;
+        intl.hw.event = PQOS_MON_EVENT_LMEM_BW;
+        ctx.lcore = cores[0];
+        ctx.rmid = 2;
+
+        will_return_maybe(__wrap__pqos_get_cap, data->cap);
+        will_return_maybe(__wrap__pqos_get_cpu, data->cpu);
+
+        expect_value(__wrap_msr_batch_exec, lcore, cores[0]);
+        expect_value(__wrap_msr_batch_exec, reg, PQOS_MSR_MON_EVTSEL);
+        expect_value(__wrap_msr_batch_exec, value, ((uint64_t)2 << 32) | 3);
+        will_return(__wrap_msr_batch_exec, MACHINE_RETVAL_OK);
+        expect_value(__wrap_msr_batch_exec, lcore, cores[0]);
+        expect_value(__wrap_msr_batch_exec, reg, PQOS_MSR_MON_QMC);
+        will_return(__wrap_msr_batch_exec, PQOS_MSR_MON_QMC_UNAVAILABLE);
+        will_return(__wrap_msr_batch_exec, MACHINE_RETVAL_OK);
+
+        /* counter not ready - read again with retry logic */
+        expect_value(hw_mon_read, lcore, cores[0]);
+        expect_value(hw_mon_read, rmid, 2);
+        expect_value(hw_mon_read, event, 3);
+        will_return(hw_mon_read, 0);
+        will_return(hw_mon_read, PQOS_RETVAL_ERROR);
+
+        ret = hw_mon_poll_prefetch(groups, DIM(groups));
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(intl.hw.prefetched, 0);
+}
+
 int
 main(void)
 {
@@ -246,7 +420,10 @@ main(void)
         const struct CMUnitTest tests[] = {
             cmocka_unit_test(test_hw_mon_read_counter_tmem),
             cmocka_unit_test(test_hw_mon_read_counter_lmem),
-            cmocka_unit_test(test_hw_mon_read_counter_llc)};
+            cmocka_unit_test(test_hw_mon_read_counter_llc),
+            cmocka_unit_test(test_hw_mon_read_counter_batch),
+            cmocka_unit_test(test_hw_mon_poll_prefetch),
+            cmocka_unit_test(test_hw_mon_poll_prefetch_retry)};
 
         result += cmocka_run_group_tests(tests, test_init_mon, test_fini_mon);
 
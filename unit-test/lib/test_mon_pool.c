@@ -0,0 +1,250 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2022 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include "mock_cap.h"
+#include "monitoring.h"
+#include "monitoring_pool.h"
+#include "test.h"
+
+#include <pthread.h>
+
+#define TEST_GROUPS 4
+
+/* ======== mock ======== */
+
+/**
+ * Worker threads call pqos_mon_poll_events concurrently so cmocka
+ * expectations cannot be used here. Polled groups are recorded instead.
+ */
+static pthread_mutex_t poll_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct pqos_mon_data *poll_group[TEST_GROUPS];
+static pthread_t poll_thread[TEST_GROUPS];
+static unsigned poll_count;
+static const struct pqos_mon_data *poll_fail;
+
+int
+__wrap_pqos_mon_poll_events(struct pqos_mon_data *group)
+{
+        pthread_mutex_lock(&poll_lock);
+        if (poll_count < TEST_GROUPS) {
+                poll_group[poll_count] = group;
+                poll_thread[poll_count] = pthread_self();
+        }
+        poll_count++;
+        pthread_mutex_unlock(&poll_lock);
+
+        if (group == poll_fail)
+                return PQOS_RETVAL_ERROR;
+
+        return PQOS_RETVAL_OK;
+}
+
+/* ======== helpers ======== */
+
+static struct pqos_mon_data_internal intl[TEST_GROUPS];
+static struct pqos_mon_poll_ctx ctx[TEST_GROUPS];
+static struct pqos_mon_data group[TEST_GROUPS];
+static struct pqos_mon_data *groups[TEST_GROUPS];
+
+/**
+ * Prepares groups 0 & 1 on socket 0 and groups 2 & 3 on socket 1
+ */
+static void
+test_groups_init(void)
+{
+        unsigned i;
+
+        memset(intl, 0, sizeof(intl));
+        memset(group, 0, sizeof(group));
+        for (i = 0; i < TEST_GROUPS; i++) {
+                ctx[i].lcore = (i < 2) ? i : 4 + i;
+                intl[i].hw.ctx = &ctx[i];
+                intl[i].hw.num_ctx = 1;
+                group[i].intl = &intl[i];
+                groups[i] = &group[i];
+        }
+
+        memset(poll_group, 0, sizeof(poll_group));
+        poll_count = 0;
+        poll_fail = NULL;
+}
+
+static pthread_t
+test_poll_thread(const struct pqos_mon_data *g)
+{
+        unsigned i;
+
+        for (i = 0; i < TEST_GROUPS; i++)
+                if (poll_group[i] == g)
+                        return poll_thread[i];
+
+        fail_msg("Group not polled");
+        return poll_thread[0];
+}
+
+/* ======== mon_pool_init ======== */
+
+static void
+test_mon_pool_init_serial(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        int ret;
+
+        ret = mon_pool_init(data->cpu, PQOS_MON_POLL_SERIAL);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(mon_pool_enabled(), 0);
+
+        ret = mon_pool_fini();
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+}
+
+static void
+test_mon_pool_init_param(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        int ret;
+
+        ret = mon_pool_init(data->cpu, (enum pqos_mon_poll_mode)100);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+        assert_int_equal(mon_pool_enabled(), 0);
+
+        ret = mon_pool_init(NULL, PQOS_MON_POLL_SOCKET);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+        assert_int_equal(mon_pool_enabled(), 0);
+}
+
+/* ======== mon_pool_poll ======== */
+
+static void
+test_mon_pool_poll(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        int ret;
+
+        will_return_always(__wrap__pqos_get_cpu, data->cpu);
+
+        ret = mon_pool_init(data->cpu, PQOS_MON_POLL_SOCKET);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_not_equal(mon_pool_enabled(), 0);
+
+        test_groups_init();
+        ret = mon_pool_poll(groups, TEST_GROUPS);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(poll_count, TEST_GROUPS);
+
+        /* groups of the same socket are polled by the same worker */
+        assert_true(pthread_equal(test_poll_thread(groups[0]),
+                                  test_poll_thread(groups[1])));
+        assert_true(pthread_equal(test_poll_thread(groups[2]),
+                                  test_poll_thread(groups[3])));
+        assert_false(pthread_equal(test_poll_thread(groups[0]),
+                                   test_poll_thread(groups[2])));
+
+        /* subsequent poll reuses the workers */
+        test_groups_init();
+        ret = mon_pool_poll(groups, 1);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(poll_count, 1);
+
+        ret = mon_pool_fini();
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(mon_pool_enabled(), 0);
+}
+
+static void
+test_mon_pool_poll_core(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        int ret;
+
+        will_return_always(__wrap__pqos_get_cpu, data->cpu);
+
+        ret = mon_pool_init(data->cpu, PQOS_MON_POLL_CORE);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_not_equal(mon_pool_enabled(), 0);
+
+        test_groups_init();
+        ret = mon_pool_poll(groups, TEST_GROUPS);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(poll_count, TEST_GROUPS);
+
+        /* each core has its own worker */
+        assert_false(pthread_equal(test_poll_thread(groups[0]),
+                                   test_poll_thread(groups[1])));
+        assert_false(pthread_equal(test_poll_thread(groups[2]),
+                                   test_poll_thread(groups[3])));
+
+        ret = mon_pool_fini();
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+}
+
+static void
+test_mon_pool_poll_error(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        int ret;
+
+        will_return_always(__wrap__pqos_get_cpu, data->cpu);
+
+        ret = mon_pool_init(data->cpu, PQOS_MON_POLL_CLUSTER);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        test_groups_init();
+        poll_fail = groups[2];
+        ret = mon_pool_poll(groups, TEST_GROUPS);
+        assert_int_equal(ret, PQOS_RETVAL_ERROR);
+        /* remaining groups are still polled */
+        assert_int_equal(poll_count, TEST_GROUPS);
+
+        ret = mon_pool_fini();
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+}
+
+int
+main(void)
+{
+        int result = 0;
+
+        const struct CMUnitTest tests[] = {
+            cmocka_unit_test(test_mon_pool_init_serial),
+            cmocka_unit_test(test_mon_pool_init_param),
+            cmocka_unit_test(test_mon_pool_poll),
+            cmocka_unit_test(test_mon_pool_poll_core),
+            cmocka_unit_test(test_mon_pool_poll_error)};
+
+        result += cmocka_run_group_tests(tests, test_init_unsupported,
+                                         test_fini);
+
+        return result;
+}
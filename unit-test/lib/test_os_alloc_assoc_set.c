@@ -31,6 +31,7 @@
  */
 
 #include "mock_cap.h"
+#include "mock_monitoring.h"
 #include "mock_resctrl.h"
 #include "mock_resctrl_alloc.h"
 #include "mock_resctrl_monitoring.h"
@@ -181,6 +182,111 @@ test_os_alloc_assoc_set_pid_param(void **state)
         assert_int_equal(ret, PQOS_RETVAL_PARAM);
 }
 
+/* ======== os_alloc_assoc_set_pids ======== */
+
+static void
+test_os_alloc_assoc_set_pids(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        int ret;
+        unsigned class_id = 1;
+        pid_t tasks[] = {2, 3, 4};
+        int status[DIM(tasks)];
+
+        will_return_maybe(__wrap__pqos_get_cap, data->cap);
+        will_return_maybe(__wrap__pqos_get_cpu, data->cpu);
+
+        will_return(__wrap_resctrl_lock_exclusive, PQOS_RETVAL_OK);
+        will_return(__wrap_resctrl_lock_release, PQOS_RETVAL_OK);
+
+        will_return(__wrap_resctrl_mon_active, PQOS_RETVAL_OK);
+        will_return(__wrap_resctrl_mon_active, 0);
+
+        expect_value(__wrap_resctrl_alloc_tasks_write, class_id, class_id);
+        expect_value(__wrap_resctrl_alloc_tasks_write, num_tasks, DIM(tasks));
+        will_return(__wrap_resctrl_alloc_tasks_write, PQOS_RETVAL_OK);
+
+        ret = os_alloc_assoc_set_pids(tasks, DIM(tasks), class_id, status);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(status[0], PQOS_RETVAL_OK);
+        assert_int_equal(status[2], PQOS_RETVAL_OK);
+}
+
+static void
+test_os_alloc_assoc_set_pids_active_mon(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        int ret;
+        unsigned class_id = 1;
+        pid_t tasks[] = {2, 3};
+
+        will_return_maybe(__wrap__pqos_get_cap, data->cap);
+        will_return_maybe(__wrap__pqos_get_cpu, data->cpu);
+
+        will_return(__wrap_resctrl_lock_exclusive, PQOS_RETVAL_OK);
+        will_return(__wrap_resctrl_lock_release, PQOS_RETVAL_OK);
+
+        will_return(__wrap_resctrl_mon_active, PQOS_RETVAL_OK);
+        will_return(__wrap_resctrl_mon_active, 1);
+
+        /* only first task is monitored */
+        expect_value(__wrap_resctrl_mon_assoc_get_pids, num_tasks, DIM(tasks));
+        will_return(__wrap_resctrl_mon_assoc_get_pids, PQOS_RETVAL_OK);
+        will_return(__wrap_resctrl_mon_assoc_get_pids, "test");
+        will_return(__wrap_resctrl_mon_assoc_get_pids, NULL);
+
+        expect_value(__wrap_resctrl_alloc_tasks_write, class_id, class_id);
+        expect_value(__wrap_resctrl_alloc_tasks_write, num_tasks, DIM(tasks));
+        will_return(__wrap_resctrl_alloc_tasks_write, PQOS_RETVAL_OK);
+
+        expect_value(__wrap_resctrl_mon_assoc_set_pids, class_id, class_id);
+        expect_value(__wrap_resctrl_mon_assoc_set_pids, task, tasks[0]);
+        expect_string(__wrap_resctrl_mon_assoc_set_pids, name, "test");
+        will_return(__wrap_resctrl_mon_assoc_set_pids, PQOS_RETVAL_OK);
+
+        ret = os_alloc_assoc_set_pids(tasks, DIM(tasks), class_id, NULL);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+}
+
+static void
+test_os_alloc_assoc_set_pids_missing(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        int ret;
+        unsigned class_id = 1;
+        pid_t tasks[] = {2, 3};
+
+        will_return_maybe(__wrap__pqos_get_cap, data->cap);
+        will_return_maybe(__wrap__pqos_get_cpu, data->cpu);
+
+        will_return(__wrap_resctrl_lock_exclusive, PQOS_RETVAL_OK);
+        will_return(__wrap_resctrl_lock_release, PQOS_RETVAL_OK);
+
+        will_return(__wrap_resctrl_mon_active, PQOS_RETVAL_OK);
+        will_return(__wrap_resctrl_mon_active, 0);
+
+        expect_value(__wrap_resctrl_alloc_tasks_write, class_id, class_id);
+        expect_value(__wrap_resctrl_alloc_tasks_write, num_tasks, DIM(tasks));
+        will_return(__wrap_resctrl_alloc_tasks_write, PQOS_RETVAL_PARAM);
+
+        ret = os_alloc_assoc_set_pids(tasks, DIM(tasks), class_id, NULL);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+}
+
+static void
+test_os_alloc_assoc_set_pids_param(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        int ret;
+        pid_t tasks[] = {2, 3};
+
+        will_return_maybe(__wrap__pqos_get_cap, data->cap);
+        will_return_maybe(__wrap__pqos_get_cpu, data->cpu);
+
+        ret = os_alloc_assoc_set_pids(tasks, DIM(tasks), 100, NULL);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+}
+
 int
 main(void)
 {
@@ -198,7 +304,11 @@ main(void)
             cmocka_unit_test(test_os_alloc_assoc_set_active_mon),
             cmocka_unit_test(test_os_alloc_assoc_set_pid),
             cmocka_unit_test(test_os_alloc_assoc_set_pid_param),
-            cmocka_unit_test(test_os_alloc_assoc_set_pid_active_mon)};
+            cmocka_unit_test(test_os_alloc_assoc_set_pid_active_mon),
+            cmocka_unit_test(test_os_alloc_assoc_set_pids),
+            cmocka_unit_test(test_os_alloc_assoc_set_pids_active_mon),
+            cmocka_unit_test(test_os_alloc_assoc_set_pids_missing),
+            cmocka_unit_test(test_os_alloc_assoc_set_pids_param)};
 
         const struct CMUnitTest tests_unsupported[] = {};
 
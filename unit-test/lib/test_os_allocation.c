@@ -902,13 +902,9 @@ test_os_alloc_assign_pid(void **state)
         will_return(__wrap_resctrl_alloc_get_unused_group, PQOS_RETVAL_OK);
         will_return(__wrap_resctrl_alloc_get_unused_group, 2);
 
-        expect_value(__wrap_resctrl_alloc_task_write, task, task_array[0]);
-        expect_value(__wrap_resctrl_alloc_task_write, class_id, 2);
-        will_return(__wrap_resctrl_alloc_task_write, PQOS_RETVAL_OK);
-
-        expect_value(__wrap_resctrl_alloc_task_write, task, task_array[1]);
-        expect_value(__wrap_resctrl_alloc_task_write, class_id, 2);
-        will_return(__wrap_resctrl_alloc_task_write, PQOS_RETVAL_OK);
+        expect_value(__wrap_resctrl_alloc_tasks_write, class_id, 2);
+        expect_value(__wrap_resctrl_alloc_tasks_write, num_tasks, task_num);
+        will_return(__wrap_resctrl_alloc_tasks_write, PQOS_RETVAL_OK);
 
         ret = os_alloc_assign_pid(technology, task_array, task_num, &class_id);
         assert_int_equal(ret, PQOS_RETVAL_OK);
@@ -927,13 +923,9 @@ test_os_alloc_release_pid(void **state __attribute__((unused)))
         will_return(__wrap_resctrl_lock_exclusive, PQOS_RETVAL_OK);
         will_return(__wrap_resctrl_lock_release, PQOS_RETVAL_OK);
 
-        expect_value(__wrap_resctrl_alloc_task_write, task, task_array[0]);
-        expect_value(__wrap_resctrl_alloc_task_write, class_id, 0);
-        will_return(__wrap_resctrl_alloc_task_write, PQOS_RETVAL_OK);
-
-        expect_value(__wrap_resctrl_alloc_task_write, task, task_array[1]);
-        expect_value(__wrap_resctrl_alloc_task_write, class_id, 0);
-        will_return(__wrap_resctrl_alloc_task_write, PQOS_RETVAL_OK);
+        expect_value(__wrap_resctrl_alloc_tasks_write, class_id, 0);
+        expect_value(__wrap_resctrl_alloc_tasks_write, num_tasks, task_num);
+        will_return(__wrap_resctrl_alloc_tasks_write, PQOS_RETVAL_OK);
 
         ret = os_alloc_release_pid(task_array, task_num);
         assert_int_equal(ret, PQOS_RETVAL_OK);
@@ -0,0 +1,278 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2022 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "monitoring.h"
+#include "os_monitoring.h"
+#include "proc_conn.h"
+#include "test.h"
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/** tasks of fake threads reported by proc connector */
+#define TEST_TID_BASE 4000000
+
+/** Processes monitored by the test */
+static pid_t m_tasks[3];
+
+/** Process events returned by next proc_conn_read() */
+static struct proc_conn_event m_events[4];
+static unsigned m_num_events;
+
+/* ======== mock ======== */
+
+int
+__wrap_proc_conn_init(void)
+{
+        return PQOS_RETVAL_OK;
+}
+
+void
+__wrap_proc_conn_fini(void)
+{
+}
+
+int
+__wrap_proc_conn_enabled(void)
+{
+        return 1;
+}
+
+int
+__wrap_proc_conn_read(proc_conn_cb_t cb, void *arg)
+{
+        unsigned i;
+
+        for (i = 0; i < m_num_events; i++)
+                cb(&m_events[i], arg);
+        m_num_events = 0;
+
+        return PQOS_RETVAL_OK;
+}
+
+int
+__wrap_perf_mon_start_task(struct pqos_mon_data *group,
+                           const pid_t tid,
+                           struct pqos_mon_perf_ctx *ctx)
+{
+        assert_non_null(group);
+        assert_non_null(ctx);
+        check_expected(tid);
+
+        return mock_type(int);
+}
+
+int
+__wrap_perf_mon_stop_task(struct pqos_mon_data *group,
+                          struct pqos_mon_perf_ctx *ctx)
+{
+        assert_non_null(group);
+        assert_non_null(ctx);
+
+        return mock_type(int);
+}
+
+/* ======== helpers ======== */
+
+static struct pqos_mon_data *
+group_alloc(void)
+{
+        struct pqos_mon_data *group = calloc(1, sizeof(*group));
+
+        assert_non_null(group);
+        group->intl = calloc(1, sizeof(*group->intl));
+        assert_non_null(group->intl);
+
+        return group;
+}
+
+static void
+group_free(struct pqos_mon_data *group)
+{
+        free(group->pids);
+        free(group->intl);
+        free(group);
+}
+
+static void
+expect_start_events(const unsigned count)
+{
+        expect_value_count(__wrap_perf_mon_is_event_supported, event,
+                           PQOS_PERF_EVENT_LLC_MISS, count);
+        will_return_count(__wrap_perf_mon_is_event_supported, 1, count);
+        expect_value_count(__wrap_perf_mon_start, event,
+                           PQOS_PERF_EVENT_LLC_MISS, count);
+        will_return_count(__wrap_perf_mon_start, PQOS_RETVAL_OK, count);
+}
+
+static void
+expect_stop_events(const unsigned count)
+{
+        expect_value_count(__wrap_perf_mon_stop, event,
+                           PQOS_PERF_EVENT_LLC_MISS, count);
+        will_return_count(__wrap_perf_mon_stop, PQOS_RETVAL_OK, count);
+}
+
+static void
+thread_created(const pid_t tid, const pid_t tgid)
+{
+        struct proc_conn_event *event = &m_events[m_num_events++];
+
+        memset(event, 0, sizeof(*event));
+        event->type = PROC_CONN_EVENT_FORK;
+        event->pid = tid;
+        event->tgid = tgid;
+        event->parent_pid = tgid;
+        event->parent_tgid = tgid;
+}
+
+/* ======== setup ======== */
+
+static int
+test_init_tasks(void **state __attribute__((unused)))
+{
+        unsigned i;
+
+        for (i = 0; i < DIM(m_tasks); i++) {
+                m_tasks[i] = fork();
+                if (m_tasks[i] == 0)
+                        for (;;)
+                                pause();
+                if (m_tasks[i] < 0)
+                        return -1;
+        }
+
+        return 0;
+}
+
+static int
+test_fini_tasks(void **state __attribute__((unused)))
+{
+        unsigned i;
+
+        for (i = 0; i < DIM(m_tasks); i++) {
+                if (m_tasks[i] <= 0)
+                        continue;
+                kill(m_tasks[i], SIGKILL);
+                waitpid(m_tasks[i], NULL, 0);
+        }
+
+        return 0;
+}
+
+/* ======== os_mon_track_poll ======== */
+
+static void
+test_os_mon_track_poll_add_remove_pids(void **state __attribute__((unused)))
+{
+        struct pqos_mon_data *group = group_alloc();
+        struct pqos_mon_data *other = group_alloc();
+        const pid_t pid = m_tasks[0];
+        const pid_t added = m_tasks[1];
+        const pid_t other_pid = m_tasks[2];
+        int ret;
+
+        ret = os_mon_track_init(PQOS_MON_PID_TRACK_THREADS);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        expect_start_events(2);
+        ret = os_mon_start_pids(1, &pid, PQOS_PERF_EVENT_LLC_MISS, NULL,
+                                group);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        ret = os_mon_start_pids(1, &other_pid, PQOS_PERF_EVENT_LLC_MISS, NULL,
+                                other);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        /* threads of added process are followed */
+        expect_start_events(1);
+        ret = os_mon_add_pids(1, &added, group);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(group->tid_nr, 2);
+
+        thread_created(TEST_TID_BASE + 1, added);
+        expect_value(__wrap_perf_mon_start_task, tid, TEST_TID_BASE + 1);
+        will_return(__wrap_perf_mon_start_task, PQOS_RETVAL_OK);
+        ret = os_mon_track_poll();
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(group->tid_nr, 3);
+
+        /* threads of removed process are not followed */
+        expect_stop_events(1);
+        ret = os_mon_remove_pids(1, &added, group);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(group->tid_nr, 1);
+
+        thread_created(TEST_TID_BASE + 2, added);
+        ret = os_mon_track_poll();
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(group->tid_nr, 1);
+
+        /* stopped group is not followed, remaining group takes its slot */
+        expect_stop_events(1);
+        ret = os_mon_stop(group);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        thread_created(TEST_TID_BASE + 3, pid);
+        thread_created(TEST_TID_BASE + 4, added);
+        thread_created(TEST_TID_BASE + 5, other_pid);
+        expect_value(__wrap_perf_mon_start_task, tid, TEST_TID_BASE + 5);
+        will_return(__wrap_perf_mon_start_task, PQOS_RETVAL_OK);
+        ret = os_mon_track_poll();
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(other->tid_nr, 2);
+
+        expect_stop_events(1);
+        ret = os_mon_stop(other);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        os_mon_track_fini();
+
+        group_free(group);
+        group_free(other);
+}
+
+int
+main(void)
+{
+        int result = 0;
+
+        const struct CMUnitTest tests[] = {
+            cmocka_unit_test(test_os_mon_track_poll_add_remove_pids),
+        };
+
+        result +=
+            cmocka_run_group_tests(tests, test_init_tasks, test_fini_tasks);
+
+        return result;
+}
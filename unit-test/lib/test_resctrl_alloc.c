@@ -347,6 +347,298 @@ test_resctrl_alloc_task_validate_error(void **state __attribute__((unused)))
         assert_int_equal(ret, PQOS_RETVAL_ERROR);
 }
 
+/* ======== resctrl_alloc_task_search ======== */
+
+static void
+expect_tasks_read(const unsigned num_classes, FILE **files)
+{
+        static char tasks_cos0[] = "1\n2\n";
+        static char tasks_cos1[] = "3\n";
+        static char tasks_empty[] = "\n";
+        unsigned i;
+
+        for (i = 0; i < num_classes; i++) {
+                if (i == 0)
+                        files[i] = fmemopen(tasks_cos0, strlen(tasks_cos0),
+                                            "r");
+                else if (i == 1)
+                        files[i] = fmemopen(tasks_cos1, strlen(tasks_cos1),
+                                            "r");
+                else
+                        files[i] = fmemopen(tasks_empty, strlen(tasks_empty),
+                                            "r");
+                assert_non_null(files[i]);
+
+                expect_value(resctrl_alloc_fopen, class_id, i);
+                expect_string(resctrl_alloc_fopen, name, "tasks");
+                expect_string(resctrl_alloc_fopen, mode, "r");
+                will_return(resctrl_alloc_fopen, files[i]);
+        }
+}
+
+static void
+test_resctrl_alloc_task_search(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        const unsigned num_classes = data->cap_l3ca.num_classes;
+        FILE *files[2][num_classes];
+        unsigned class_id;
+        unsigned i;
+        int ret;
+
+        resctrl_alloc_task_index_invalidate();
+
+        /* index is built with single pass over tasks files */
+        expect_value(__wrap_kill, pid, 3);
+        expect_value(__wrap_kill, sig, 0);
+        will_return(__wrap_kill, 0);
+        expect_tasks_read(num_classes, files[0]);
+
+        ret = resctrl_alloc_task_search(&class_id, data->cap, 3);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(class_id, 1);
+
+        /* following lookups use the index */
+        ret = resctrl_alloc_task_search(&class_id, data->cap, 2);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(class_id, 0);
+
+        /* task missing in the index is searched once more */
+        expect_value(__wrap_kill, pid, 5);
+        expect_value(__wrap_kill, sig, 0);
+        will_return(__wrap_kill, 0);
+        expect_tasks_read(num_classes, files[1]);
+
+        ret = resctrl_alloc_task_search(&class_id, data->cap, 5);
+        assert_int_equal(ret, PQOS_RETVAL_ERROR);
+
+        for (i = 0; i < num_classes; i++) {
+                fclose(files[0][i]);
+                fclose(files[1][i]);
+        }
+        resctrl_alloc_task_index_invalidate();
+}
+
+static void
+test_resctrl_alloc_task_search_task_write(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        const unsigned num_classes = data->cap_l3ca.num_classes;
+        FILE *files[num_classes];
+        char buf[16];
+        FILE *fd;
+        unsigned class_id;
+        unsigned i;
+        int ret;
+
+        resctrl_alloc_task_index_invalidate();
+
+        expect_value(__wrap_kill, pid, 1);
+        expect_value(__wrap_kill, sig, 0);
+        will_return(__wrap_kill, 0);
+        expect_tasks_read(num_classes, files);
+
+        ret = resctrl_alloc_task_search(&class_id, data->cap, 1);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(class_id, 0);
+
+        /* own write updates the index */
+        fd = fmemopen(buf, sizeof(buf), "w");
+        assert_non_null(fd);
+        expect_value(__wrap_kill, pid, 1);
+        expect_value(__wrap_kill, sig, 0);
+        will_return(__wrap_kill, 0);
+        expect_value(resctrl_alloc_fopen, class_id, 1);
+        expect_string(resctrl_alloc_fopen, name, "tasks");
+        expect_string(resctrl_alloc_fopen, mode, "w");
+        will_return(resctrl_alloc_fopen, fd);
+
+        ret = resctrl_alloc_task_write(1, 1);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        ret = resctrl_alloc_task_search(&class_id, data->cap, 1);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(class_id, 1);
+
+        fclose(fd);
+        for (i = 0; i < num_classes; i++)
+                fclose(files[i]);
+        resctrl_alloc_task_index_invalidate();
+}
+
+/* ======== resctrl_alloc_assoc_get_pids ======== */
+
+static void
+test_resctrl_alloc_assoc_get_pids(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        const unsigned num_classes = data->cap_l3ca.num_classes;
+        FILE *files[num_classes];
+        pid_t tasks[] = {3, 5, 4, 1};
+        unsigned class_ids[DIM(tasks)];
+        int status[DIM(tasks)];
+        unsigned i;
+        int ret;
+
+        will_return_maybe(__wrap__pqos_get_cap, data->cap);
+
+        resctrl_alloc_task_index_invalidate();
+
+        /* tasks files are read once for all tasks */
+        expect_tasks_read(num_classes, files);
+
+        /* task 5 exited */
+        expect_value(__wrap_kill, pid, 5);
+        expect_value(__wrap_kill, sig, 0);
+        will_return(__wrap_kill, -1);
+
+        /* task 4 exists but is not in any tasks file */
+        expect_value(__wrap_kill, pid, 4);
+        expect_value(__wrap_kill, sig, 0);
+        will_return(__wrap_kill, 0);
+
+        ret = resctrl_alloc_assoc_get_pids(tasks, DIM(tasks), class_ids,
+                                           status);
+        assert_int_equal(ret, PQOS_RETVAL_ERROR);
+        assert_int_equal(status[0], PQOS_RETVAL_OK);
+        assert_int_equal(class_ids[0], 1);
+        assert_int_equal(status[1], PQOS_RETVAL_PARAM);
+        assert_int_equal(status[2], PQOS_RETVAL_ERROR);
+        assert_int_equal(status[3], PQOS_RETVAL_OK);
+        assert_int_equal(class_ids[3], 0);
+
+        for (i = 0; i < num_classes; i++)
+                fclose(files[i]);
+        resctrl_alloc_task_index_invalidate();
+}
+
+static void
+test_resctrl_alloc_assoc_get_pids_missing(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        const unsigned num_classes = data->cap_l3ca.num_classes;
+        FILE *files[num_classes];
+        pid_t tasks[] = {5, 2};
+        unsigned class_ids[DIM(tasks)];
+        unsigned i;
+        int ret;
+
+        will_return_maybe(__wrap__pqos_get_cap, data->cap);
+
+        resctrl_alloc_task_index_invalidate();
+
+        expect_tasks_read(num_classes, files);
+
+        expect_value(__wrap_kill, pid, 5);
+        expect_value(__wrap_kill, sig, 0);
+        will_return(__wrap_kill, -1);
+
+        /* exited task does not stop lookup of the others */
+        ret = resctrl_alloc_assoc_get_pids(tasks, DIM(tasks), class_ids, NULL);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+        assert_int_equal(class_ids[1], 0);
+
+        for (i = 0; i < num_classes; i++)
+                fclose(files[i]);
+        resctrl_alloc_task_index_invalidate();
+}
+
+/* ======== resctrl_alloc_assoc_get_pid ======== */
+
+static void
+test_resctrl_alloc_assoc_get_pid(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        const unsigned num_classes = data->cap_l3ca.num_classes;
+        static char tasks_cos1[] = "3\n";
+        static char tasks_empty[] = "\n";
+        FILE *files[num_classes];
+        unsigned class_id;
+        unsigned i;
+        int ret;
+
+        will_return_maybe(__wrap__pqos_get_cap, data->cap);
+
+        resctrl_alloc_task_index_invalidate();
+
+        expect_value(__wrap_kill, pid, 3);
+        expect_value(__wrap_kill, sig, 0);
+        will_return(__wrap_kill, 0);
+
+        /* search starts at highest COS and stops at the match */
+        for (i = num_classes - 1; i >= 1; i--) {
+                if (i == 1)
+                        files[i] = fmemopen(tasks_cos1, strlen(tasks_cos1),
+                                            "r");
+                else
+                        files[i] = fmemopen(tasks_empty, strlen(tasks_empty),
+                                            "r");
+                assert_non_null(files[i]);
+
+                expect_value(resctrl_alloc_fopen, class_id, i);
+                expect_string(resctrl_alloc_fopen, name, "tasks");
+                expect_string(resctrl_alloc_fopen, mode, "r");
+                will_return(resctrl_alloc_fopen, files[i]);
+        }
+
+        ret = resctrl_alloc_assoc_get_pid(3, &class_id);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(class_id, 1);
+
+        for (i = num_classes - 1; i >= 1; i--)
+                fclose(files[i]);
+}
+
+/* ======== resctrl_alloc_tasks_write ======== */
+
+static void
+test_resctrl_alloc_tasks_write(void **state __attribute__((unused)))
+{
+        pid_t tasks[] = {1, 0, 2};
+        int status[DIM(tasks)];
+        char buf[16];
+        size_t len;
+        FILE *fd;
+        int ret;
+
+        /* tasks file is opened once for all tasks */
+        fd = tmpfile();
+        assert_non_null(fd);
+        expect_value(resctrl_alloc_fopen, class_id, 1);
+        expect_string(resctrl_alloc_fopen, name, "tasks");
+        expect_string(resctrl_alloc_fopen, mode, "w");
+        will_return(resctrl_alloc_fopen, fd);
+
+        ret = resctrl_alloc_tasks_write(1, tasks, DIM(tasks), status);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+        assert_int_equal(status[0], PQOS_RETVAL_OK);
+        assert_int_equal(status[1], PQOS_RETVAL_PARAM);
+        assert_int_equal(status[2], PQOS_RETVAL_OK);
+
+        /* invalid task does not stop the remaining writes */
+        rewind(fd);
+        len = fread(buf, 1, sizeof(buf) - 1, fd);
+        buf[len] = '\0';
+        assert_string_equal(buf, "1\n2\n");
+
+        fclose(fd);
+}
+
+static void
+test_resctrl_alloc_tasks_write_fopen(void **state __attribute__((unused)))
+{
+        pid_t tasks[] = {1, 2};
+        int ret;
+
+        expect_value(resctrl_alloc_fopen, class_id, 1);
+        expect_string(resctrl_alloc_fopen, name, "tasks");
+        expect_string(resctrl_alloc_fopen, mode, "w");
+        will_return(resctrl_alloc_fopen, NULL);
+
+        ret = resctrl_alloc_tasks_write(1, tasks, DIM(tasks), NULL);
+        assert_int_equal(ret, PQOS_RETVAL_ERROR);
+}
+
 int
 main(void)
 {
@@ -354,7 +646,12 @@ main(void)
 
         const struct CMUnitTest tests_l3ca[] = {
             cmocka_unit_test(test_resctrl_alloc_get_grps_num_l3),
-            cmocka_unit_test(test_resctrl_alloc_schemata_write_l3ca)};
+            cmocka_unit_test(test_resctrl_alloc_schemata_write_l3ca),
+            cmocka_unit_test(test_resctrl_alloc_task_search),
+            cmocka_unit_test(test_resctrl_alloc_task_search_task_write),
+            cmocka_unit_test(test_resctrl_alloc_assoc_get_pids),
+            cmocka_unit_test(test_resctrl_alloc_assoc_get_pids_missing),
+            cmocka_unit_test(test_resctrl_alloc_assoc_get_pid)};
 
         const struct CMUnitTest tests_l2ca[] = {
             cmocka_unit_test(test_resctrl_alloc_get_grps_num_l2),
@@ -376,7 +673,9 @@ main(void)
             cmocka_unit_test(test_resctrl_alloc_schemata_read_fopen),
             cmocka_unit_test(test_resctrl_alloc_schemata_write_fopen),
             cmocka_unit_test(test_resctrl_alloc_task_validate_ok),
-            cmocka_unit_test(test_resctrl_alloc_task_validate_error)};
+            cmocka_unit_test(test_resctrl_alloc_task_validate_error),
+            cmocka_unit_test(test_resctrl_alloc_tasks_write),
+            cmocka_unit_test(test_resctrl_alloc_tasks_write_fopen)};
 
         result += cmocka_run_group_tests(tests_l3ca, test_init_l3ca, test_fini);
         result += cmocka_run_group_tests(tests_l2ca, test_init_l2ca, test_fini);
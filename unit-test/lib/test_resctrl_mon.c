@@ -34,7 +34,9 @@
 #include "resctrl_monitoring.h"
 #include "test.h"
 
+#include <stdio.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 /* ======== mock ======== */
 
@@ -95,12 +97,96 @@ test_resctrl_mon_rmdir(void **state __attribute__((unused)))
         assert_int_equal(ret, PQOS_RETVAL_OK);
 }
 
+/* ======== resctrl_mon_counter_pread ======== */
+
+/**
+ * @brief Replaces content of the counter file
+ */
+static void
+test_counter_write(FILE *fd, const char *text)
+{
+        assert_int_equal(ftruncate(fileno(fd), 0), 0);
+        assert_int_equal(pwrite(fileno(fd), text, strlen(text), 0),
+                         (ssize_t)strlen(text));
+}
+
+static void
+test_resctrl_mon_counter_pread(void **state __attribute__((unused)))
+{
+        int ret;
+        uint64_t value;
+        FILE *fd = tmpfile();
+
+        assert_non_null(fd);
+
+        test_counter_write(fd, "123456789\n");
+        ret = resctrl_mon_counter_pread(fileno(fd), &value);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(value, 123456789);
+
+        /* file is re-read from the beginning */
+        test_counter_write(fd, "18446744073709551614\n");
+        ret = resctrl_mon_counter_pread(fileno(fd), &value);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(value, 18446744073709551614LLU);
+
+        test_counter_write(fd, "42");
+        ret = resctrl_mon_counter_pread(fileno(fd), &value);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(value, 42);
+
+        fclose(fd);
+}
+
+static void
+test_resctrl_mon_counter_pread_unavailable(void **state
+                                           __attribute__((unused)))
+{
+        int ret;
+        uint64_t value;
+        FILE *fd = tmpfile();
+
+        assert_non_null(fd);
+
+        test_counter_write(fd, "Unavailable\n");
+        ret = resctrl_mon_counter_pread(fileno(fd), &value);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(value, 0);
+
+        test_counter_write(fd, "");
+        ret = resctrl_mon_counter_pread(fileno(fd), &value);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(value, 0);
+
+        /* overflow */
+        test_counter_write(fd, "18446744073709551616\n");
+        ret = resctrl_mon_counter_pread(fileno(fd), &value);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(value, 0);
+
+        fclose(fd);
+}
+
+static void
+test_resctrl_mon_counter_pread_error(void **state __attribute__((unused)))
+{
+        int ret;
+        uint64_t value = 1;
+
+        ret = resctrl_mon_counter_pread(-1, &value);
+        assert_int_equal(ret, PQOS_RETVAL_ERROR);
+        assert_int_equal(value, 0);
+}
+
 int
 main(void)
 {
         const struct CMUnitTest tests[] = {
             cmocka_unit_test(test_resctrl_mon_mkdir),
             cmocka_unit_test(test_resctrl_mon_rmdir),
+            cmocka_unit_test(test_resctrl_mon_counter_pread),
+            cmocka_unit_test(test_resctrl_mon_counter_pread_unavailable),
+            cmocka_unit_test(test_resctrl_mon_counter_pread_error),
         };
 
         cmocka_run_group_tests(tests, NULL, NULL);
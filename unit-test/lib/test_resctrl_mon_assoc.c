@@ -543,9 +543,9 @@ test_resctrl_mon_assoc_get_pid_alloc_default(void **state
         will_return(__wrap_resctrl_alloc_get_grps_num, PQOS_RETVAL_OK);
         will_return(__wrap_resctrl_alloc_get_grps_num, 1);
 
-        expect_value(__wrap_resctrl_alloc_assoc_get_pid, task, 1);
-        will_return(__wrap_resctrl_alloc_assoc_get_pid, PQOS_RETVAL_OK);
-        will_return(__wrap_resctrl_alloc_assoc_get_pid, 0);
+        expect_value(__wrap_resctrl_alloc_task_search, task, 1);
+        will_return(__wrap_resctrl_alloc_task_search, PQOS_RETVAL_OK);
+        will_return(__wrap_resctrl_alloc_task_search, 0);
 
         expect_string(__wrap_scandir, dirp, "/sys/fs/resctrl/mon_groups/");
         will_return(__wrap_scandir, 1);
@@ -610,6 +610,129 @@ test_resctrl_mon_assoc_set_pid_error(void **state __attribute__((unused)))
         assert_int_equal(ret, PQOS_RETVAL_ERROR);
 }
 
+/* ======== resctrl_mon_assoc_get_pids ======== */
+
+static void
+test_resctrl_mon_assoc_get_pids_unsupported(void **state
+                                            __attribute__((unused)))
+{
+        int ret;
+        pid_t tasks[] = {1, 2};
+        char *names[DIM(tasks)] = {NULL};
+
+        will_return(resctrl_mon_is_supported, 0);
+
+        ret = resctrl_mon_assoc_get_pids(tasks, DIM(tasks), names);
+        assert_int_equal(ret, PQOS_RETVAL_RESOURCE);
+        assert_null(names[0]);
+        assert_null(names[1]);
+}
+
+static void
+test_resctrl_mon_assoc_get_pids(void **state __attribute__((unused)))
+{
+        int ret;
+        pid_t tasks[] = {2, 1};
+        char *names[DIM(tasks)] = {NULL};
+        struct pqos_cap cap;
+
+        will_return_maybe(__wrap__pqos_get_cap, &cap);
+
+        will_return(resctrl_mon_is_supported, 1);
+        will_return(__wrap_resctrl_alloc_get_grps_num, PQOS_RETVAL_OK);
+        will_return(__wrap_resctrl_alloc_get_grps_num, 1);
+
+        /* single scan for all tasks */
+        expect_string(__wrap_scandir, dirp, "/sys/fs/resctrl/mon_groups/");
+        will_return(__wrap_scandir, 1);
+
+        ret = resctrl_mon_assoc_get_pids(tasks, DIM(tasks), names);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_null(names[0]);
+        assert_non_null(names[1]);
+        assert_string_equal(names[1], "test");
+
+        free(names[1]);
+}
+
+static void
+test_resctrl_mon_assoc_get_pids_error(void **state __attribute__((unused)))
+{
+        int ret;
+        pid_t tasks[] = {1};
+        char *names[DIM(tasks)] = {NULL};
+        struct pqos_cap cap;
+
+        will_return_maybe(__wrap__pqos_get_cap, &cap);
+
+        will_return(resctrl_mon_is_supported, 1);
+        will_return(__wrap_resctrl_alloc_get_grps_num, PQOS_RETVAL_OK);
+        will_return(__wrap_resctrl_alloc_get_grps_num, 1);
+
+        expect_string(__wrap_scandir, dirp, "/sys/fs/resctrl/mon_groups/");
+        will_return(__wrap_scandir, -1);
+
+        ret = resctrl_mon_assoc_get_pids(tasks, DIM(tasks), names);
+        assert_int_equal(ret, PQOS_RETVAL_ERROR);
+        assert_null(names[0]);
+}
+
+/* ======== resctrl_mon_assoc_set_pids ======== */
+
+static void
+test_resctrl_mon_assoc_set_pids_unsupported(void **state
+                                            __attribute__((unused)))
+{
+        int ret;
+        pid_t tasks[] = {1};
+        char name[] = "test";
+        char *names[] = {name};
+
+        will_return(resctrl_mon_is_supported, 0);
+
+        ret = resctrl_mon_assoc_set_pids(0, tasks, DIM(tasks), names, NULL);
+        assert_int_equal(ret, PQOS_RETVAL_RESOURCE);
+}
+
+static void
+test_resctrl_mon_assoc_set_pids(void **state __attribute__((unused)))
+{
+        int ret;
+        pid_t tasks[] = {1, 2, 3, 4};
+        char name[] = "test";
+        char *names[] = {name, NULL, name, name};
+        int status[] = {PQOS_RETVAL_OK, PQOS_RETVAL_OK, PQOS_RETVAL_OK,
+                        PQOS_RETVAL_PARAM};
+
+        will_return(resctrl_mon_is_supported, 1);
+
+        /* group directory is created once per group */
+        expect_value(__wrap_resctrl_mon_mkdir, class_id, 0);
+        expect_string(__wrap_resctrl_mon_mkdir, name, name);
+        will_return(__wrap_resctrl_mon_mkdir, PQOS_RETVAL_OK);
+
+        ret = resctrl_mon_assoc_set_pids(0, tasks, DIM(tasks), names, status);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+}
+
+static void
+test_resctrl_mon_assoc_set_pids_error(void **state __attribute__((unused)))
+{
+        int ret;
+        pid_t tasks[] = {1};
+        char name[] = "test";
+        char *names[] = {name};
+
+        will_return(resctrl_mon_is_supported, 1);
+
+        expect_value(__wrap_resctrl_mon_mkdir, class_id, 1);
+        expect_string(__wrap_resctrl_mon_mkdir, name, name);
+        will_return(__wrap_resctrl_mon_mkdir, PQOS_RETVAL_BUSY);
+
+        ret = resctrl_mon_assoc_set_pids(1, tasks, DIM(tasks), names, NULL);
+        assert_int_equal(ret, PQOS_RETVAL_ERROR);
+}
+
 int
 main(void)
 {
@@ -630,6 +753,12 @@ main(void)
             cmocka_unit_test(test_resctrl_mon_assoc_set_pid_unsupported),
             cmocka_unit_test(test_resctrl_mon_assoc_set_pid),
             cmocka_unit_test(test_resctrl_mon_assoc_set_pid_error),
+            cmocka_unit_test(test_resctrl_mon_assoc_get_pids_unsupported),
+            cmocka_unit_test(test_resctrl_mon_assoc_get_pids),
+            cmocka_unit_test(test_resctrl_mon_assoc_get_pids_error),
+            cmocka_unit_test(test_resctrl_mon_assoc_set_pids_unsupported),
+            cmocka_unit_test(test_resctrl_mon_assoc_set_pids),
+            cmocka_unit_test(test_resctrl_mon_assoc_set_pids_error),
         };
 
         cmocka_run_group_tests(tests, NULL, NULL);
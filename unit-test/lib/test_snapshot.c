@@ -0,0 +1,329 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2022 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include "snapshot.h"
+#include "test.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+static char snapshot_file[64];
+
+/* ======== mock ======== */
+
+int
+hw_cap_l3ca_cdp(const struct pqos_cpuinfo *cpu, int *enabled)
+{
+        int ret;
+
+        assert_non_null(cpu);
+
+        ret = mock_type(int);
+        if (ret == PQOS_RETVAL_OK)
+                *enabled = mock_type(int);
+
+        return ret;
+}
+
+/* ======== setup ======== */
+
+static int
+test_init_snapshot(void **state)
+{
+        struct test_data *data;
+        unsigned technology = 0;
+        int ret;
+
+        technology |= 1 << PQOS_CAP_TYPE_MON;
+        technology |= 1 << PQOS_CAP_TYPE_L3CA;
+        technology |= 1 << PQOS_CAP_TYPE_MBA;
+
+        ret = test_init(state, technology);
+        if (ret != 0)
+                return ret;
+
+        data = (struct test_data *)*state;
+        data->cpu->mem_size =
+            sizeof(*data->cpu) +
+            data->cpu->num_cores * sizeof(data->cpu->cores[0]);
+        data->cap->mem_size =
+            sizeof(*data->cap) +
+            data->cap->num_cap * sizeof(data->cap->capabilities[0]);
+        data->cap_mon->mem_size =
+            sizeof(*data->cap_mon) +
+            data->cap_mon->num_events * sizeof(data->cap_mon->events[0]);
+        data->cap_l3ca.mem_size = sizeof(data->cap_l3ca);
+        data->cap_mba.mem_size = sizeof(data->cap_mba);
+
+        snprintf(snapshot_file, sizeof(snapshot_file),
+                 "/tmp/pqos_test_snapshot.%d", (int)getpid());
+        setenv("RDT_SNAPSHOT", snapshot_file, 1);
+
+        return 0;
+}
+
+static int
+test_fini_snapshot(void **state)
+{
+        snapshot_fini();
+        unlink(snapshot_file);
+        unsetenv("RDT_SNAPSHOT");
+
+        return test_fini(state);
+}
+
+static void
+free_cap(struct pqos_cap *cap)
+{
+        unsigned i;
+
+        for (i = 0; i < cap->num_cap; i++)
+                free(cap->capabilities[i].u.generic_ptr);
+        free(cap);
+}
+
+/* ======== snapshot_init ======== */
+
+static void
+test_snapshot_init_missing(void **state __attribute__((unused)))
+{
+        int ret;
+
+        ret = snapshot_init();
+        assert_int_equal(ret, PQOS_RETVAL_RESOURCE);
+}
+
+static void
+test_snapshot_init_unset(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        int ret;
+
+        unsetenv("RDT_SNAPSHOT");
+
+        ret = snapshot_save(PQOS_INTER_MSR, data->cap, data->cpu);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_not_equal(access(snapshot_file, F_OK), 0);
+
+        ret = snapshot_init();
+        assert_int_equal(ret, PQOS_RETVAL_RESOURCE);
+}
+
+static void
+test_snapshot_init_corrupted(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        FILE *fd;
+        int ret;
+
+        ret = snapshot_save(PQOS_INTER_MSR, data->cap, data->cpu);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        fd = fopen(snapshot_file, "r+");
+        assert_non_null(fd);
+        assert_int_equal(fseek(fd, -1, SEEK_END), 0);
+        fputc(0xff, fd);
+        fclose(fd);
+
+        ret = snapshot_init();
+        assert_int_equal(ret, PQOS_RETVAL_RESOURCE);
+}
+
+/* ======== snapshot_get_cpu ======== */
+
+static void
+test_snapshot_get_cpu(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        struct pqos_cpuinfo *cpu = NULL;
+        int ret;
+
+        ret = snapshot_get_cpu(&cpu);
+        assert_int_equal(ret, PQOS_RETVAL_RESOURCE);
+
+        ret = snapshot_save(PQOS_INTER_MSR, data->cap, data->cpu);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        ret = snapshot_init();
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        ret = snapshot_get_cpu(&cpu);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_non_null(cpu);
+        assert_memory_equal(cpu, data->cpu, data->cpu->mem_size);
+
+        free(cpu);
+}
+
+/* ======== snapshot_get_cap ======== */
+
+static void
+test_snapshot_get_cap(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        struct pqos_cap *cap = NULL;
+        unsigned i;
+        int ret;
+
+        ret = snapshot_save(PQOS_INTER_MSR, data->cap, data->cpu);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        ret = snapshot_init();
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        ret = snapshot_get_cap(PQOS_INTER_MSR, data->cpu, &cap);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_non_null(cap);
+        assert_int_equal(cap->num_cap, data->cap->num_cap);
+
+        for (i = 0; i < cap->num_cap; i++) {
+                const struct pqos_capability *c = &cap->capabilities[i];
+                const struct pqos_capability *e = &data->cap->capabilities[i];
+
+                assert_int_equal(c->type, e->type);
+                assert_memory_equal(c->u.generic_ptr, e->u.generic_ptr,
+                                    *(unsigned *)e->u.generic_ptr);
+        }
+
+        free_cap(cap);
+}
+
+static void
+test_snapshot_get_cap_interface(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        struct pqos_cap *cap = NULL;
+        int ret;
+
+        ret = snapshot_save(PQOS_INTER_MSR, data->cap, data->cpu);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        ret = snapshot_init();
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        ret = snapshot_get_cap(PQOS_INTER_OS, data->cpu, &cap);
+        assert_int_equal(ret, PQOS_RETVAL_RESOURCE);
+        assert_null(cap);
+}
+
+static void
+test_snapshot_get_cap_topology(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        struct pqos_cap *cap = NULL;
+        int ret;
+
+        ret = snapshot_save(PQOS_INTER_MSR, data->cap, data->cpu);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        ret = snapshot_init();
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        data->cpu->cores[0].l2_id = 100;
+
+        ret = snapshot_get_cap(PQOS_INTER_MSR, data->cpu, &cap);
+        assert_int_equal(ret, PQOS_RETVAL_RESOURCE);
+        assert_null(cap);
+}
+
+static void
+test_snapshot_get_cap_cdp(void **state)
+{
+        struct test_data *data = (struct test_data *)*state;
+        struct pqos_cap *cap = NULL;
+        int ret;
+
+        data->cap_l3ca.cdp = 1;
+        data->cap_l3ca.cdp_on = 0;
+
+        ret = snapshot_save(PQOS_INTER_MSR, data->cap, data->cpu);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        ret = snapshot_init();
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+
+        /* CDP state unchanged */
+        will_return(hw_cap_l3ca_cdp, PQOS_RETVAL_OK);
+        will_return(hw_cap_l3ca_cdp, 0);
+
+        ret = snapshot_get_cap(PQOS_INTER_MSR, data->cpu, &cap);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        free_cap(cap);
+        cap = NULL;
+
+        /* CDP enabled since snapshot */
+        will_return(hw_cap_l3ca_cdp, PQOS_RETVAL_OK);
+        will_return(hw_cap_l3ca_cdp, 1);
+
+        ret = snapshot_get_cap(PQOS_INTER_MSR, data->cpu, &cap);
+        assert_int_equal(ret, PQOS_RETVAL_RESOURCE);
+        assert_null(cap);
+}
+
+int
+main(void)
+{
+        int result = 0;
+
+        const struct CMUnitTest tests[] = {
+            cmocka_unit_test_setup_teardown(test_snapshot_init_missing,
+                                            test_init_snapshot,
+                                            test_fini_snapshot),
+            cmocka_unit_test_setup_teardown(test_snapshot_init_unset,
+                                            test_init_snapshot,
+                                            test_fini_snapshot),
+            cmocka_unit_test_setup_teardown(test_snapshot_init_corrupted,
+                                            test_init_snapshot,
+                                            test_fini_snapshot),
+            cmocka_unit_test_setup_teardown(test_snapshot_get_cpu,
+                                            test_init_snapshot,
+                                            test_fini_snapshot),
+            cmocka_unit_test_setup_teardown(test_snapshot_get_cap,
+                                            test_init_snapshot,
+                                            test_fini_snapshot),
+            cmocka_unit_test_setup_teardown(test_snapshot_get_cap_interface,
+                                            test_init_snapshot,
+                                            test_fini_snapshot),
+            cmocka_unit_test_setup_teardown(test_snapshot_get_cap_topology,
+                                            test_init_snapshot,
+                                            test_fini_snapshot),
+            cmocka_unit_test_setup_teardown(test_snapshot_get_cap_cdp,
+                                            test_init_snapshot,
+                                            test_fini_snapshot),
+        };
+
+        result += cmocka_run_group_tests(tests, NULL, NULL);
+
+        return result;
+}
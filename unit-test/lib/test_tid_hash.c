@@ -0,0 +1,212 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2022 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "test.h"
+#include "tid_hash.h"
+
+/* ======== tid_hash_put ======== */
+
+static void
+test_tid_hash_put(void **state __attribute__((unused)))
+{
+        struct tid_hash hash;
+        unsigned value;
+        int ret;
+
+        tid_hash_init(&hash);
+
+        ret = tid_hash_put(&hash, 100, 1);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        ret = tid_hash_put(&hash, 200, 2);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(hash.num, 2);
+
+        assert_int_equal(tid_hash_get(&hash, 100, &value), 1);
+        assert_int_equal(value, 1);
+        assert_int_equal(tid_hash_get(&hash, 200, &value), 1);
+        assert_int_equal(value, 2);
+        assert_int_equal(tid_hash_get(&hash, 300, NULL), 0);
+
+        /* value of existing TID is updated */
+        ret = tid_hash_put(&hash, 100, 5);
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(hash.num, 2);
+        assert_int_equal(tid_hash_get(&hash, 100, &value), 1);
+        assert_int_equal(value, 5);
+
+        tid_hash_fini(&hash);
+}
+
+static void
+test_tid_hash_put_resize(void **state __attribute__((unused)))
+{
+        struct tid_hash hash;
+        unsigned value;
+        pid_t tid;
+
+        tid_hash_init(&hash);
+
+        for (tid = 1; tid <= 1000; tid++)
+                assert_int_equal(tid_hash_put(&hash, tid, (unsigned)tid * 2),
+                                 PQOS_RETVAL_OK);
+        assert_int_equal(hash.num, 1000);
+        assert_true(hash.num * 4 <= hash.size * 3);
+
+        for (tid = 1; tid <= 1000; tid++) {
+                assert_int_equal(tid_hash_get(&hash, tid, &value), 1);
+                assert_int_equal(value, (unsigned)tid * 2);
+        }
+
+        tid_hash_fini(&hash);
+}
+
+/* ======== tid_hash_get ======== */
+
+static void
+test_tid_hash_get_empty(void **state __attribute__((unused)))
+{
+        struct tid_hash hash;
+
+        tid_hash_init(&hash);
+
+        assert_int_equal(tid_hash_get(&hash, 1, NULL), 0);
+        assert_int_equal(tid_hash_del(&hash, 1), 0);
+
+        tid_hash_fini(&hash);
+}
+
+/* ======== tid_hash_del ======== */
+
+static void
+test_tid_hash_del(void **state __attribute__((unused)))
+{
+        struct tid_hash hash;
+        unsigned value;
+        pid_t tid;
+
+        tid_hash_init(&hash);
+
+        for (tid = 1; tid <= 100; tid++)
+                assert_int_equal(tid_hash_put(&hash, tid, (unsigned)tid),
+                                 PQOS_RETVAL_OK);
+
+        /* remove every other TID, remaining ones stay reachable */
+        for (tid = 1; tid <= 100; tid += 2)
+                assert_int_equal(tid_hash_del(&hash, tid), 1);
+        assert_int_equal(hash.num, 50);
+        assert_int_equal(tid_hash_del(&hash, 1), 0);
+
+        for (tid = 1; tid <= 100; tid++) {
+                if (tid % 2) {
+                        assert_int_equal(tid_hash_get(&hash, tid, NULL), 0);
+                        continue;
+                }
+                assert_int_equal(tid_hash_get(&hash, tid, &value), 1);
+                assert_int_equal(value, (unsigned)tid);
+        }
+
+        tid_hash_fini(&hash);
+}
+
+static void
+test_tid_hash_del_collision(void **state __attribute__((unused)))
+{
+        struct tid_hash hash;
+        unsigned value;
+        pid_t tid;
+
+        tid_hash_init(&hash);
+
+        /* TIDs differing by table size share a home slot */
+        assert_int_equal(tid_hash_reserve(&hash, 1), PQOS_RETVAL_OK);
+        for (tid = 1; tid <= 4; tid++)
+                assert_int_equal(
+                    tid_hash_put(&hash, tid * (pid_t)hash.size * 65536, 0),
+                    PQOS_RETVAL_OK);
+
+        assert_int_equal(tid_hash_del(&hash, (pid_t)hash.size * 65536), 1);
+        for (tid = 2; tid <= 4; tid++)
+                assert_int_equal(tid_hash_get(&hash,
+                                              tid * (pid_t)hash.size * 65536,
+                                              &value),
+                                 1);
+
+        tid_hash_fini(&hash);
+}
+
+/* ======== tid_hash_reserve ======== */
+
+static void
+test_tid_hash_reserve(void **state __attribute__((unused)))
+{
+        struct tid_hash hash;
+        unsigned size;
+        pid_t tid;
+
+        tid_hash_init(&hash);
+
+        assert_int_equal(tid_hash_reserve(&hash, 100), PQOS_RETVAL_OK);
+        size = hash.size;
+        assert_true(size * 3 >= 100 * 4);
+
+        /* no reallocation up to reserved number of TIDs */
+        for (tid = 1; tid <= 100; tid++)
+                assert_int_equal(tid_hash_put(&hash, tid, 0), PQOS_RETVAL_OK);
+        assert_int_equal(hash.size, size);
+
+        tid_hash_clear(&hash);
+        assert_int_equal(hash.num, 0);
+        assert_int_equal(hash.size, size);
+        assert_int_equal(tid_hash_get(&hash, 1, NULL), 0);
+
+        tid_hash_fini(&hash);
+}
+
+int
+main(void)
+{
+        int result = 0;
+
+        const struct CMUnitTest tests[] = {
+            cmocka_unit_test(test_tid_hash_put),
+            cmocka_unit_test(test_tid_hash_put_resize),
+            cmocka_unit_test(test_tid_hash_get_empty),
+            cmocka_unit_test(test_tid_hash_del),
+            cmocka_unit_test(test_tid_hash_del_collision),
+            cmocka_unit_test(test_tid_hash_reserve),
+        };
+
+        result += cmocka_run_group_tests(tests, NULL, NULL);
+
+        return result;
+}
@@ -0,0 +1,118 @@
+/*
+ * BSD LICENSE
+ *
+ * Copyright(c) 2022 Intel Corporation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in
+ *     the documentation and/or other materials provided with the
+ *     distribution.
+ *   * Neither the name of Intel Corporation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include "test.h"
+#include "uring.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <unistd.h>
+
+/* ======== uring_read ======== */
+
+static void
+test_uring_read(void **state __attribute__((unused)))
+{
+        int ret;
+        char buf[2][16];
+        struct uring_read rd[2];
+        struct uring_read *reads[] = {&rd[0], &rd[1]};
+        FILE *fd = tmpfile();
+
+        assert_non_null(fd);
+        fprintf(fd, "1234567890");
+        fflush(fd);
+
+        memset(buf, 0, sizeof(buf));
+        rd[0].fd = fileno(fd);
+        rd[0].buf = buf[0];
+        rd[0].size = 4;
+        rd[0].offset = 0;
+        rd[1].fd = fileno(fd);
+        rd[1].buf = buf[1];
+        rd[1].size = sizeof(buf[1]);
+        rd[1].offset = 6;
+
+        ret = uring_read(reads, DIM(reads));
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(rd[0].res, 4);
+        assert_string_equal(buf[0], "1234");
+        assert_int_equal(rd[1].res, 4);
+        assert_string_equal(buf[1], "7890");
+
+        fclose(fd);
+}
+
+static void
+test_uring_read_error(void **state __attribute__((unused)))
+{
+        int ret;
+        char buf[16];
+        struct uring_read rd;
+        struct uring_read *reads[] = {&rd};
+
+        rd.fd = -1;
+        rd.buf = buf;
+        rd.size = sizeof(buf);
+        rd.offset = 0;
+
+        ret = uring_read(reads, DIM(reads));
+        assert_int_equal(ret, PQOS_RETVAL_OK);
+        assert_int_equal(rd.res, -EBADF);
+}
+
+static void
+test_uring_read_param(void **state __attribute__((unused)))
+{
+        int ret;
+
+        ret = uring_read(NULL, 1);
+        assert_int_equal(ret, PQOS_RETVAL_PARAM);
+}
+
+int
+main(void)
+{
+        int result = 0;
+
+        const struct CMUnitTest tests[] = {
+            cmocka_unit_test(test_uring_read),
+            cmocka_unit_test(test_uring_read_error),
+            cmocka_unit_test(test_uring_read_param),
+        };
+
+        result += cmocka_run_group_tests(tests, NULL, NULL);
+
+        return result;
+}
@@ -89,6 +89,16 @@ __wrap_hw_mon_stop(struct pqos_mon_data *group)
         return mock_type(int);
 }
 
+int
+__wrap_hw_mon_poll_prefetch(struct pqos_mon_data **groups,
+                            const unsigned num_groups)
+{
+        assert_non_null(groups);
+        check_expected(num_groups);
+
+        return mock_type(int);
+}
+
 int
 __wrap_hw_mon_poll(struct pqos_mon_data *group, const enum pqos_mon_event event)
 {
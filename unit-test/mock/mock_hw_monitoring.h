@@ -43,6 +43,8 @@ int __wrap_hw_mon_start(const unsigned num_cores,
                         void *context,
                         struct pqos_mon_data *group);
 int __wrap_hw_mon_stop(struct pqos_mon_data *group);
+int __wrap_hw_mon_poll_prefetch(struct pqos_mon_data **groups,
+                                const unsigned num_groups);
 int __wrap_hw_mon_poll(struct pqos_mon_data *group,
                        const enum pqos_mon_event event);
 int __wrap_hw_mon_start_uncore(const unsigned num_sockets,
@@ -53,3 +53,33 @@ __wrap_msr_write(const unsigned lcore, const uint32_t reg, const uint64_t value)
 
         return mock_type(int);
 }
+
+int
+__wrap_msr_batch_exec(struct msr_batch *batch)
+{
+        unsigned i;
+        int ret = MACHINE_RETVAL_OK;
+
+        assert_non_null(batch);
+
+        for (i = 0; i < batch->num; i++) {
+                struct msr_op *op = &batch->ops[i];
+                const unsigned lcore = op->lcore;
+                const uint32_t reg = op->reg;
+
+                check_expected(lcore);
+                check_expected(reg);
+                if (op->op == MSR_OP_READ)
+                        op->value = mock_type(uint64_t);
+                else {
+                        const uint64_t value = op->value;
+
+                        check_expected(value);
+                }
+                op->status = mock_type(int);
+                if (op->status != MACHINE_RETVAL_OK)
+                        ret = MACHINE_RETVAL_ERROR;
+        }
+
+        return ret;
+}
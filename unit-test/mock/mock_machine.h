@@ -33,11 +33,14 @@
 #ifndef MOCK_MACHINE_H_
 #define MOCK_MACHINE_H_
 
+#include "machine.h"
+
 #include <stdint.h>
 
 int __wrap_msr_read(const unsigned lcore, const uint32_t reg, uint64_t *value);
 int __wrap_msr_write(const unsigned lcore,
                      const uint32_t reg,
                      const uint64_t value);
+int __wrap_msr_batch_exec(struct msr_batch *batch);
 
 #endif /* MOCK_MACHINE_H_ */
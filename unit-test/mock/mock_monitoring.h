@@ -38,4 +38,4 @@
 int __wrap_pqos_mon_poll_events(struct pqos_mon_data *group);
 int __wrap_resctrl_mon_active(unsigned *monitoring_status);
 
-#endif MOCK_MONITORING_H_
+#endif /* MOCK_MONITORING_H_ */
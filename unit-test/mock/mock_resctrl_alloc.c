@@ -98,6 +98,24 @@ __wrap_resctrl_alloc_assoc_get_pid(const pid_t task, unsigned *class_id)
         return ret;
 }
 
+int
+__wrap_resctrl_alloc_task_search(unsigned *class_id,
+                                 const struct pqos_cap *cap,
+                                 const pid_t task)
+{
+        int ret;
+
+        check_expected(task);
+        assert_non_null(class_id);
+        assert_non_null(cap);
+
+        ret = mock_type(int);
+        if (ret == PQOS_RETVAL_OK)
+                *class_id = mock_type(int);
+
+        return ret;
+}
+
 int
 __wrap_resctrl_alloc_get_unused_group(const unsigned grps_num,
                                       unsigned *group_id)
@@ -165,6 +183,27 @@ __wrap_resctrl_alloc_task_write(const unsigned class_id, const pid_t task)
         return mock_type(int);
 }
 
+int
+__wrap_resctrl_alloc_tasks_write(const unsigned class_id,
+                                 const pid_t *tasks,
+                                 const unsigned num_tasks,
+                                 int *status)
+{
+        unsigned i;
+        int ret;
+
+        assert_non_null(tasks);
+        check_expected(class_id);
+        check_expected(num_tasks);
+
+        ret = mock_type(int);
+        if (status != NULL)
+                for (i = 0; i < num_tasks; i++)
+                        status[i] = ret;
+
+        return ret;
+}
+
 int
 __wrap_resctrl_alloc_get_num_closids(unsigned *num_closids)
 {
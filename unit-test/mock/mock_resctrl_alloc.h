@@ -44,6 +44,9 @@ int __wrap_resctrl_alloc_assoc_get(const unsigned lcore, unsigned *class_id);
 int __wrap_resctrl_alloc_assoc_set_pid(const pid_t task,
                                        const unsigned class_id);
 int __wrap_resctrl_alloc_assoc_get_pid(const pid_t task, unsigned *class_id);
+int __wrap_resctrl_alloc_task_search(unsigned *class_id,
+                                     const struct pqos_cap *cap,
+                                     const pid_t task);
 int __wrap_resctrl_alloc_get_unused_group(const unsigned grps_num,
                                           unsigned *group_id);
 int __wrap_resctrl_alloc_cpumask_write(const unsigned class_id,
@@ -57,6 +60,10 @@ __wrap_resctrl_alloc_schemata_write(const unsigned class_id,
                                     const unsigned technology,
                                     const struct resctrl_schemata *schemata);
 int __wrap_resctrl_alloc_task_write(const unsigned class_id, const pid_t task);
+int __wrap_resctrl_alloc_tasks_write(const unsigned class_id,
+                                     const pid_t *tasks,
+                                     const unsigned num_tasks,
+                                     int *status);
 int __wrap_resctrl_alloc_get_num_closids(unsigned *num_closids);
 int __wrap_resctrl_alloc_get_grps_num(const struct pqos_cap *cap,
                                       unsigned *grps_num);
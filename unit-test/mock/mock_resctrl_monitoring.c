@@ -82,6 +82,58 @@ __wrap_resctrl_mon_assoc_set_pid(const pid_t task, const char *name)
         return mock_type(int);
 }
 
+int
+__wrap_resctrl_mon_assoc_get_pids(const pid_t *tasks,
+                                  const unsigned num_tasks,
+                                  char **names)
+{
+        int ret;
+        unsigned i;
+
+        assert_non_null(tasks);
+        assert_non_null(names);
+        check_expected(num_tasks);
+
+        ret = mock_type(int);
+        if (ret != PQOS_RETVAL_OK)
+                return ret;
+
+        /* monitoring group name of each task, NULL if not monitored */
+        for (i = 0; i < num_tasks; i++) {
+                const char *name = mock_ptr_type(const char *);
+
+                if (name != NULL)
+                        names[i] = strdup(name);
+        }
+
+        return ret;
+}
+
+int
+__wrap_resctrl_mon_assoc_set_pids(const unsigned class_id,
+                                  const pid_t *tasks,
+                                  const unsigned num_tasks,
+                                  char *const *names,
+                                  const int *status __attribute__((unused)))
+{
+        unsigned i;
+
+        check_expected(class_id);
+
+        for (i = 0; i < num_tasks; i++) {
+                const pid_t task = tasks[i];
+                const char *name = names[i];
+
+                if (name == NULL)
+                        continue;
+
+                check_expected(task);
+                check_expected(name);
+        }
+
+        return mock_type(int);
+}
+
 int
 __wrap_resctrl_mon_mkdir(const unsigned class_id, const char *name)
 {
@@ -43,6 +43,14 @@ int __wrap_resctrl_mon_assoc_get_pid(const pid_t task,
                                      char *name,
                                      const unsigned name_size);
 int __wrap_resctrl_mon_assoc_set_pid(const pid_t task, const char *name);
+int __wrap_resctrl_mon_assoc_get_pids(const pid_t *tasks,
+                                      const unsigned num_tasks,
+                                      char **names);
+int __wrap_resctrl_mon_assoc_set_pids(const unsigned class_id,
+                                      const pid_t *tasks,
+                                      const unsigned num_tasks,
+                                      char *const *names,
+                                      const int *status);
 int __wrap_resctrl_mon_mkdir(const unsigned class_id, const char *name);
 int __wrap_resctrl_mon_rmdir(const unsigned class_id, const char *name);
 int __wrap_resctrl_mon_cpumask_read(const unsigned class_id,
@@ -62,5 +70,6 @@ int resctrl_mon_cpumask_read(const unsigned class_id,
 int resctrl_mon_cpumask_write(const unsigned class_id,
                               const char *resctrl_group,
                               const struct resctrl_cpumask *mask);
+int resctrl_mon_counter_pread(const int fd, uint64_t *value);
 
 #endif /* MOCK_RESCTRL_MONITORING_H_ */